@@ -480,6 +480,7 @@ cdef extern from 'client/client.h' namespace 'cl':
         weaver_client_returncode single_stream_migration()
         weaver_client_returncode exit_weaver()
         weaver_client_returncode get_node_count(vector[uint64_t]&)
+        weaver_client_returncode get_mem_stats(vector[vector[uint64_t]]&)
         bint aux_index()
 
 class WeaverError(Exception):
@@ -1369,5 +1370,11 @@ cdef class Client:
             count.append(deref(iter))
             inc(iter)
         return count
+    def get_mem_stats(self):
+        cdef vector[vector[uint64_t]] mem_bytes
+        code = self.thisptr.get_mem_stats(mem_bytes)
+        if code != WEAVER_CLIENT_SUCCESS:
+            raise WeaverError(code)
+        return [list(shard_bytes) for shard_bytes in mem_bytes]
     def aux_index(self):
         return self.thisptr.aux_index()
@@ -96,6 +96,11 @@ client :: client(const char *coordinator="127.0.0.1", uint16_t port=5200, const
     weaver_client_returncode reg_code;
     INIT_PROG("/usr/local/lib/libweavertraversepropsprog.so", "traverse_props_prog", prog_handle);
     INIT_PROG("/usr/local/lib/libweavernninferprog.so", "nn_infer_prog", prog_handle);
+    INIT_PROG("/usr/local/lib/libweavertwoneighborhoodprog.so", "two_neighborhood_prog", prog_handle);
+    INIT_PROG("/usr/local/lib/libweaverpathlessreachprog.so", "pathless_reach_prog", prog_handle);
+    INIT_PROG("/usr/local/lib/libweaverpagerankprog.so", "pagerank_prog", prog_handle);
+    INIT_PROG("/usr/local/lib/libweavermsbfsprog.so", "msbfs_prog", prog_handle);
+    INIT_PROG("/usr/local/lib/libweaverbireachprog.so", "bireach_prog", prog_handle);
 }
 
 // call once per application, even with multiple clients
@@ -418,9 +423,18 @@ client :: run_node_prog(const std::string &prog_type,
 
     void *prog_handle = (void*)prog_iter->second.get();
 
+    // per request constants are sent once, those of the first start node apply to the whole request
+    node_prog::np_const_ptr_t constants;
+    for (auto &p: initial_args) {
+        node_prog::np_const_ptr_t c = p.second->extract_constants();
+        if (constants == nullptr) {
+            constants = c;
+        }
+    }
+
 #ifdef weaver_benchmark_
 
-    msg.prepare_message(message::CLIENT_NODE_PROG_REQ, prog_handle, prog_type, initial_args);
+    msg.prepare_message(message::CLIENT_NODE_PROG_REQ, prog_handle, prog_type, constants, initial_args);
     send_code = send_coord(msg.buf);
 
     if (send_code != BUSYBEE_SUCCESS) {
@@ -437,7 +451,7 @@ client :: run_node_prog(const std::string &prog_type,
 
     bool retry;
     do {
-        msg.prepare_message(message::CLIENT_NODE_PROG_REQ, prog_handle, prog_type, initial_args);
+        msg.prepare_message(message::CLIENT_NODE_PROG_REQ, prog_handle, prog_type, constants, initial_args);
         send_code = send_coord(msg.buf);
 
         if (send_code == BUSYBEE_DISRUPTED) {
@@ -488,6 +502,99 @@ client :: run_node_prog(const std::string &prog_type,
     }
 }
 
+// whole graph prog, runs at every node in supersteps
+// max_supersteps 0 runs until every node halts and no messages are sent
+weaver_client_returncode
+client :: run_bsp_prog(const std::string &prog_type,
+                       std::shared_ptr<Node_Parameters_Base> &params,
+                       uint32_t max_supersteps,
+                       std::shared_ptr<Node_Parameters_Base> &return_param)
+{
+    CHECK_INIT;
+
+    message::message msg;
+    busybee_returncode send_code, recv_code;
+
+    auto prog_iter = m_dyn_prog_map.find(prog_type);
+    if (prog_iter == m_dyn_prog_map.end()) {
+        WDEBUG << "did not find node prog " << prog_type << std::endl;
+        return WEAVER_CLIENT_BADPROGTYPE;
+    }
+
+    void *prog_handle = (void*)prog_iter->second.get();
+
+#ifdef weaver_benchmark_
+
+    msg.prepare_message(message::CLIENT_BSP_PROG_REQ, prog_handle, prog_type, max_supersteps, params);
+    send_code = send_coord(msg.buf);
+
+    if (send_code != BUSYBEE_SUCCESS) {
+        return WEAVER_CLIENT_INTERNALMSGERROR;
+    }
+
+    recv_code = recv_coord(&msg.buf);
+
+    if (recv_code != BUSYBEE_SUCCESS) {
+        return WEAVER_CLIENT_INTERNALMSGERROR;
+    }
+
+#else
+
+    bool retry;
+    do {
+        msg.prepare_message(message::CLIENT_BSP_PROG_REQ, prog_handle, prog_type, max_supersteps, params);
+        send_code = send_coord(msg.buf);
+
+        if (send_code == BUSYBEE_DISRUPTED) {
+            reconfigure();
+            return WEAVER_CLIENT_DISRUPTED;
+        } else if (send_code != BUSYBEE_SUCCESS) {
+            return WEAVER_CLIENT_INTERNALMSGERROR;
+        }
+
+        recv_code = recv_coord(&msg.buf);
+
+        switch (recv_code) {
+            case BUSYBEE_TIMEOUT:
+            case BUSYBEE_DISRUPTED:
+                reconfigure();
+                retry = true;
+                break;
+
+            case BUSYBEE_SUCCESS:
+                if (msg.unpack_message_type() == message::NODE_PROG_RETRY) {
+                    retry = true;
+                } else {
+                    retry = false;
+                }
+                break;
+
+            default:
+                return WEAVER_CLIENT_INTERNALMSGERROR;
+        }
+    } while (retry);
+
+#endif
+
+    std::string return_prog_type;
+    uint64_t ignore_req_id, ignore_vt_ptr;
+    auto ret_status = msg.unpack_message_type();
+    if (ret_status == message::NODE_PROG_RETURN) {
+        msg.unpack_message(message::NODE_PROG_RETURN,
+                           prog_handle,
+                           return_prog_type,
+                           ignore_req_id,
+                           ignore_vt_ptr,
+                           return_param);
+        assert(return_prog_type == prog_type);
+        return WEAVER_CLIENT_SUCCESS;
+    } else if (ret_status == message::NODE_PROG_BADPROGTYPE) {
+        return WEAVER_CLIENT_BADPROGTYPE;
+    } else {
+        return WEAVER_CLIENT_NOTFOUND;
+    }
+}
+
 weaver_client_returncode
 client :: traverse_props_program(std::vector<std::pair<std::string, node_prog::traverse_props_params>> &initial_args,
                                  node_prog::traverse_props_params &return_param)
@@ -533,6 +640,144 @@ client :: nn_infer(std::string &start_node,
     return retcode;
 }
 
+weaver_client_returncode
+client :: two_neighborhood_program(const std::string &center,
+                                   node_prog::two_neighborhood_params &args,
+                                   node_prog::two_neighborhood_params &ret)
+{
+    auto param_ptr = std::make_shared<node_prog::two_neighborhood_params>(args);
+    auto base_ptr  = std::dynamic_pointer_cast<Node_Parameters_Base>(param_ptr);
+    std::vector<std::pair<std::string, std::shared_ptr<Node_Parameters_Base>>> ptr_args(1, std::make_pair(center, base_ptr));
+
+    std::shared_ptr<Node_Parameters_Base> return_base_ptr;
+    weaver_client_returncode retcode = run_node_prog(m_built_in_progs["two_neighborhood_prog"], ptr_args, return_base_ptr);
+
+    auto return_param_ptr = std::dynamic_pointer_cast<node_prog::two_neighborhood_params>(return_base_ptr);
+    ret = *return_param_ptr;
+
+    return retcode;
+}
+
+weaver_client_returncode
+client :: pathless_reach_program(const std::string &source,
+                                 node_prog::pathless_reach_params &args,
+                                 node_prog::pathless_reach_params &ret)
+{
+    auto param_ptr = std::make_shared<node_prog::pathless_reach_params>(args);
+    param_ptr->prev_node = db::coordinator;
+    auto base_ptr  = std::dynamic_pointer_cast<Node_Parameters_Base>(param_ptr);
+    std::vector<std::pair<std::string, std::shared_ptr<Node_Parameters_Base>>> ptr_args(1, std::make_pair(source, base_ptr));
+
+    std::shared_ptr<Node_Parameters_Base> return_base_ptr;
+    weaver_client_returncode retcode = run_node_prog(m_built_in_progs["pathless_reach_prog"], ptr_args, return_base_ptr);
+
+    auto return_param_ptr = std::dynamic_pointer_cast<node_prog::pathless_reach_params>(return_base_ptr);
+    ret = *return_param_ptr;
+
+    return retcode;
+}
+
+weaver_client_returncode
+client :: msbfs_program(const std::vector<std::pair<std::string, std::string>> &queries,
+                        node_prog::msbfs_params &args,
+                        std::vector<uint32_t> &distances)
+{
+    distances.assign(queries.size(), node_prog::MsbfsUnreachable);
+
+    for (uint64_t first = 0; first < queries.size(); first += node_prog::MaxMsbfsQueries) {
+        uint64_t num = std::min<uint64_t>(queries.size() - first, node_prog::MaxMsbfsQueries);
+
+        // queries from the same source start as one hop
+        std::vector<node_handle_t> targets;
+        std::unordered_map<std::string, uint64_t> frontiers;
+        std::vector<std::string> sources;
+        for (uint64_t q = 0; q < num; q++) {
+            const std::pair<std::string, std::string> &query = queries[first+q];
+            targets.emplace_back(query.second);
+            if (frontiers.find(query.first) == frontiers.end()) {
+                sources.emplace_back(query.first);
+            }
+            frontiers[query.first] |= (1ULL << q);
+        }
+
+        std::vector<std::pair<std::string, std::shared_ptr<Node_Parameters_Base>>> ptr_args;
+        for (const std::string &src: sources) {
+            auto param_ptr = std::make_shared<node_prog::msbfs_params>();
+            param_ptr->targets = targets;
+            param_ptr->max_hops = args.max_hops;
+            param_ptr->edge_props = args.edge_props;
+            param_ptr->frontier = frontiers[src];
+            param_ptr->hops = 0;
+            auto base_ptr  = std::dynamic_pointer_cast<Node_Parameters_Base>(param_ptr);
+            ptr_args.emplace_back(std::make_pair(src, base_ptr));
+        }
+
+        std::shared_ptr<Node_Parameters_Base> return_base_ptr;
+        weaver_client_returncode retcode = run_node_prog(m_built_in_progs["msbfs_prog"], ptr_args, return_base_ptr);
+        if (retcode != WEAVER_CLIENT_SUCCESS) {
+            return retcode;
+        }
+
+        auto return_param_ptr = std::dynamic_pointer_cast<node_prog::msbfs_params>(return_base_ptr);
+        const std::vector<uint32_t> &found = return_param_ptr->distances;
+        for (uint64_t q = 0; q < num && q < found.size(); q++) {
+            distances[first+q] = found[q];
+        }
+    }
+
+    return WEAVER_CLIENT_SUCCESS;
+}
+
+weaver_client_returncode
+client :: bireach_program(const std::string &source,
+                          const std::string &dest,
+                          node_prog::bireach_params &args,
+                          node_prog::bireach_params &ret)
+{
+    auto fwd_ptr = std::make_shared<node_prog::bireach_params>(args);
+    fwd_ptr->backward = false;
+    fwd_ptr->returning = false;
+    fwd_ptr->prev_node = db::coordinator;
+    fwd_ptr->source = source;
+    fwd_ptr->dest = dest;
+
+    auto back_ptr = std::make_shared<node_prog::bireach_params>(*fwd_ptr);
+    back_ptr->backward = true;
+    back_ptr->via.clear();
+    back_ptr->hops = 0;
+
+    std::vector<std::pair<std::string, std::shared_ptr<Node_Parameters_Base>>> ptr_args;
+    ptr_args.emplace_back(std::make_pair(source, std::dynamic_pointer_cast<Node_Parameters_Base>(fwd_ptr)));
+    ptr_args.emplace_back(std::make_pair(dest, std::dynamic_pointer_cast<Node_Parameters_Base>(back_ptr)));
+
+    std::shared_ptr<Node_Parameters_Base> return_base_ptr;
+    weaver_client_returncode retcode = run_node_prog(m_built_in_progs["bireach_prog"], ptr_args, return_base_ptr);
+
+    auto return_param_ptr = std::dynamic_pointer_cast<node_prog::bireach_params>(return_base_ptr);
+    ret = *return_param_ptr;
+
+    return retcode;
+}
+
+weaver_client_returncode
+client :: pagerank_program(node_prog::pagerank_params &args,
+                           node_prog::pagerank_params &ret)
+{
+    auto param_ptr = std::make_shared<node_prog::pagerank_params>(args);
+    auto base_ptr  = std::dynamic_pointer_cast<Node_Parameters_Base>(param_ptr);
+
+    // one more superstep than the prog sends messages for, to add up the last ranks
+    std::shared_ptr<Node_Parameters_Base> return_base_ptr;
+    weaver_client_returncode retcode = run_bsp_prog(m_built_in_progs["pagerank_prog"], base_ptr, args.num_supersteps+1, return_base_ptr);
+
+    if (retcode == WEAVER_CLIENT_SUCCESS) {
+        auto return_param_ptr = std::dynamic_pointer_cast<node_prog::pagerank_params>(return_base_ptr);
+        ret = *return_param_ptr;
+    }
+
+    return retcode;
+}
+
 weaver_client_returncode
 client :: register_node_prog(const std::string &so_file,
                              std::string &prog_handle)
@@ -664,6 +909,43 @@ client :: get_node_count(std::vector<uint64_t> &node_count)
     }
 }
 
+weaver_client_returncode
+client :: get_mem_stats(std::vector<std::vector<uint64_t>> &mem_bytes)
+{
+    CHECK_INIT;
+
+    mem_bytes.clear();
+
+    while(true) {
+        message::message msg;
+        msg.prepare_message(message::CLIENT_MEM_STATS);
+        busybee_returncode send_code = send_coord(msg.buf);
+
+        if (send_code == BUSYBEE_DISRUPTED) {
+            reconfigure();
+            continue;
+        } else if (send_code != BUSYBEE_SUCCESS) {
+            return WEAVER_CLIENT_INTERNALMSGERROR;
+        }
+
+        busybee_returncode recv_code = recv_coord(&msg.buf);
+
+        switch (recv_code) {
+            case BUSYBEE_DISRUPTED:
+            case BUSYBEE_TIMEOUT:
+                reconfigure();
+                break;
+
+            case BUSYBEE_SUCCESS:
+                msg.unpack_message(message::MEM_STATS_REPLY, nullptr, mem_bytes);
+                return WEAVER_CLIENT_SUCCESS;
+
+            default:
+                return WEAVER_CLIENT_INTERNALMSGERROR;
+        }
+    }
+}
+
 #undef CHECK_INIT
 
 bool
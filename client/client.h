@@ -30,6 +30,11 @@
 #include "node_prog/node_prog_type.h"
 #include "node_prog/traverse_with_props.h"
 #include "node_prog/neural_net_infer.h"
+#include "node_prog/two_neighborhood_program.h"
+#include "node_prog/pathless_reach_program.h"
+#include "node_prog/pagerank_program.h"
+#include "node_prog/msbfs_program.h"
+#include "node_prog/bireach_program.h"
 
 namespace cl
 {
@@ -83,12 +88,36 @@ namespace cl
             weaver_client_returncode run_node_prog(const std::string &prog_type,
                                                    std::vector<std::pair<std::string, std::shared_ptr<node_prog::Node_Parameters_Base>>> &args,
                                                    std::shared_ptr<node_prog::Node_Parameters_Base> &return_param);
+            weaver_client_returncode run_bsp_prog(const std::string &prog_type,
+                                                  std::shared_ptr<node_prog::Node_Parameters_Base> &params,
+                                                  uint32_t max_supersteps,
+                                                  std::shared_ptr<node_prog::Node_Parameters_Base> &return_param);
             weaver_client_returncode traverse_props_program(std::vector<std::pair<std::string, node_prog::traverse_props_params>> &initial_args,
                                                             node_prog::traverse_props_params&);
             weaver_client_returncode nn_infer(std::string &start_node,
                                               std::string &end_node,
                                               node_prog::nn_params &args,
                                               node_prog::nn_params &ret);
+            weaver_client_returncode two_neighborhood_program(const std::string &center,
+                                                              node_prog::two_neighborhood_params &args,
+                                                              node_prog::two_neighborhood_params &ret);
+            weaver_client_returncode pathless_reach_program(const std::string &source,
+                                                            node_prog::pathless_reach_params &args,
+                                                            node_prog::pathless_reach_params &ret);
+            // hops from source to target of each (source, target) query, MsbfsUnreachable if not reachable
+            // in args.max_hops hops over edges with args.edge_props. MaxMsbfsQueries queries per request
+            weaver_client_returncode msbfs_program(const std::vector<std::pair<std::string, std::string>> &queries,
+                                                   node_prog::msbfs_params &args,
+                                                   std::vector<uint32_t> &distances);
+            // whether dest is reachable from source over edges with args.edge_props, searching
+            // forward from source and backward from dest at most args.max_back_hops hops
+            weaver_client_returncode bireach_program(const std::string &source,
+                                                     const std::string &dest,
+                                                     node_prog::bireach_params &args,
+                                                     node_prog::bireach_params &ret);
+
+            weaver_client_returncode pagerank_program(node_prog::pagerank_params &args,
+                                                      node_prog::pagerank_params &ret);
 
             weaver_client_returncode register_node_prog(const std::string &so_file,
                                                         std::string &prog_handle);
@@ -97,6 +126,8 @@ namespace cl
             weaver_client_returncode exit_weaver();
             uint64_t get_vt_id() { return vtid; }
             weaver_client_returncode get_node_count(std::vector<uint64_t>&);
+            // per shard, bytes for each db::mem_type
+            weaver_client_returncode get_mem_stats(std::vector<std::vector<uint64_t>>&);
             bool aux_index();
             void print_cur_tx();
 
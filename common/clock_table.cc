@@ -0,0 +1,238 @@
+/*
+ * ===============================================================
+ *    Description:  Implementation of clock interning table.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <string.h>
+
+#include "common/clock_table.h"
+
+using vc::clock_table;
+
+const vc::vclock_ptr_t clock_table::null_clk;
+
+vc::clock_table vc::interned_clocks;
+
+clock_table :: clock_table()
+    : next_id(null_id+1)
+    , width(0)
+{
+    for (uint32_t i = 0; i < MaxChunks; i++) {
+        chunks[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+clock_table :: ~clock_table()
+{
+    for (uint32_t i = 0; i < MaxChunks; i++) {
+        delete chunks[i].load(std::memory_order_relaxed);
+    }
+}
+
+uint64_t
+clock_table :: hash(uint64_t vt_id, const uint64_t *clk, uint64_t sz)
+{
+    uint64_t h = vt_id * 0x9e3779b97f4a7c15ULL;
+    for (uint64_t i = 0; i < sz; i++) {
+        h ^= clk[i] + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+bool
+clock_table :: row_equals(uint32_t id, const vclock &clk) const
+{
+    const uint64_t *r = row(id);
+    return r[0] == clk.vt_id
+        && memcmp(r+1, clk.clock.data(), clk.clock.size()*sizeof(uint64_t)) == 0;
+}
+
+// caller holds s.mtx
+// ids freed by a stripe are reused only by the same stripe, so that all
+// changes to an entry's live flag and index happen under one lock
+uint32_t
+clock_table :: alloc_id(stripe &s)
+{
+    if (!s.free_ids.empty()) {
+        uint32_t id = s.free_ids.back();
+        s.free_ids.pop_back();
+        return id;
+    }
+
+    uint32_t id = next_id.fetch_add(1, std::memory_order_relaxed);
+    assert(id != 0); // overflow
+    std::atomic<chunk*> &c = chunks[chunk_idx(id)];
+    if (c.load(std::memory_order_acquire) == nullptr) {
+        chunk *fresh = new chunk(1ULL << chunk_idx(id), row_sz());
+        chunk *expected = nullptr;
+        if (!c.compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) {
+            delete fresh;
+        }
+    }
+    return id;
+}
+
+// returns id for clock, adds clock to the table if not already present
+// caller owns one reference to the returned id
+uint32_t
+clock_table :: intern(const vclock_ptr_t &clk)
+{
+    if (!clk) {
+        return null_id;
+    }
+
+    uint32_t sz = clk->clock.size();
+    uint32_t expected = 0;
+    if (!width.compare_exchange_strong(expected, sz, std::memory_order_relaxed)) {
+        assert(expected == sz); // clocks are ClkSz wide
+    }
+
+    uint64_t h = hash(clk->vt_id, clk->clock.data(), sz);
+    uint8_t stripe_idx = h % NumStripes;
+    stripe &s = stripes[stripe_idx];
+    s.mtx.lock();
+
+    auto range = s.ids.equal_range(h);
+    for (auto iter = range.first; iter != range.second; iter++) {
+        if (row_equals(iter->second, *clk)) {
+            uint32_t id = iter->second;
+            // may revive an id whose last release is waiting for this lock
+            at(id).refcount.fetch_add(1, std::memory_order_relaxed);
+            s.mtx.unlock();
+            return id;
+        }
+    }
+
+    uint32_t id = alloc_id(s);
+    uint64_t *r = row(id);
+    r[0] = clk->vt_id;
+    memcpy(r+1, clk->clock.data(), sz*sizeof(uint64_t));
+
+    entry &e = at(id);
+    assert(!e.live && e.refcount.load(std::memory_order_relaxed) == 0);
+    e.stripe = stripe_idx;
+    e.live = true;
+    e.refcount.store(1, std::memory_order_relaxed);
+    s.ids.emplace(h, id);
+
+    s.mtx.unlock();
+    return id;
+}
+
+void
+clock_table :: release(uint32_t id)
+{
+    if (id == null_id) {
+        return;
+    }
+
+    entry &e = at(id);
+    uint32_t prev = e.refcount.fetch_sub(1, std::memory_order_acq_rel);
+    assert(prev > 0);
+    if (prev != 1) {
+        return;
+    }
+
+    // last reference, unless intern revived the id or another release got here first
+    stripe &s = stripes[e.stripe];
+    s.mtx.lock();
+    if (e.live && e.refcount.load(std::memory_order_relaxed) == 0) {
+        const uint64_t *r = row(id);
+        uint64_t h = hash(r[0], r+1, row_sz()-1);
+        auto range = s.ids.equal_range(h);
+        for (auto iter = range.first; iter != range.second; iter++) {
+            if (iter->second == id) {
+                s.ids.erase(iter);
+                break;
+            }
+        }
+        e.live = false;
+        e.has_clk.store(false, std::memory_order_relaxed);
+        e.clk.reset();
+        s.free_ids.emplace_back(id);
+    }
+    s.mtx.unlock();
+}
+
+// vclock for id, built from the row on first use
+// valid as long as the caller holds a reference to id
+const vc::vclock_ptr_t&
+clock_table :: get(uint32_t id) const
+{
+    if (id == null_id) {
+        return null_clk;
+    }
+
+    entry &e = at(id);
+    if (!e.has_clk.load(std::memory_order_acquire)) {
+        stripe &s = stripes[e.stripe];
+        s.mtx.lock();
+        if (!e.has_clk.load(std::memory_order_relaxed)) {
+            const uint64_t *r = row(id);
+            vclock_t clk(r+1, r+row_sz());
+            e.clk = std::make_shared<vclock>(r[0], clk);
+            e.has_clk.store(true, std::memory_order_release);
+        }
+        s.mtx.unlock();
+    }
+    return e.clk;
+}
+
+uint64_t
+clock_table :: num_clocks()
+{
+    uint64_t ret = 0;
+    for (uint32_t i = 0; i < NumStripes; i++) {
+        stripes[i].mtx.lock();
+        ret += stripes[i].ids.size();
+        stripes[i].mtx.unlock();
+    }
+    return ret;
+}
+
+// walks all ids, for stats only
+uint64_t
+clock_table :: num_references()
+{
+    uint64_t ret = 0;
+    uint32_t max_id = next_id.load(std::memory_order_relaxed);
+    for (uint32_t id = null_id+1; id < max_id; id++) {
+        if (chunk_of(id) != nullptr) {
+            ret += at(id).refcount.load(std::memory_order_relaxed);
+        }
+    }
+    return ret;
+}
+
+// approximate, counts chunks, built vclocks and stripe indices
+uint64_t
+clock_table :: bytes()
+{
+    uint64_t ret = 0;
+    uint64_t clk_sz = sizeof(vclock) + clock_size()*sizeof(uint64_t) + 2*sizeof(void*); // + shared_ptr control block
+    uint32_t max_id = next_id.load(std::memory_order_relaxed);
+    for (uint32_t c = 0; c < MaxChunks; c++) {
+        if (chunks[c].load(std::memory_order_acquire) != nullptr) {
+            ret += sizeof(chunk) + (1ULL << c) * (sizeof(entry) + row_sz()*sizeof(uint64_t));
+        }
+    }
+    for (uint32_t id = null_id+1; id < max_id; id++) {
+        if (chunk_of(id) != nullptr && at(id).has_clk.load(std::memory_order_relaxed)) {
+            ret += clk_sz;
+        }
+    }
+    for (uint32_t i = 0; i < NumStripes; i++) {
+        stripes[i].mtx.lock();
+        ret += stripes[i].ids.size() * (sizeof(std::pair<const uint64_t, uint32_t>) + 2*sizeof(void*))
+             + stripes[i].ids.bucket_count() * sizeof(void*)
+             + stripes[i].free_ids.capacity() * sizeof(uint32_t);
+        stripes[i].mtx.unlock();
+    }
+    return ret;
+}
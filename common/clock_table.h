@@ -0,0 +1,124 @@
+/*
+ * ===============================================================
+ *    Description:  Interned vector clocks for graph element
+ *                  version stamps.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_common_clock_table_h_
+#define weaver_common_clock_table_h_
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <po6/threads/mutex.h>
+
+#include "common/vclock.h"
+
+namespace vc
+{
+    // every distinct clock is stored once per shard, the shard process has one table
+    // elements and properties hold 32-bit ids into this table instead of
+    // their own shared_ptr copies, ids are refcounted and recycled
+    //
+    // clocks are kept as fixed-width rows of words (vt_id, then ClkSz entries) in
+    // per chunk arrays, visibility checks compare rows by id without a vclock object
+    // a vclock is built for an id only when get() asks for one
+    //
+    // acquire and release are lock free, intern and the last release of an id lock
+    // one of NumStripes stripes chosen by the clock's hash
+    class clock_table
+    {
+        public:
+            static const uint32_t null_id = 0;
+
+        private:
+            static const uint32_t MaxChunks = 32;
+            static const uint32_t NumStripes = 64;
+
+            struct entry
+            {
+                std::atomic<uint32_t> refcount;
+                uint8_t stripe;
+                bool live; // in the stripe index, under stripe lock
+                std::atomic<bool> has_clk;
+                vclock_ptr_t clk; // built by get(), reset on last release
+
+                entry() : refcount(0), stripe(0), live(false), has_clk(false) { }
+            };
+
+            // chunk k holds ids [2^k, 2^(k+1)), so the table grows geometrically with the id space used
+            struct chunk
+            {
+                std::unique_ptr<entry[]> entries;
+                std::unique_ptr<uint64_t[]> rows;
+
+                chunk(uint64_t sz, uint64_t row_sz) : entries(new entry[sz]), rows(new uint64_t[sz * row_sz]) { }
+            };
+
+            struct stripe
+            {
+                po6::threads::mutex mtx;
+                // clock hash -> ids, rows are compared on lookup
+                std::unordered_multimap<uint64_t, uint32_t> ids;
+                std::vector<uint32_t> free_ids;
+            };
+
+            // chunks are never moved or freed while the table lives, so lookups need not lock
+            std::atomic<chunk*> chunks[MaxChunks];
+            std::atomic<uint32_t> next_id;
+            std::atomic<uint32_t> width; // ClkSz, fixed by the first intern
+            mutable stripe stripes[NumStripes];
+
+            static const vclock_ptr_t null_clk;
+
+            uint64_t row_sz() const { return width.load(std::memory_order_relaxed) + 1; }
+            static uint32_t chunk_idx(uint32_t id) { return 31 - __builtin_clz(id); }
+            static uint32_t chunk_offset(uint32_t id) { return id ^ (1U << chunk_idx(id)); }
+            chunk* chunk_of(uint32_t id) const { return chunks[chunk_idx(id)].load(std::memory_order_acquire); }
+            entry& at(uint32_t id) const { return chunk_of(id)->entries[chunk_offset(id)]; }
+            uint64_t* row(uint32_t id) const { return chunk_of(id)->rows.get() + chunk_offset(id) * row_sz(); }
+
+            static uint64_t hash(uint64_t vt_id, const uint64_t *clk, uint64_t sz);
+            bool row_equals(uint32_t id, const vclock &clk) const;
+            uint32_t alloc_id(stripe &s);
+
+        public:
+            clock_table();
+            ~clock_table();
+
+            uint32_t intern(const vclock_ptr_t &clk);
+            void acquire(uint32_t id);
+            void release(uint32_t id);
+            const vclock_ptr_t& get(uint32_t id) const;
+            // ClkSz entries of the clock, epoch first, for id != null_id
+            const uint64_t* words(uint32_t id) const { return row(id) + 1; }
+            uint64_t vt_id(uint32_t id) const { return row(id)[0]; }
+            uint64_t clock_size() const { return width.load(std::memory_order_relaxed); }
+
+            // stats
+            uint64_t num_clocks();
+            uint64_t num_references();
+            uint64_t bytes();
+    };
+
+    inline void
+    clock_table :: acquire(uint32_t id)
+    {
+        if (id != null_id) {
+            // caller holds a reference already, so id cannot be recycled under us
+            at(id).refcount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    extern clock_table interned_clocks;
+}
+
+#endif
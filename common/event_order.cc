@@ -12,9 +12,15 @@
  */
 
 //#define weaver_debug_
+#include <algorithm>
+
 #include "common/event_order.h"
 #include "common/config_constants.h"
 
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
 using order::oracle;
 
 oracle :: oracle()
@@ -30,37 +36,69 @@ oracle :: oracle()
 int
 oracle :: compare_two_clocks(const vc::vclock_t &clk1, const vc::vclock_t &clk2)
 {
-    int ret = 2;
-
     uint64_t clk_sz = clk1.size() < clk2.size() ? clk1.size() : clk2.size();
     //assert(clk1.size() == ClkSz);
     //assert(clk2.size() == ClkSz);
+    return compare_two_clocks(clk1.data(), clk2.data(), clk_sz);
+}
 
+// same as above, on raw clock entries such as rows of vc::interned_clocks
+int
+oracle :: compare_two_clocks(const uint64_t *c1, const uint64_t *c2, uint64_t clk_sz)
+{
     // check epoch number
-    if (clk1[0] < clk2[0]) {
+    if (c1[0] < c2[0]) {
         return 0;
-    } else if (clk1[0] > clk2[0]) {
+    } else if (c1[0] > c2[0]) {
         return 1;
     }
 
     // same epoch number, compare each entry in vector
-    for (uint64_t i = 1; i < clk_sz; i++) {
-        if ((clk1[i] < clk2[i]) && (ret != 0)) {
-            if (ret == 2) {
-                ret = 0;
-            } else {
-                return -1;
-            }
-        } else if ((clk1[i] > clk2[i]) && (ret != 1)) {
-            if (ret == 2) {
-                ret = 1;
-            } else {
-                return -1;
-            }
-        }
+    // accumulate whether any entry is smaller/larger without branching per entry
+    // entries are unsigned, flip the sign bit to use signed simd compares
+    uint64_t i = 1;
+    bool less = false, greater = false;
+
+#if defined(__AVX2__)
+    const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+    __m256i less_acc = _mm256_setzero_si256();
+    __m256i greater_acc = _mm256_setzero_si256();
+    for (; i+4 <= clk_sz; i += 4) {
+        __m256i a = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(c1+i)), bias);
+        __m256i b = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(c2+i)), bias);
+        less_acc = _mm256_or_si256(less_acc, _mm256_cmpgt_epi64(b, a));
+        greater_acc = _mm256_or_si256(greater_acc, _mm256_cmpgt_epi64(a, b));
+    }
+    less = !_mm256_testz_si256(less_acc, less_acc);
+    greater = !_mm256_testz_si256(greater_acc, greater_acc);
+#elif defined(__SSE4_2__)
+    const __m128i bias = _mm_set1_epi64x(INT64_MIN);
+    __m128i less_acc = _mm_setzero_si128();
+    __m128i greater_acc = _mm_setzero_si128();
+    for (; i+2 <= clk_sz; i += 2) {
+        __m128i a = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(c1+i)), bias);
+        __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(c2+i)), bias);
+        less_acc = _mm_or_si128(less_acc, _mm_cmpgt_epi64(b, a));
+        greater_acc = _mm_or_si128(greater_acc, _mm_cmpgt_epi64(a, b));
+    }
+    less = !_mm_testz_si128(less_acc, less_acc);
+    greater = !_mm_testz_si128(greater_acc, greater_acc);
+#endif
+
+    for (; i < clk_sz; i++) {
+        less |= (c1[i] < c2[i]);
+        greater |= (c1[i] > c2[i]);
     }
 
-    return ret;
+    if (less && greater) {
+        return -1;
+    } else if (less) {
+        return 0;
+    } else if (greater) {
+        return 1;
+    } else {
+        return 2;
+    }
 }
 
 // method which only compares vector clocks
@@ -308,6 +346,15 @@ bool
 oracle :: clock_creat_before_del_after(const vc::vclock &req_vclock,
     const vclock_ptr_t &creat_time,
     const vclock_ptr_t &del_time)
+{
+    return clock_creat_before_del_after(req_vclock, creat_time.get(), del_time.get());
+}
+
+// same as above, for callers that cache raw clock pointers (db::adjacency)
+bool
+oracle :: clock_creat_before_del_after(const vc::vclock &req_vclock,
+    const vc::vclock *creat_time,
+    const vc::vclock *del_time)
 {
     bool cmp = true;
 
@@ -326,6 +373,104 @@ oracle :: clock_creat_before_del_after(const vc::vclock &req_vclock,
     return cmp;
 }
 
+// compare interned clock id with clk, as compare_two_vts
+// the stored row is compared directly, a vclock is built for id only if Kronos is needed
+int64_t
+oracle :: compare_interned(uint32_t id, const vc::vclock &clk)
+{
+    uint64_t clk_sz = std::min(vc::interned_clocks.clock_size(), (uint64_t)clk.clock.size());
+    int cmp = compare_two_clocks(vc::interned_clocks.words(id), clk.clock.data(), clk_sz);
+    if (cmp == -1) {
+        cmp = compare_two_vts(*vc::interned_clocks.get(id), clk);
+    }
+    return cmp;
+}
+
+// clock_creat_before_del_after for ids in vc::interned_clocks
+bool
+oracle :: clock_creat_before_del_after(const vc::vclock &req_vclock,
+    uint32_t creat_id,
+    uint32_t del_id)
+{
+    bool cmp = true;
+
+    if (del_id != vc::clock_table::null_id) {
+        int64_t cmp_1 = compare_interned(del_id, req_vclock);
+        assert(cmp_1 != 2);
+        cmp = (cmp_1 == 1);
+    }
+
+    if (cmp) {
+        int64_t cmp_2 = compare_interned(creat_id, req_vclock);
+        assert(cmp_2 != 2);
+        cmp = (cmp_2 == 0);
+    }
+
+    return cmp;
+}
+
+// batch version of clock_creat_before_del_after for a block of up to 64 elements
+// bit i of the returned mask is set iff element i is visible at req_vclock
+// elements without a deletion time only need the creation check, and runs of
+// elements stamped with the same clock reuse the previous comparison
+// Kronos is called only for the elements left undecided by vector clocks
+uint64_t
+oracle :: visible_mask(const vc::vclock &req_vclock,
+    const uint32_t *creat_ids,
+    const uint32_t *del_ids,
+    uint32_t num)
+{
+    assert(num <= 64);
+    uint64_t visible = 0;
+    uint64_t undecided = 0;
+
+    const uint64_t *req = req_vclock.clock.data();
+    uint64_t clk_sz = std::min(vc::interned_clocks.clock_size(), (uint64_t)req_vclock.clock.size());
+    uint32_t last_creat = vc::clock_table::null_id, last_del = vc::clock_table::null_id;
+    int last_creat_cmp = -1, last_del_cmp = -1;
+
+    for (uint32_t i = 0; i < num; i++) {
+        uint64_t bit = 1ULL << i;
+        uint32_t del_id = del_ids[i];
+
+        if (del_id != vc::clock_table::null_id) {
+            if (del_id != last_del) {
+                last_del = del_id;
+                last_del_cmp = compare_two_clocks(vc::interned_clocks.words(del_id), req, clk_sz);
+                assert(last_del_cmp != 2);
+            }
+            if (last_del_cmp == -1) {
+                undecided |= bit;
+                continue;
+            } else if (last_del_cmp != 1) {
+                continue;
+            }
+        }
+
+        uint32_t creat_id = creat_ids[i];
+        if (creat_id != last_creat) {
+            last_creat = creat_id;
+            last_creat_cmp = compare_two_clocks(vc::interned_clocks.words(creat_id), req, clk_sz);
+            assert(last_creat_cmp != 2);
+        }
+        if (last_creat_cmp == 0) {
+            visible |= bit;
+        } else if (last_creat_cmp == -1) {
+            undecided |= bit;
+        }
+    }
+
+    while (undecided) {
+        uint32_t i = __builtin_ctzll(undecided);
+        undecided &= (undecided-1);
+        if (clock_creat_before_del_after(req_vclock, creat_ids[i], del_ids[i])) {
+            visible |= (1ULL << i);
+        }
+    }
+
+    return visible;
+}
+
 // assign 'after' happens after all 'before'
 // will call Kronos if clocks are incomparable
 // returns true if successful, false if assignment impossible
@@ -21,6 +21,7 @@
 
 #include "common/weaver_constants.h"
 #include "common/vclock.h"
+#include "common/clock_table.h"
 #include "chronos/chronos.h"
 
 using vc::vclock_ptr_t;
@@ -108,6 +109,9 @@ namespace order
             int64_t compare_vts(const std::vector<vc::vclock> &clocks);
             int64_t compare_two_vts(const vc::vclock &clk1, const vc::vclock &clk2);
             bool clock_creat_before_del_after(const vc::vclock &req_vclock, const vclock_ptr_t &creat_time, const vclock_ptr_t &del_time);
+            bool clock_creat_before_del_after(const vc::vclock &req_vclock, const vc::vclock *creat_time, const vc::vclock *del_time);
+            bool clock_creat_before_del_after(const vc::vclock &req_vclock, uint32_t creat_id, uint32_t del_id);
+            uint64_t visible_mask(const vc::vclock &req_vclock, const uint32_t *creat_ids, const uint32_t *del_ids, uint32_t num);
             bool assign_vt_order(const std::vector<vc::vclock> &before, const vc::vclock &after);
 
         public:
@@ -117,6 +121,8 @@ namespace order
             static bool equal_or_happens_before_no_kronos(const vc::vclock_t &vclk1, const vc::vclock_t &vclk2);
         private:
             static int compare_two_clocks(const vc::vclock_t &clk1, const vc::vclock_t &clk2);
+            static int compare_two_clocks(const uint64_t *clk1, const uint64_t *clk2, uint64_t clk_sz);
+            int64_t compare_interned(uint32_t id, const vc::vclock &clk);
             static std::vector<bool> compare_vector_clocks(const std::vector<vc::vclock> &clocks);
             static void compare_vts_no_kronos(const std::vector<vc::vclock> &clocks, std::vector<bool> &large, int64_t &small_idx);
     };
@@ -27,11 +27,7 @@ hyper_stub_base :: hyper_stub_base()
                  "aliases"}
     , node_dtypes{HYPERDATATYPE_INT64,
                   HYPERDATATYPE_STRING,
-#ifdef weaver_large_property_maps_
-                  HYPERDATATYPE_MAP_STRING_STRING,
-#else
                   HYPERDATATYPE_LIST_STRING,
-#endif
                   HYPERDATATYPE_SET_INT64,
                   HYPERDATATYPE_INT64,
                   HYPERDATATYPE_STRING,
@@ -823,11 +819,7 @@ hyper_stub_base :: recreate_node(const hyperdex_client_attribute *cl_attr,
     vc::vclock_ptr_t create_clk;
     unpack_buffer(cl_attr[idx[1]].value, cl_attr[idx[1]].value_sz, create_clk);
     // properties
-#ifdef weaver_large_property_maps_
-    unpack_buffer<std::vector<std::shared_ptr<db::property>>>(cl_attr[idx[2]].value, cl_attr[idx[2]].value_sz, n.base.properties);
-#else
     unpack_buffer(cl_attr[idx[2]].value, cl_attr[idx[2]].value_sz, n.base.properties);
-#endif
 
     n.state = db::node::mode::STABLE;
     n.in_use = false;
@@ -988,7 +980,7 @@ hyper_stub_base :: get_node_edges(db::node &n, bool tx)
                                         shard,
                                         edge_id,
                                         &e);
-                n.out_edges[edge_handles[i]].emplace_back(e);
+                n.add_edge_version(e);
                 hyperdex_client_destroy_attrs(attr_array[i], NUM_EDGE_ATTRS);
             } else {
                 WDEBUG << "bad num attributes " << *num_attrs[i] << std::endl;
@@ -1110,11 +1102,7 @@ hyper_stub_base :: prepare_node(hyperdex_client_attribute *cl_attr,
     attr_idx++;
 
     // properties
-#ifdef weaver_large_property_maps_
-    prepare_buffer<std::vector<std::shared_ptr<db::property>>>(n.base.properties, props_buf);
-#else
     prepare_buffer(n.base.properties, props_buf);
-#endif
     cl_attr[attr_idx].attr = node_attrs[2];
     cl_attr[attr_idx].value = (const char*)props_buf->data();
     cl_attr[attr_idx].value_sz = props_buf->size();
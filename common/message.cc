@@ -42,6 +42,8 @@ message :: to_string(const msg_type &t)
             return "TX_DONE";
         case NODE_PROG:
             return "NODE_PROG";
+        case NODE_PROG_BATCH:
+            return "NODE_PROG_BATCH";
         case NODE_PROG_RETURN:
             return "NODE_PROG_RETURN";
         case NODE_PROG_RETRY:
@@ -76,6 +78,38 @@ message :: to_string(const msg_type &t)
             return "CLIENT_NODE_COUNT";
         case NODE_COUNT_REPLY:
             return "NODE_COUNT_REPLY";
+        case CLIENT_MEM_STATS:
+            return "CLIENT_MEM_STATS";
+        case MEM_STATS_REPLY:
+            return "MEM_STATS_REPLY";
+        case REPLICA_PUSH:
+            return "REPLICA_PUSH";
+        case REPLICA_EXTEND:
+            return "REPLICA_EXTEND";
+        case REPLICA_DROP:
+            return "REPLICA_DROP";
+        case FRONTIER_PIECE:
+            return "FRONTIER_PIECE";
+        case CLIENT_BSP_PROG_REQ:
+            return "CLIENT_BSP_PROG_REQ";
+        case BSP_PROG:
+            return "BSP_PROG";
+        case BSP_STEP:
+            return "BSP_STEP";
+        case BSP_MSGS:
+            return "BSP_MSGS";
+        case BSP_STEP_DONE:
+            return "BSP_STEP_DONE";
+        case BSP_RESULT:
+            return "BSP_RESULT";
+        case NODE_PROG_PARTIAL:
+            return "NODE_PROG_PARTIAL";
+        case IN_EDGE_UPDATES:
+            return "IN_EDGE_UPDATES";
+        case IN_EDGE_RESYNC:
+            return "IN_EDGE_RESYNC";
+        case NODE_PROG_CANCEL:
+            return "NODE_PROG_CANCEL";
         case RESTORE_DONE:
             return "RESTORE_DONE";
         case LOADED_GRAPH:
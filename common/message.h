@@ -41,6 +41,7 @@ namespace message
         TX_DONE,
         // node program messages
         NODE_PROG,
+        NODE_PROG_BATCH, // NODE_PROG messages of several requests, framed, see db/outbox.h
         NODE_PROG_RETURN,
         NODE_PROG_RETRY,
         NODE_PROG_NOTFOUND,
@@ -59,6 +60,29 @@ namespace message
         MIGRATION_TOKEN,
         CLIENT_NODE_COUNT,
         NODE_COUNT_REPLY,
+        CLIENT_MEM_STATS,
+        MEM_STATS_REPLY,
+        // read replicas of hot nodes
+        REPLICA_PUSH,
+        REPLICA_EXTEND,
+        REPLICA_DROP,
+        // wakes an idle shard thread to take a split frontier piece
+        FRONTIER_PIECE,
+        // whole graph node programs run in supersteps, see db/bsp_job.h
+        CLIENT_BSP_PROG_REQ,
+        BSP_PROG,
+        BSP_STEP,
+        BSP_MSGS,
+        BSP_STEP_DONE,
+        BSP_RESULT,
+        // partial result of an aggregating node program, see db/prog_aggregate.h
+        NODE_PROG_PARTIAL,
+        // in-neighbor updates for nodes at the receiving shard, see db/in_adjacency.h
+        IN_EDGE_UPDATES,
+        // shard restored from backup asks for the edges to its nodes again
+        IN_EDGE_RESYNC,
+        // VT returned a node program to the client, shards drop the rest of its work
+        NODE_PROG_CANCEL,
         // ft messages
         RESTORE_DONE,
         // initial graph loading
@@ -144,17 +168,32 @@ namespace message
         pack_buffer_wrapper(packer, aux_args, args...);
     }
 
+    // message type and args without the busybee header, for packing a message into a buffer shared with others
+    template <typename... Args>
+    inline uint64_t
+    body_size(const enum msg_type given_type, void *aux_args, const Args&... args)
+    {
+        return size(given_type) + size_wrapper(aux_args, args...);
+    }
+
+    template <typename... Args>
+    inline void
+    pack_body(e::packer &packer, const enum msg_type given_type, void *aux_args, const Args&... args)
+    {
+        pack_buffer(packer, given_type);
+        pack_buffer_wrapper(packer, aux_args, args...);
+    }
+
     template <typename... Args>
     inline void
     message :: prepare_message(const enum msg_type given_type, void *aux_args, const Args&... args)
     {
-        uint64_t bytes_to_pack = size_wrapper(aux_args, args...) + size(given_type);
+        uint64_t bytes_to_pack = body_size(given_type, aux_args, args...);
         type = given_type;
         buf.reset(e::buffer::create(BUSYBEE_HEADER_SIZE + bytes_to_pack));
         e::packer packer = buf->pack_at(BUSYBEE_HEADER_SIZE); 
 
-        pack_buffer(packer, given_type);
-        pack_buffer_wrapper(packer, aux_args, args...);
+        pack_body(packer, given_type, aux_args, args...);
     }
 
 
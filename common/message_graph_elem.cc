@@ -24,7 +24,7 @@ uint64_t
 message :: size(void *aux_args, const db::element &t)
 {
     uint64_t sz = size(aux_args, t.get_handle()) // client handle
-        + size(aux_args, t.get_creat_time()) + size(aux_args, t.get_del_time()) // time stamps
+        + size_interned_clock(aux_args, t.get_creat_id()) + size_interned_clock(aux_args, t.get_del_id()) // time stamps
         + size(aux_args, *t.get_properties()); // properties
     return sz;
 }
@@ -56,6 +56,7 @@ message :: size(void *aux_args, const db::node &t)
     uint64_t sz = 0;
     sz += size(aux_args, t.base);
     sz += size(aux_args, t.out_edges);
+    sz += size(aux_args, t.in_edges);
     sz += size(aux_args, t.aliases);
 #ifdef WEAVER_CLDG
     sz += size(aux_args, t.msg_count);
@@ -63,7 +64,6 @@ message :: size(void *aux_args, const db::node &t)
 #ifdef WEAVER_NEW_CLDG
     sz += size(aux_args, t.msg_count);
 #endif
-    sz += size(aux_args, t.node_prog_states);
     return sz;
 }
 
@@ -71,8 +71,8 @@ message :: size(void *aux_args, const db::node &t)
 void message :: pack_buffer(e::packer &packer, void *aux_args, const db::element &t)
 {
     pack_buffer(packer, aux_args, t.get_handle());
-    pack_buffer(packer, aux_args, t.get_creat_time());
-    pack_buffer(packer, aux_args, t.get_del_time());
+    pack_interned_clock(packer, aux_args, t.get_creat_id());
+    pack_interned_clock(packer, aux_args, t.get_del_id());
     pack_buffer(packer, aux_args, *t.get_properties());
 }
 
@@ -99,6 +99,7 @@ message :: pack_buffer(e::packer &packer, void *aux_args, const db::node &t)
 {
     pack_buffer(packer, aux_args, t.base);
     pack_buffer(packer, aux_args, t.out_edges);
+    pack_buffer(packer, aux_args, t.in_edges);
     pack_buffer(packer, aux_args, t.aliases);
 #ifdef WEAVER_CLDG
     pack_buffer(packer, aux_args, t.msg_count);
@@ -106,7 +107,6 @@ message :: pack_buffer(e::packer &packer, void *aux_args, const db::node &t)
 #ifdef WEAVER_NEW_CLDG
     pack_buffer(packer, aux_args, t.msg_count);
 #endif
-    pack_buffer(packer, aux_args, t.node_prog_states);
 }
 
 // unpacking methods
@@ -164,6 +164,8 @@ message :: unpack_buffer(e::unpacker &unpacker, void *aux_args, db::node &t)
 {
     unpack_buffer(unpacker, aux_args, t.base);
     unpack_buffer(unpacker, aux_args, t.out_edges);
+    t.rebuild_adjacency();
+    unpack_buffer(unpacker, aux_args, t.in_edges);
     unpack_buffer(unpacker, aux_args, t.aliases);
 #ifdef WEAVER_CLDG
     unpack_buffer(unpacker, aux_args, t.msg_count);
@@ -172,8 +174,6 @@ message :: unpack_buffer(e::unpacker &unpacker, void *aux_args, db::node &t)
     unpack_buffer(unpacker, aux_args, t.msg_count);
 #endif
 
-    unpack_buffer(unpacker, aux_args, t.node_prog_states);
-
     //// unpack node prog state
     //// need to unroll because we have to first unpack into particular state type, and then upcast and save as base type
     //uint32_t num_prog_types = node_prog::END;
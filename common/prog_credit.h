@@ -0,0 +1,70 @@
+/*
+ * ===============================================================
+ *    Description:  Credit for detecting when an aggregating node
+ *                  program has finished everywhere. The VT starts
+ *                  a request with credit 1 and splits it between
+ *                  the messages of the request, every shard returns
+ *                  the credit it received with its partial result.
+ *                  The request is done when the VT has all of it
+ *                  back. Credit is a sum of 2^-e, kept as the set of
+ *                  exponents e, ascending and without repeats.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_common_prog_credit_h_
+#define weaver_common_prog_credit_h_
+
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+namespace weaver_util
+{
+    typedef std::vector<uint32_t> prog_credit_t;
+
+    inline prog_credit_t
+    whole_credit()
+    {
+        return prog_credit_t(1, 0);
+    }
+
+    inline bool
+    is_whole_credit(const prog_credit_t &c)
+    {
+        return c.size() == 1 && c[0] == 0;
+    }
+
+    // binary addition, two 2^-e make one 2^-(e-1)
+    inline void
+    add_credit(prog_credit_t &into, const prog_credit_t &from)
+    {
+        for (uint32_t e: from) {
+            auto iter = std::lower_bound(into.begin(), into.end(), e);
+            while (iter != into.end() && *iter == e && e > 0) {
+                into.erase(iter);
+                e--;
+                iter = std::lower_bound(into.begin(), into.end(), e);
+            }
+            into.insert(iter, e);
+        }
+    }
+
+    // halves the largest piece of c, returns one half and keeps the other
+    // c must not be empty
+    inline prog_credit_t
+    split_credit(prog_credit_t &c)
+    {
+        uint32_t e = c.front() + 1;
+        c.erase(c.begin());
+        prog_credit_t half(1, e);
+        add_credit(c, half);
+        return half;
+    }
+}
+
+#endif
@@ -19,43 +19,47 @@ using predicate::prop_predicate;
 
 bool
 prop_predicate :: check(const node_prog::property &prop) const
+{
+    return key == prop.get_key() && check_value(prop.get_value());
+}
+
+// check relation on value only, caller has matched the key
+bool
+prop_predicate :: check_value(const std::string &prop_value) const
 {
     switch (rel) {
         case EQUALS:
-            return key == prop.get_key() && prop.get_value() == value;
+            return prop_value == value;
             break;
 
         case LESS:
-            return key == prop.get_key() && prop.get_value() < value;
+            return prop_value < value;
             break;
 
         case GREATER:
-            return key == prop.get_key() && prop.get_value() > value;
+            return prop_value > value;
             break;
 
         case LESS_EQUAL:
-            return key == prop.get_key() && prop.get_value() <= value;
+            return prop_value <= value;
             break;
 
         case GREATER_EQUAL:
-            return key == prop.get_key() && prop.get_value() >= value;
+            return prop_value >= value;
             break;
 
         case STARTS_WITH:
-            return key == prop.get_key()
-                && prop.get_value().size() >= value.size()
-                && prop.get_value().compare(0, value.size(), value) == 0;
+            return prop_value.size() >= value.size()
+                && prop_value.compare(0, value.size(), value) == 0;
             break;
 
         case ENDS_WITH:
-            return key == prop.get_key()
-                && prop.get_value().size() >= value.size()
-                && prop.get_value().compare(prop.get_value().size()-value.size(), value.size(), value) == 0;
+            return prop_value.size() >= value.size()
+                && prop_value.compare(prop_value.size()-value.size(), value.size(), value) == 0;
             break;
 
         case CONTAINS:
-            return key == prop.get_key()
-                && prop.get_value().find(value) != std::string::npos;
+            return prop_value.find(value) != std::string::npos;
             break;
 
         default:
@@ -37,6 +37,7 @@ namespace predicate
         relation rel;
 
         bool check(const node_prog::property &prop) const;
+        bool check_value(const std::string &prop_value) const;
     };
 }
 
@@ -21,13 +21,16 @@
 #include "node_prog/base_classes.h"
 #include "node_prog/property.h"
 #include "db/remote_node.h"
+#include "db/in_adjacency.h"
 #include "db/property.h"
+#include "db/prop_block.h"
 #include "client/datastructures.h"
 
 using node_prog::Node_Parameters_Base;
 using node_prog::Node_State_Base;
 using node_prog::np_param_ptr_t;
 using node_prog::np_state_ptr_t;
+using node_prog::np_const_ptr_t;
 using node_prog::param_ctor_func_t;
 using node_prog::param_size_func_t;
 using node_prog::param_pack_func_t;
@@ -57,6 +60,20 @@ message :: size(void *prog_handle, const np_state_ptr_t &t)
     return prog_table->state_size(*t, prog_handle);
 }
 
+// constants are optional in a message, a flag says if they follow
+uint64_t
+message :: size(void *prog_handle, const np_const_ptr_t &t)
+{
+    CAST_PROG_HANDLE;
+    bool present = (t != nullptr);
+    uint64_t sz = size(prog_handle, present);
+    if (present) {
+        assert(prog_table->const_size != nullptr);
+        sz += prog_table->const_size(*t, prog_handle);
+    }
+    return sz;
+}
+
 uint64_t
 message :: size(void *aux_args, const node_prog::Cache_Value_Base &t)
 {
@@ -70,6 +87,18 @@ message :: size(void *aux_args, const vc::vclock &t)
         + size(aux_args, t.clock);
 }
 
+uint64_t
+message :: size_interned_clock(void *aux_args, uint32_t id)
+{
+    bool exists = (id != vc::clock_table::null_id);
+    uint64_t sz = size(aux_args, exists);
+    if (exists) {
+        sz += sizeof(uint64_t) // vt_id
+            + sizeof(uint32_t) + vc::interned_clocks.clock_size()*sizeof(uint64_t);
+    }
+    return sz;
+}
+
 uint64_t
 message :: size(void *aux_args, const node_prog::property &t)
 {
@@ -82,8 +111,24 @@ message :: size(void *aux_args, const db::property &t)
 {
     return size(aux_args, t.key)
         + size(aux_args, t.value)
-        + size(aux_args, t.get_creat_time())
-        + size(aux_args, t.get_del_time());
+        + size_interned_clock(aux_args, t.get_creat_id())
+        + size_interned_clock(aux_args, t.get_del_id());
+}
+
+// same wire format as std::vector<std::shared_ptr<db::property>>
+uint64_t
+message :: size(void *aux_args, const db::prop_block &t)
+{
+    bool exists = true;
+    uint64_t sz = sizeof(uint32_t);
+    for (uint64_t slot = 0; slot < t.size(); slot++) {
+        sz += size(aux_args, exists)
+            + size(aux_args, t.key(slot))
+            + size(aux_args, t.value(slot))
+            + size_interned_clock(aux_args, t.creat_id(slot))
+            + size_interned_clock(aux_args, t.del_id(slot));
+    }
+    return sz;
 }
 
 uint64_t
@@ -92,6 +137,30 @@ message :: size(void *aux_args, const db::remote_node &t)
     return size(aux_args, t.loc) + size(aux_args, t.handle);
 }
 
+uint64_t
+message :: size(void *aux_args, const db::in_edge_update &t)
+{
+    return size(aux_args, t.node)
+         + size(aux_args, t.edge)
+         + size(aux_args, t.src)
+         + size(aux_args, t.creat_time)
+         + size(aux_args, t.del_time);
+}
+
+uint64_t
+message :: size(void *aux_args, const db::in_adjacency &t)
+{
+    uint64_t sz = size(aux_args, t.size());
+    for (uint64_t i = 0; i < t.size(); i++) {
+        const db::in_edge &e = t.at(i);
+        sz += size(aux_args, e.handle)
+            + size(aux_args, e.nbr)
+            + size_interned_clock(aux_args, e.creat_id)
+            + size_interned_clock(aux_args, e.del_id);
+    }
+    return sz;
+}
+
 uint64_t
 message :: size(void *aux_args, const std::shared_ptr<transaction::pending_update> &t)
 {
@@ -181,6 +250,18 @@ message :: pack_buffer(e::packer &packer, void *prog_handle, const np_state_ptr_
     prog_table->state_pack(*t, packer, prog_handle);
 }
 
+void
+message :: pack_buffer(e::packer &packer, void *prog_handle, const np_const_ptr_t &t)
+{
+    CAST_PROG_HANDLE;
+    bool present = (t != nullptr);
+    pack_buffer(packer, prog_handle, present);
+    if (present) {
+        assert(prog_table->const_pack != nullptr);
+        prog_table->const_pack(*t, packer, prog_handle);
+    }
+}
+
 void
 message :: pack_buffer(e::packer &packer, void *aux_args, const node_prog::Cache_Value_Base *&t)
 {
@@ -194,6 +275,24 @@ message :: pack_buffer(e::packer &packer, void *aux_args, const vc::vclock &t)
     pack_buffer(packer, aux_args, t.clock);
 }
 
+// packs the stored row, without building a vclock for id
+void
+message :: pack_interned_clock(e::packer &packer, void *aux_args, uint32_t id)
+{
+    bool exists = (id != vc::clock_table::null_id);
+    pack_buffer(packer, aux_args, exists);
+    if (exists) {
+        const uint64_t *words = vc::interned_clocks.words(id);
+        uint64_t vt_id = vc::interned_clocks.vt_id(id);
+        uint32_t clk_sz = vc::interned_clocks.clock_size();
+        pack_buffer(packer, aux_args, vt_id);
+        pack_buffer(packer, aux_args, clk_sz);
+        for (uint32_t i = 0; i < clk_sz; i++) {
+            pack_buffer(packer, aux_args, words[i]);
+        }
+    }
+}
+
 void 
 message :: pack_buffer(e::packer &packer, void *aux_args, const node_prog::property &t)
 {
@@ -206,8 +305,24 @@ message :: pack_buffer(e::packer &packer, void *aux_args, const db::property &t)
 {
     pack_buffer(packer, aux_args, t.key);
     pack_buffer(packer, aux_args, t.value);
-    pack_buffer(packer, aux_args, t.get_creat_time());
-    pack_buffer(packer, aux_args, t.get_del_time());
+    pack_interned_clock(packer, aux_args, t.get_creat_id());
+    pack_interned_clock(packer, aux_args, t.get_del_id());
+}
+
+void
+message :: pack_buffer(e::packer &packer, void *aux_args, const db::prop_block &t)
+{
+    assert(t.size() <= UINT32_MAX);
+    uint32_t num_props = t.size();
+    bool exists = true;
+    pack_buffer(packer, aux_args, num_props);
+    for (uint64_t slot = 0; slot < t.size(); slot++) {
+        pack_buffer(packer, aux_args, exists);
+        pack_buffer(packer, aux_args, t.key(slot));
+        pack_buffer(packer, aux_args, t.value(slot));
+        pack_interned_clock(packer, aux_args, t.creat_id(slot));
+        pack_interned_clock(packer, aux_args, t.del_id(slot));
+    }
 }
 
 void 
@@ -217,6 +332,29 @@ message :: pack_buffer(e::packer &packer, void *aux_args, const db::remote_node
     pack_buffer(packer, aux_args, t.handle);
 }
 
+void
+message :: pack_buffer(e::packer &packer, void *aux_args, const db::in_edge_update &t)
+{
+    pack_buffer(packer, aux_args, t.node);
+    pack_buffer(packer, aux_args, t.edge);
+    pack_buffer(packer, aux_args, t.src);
+    pack_buffer(packer, aux_args, t.creat_time);
+    pack_buffer(packer, aux_args, t.del_time);
+}
+
+void
+message :: pack_buffer(e::packer &packer, void *aux_args, const db::in_adjacency &t)
+{
+    pack_buffer(packer, aux_args, t.size());
+    for (uint64_t i = 0; i < t.size(); i++) {
+        const db::in_edge &e = t.at(i);
+        pack_buffer(packer, aux_args, e.handle);
+        pack_buffer(packer, aux_args, e.nbr);
+        pack_interned_clock(packer, aux_args, e.creat_id);
+        pack_interned_clock(packer, aux_args, e.del_id);
+    }
+}
+
 void
 message :: pack_buffer(e::packer &packer, void *aux_args, const std::shared_ptr<transaction::pending_update> &t)
 {
@@ -306,6 +444,20 @@ message :: unpack_buffer(e::unpacker &unpacker, void *prog_handle, np_state_ptr_
     prog_table->state_unpack(*t, unpacker, prog_handle);
 }
 
+void
+message :: unpack_buffer(e::unpacker &unpacker, void *prog_handle, np_const_ptr_t &t)
+{
+    CAST_PROG_HANDLE;
+    bool present;
+    unpack_buffer(unpacker, prog_handle, present);
+    t.reset();
+    if (present) {
+        assert(prog_table->const_ctor != nullptr);
+        t = prog_table->const_ctor();
+        prog_table->const_unpack(*t, unpacker, prog_handle);
+    }
+}
+
 void
 message :: unpack_buffer(e::unpacker &unpacker, void *aux_args, node_prog::Cache_Value_Base &t)
 {
@@ -339,6 +491,21 @@ message :: unpack_buffer(e::unpacker &unpacker, void *aux_args, db::property &t)
     t.update_del_time(tdel);
 }
 
+void
+message :: unpack_buffer(e::unpacker &unpacker, void *aux_args, db::prop_block &t)
+{
+    t.clear();
+    uint32_t num_props;
+    unpack_buffer(unpacker, aux_args, num_props);
+    for (uint32_t i = 0; i < num_props; i++) {
+        std::shared_ptr<db::property> p;
+        unpack_buffer(unpacker, aux_args, p);
+        if (p) {
+            t.append(*p);
+        }
+    }
+}
+
 void 
 message :: unpack_buffer(e::unpacker &unpacker, void *aux_args, db::remote_node& t)
 {
@@ -346,6 +513,32 @@ message :: unpack_buffer(e::unpacker &unpacker, void *aux_args, db::remote_node&
     unpack_buffer(unpacker, aux_args, t.handle);
 }
 
+void
+message :: unpack_buffer(e::unpacker &unpacker, void *aux_args, db::in_edge_update &t)
+{
+    unpack_buffer(unpacker, aux_args, t.node);
+    unpack_buffer(unpacker, aux_args, t.edge);
+    unpack_buffer(unpacker, aux_args, t.src);
+    unpack_buffer(unpacker, aux_args, t.creat_time);
+    unpack_buffer(unpacker, aux_args, t.del_time);
+}
+
+void
+message :: unpack_buffer(e::unpacker &unpacker, void *aux_args, db::in_adjacency &t)
+{
+    uint64_t num;
+    unpack_buffer(unpacker, aux_args, num);
+
+    db::in_edge_update upd;
+    for (uint64_t i = 0; i < num; i++) {
+        unpack_buffer(unpacker, aux_args, upd.edge);
+        unpack_buffer(unpacker, aux_args, upd.src);
+        unpack_buffer(unpacker, aux_args, upd.creat_time);
+        unpack_buffer(unpacker, aux_args, upd.del_time);
+        t.append(upd);
+    }
+}
+
 void
 message :: unpack_buffer(e::unpacker &unpacker, void *aux_args, std::shared_ptr<transaction::pending_update> &t)
 {
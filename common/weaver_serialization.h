@@ -37,6 +37,7 @@ namespace node_prog
 {
     class Node_Parameters_Base;
     class Node_State_Base;
+    class Node_Constants_Base;
     class Cache_Value_Base;
     class property;
     struct edge_cache_context;
@@ -46,7 +47,10 @@ namespace node_prog
 namespace db
 {
     class property;
+    class prop_block;
     class remote_node;
+    struct in_edge_update;
+    class in_adjacency;
     class element;
     class edge;
     class node;
@@ -61,18 +65,24 @@ namespace cl
 namespace message
 {
     uint64_t size(void*, const vc::vclock &t);
+    // id in vc::interned_clocks, same wire format as vclock_ptr_t
+    uint64_t size_interned_clock(void*, uint32_t id);
     uint64_t size(void*, const transaction::pending_tx &t);
     uint64_t size(void*, const std::shared_ptr<transaction::pending_update> &ptr_t);
     uint64_t size(void*, const std::shared_ptr<transaction::nop_data> &ptr_t);
     uint64_t size(void*, const predicate::prop_predicate&);
     uint64_t size(void*, const std::shared_ptr<node_prog::Node_Parameters_Base> &t);
     uint64_t size(void*, const std::shared_ptr<node_prog::Node_State_Base> &t);
+    uint64_t size(void*, const std::shared_ptr<node_prog::Node_Constants_Base> &t);
     uint64_t size(void*, const node_prog::Cache_Value_Base &t);
     uint64_t size(void*, const node_prog::property &t);
     uint64_t size(void*, const node_prog::node_cache_context &t);
     uint64_t size(void*, const node_prog::edge_cache_context &t);
     uint64_t size(void*, const db::property &t);
+    uint64_t size(void*, const db::prop_block &t);
     uint64_t size(void*, const db::remote_node &t);
+    uint64_t size(void*, const db::in_edge_update &t);
+    uint64_t size(void*, const db::in_adjacency &t);
     uint64_t size(void*, const db::element &t);
     uint64_t size(void*, const db::edge &t);
     uint64_t size(void*, const db::edge* const &t);
@@ -81,18 +91,23 @@ namespace message
     uint64_t size(void*, const cl::edge &t);
 
     void pack_buffer(e::packer&, void*, const vc::vclock &t);
+    void pack_interned_clock(e::packer&, void*, uint32_t id);
     void pack_buffer(e::packer&, void*, const transaction::pending_tx &t);
     void pack_buffer(e::packer&, void*, const std::shared_ptr<transaction::pending_update> &ptr_t);
     void pack_buffer(e::packer&, void*, const std::shared_ptr<transaction::nop_data> &ptr_t);
     void pack_buffer(e::packer&, void*, const predicate::prop_predicate &t);
     void pack_buffer(e::packer&, void*, const std::shared_ptr<node_prog::Node_Parameters_Base> &t);
     void pack_buffer(e::packer&, void*, const std::shared_ptr<node_prog::Node_State_Base> &t);
+    void pack_buffer(e::packer&, void*, const std::shared_ptr<node_prog::Node_Constants_Base> &t);
     void pack_buffer(e::packer&, void*, const node_prog::Cache_Value_Base *&t);
     void pack_buffer(e::packer&, void*, const node_prog::property &t);
     void pack_buffer(e::packer&, void*, const node_prog::node_cache_context &t);
     void pack_buffer(e::packer&, void*, const node_prog::edge_cache_context &t);
     void pack_buffer(e::packer&, void*, const db::property &t);
+    void pack_buffer(e::packer&, void*, const db::prop_block &t);
     void pack_buffer(e::packer&, void*, const db::remote_node &t);
+    void pack_buffer(e::packer&, void*, const db::in_edge_update &t);
+    void pack_buffer(e::packer&, void*, const db::in_adjacency &t);
     void pack_buffer(e::packer&, void*, const db::element &t);
     void pack_buffer(e::packer&, void*, const db::edge &t);
     void pack_buffer(e::packer&, void*, const db::edge* const &t);
@@ -107,12 +122,16 @@ namespace message
     void unpack_buffer(e::unpacker&, void*, predicate::prop_predicate &t);
     void unpack_buffer(e::unpacker&, void*, std::shared_ptr<node_prog::Node_Parameters_Base> &t);
     void unpack_buffer(e::unpacker&, void*, std::shared_ptr<node_prog::Node_State_Base> &t);
+    void unpack_buffer(e::unpacker&, void*, std::shared_ptr<node_prog::Node_Constants_Base> &t);
     void unpack_buffer(e::unpacker&, void*, node_prog::Cache_Value_Base &t);
     void unpack_buffer(e::unpacker&, void*, node_prog::property &t);
     void unpack_buffer(e::unpacker&, void*, node_prog::node_cache_context &t);
     void unpack_buffer(e::unpacker&, void*, node_prog::edge_cache_context &t);
     void unpack_buffer(e::unpacker&, void*, db::property &t);
+    void unpack_buffer(e::unpacker&, void*, db::prop_block &t);
     void unpack_buffer(e::unpacker&, void*, db::remote_node& t);
+    void unpack_buffer(e::unpacker&, void*, db::in_edge_update &t);
+    void unpack_buffer(e::unpacker&, void*, db::in_adjacency &t);
     void unpack_buffer(e::unpacker&, void*, db::element &t);
     void unpack_buffer(e::unpacker&, void*, db::edge &t);
     void unpack_buffer(e::unpacker&, void*, db::edge *&t);
@@ -0,0 +1,44 @@
+/*
+ * ===============================================================
+ *    Description:  Superstep barrier of a whole graph node prog.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_coordinator_bsp_barrier_h_
+#define weaver_coordinator_bsp_barrier_h_
+
+namespace coordinator
+{
+    struct bsp_barrier
+    {
+        current_prog *cp;
+        std::string prog_type;
+        void *prog_handle;
+        uint64_t num_shards;
+        uint32_t superstep, max_supersteps;
+        // shards heard from this superstep, and their totals
+        uint64_t reported, active, sent;
+        bool finishing;
+        uint64_t results;
+        node_prog::np_param_ptr_t global, result;
+
+        bsp_barrier()
+            : cp(nullptr)
+            , prog_handle(nullptr)
+            , num_shards(0)
+            , superstep(0)
+            , max_supersteps(0)
+            , reported(0)
+            , active(0)
+            , sent(0)
+            , finishing(false)
+            , results(0)
+        { }
+    };
+}
+#endif
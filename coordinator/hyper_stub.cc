@@ -60,12 +60,7 @@ hyper_stub :: get_idx(std::unordered_map<std::string, std::pair<std::string, uin
 void
 hyper_stub :: clean_node(db::node *n)
 {
-    for (auto &x: n->out_edges) {
-        for (db::edge *e: x.second) {
-            delete e;
-        }
-    }
-    n->out_edges.clear();
+    n->free_edges();
     delete n;
 }
 
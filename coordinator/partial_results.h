@@ -0,0 +1,31 @@
+/*
+ * ===============================================================
+ *    Description:  Merged result of an aggregating node prog, and
+ *                  the credit returned by shards so far.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_coordinator_partial_results_h_
+#define weaver_coordinator_partial_results_h_
+
+#include "common/prog_credit.h"
+
+namespace coordinator
+{
+    struct partial_results
+    {
+        current_prog *cp;
+        void *prog_handle;
+        weaver_util::prog_credit_t credit;
+        node_prog::np_param_ptr_t result;
+        uint64_t partials;
+
+        partial_results() : cp(nullptr), prog_handle(nullptr), partials(0) { }
+    };
+}
+#endif
@@ -348,10 +348,12 @@ unpack_and_forward_node_prog(std::unique_ptr<message::message> msg,
         return;
     }
 
+    node_prog::np_const_ptr_t constants;
     std::vector<std::pair<node_handle_t, std::shared_ptr<Node_Parameters_Base>>> initial_args;
     msg->unpack_message(message::CLIENT_NODE_PROG_REQ,
                         prog_handle,
                         prog_type,
+                        constants,
                         initial_args);
     
     // map from locations to a list of start_node_params to send to that shard
@@ -438,8 +440,29 @@ unpack_and_forward_node_prog(std::unique_ptr<message::message> msg,
     vts->outstanding_progs.emplace(req_id);
     vts->tx_prog_mutex.unlock();
 
+    // results of aggregating progs are merged here until all credit is back
+    dynamic_prog_table *prog_table = (dynamic_prog_table*)prog_handle;
+    bool aggregate = prog_table->merge_results != nullptr && prog_table->bsp_node_program == nullptr;
+    weaver_util::prog_credit_t credit, batch_credit;
+    if (aggregate) {
+        credit = weaver_util::whole_credit();
+        vts->partial_mtx.lock();
+        coordinator::partial_results &partial = vts->partial_progs[req_id];
+        partial.cp = cp;
+        partial.prog_handle = prog_handle;
+        vts->partial_mtx.unlock();
+    }
+
     message::message msg_to_send;
+    uint64_t batches_left = initial_batches.size();
     for (auto &batch_pair: initial_batches) {
+        if (aggregate) {
+            if (--batches_left > 0) {
+                batch_credit = weaver_util::split_credit(credit);
+            } else {
+                batch_credit = std::move(credit);
+            }
+        }
         msg_to_send.prepare_message(message::NODE_PROG,
                                     prog_handle,
                                     prog_type,
@@ -447,6 +470,8 @@ unpack_and_forward_node_prog(std::unique_ptr<message::message> msg,
                                     req_timestamp,
                                     req_id,
                                     cp_int,
+                                    constants,
+                                    batch_credit,
                                     batch_pair.second);
         vts->comm.send(batch_pair.first, msg_to_send.buf);
         //WDEBUG << "send node prog=" << req_id << " to shard=" << batch_pair.first << std::endl;
@@ -494,6 +519,232 @@ node_prog_done(uint64_t req_id, current_prog *cp)
     return true;
 }
 
+// start a whole graph node program at every shard
+void
+start_bsp_prog(std::unique_ptr<message::message> msg, uint64_t clientID)
+{
+    vts->restore_mtx.lock();
+    if (vts->restore_status > 0) {
+        vts->prog_queue->emplace_back(blocked_prog(clientID, std::move(msg)));
+        vts->restore_mtx.unlock();
+        return;
+    } else {
+        vts->restore_mtx.unlock();
+    }
+
+    std::string prog_type;
+    msg->unpack_partial_message(message::CLIENT_BSP_PROG_REQ, prog_type);
+
+    dynamic_prog_table *prog = nullptr;
+    vts->m_dyn_prog_mtx.lock();
+    auto prog_iter = vts->m_dyn_prog_map.find(prog_type);
+    if (prog_iter != vts->m_dyn_prog_map.end()) {
+        prog = prog_iter->second.get();
+    }
+    vts->m_dyn_prog_mtx.unlock();
+
+    if (prog == nullptr || prog->bsp_node_program == nullptr) {
+        msg->prepare_message(message::NODE_PROG_BADPROGTYPE);
+        vts->comm.send_to_client(clientID, msg->buf);
+        return;
+    }
+
+    uint32_t max_supersteps;
+    std::shared_ptr<Node_Parameters_Base> global;
+    msg->unpack_message(message::CLIENT_BSP_PROG_REQ, prog, prog_type, max_supersteps, global);
+
+    vts->clk_rw_mtx.wrlock();
+    vts->vclk.increment_clock();
+    vc::vclock req_timestamp = vts->vclk;
+    assert(req_timestamp.clock.size() == ClkSz);
+
+    vts->tx_prog_mutex.lock();
+    vts->clk_rw_mtx.unlock();
+
+    uint64_t req_id = vts->generate_req_id();
+    current_prog *cp = new current_prog(req_id, clientID, req_timestamp);
+    uint64_t cp_int = (uint64_t)cp;
+    vts->pend_progs.emplace_back(cp);
+    vts->outstanding_progs.emplace(req_id);
+    vts->tx_prog_mutex.unlock();
+
+    uint64_t num_shards = get_num_shards();
+    vts->bsp_mtx.lock();
+    coordinator::bsp_barrier &barrier = vts->bsp_progs[req_id];
+    barrier.cp = cp;
+    barrier.prog_type = prog_type;
+    barrier.prog_handle = prog;
+    barrier.num_shards = num_shards;
+    barrier.max_supersteps = max_supersteps;
+    barrier.global = global;
+    vts->bsp_mtx.unlock();
+
+    message::message msg_to_send;
+    for (uint64_t i = 0; i < num_shards; i++) {
+        msg_to_send.prepare_message(message::BSP_PROG,
+                                    prog,
+                                    prog_type,
+                                    vt_id,
+                                    req_timestamp,
+                                    req_id,
+                                    cp_int,
+                                    num_shards,
+                                    global);
+        vts->comm.send(i + ShardIdIncr, msg_to_send.buf);
+    }
+
+#ifdef weaver_benchmark_
+    vts->test_mtx.lock();
+    vts->outstanding_cnt++;
+    if (vts->outstanding_cnt > vts->max_outstanding_cnt) {
+        vts->max_outstanding_cnt = vts->outstanding_cnt;
+    }
+    vts->test_mtx.unlock();
+#endif
+}
+
+// shards stop running the request now, instead of when the done clock passes it
+void
+cancel_node_prog(uint64_t req_id, const vc::vclock &req_vclk)
+{
+    message::message msg;
+    uint64_t num_shards = get_num_shards();
+    for (uint64_t i = 0; i < num_shards; i++) {
+        msg.prepare_message(message::NODE_PROG_CANCEL, nullptr, req_id, req_vclk);
+        vts->comm.send(i + ShardIdIncr, msg.buf);
+    }
+}
+
+// merge the partial result of a shard, and return to the client once all credit is back
+void
+node_prog_partial(std::unique_ptr<message::message> msg)
+{
+    std::string prog_type;
+    uint64_t req_id;
+    weaver_util::prog_credit_t credit;
+    bool has_result;
+    msg->unpack_partial_message(message::NODE_PROG_PARTIAL, prog_type, req_id, credit, has_result);
+
+    vts->partial_mtx.lock();
+    auto iter = vts->partial_progs.find(req_id);
+    assert(iter != vts->partial_progs.end());
+    coordinator::partial_results &partial = iter->second;
+    dynamic_prog_table *prog = (dynamic_prog_table*)partial.prog_handle;
+    if (has_result) {
+        std::shared_ptr<Node_Parameters_Base> shard_result;
+        msg->unpack_message(message::NODE_PROG_PARTIAL, prog, prog_type, req_id, credit, has_result, shard_result);
+        prog->merge_results(partial.result, shard_result);
+    }
+    partial.partials++;
+    weaver_util::add_credit(partial.credit, credit);
+    if (!weaver_util::is_whole_credit(partial.credit)) {
+        vts->partial_mtx.unlock();
+        return;
+    }
+    coordinator::partial_results done = std::move(partial);
+    vts->partial_progs.erase(iter);
+    vts->partial_mtx.unlock();
+
+    current_prog *cp = done.cp;
+    uint64_t client = cp->client;
+    uint64_t cp_int = (uint64_t)cp;
+    if (node_prog_done(req_id, cp)) {
+        // no node returned anything
+        if (done.result == nullptr) {
+            done.result = prog->param_ctor();
+        }
+        msg->prepare_message(message::NODE_PROG_RETURN, prog, prog_type, req_id, cp_int, done.result);
+        vts->comm.send_to_client(client, msg->buf);
+#ifdef weaver_benchmark_
+        vts->test_mtx.lock();
+        vts->outstanding_cnt--;
+        vts->test_mtx.unlock();
+#endif
+    }
+}
+
+// a shard ran a superstep, start the next one or finish once all shards have
+void
+bsp_step_done(std::unique_ptr<message::message> msg)
+{
+    uint64_t req_id, active, sent;
+    uint32_t step;
+    msg->unpack_message(message::BSP_STEP_DONE, nullptr, req_id, step, active, sent);
+
+    vts->bsp_mtx.lock();
+    auto iter = vts->bsp_progs.find(req_id);
+    assert(iter != vts->bsp_progs.end());
+    coordinator::bsp_barrier &barrier = iter->second;
+    assert(barrier.superstep == step);
+    barrier.active += active;
+    barrier.sent += sent;
+    bool all_done = ++barrier.reported == barrier.num_shards;
+    bool finish = false;
+    if (all_done) {
+        // messages sent in the last superstep are dropped
+        finish = (barrier.active == 0 && barrier.sent == 0)
+              || (barrier.max_supersteps > 0 && step+1 >= barrier.max_supersteps);
+        barrier.finishing = finish;
+        barrier.superstep++;
+        barrier.reported = 0;
+        barrier.active = 0;
+        barrier.sent = 0;
+    }
+    uint64_t num_shards = barrier.num_shards;
+    vts->bsp_mtx.unlock();
+
+    if (all_done) {
+        message::message msg_to_send;
+        for (uint64_t i = 0; i < num_shards; i++) {
+            msg_to_send.prepare_message(message::BSP_STEP, nullptr, req_id, step+1, finish);
+            vts->comm.send(i + ShardIdIncr, msg_to_send.buf);
+        }
+    }
+}
+
+// merge the result of a shard, and return to the client once all shards have sent theirs
+void
+bsp_result(std::unique_ptr<message::message> msg)
+{
+    std::string prog_type;
+    uint64_t req_id;
+    bool has_result;
+    msg->unpack_partial_message(message::BSP_RESULT, prog_type, req_id, has_result);
+
+    vts->bsp_mtx.lock();
+    auto iter = vts->bsp_progs.find(req_id);
+    assert(iter != vts->bsp_progs.end());
+    coordinator::bsp_barrier &barrier = iter->second;
+    dynamic_prog_table *prog = (dynamic_prog_table*)barrier.prog_handle;
+    if (has_result) {
+        std::shared_ptr<Node_Parameters_Base> shard_result;
+        msg->unpack_message(message::BSP_RESULT, prog, prog_type, req_id, has_result, shard_result);
+        prog->merge_results(barrier.result, shard_result);
+    }
+    if (++barrier.results < barrier.num_shards) {
+        vts->bsp_mtx.unlock();
+        return;
+    }
+    coordinator::bsp_barrier done = std::move(barrier);
+    vts->bsp_progs.erase(iter);
+    vts->bsp_mtx.unlock();
+
+    current_prog *cp = done.cp;
+    uint64_t client = cp->client;
+    uint64_t cp_int = (uint64_t)cp;
+    if (node_prog_done(req_id, cp)) {
+        // no node had a value, return the request params
+        msg->prepare_message(message::NODE_PROG_RETURN, prog, prog_type, req_id, cp_int,
+                             done.result? done.result : done.global);
+        vts->comm.send_to_client(client, msg->buf);
+#ifdef weaver_benchmark_
+        vts->test_mtx.lock();
+        vts->outstanding_cnt--;
+        vts->test_mtx.unlock();
+#endif
+    }
+}
+
 bool
 register_node_prog(std::unique_ptr<message::message> msg, uint64_t client)
 {
@@ -660,11 +911,13 @@ server_loop(void *args)
                 case message::VT_NOP_ACK: {
                     uint64_t shard_node_count, nop_qts, sid, sender;
                     std::unordered_map<uint64_t, uint64_t> node_recovery_counts;
-                    msg->unpack_message(message::VT_NOP_ACK, nullptr, sender, nop_qts, shard_node_count, node_recovery_counts);
+                    std::vector<uint64_t> mem_bytes;
+                    msg->unpack_message(message::VT_NOP_ACK, nullptr, sender, nop_qts, shard_node_count, node_recovery_counts, mem_bytes);
                     sid = sender - ShardIdIncr;
                     vts->periodic_update_mutex.lock();
                     if (nop_qts > vts->nop_ack_qts[sid]) {
                         vts->shard_node_count[sid] = shard_node_count;
+                        vts->shard_mem_bytes[sid] = std::move(mem_bytes);
                         vts->to_nop[sid] = true;
                         vts->nop_ack_qts[sid] = nop_qts;
                     }
@@ -697,6 +950,14 @@ server_loop(void *args)
                     break;
                 }
 
+                case message::CLIENT_MEM_STATS: {
+                    vts->periodic_update_mutex.lock();
+                    msg->prepare_message(message::MEM_STATS_REPLY, nullptr, vts->shard_mem_bytes);
+                    vts->periodic_update_mutex.unlock();
+                    vts->comm.send_to_client(client_sender, msg->buf);
+                    break;
+                }
+
                 case message::TX_DONE:
                     msg->unpack_message(message::TX_DONE, nullptr, tx_id, shard_id);
                     end_tx(tx_id, shard_id, hstub);
@@ -743,11 +1004,15 @@ server_loop(void *args)
                     msg->unpack_partial_message(message::NODE_PROG_RETURN, prog_type, req_id, cp_int); // don't unpack rest
                     current_prog *cp = (current_prog*)cp_int;
                     client = cp->client;
+                    vc::vclock req_vclk = *cp->vclk;
 
                     bool to_process = node_prog_done(req_id, cp);
 
                     if (to_process) {
                         vts->comm.send_to_client(client, msg->buf);
+                        if (CANCEL_DONE_PROGS) {
+                            cancel_node_prog(req_id, req_vclk);
+                        }
                         //WDEBUG << "done node prog=" << req_id << " and sent to client=" << client << std::endl;
 #ifdef weaver_benchmark_
                         vts->test_mtx.lock();
@@ -758,6 +1023,22 @@ server_loop(void *args)
                     break;
                 }
 
+                case message::CLIENT_BSP_PROG_REQ:
+                    start_bsp_prog(std::move(msg), client_sender);
+                    break;
+
+                case message::BSP_STEP_DONE:
+                    bsp_step_done(std::move(msg));
+                    break;
+
+                case message::BSP_RESULT:
+                    bsp_result(std::move(msg));
+                    break;
+
+                case message::NODE_PROG_PARTIAL:
+                    node_prog_partial(std::move(msg));
+                    break;
+
                 case message::REGISTER_NODE_PROG:
                     WDEBUG << "got REGISTER_NODE_PROG msg" << std::endl;
                     if (!register_node_prog(std::move(msg), client_sender)) {
@@ -809,7 +1090,11 @@ server_loop(void *args)
 
                     vts->tx_queue_loop();
                     for (blocked_prog &bp: *progs) {
-                        unpack_and_forward_node_prog(std::move(bp.msg), bp.client, hstub);
+                        if (bp.msg->unpack_message_type() == message::CLIENT_BSP_PROG_REQ) {
+                            start_bsp_prog(std::move(bp.msg), bp.client);
+                        } else {
+                            unpack_and_forward_node_prog(std::move(bp.msg), bp.client, hstub);
+                        }
                     }
                     break;
                 }
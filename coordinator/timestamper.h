@@ -35,6 +35,8 @@
 #include "coordinator/blocked_prog.h"
 #include "coordinator/hyper_stub.h"
 #include "coordinator/register_node_prog_state.h"
+#include "coordinator/bsp_barrier.h"
+#include "coordinator/partial_results.h"
 
 namespace coordinator
 {
@@ -104,6 +106,12 @@ namespace coordinator
             // prog cleanup and permanent deletion
             std::unordered_set<uint64_t> outstanding_progs; // for multiple returns and ft
             std::vector<current_prog*> pend_progs, done_progs;
+            // whole graph progs by req id
+            po6::threads::mutex bsp_mtx;
+            std::unordered_map<uint64_t, coordinator::bsp_barrier> bsp_progs;
+            // aggregating progs by req id
+            po6::threads::mutex partial_mtx;
+            std::unordered_map<uint64_t, coordinator::partial_results> partial_progs;
             std::unordered_map<uint64_t, std::pair<uint64_t, uint64_t>> node_recovery_counts;
             int prog_done_cnt;
             vc::vclock_t m_max_done_clk; // permanent deletion
@@ -127,6 +135,8 @@ namespace coordinator
             // migration
             uint64_t migr_client;
             std::vector<uint64_t> shard_node_count;
+            // bytes per subsystem as last reported by each shard, see db/mem_accounting.h
+            std::vector<std::vector<uint64_t>> shard_mem_bytes;
 
             // fault tolerance
             std::pair<uint64_t, uint64_t> out_queue_clk; // (epoch num, out clk)
@@ -189,6 +199,7 @@ namespace coordinator
         , load_count(0)
         , max_load_time(0)
         , shard_node_count(NumShards, 0)
+        , shard_mem_bytes(NumShards)
         , out_queue_clk(std::make_pair(0,1))
         , out_queue_counter(0)
         , prog_queue(new std::vector<blocked_prog>())
@@ -290,6 +301,7 @@ namespace coordinator
         to_nop.resize(num_shards, true);
         nop_ack_qts.resize(num_shards, 0);
         shard_node_count.resize(num_shards, 0);
+        shard_mem_bytes.resize(num_shards);
         std::fill(m_max_done_clk.begin(), m_max_done_clk.end(), 0);
         m_max_done_clk[0] = config.version();
 
@@ -15,5 +15,6 @@
 #define weaver_coordinator_vt_constants_h_
 
 #define NUM_VT_THREADS 8
+#define CANCEL_DONE_PROGS true // tell shards when a node prog returns, false leaves it to the done clock
 
 #endif
@@ -0,0 +1,265 @@
+/*
+ * ===============================================================
+ *    Description:  Contiguous per-node out-edge block.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_adjacency_h_
+#define weaver_db_adjacency_h_
+
+#include <stdint.h>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <unordered_map>
+#include <assert.h>
+
+#include "common/clock_table.h"
+#include "db/edge.h"
+
+namespace db
+{
+    // edges of a node stored contiguously in insertion order, one slot per edge version
+    // clock ids and nbr loc are cached in parallel arrays so that traversals can
+    // filter a whole block of edges without touching the edge objects
+    // node::out_edges is kept as the handle -> versions index for lookups
+    // each edge remembers its slot, removal swaps the last slot in
+    //
+    // blocks of at least PropIndexThreshold edges also keep a (property key id, value) -> sorted
+    // slots index, built and updated only with the node latched exclusively. It lists every slot
+    // whose edge has any version of the property, and may keep slots of property versions since
+    // compacted, so readers check each edge at their own clock, see node_prog::filtered_edge_iter
+    class adjacency
+    {
+        public:
+            static const uint64_t PropIndexThreshold = 64;
+
+        private:
+            typedef std::unordered_map<std::string, std::vector<uint32_t>> value_slots_t;
+
+            std::vector<edge*> edges;
+            std::vector<uint32_t> creat_ids; // ids in vc::interned_clocks, the edge holds the reference
+            std::vector<uint32_t> del_ids; // null_id if edge not deleted
+            std::vector<uint64_t> nbr_locs;
+            std::unique_ptr<std::unordered_map<uint32_t, value_slots_t>> prop_index;
+
+            void copy_slot(uint64_t to, uint64_t from);
+            void index_edge(edge *e, uint32_t slot);
+            void unindex_edge(edge *e, uint32_t slot);
+
+        public:
+            void append(edge *e);
+            void refresh(edge *e);
+            void remove(edge *e);
+            void clear();
+            void reserve(uint64_t sz);
+            void shrink();
+            uint64_t size() const { return edges.size(); }
+            bool empty() const { return edges.empty(); }
+
+            edge* at(uint64_t slot) const { return edges[slot]; }
+            uint64_t nbr_loc(uint64_t slot) const { return nbr_locs[slot]; }
+            const uint32_t* creat_id_block() const { return creat_ids.data(); }
+            const uint32_t* del_id_block() const { return del_ids.data(); }
+
+            // property index, caution: writers hold the node latch exclusively
+            bool prop_indexed() const { return (bool)prop_index; }
+            void build_prop_index();
+            void drop_prop_index() { prop_index.reset(); }
+            // builds the index once the block is large enough
+            void maybe_build_prop_index();
+            // after edge e got a new version of property key_id=value
+            void index_property(edge *e, uint32_t key_id, const std::string &value);
+            // slots of edges which may have property key_id=value, only if prop_indexed()
+            const std::vector<uint32_t>& prop_slots(uint32_t key_id, const std::string &value) const;
+    };
+
+    inline void
+    insert_sorted_slot(std::vector<uint32_t> &slots, uint32_t slot)
+    {
+        auto iter = std::lower_bound(slots.begin(), slots.end(), slot);
+        if (iter == slots.end() || *iter != slot) {
+            slots.insert(iter, slot);
+        }
+    }
+
+    inline void
+    erase_sorted_slot(std::vector<uint32_t> &slots, uint32_t slot)
+    {
+        auto iter = std::lower_bound(slots.begin(), slots.end(), slot);
+        if (iter != slots.end() && *iter == slot) {
+            slots.erase(iter);
+        }
+    }
+
+    inline void
+    adjacency :: index_edge(edge *e, uint32_t slot)
+    {
+        const prop_block &props = *e->base.get_properties();
+        for (uint64_t i = 0; i < props.size(); i++) {
+            insert_sorted_slot((*prop_index)[props.key_id(i)][props.value(i)], slot);
+        }
+    }
+
+    // slots of property versions compacted since they were indexed stay behind, see class comment
+    inline void
+    adjacency :: unindex_edge(edge *e, uint32_t slot)
+    {
+        const prop_block &props = *e->base.get_properties();
+        for (uint64_t i = 0; i < props.size(); i++) {
+            auto key_iter = prop_index->find(props.key_id(i));
+            if (key_iter == prop_index->end()) {
+                continue;
+            }
+            auto value_iter = key_iter->second.find(props.value(i));
+            if (value_iter == key_iter->second.end()) {
+                continue;
+            }
+            erase_sorted_slot(value_iter->second, slot);
+            if (value_iter->second.empty()) {
+                key_iter->second.erase(value_iter);
+            }
+        }
+    }
+
+    inline void
+    adjacency :: build_prop_index()
+    {
+        prop_index.reset(new std::unordered_map<uint32_t, value_slots_t>());
+        for (uint64_t slot = 0; slot < edges.size(); slot++) {
+            index_edge(edges[slot], slot);
+        }
+    }
+
+    inline void
+    adjacency :: maybe_build_prop_index()
+    {
+        if (!prop_index && edges.size() >= PropIndexThreshold) {
+            build_prop_index();
+        }
+    }
+
+    inline void
+    adjacency :: index_property(edge *e, uint32_t key_id, const std::string &value)
+    {
+        if (prop_index) {
+            assert(edges[e->adj_slot] == e);
+            insert_sorted_slot((*prop_index)[key_id][value], e->adj_slot);
+        }
+    }
+
+    inline const std::vector<uint32_t>&
+    adjacency :: prop_slots(uint32_t key_id, const std::string &value) const
+    {
+        static const std::vector<uint32_t> none;
+        assert(prop_index);
+
+        auto key_iter = prop_index->find(key_id);
+        if (key_iter == prop_index->end()) {
+            return none;
+        }
+        auto value_iter = key_iter->second.find(value);
+        if (value_iter == key_iter->second.end()) {
+            return none;
+        }
+        return value_iter->second;
+    }
+
+    inline void
+    adjacency :: append(edge *e)
+    {
+        assert(e->adj_slot == UINT32_MAX);
+        e->adj_slot = edges.size();
+        edges.emplace_back(e);
+        creat_ids.emplace_back(e->base.get_creat_id());
+        del_ids.emplace_back(e->base.get_del_id());
+        nbr_locs.emplace_back(e->nbr.loc);
+        if (prop_index) {
+            index_edge(e, e->adj_slot);
+        }
+    }
+
+    // re-read cached fields after the edge's clocks or nbr loc changed
+    inline void
+    adjacency :: refresh(edge *e)
+    {
+        uint32_t slot = e->adj_slot;
+        assert(slot < edges.size());
+        assert(edges[slot] == e);
+        creat_ids[slot] = e->base.get_creat_id();
+        del_ids[slot] = e->base.get_del_id();
+        nbr_locs[slot] = e->nbr.loc;
+    }
+
+    inline void
+    adjacency :: copy_slot(uint64_t to, uint64_t from)
+    {
+        if (prop_index) {
+            unindex_edge(edges[from], from);
+            index_edge(edges[from], to);
+        }
+        edges[to] = edges[from];
+        creat_ids[to] = creat_ids[from];
+        del_ids[to] = del_ids[from];
+        nbr_locs[to] = nbr_locs[from];
+        edges[to]->adj_slot = to;
+    }
+
+    inline void
+    adjacency :: remove(edge *e)
+    {
+        uint32_t slot = e->adj_slot;
+        assert(slot < edges.size());
+        assert(edges[slot] == e);
+
+        if (prop_index) {
+            unindex_edge(e, slot);
+        }
+        if (slot != edges.size()-1) {
+            copy_slot(slot, edges.size()-1);
+        }
+        edges.pop_back();
+        creat_ids.pop_back();
+        del_ids.pop_back();
+        nbr_locs.pop_back();
+        e->adj_slot = UINT32_MAX;
+    }
+
+    inline void
+    adjacency :: clear()
+    {
+        edges.clear();
+        creat_ids.clear();
+        del_ids.clear();
+        nbr_locs.clear();
+        prop_index.reset();
+    }
+
+    inline void
+    adjacency :: reserve(uint64_t sz)
+    {
+        edges.reserve(sz);
+        creat_ids.reserve(sz);
+        del_ids.reserve(sz);
+        nbr_locs.reserve(sz);
+    }
+
+    // release spare capacity after many removals
+    inline void
+    adjacency :: shrink()
+    {
+        if (edges.capacity() > 2*edges.size()) {
+            edges.shrink_to_fit();
+            creat_ids.shrink_to_fit();
+            del_ids.shrink_to_fit();
+            nbr_locs.shrink_to_fit();
+        }
+    }
+}
+
+#endif
@@ -22,6 +22,7 @@ namespace db
     {
         std::string type;
         vc::vclock clk;
+        uint64_t req_id;
         std::shared_ptr<void> state;
         db::node *n;
     };
@@ -0,0 +1,268 @@
+/*
+ * ===============================================================
+ *    Description:  Whole graph node programs on a shard. Every
+ *                  superstep runs the program at each node of the
+ *                  shard at the request's clock, and sends the
+ *                  messages for other shards as one BSP_MSGS per
+ *                  shard. The next superstep starts once the VT has
+ *                  heard from all shards and every other shard's
+ *                  messages for it have arrived.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_bsp_job_h_
+#define weaver_db_bsp_job_h_
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <po6/threads/mutex.h>
+
+#include "common/vclock.h"
+#include "common/event_order.h"
+#include "node_prog/dynamic_prog_table.h"
+#include "db/node_id_table.h"
+
+namespace db
+{
+    typedef std::vector<std::pair<node_handle_t, node_prog::np_param_ptr_t>> bsp_msgs_t;
+
+    struct bsp_job
+    {
+        po6::threads::mutex mtx;
+        uint64_t req_id;
+        vc::vclock clk;
+
+        // set by BSP_PROG, once reads at clk can go through
+        bool started;
+        std::string prog_type;
+        dynamic_prog_table *prog;
+        uint64_t vt_id, vt_prog_ptr, num_shards;
+        node_prog::np_param_ptr_t global;
+
+        // superstep the VT has allowed to start, and the next one to run here
+        uint32_t allowed, next;
+        bool running, finish;
+        // messages from other shards by superstep, with the number of shards heard from
+        std::unordered_map<uint32_t, std::pair<uint64_t, bsp_msgs_t>> remote;
+
+        // nodes of this shard at clk, touched only by the thread running a superstep
+        std::vector<node_handle_t> handles;
+        std::vector<uint64_t> ids;
+        std::unordered_map<node_handle_t, uint32_t> by_handle;
+        std::vector<uint32_t> by_dense; // node_id_table::dense_index -> node, UINT32_MAX if none
+        std::vector<node_prog::np_state_ptr_t> values;
+        std::vector<bool> halted;
+        std::vector<std::vector<node_prog::np_param_ptr_t>> inbox; // messages for the next superstep
+
+        bsp_job(uint64_t rid, const vc::vclock &req_clk)
+            : req_id(rid)
+            , clk(req_clk)
+            , started(false)
+            , prog(nullptr)
+            , vt_id(UINT64_MAX)
+            , vt_prog_ptr(0)
+            , num_shards(0)
+            , allowed(0)
+            , next(0)
+            , running(false)
+            , finish(false)
+        { }
+
+        // caution: assume holding mtx
+        // true if the next superstep can run now, the caller then runs it
+        bool claim(bsp_msgs_t &arrived);
+        // caution: assume holding mtx
+        // true if the result can be sent now, the caller then sends it
+        bool claim_finish();
+        void add_node(const node_handle_t &handle, uint64_t id);
+        // node of a message sent on this shard, UINT32_MAX if not a node of this job
+        uint32_t local_index(uint64_t id, const node_handle_t &handle);
+        // adds a message for the next superstep, folded if the program has a combiner
+        void deliver(uint32_t idx, node_prog::np_param_ptr_t msg);
+    };
+
+    // jobs by request id, a job is created by whichever of its messages arrives first
+    // messages of the last superstep may arrive after the job finished, finished
+    // requests are remembered until the done clock passes them
+    class bsp_jobs
+    {
+        private:
+            po6::threads::mutex mtx;
+            std::unordered_map<uint64_t, std::shared_ptr<bsp_job>> jobs;
+            std::unordered_map<uint64_t, vc::vclock> finished;
+
+        public:
+            bsp_jobs() { }
+            bsp_jobs(const bsp_jobs&) = delete;
+            bsp_jobs& operator=(const bsp_jobs&) = delete;
+
+            // null if the job already finished
+            std::shared_ptr<bsp_job> get(uint64_t req_id, const vc::vclock &clk);
+            std::shared_ptr<bsp_job> find(uint64_t req_id);
+            void finish(uint64_t req_id);
+            void cleanup(const std::vector<vc::vclock_t> &done_clk);
+            uint64_t size();
+    };
+
+    inline bool
+    bsp_job :: claim(bsp_msgs_t &arrived)
+    {
+        if (!started || running || finish || next > allowed) {
+            return false;
+        }
+
+        if (next > 0) {
+            auto iter = remote.find(next);
+            if (num_shards > 1 && (iter == remote.end() || iter->second.first < num_shards-1)) {
+                return false;
+            }
+            if (iter != remote.end()) {
+                arrived = std::move(iter->second.second);
+                remote.erase(iter);
+            }
+        }
+
+        running = true;
+        return true;
+    }
+
+    inline bool
+    bsp_job :: claim_finish()
+    {
+        if (!started || !finish || running) {
+            return false;
+        }
+
+        running = true;
+        return true;
+    }
+
+    inline void
+    bsp_job :: add_node(const node_handle_t &handle, uint64_t id)
+    {
+        uint32_t idx = handles.size();
+        handles.emplace_back(handle);
+        ids.emplace_back(id);
+        by_handle.emplace(handle, idx);
+
+        uint64_t dense = node_id_table::dense_index(id);
+        if (dense >= by_dense.size()) {
+            by_dense.resize(dense+1, UINT32_MAX);
+        }
+        by_dense[dense] = idx;
+    }
+
+    inline uint32_t
+    bsp_job :: local_index(uint64_t id, const node_handle_t &handle)
+    {
+        if (id != node_id_table::invalid_id) {
+            uint64_t dense = node_id_table::dense_index(id);
+            // ids are hints, the slot may have been reused by another node
+            if (dense < by_dense.size()
+             && by_dense[dense] != UINT32_MAX
+             && ids[by_dense[dense]] == id) {
+                return by_dense[dense];
+            }
+        }
+
+        auto iter = by_handle.find(handle);
+        return iter == by_handle.end()? UINT32_MAX : iter->second;
+    }
+
+    inline void
+    bsp_job :: deliver(uint32_t idx, node_prog::np_param_ptr_t msg)
+    {
+        std::vector<node_prog::np_param_ptr_t> &msgs = inbox[idx];
+        if (prog->bsp_combine != nullptr && !msgs.empty()) {
+            prog->bsp_combine(msgs.front(), std::move(msg));
+        } else {
+            msgs.emplace_back(std::move(msg));
+        }
+    }
+
+    inline std::shared_ptr<bsp_job>
+    bsp_jobs :: get(uint64_t req_id, const vc::vclock &clk)
+    {
+        std::shared_ptr<bsp_job> ret;
+
+        mtx.lock();
+        if (finished.find(req_id) == finished.end()) {
+            std::shared_ptr<bsp_job> &job = jobs[req_id];
+            if (!job) {
+                job = std::make_shared<bsp_job>(req_id, clk);
+            }
+            ret = job;
+        }
+        mtx.unlock();
+
+        return ret;
+    }
+
+    inline std::shared_ptr<bsp_job>
+    bsp_jobs :: find(uint64_t req_id)
+    {
+        std::shared_ptr<bsp_job> ret;
+
+        mtx.lock();
+        auto iter = jobs.find(req_id);
+        if (iter != jobs.end()) {
+            ret = iter->second;
+        }
+        mtx.unlock();
+
+        return ret;
+    }
+
+    inline void
+    bsp_jobs :: finish(uint64_t req_id)
+    {
+        mtx.lock();
+        auto iter = jobs.find(req_id);
+        if (iter != jobs.end()) {
+            finished.emplace(req_id, iter->second->clk);
+            jobs.erase(iter);
+        }
+        mtx.unlock();
+    }
+
+    inline void
+    bsp_jobs :: cleanup(const std::vector<vc::vclock_t> &done_clk)
+    {
+        mtx.lock();
+        for (auto iter = finished.begin(); iter != finished.end();) {
+            const vc::vclock &clk = iter->second;
+            if (order::oracle::happens_before_no_kronos(clk.clock, done_clk[clk.vt_id])) {
+                iter = finished.erase(iter);
+            } else {
+                iter++;
+            }
+        }
+        // created by a message which arrived after the job was forgotten
+        for (auto iter = jobs.begin(); iter != jobs.end();) {
+            const vc::vclock &clk = iter->second->clk;
+            if (order::oracle::happens_before_no_kronos(clk.clock, done_clk[clk.vt_id])) {
+                iter = jobs.erase(iter);
+            } else {
+                iter++;
+            }
+        }
+        mtx.unlock();
+    }
+
+    inline uint64_t
+    bsp_jobs :: size()
+    {
+        mtx.lock();
+        uint64_t sz = jobs.size();
+        mtx.unlock();
+        return sz;
+    }
+}
+
+#endif
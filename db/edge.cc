@@ -13,12 +13,16 @@
 
 #include <memory>
 #include "db/edge.h"
+#include "db/mem_accounting.h"
 
 db::edge db::edge::empty_edge;
 
 using db::edge;
 using db::remote_node;
 
+// edge object plus its adjacency slot and out_edges entry in the owning node
+static const uint64_t charged_bytes = sizeof(edge) + 3*sizeof(void*) + sizeof(uint64_t) + 4*sizeof(void*);
+
 // empty constructor for unpacking
 edge :: edge()
     : base()
@@ -28,6 +32,7 @@ edge :: edge()
 #ifdef WEAVER_NEW_CLDG
     , msg_count(0)
 #endif
+    , adj_slot(UINT32_MAX)
 {
 }
 
@@ -40,6 +45,7 @@ edge :: edge(const edge_handle_t &handle, vclock_ptr_t &vclk, uint64_t remote_lo
 #ifdef WEAVER_NEW_CLDG
     , msg_count(0)
 #endif
+    , adj_slot(UINT32_MAX)
 {
 }
 
@@ -52,6 +58,7 @@ edge :: edge(const edge_handle_t &handle, vclock_ptr_t &vclk, remote_node &rn)
 #ifdef WEAVER_NEW_CLDG
     , msg_count(0)
 #endif
+    , adj_slot(UINT32_MAX)
 {
 }
 
@@ -60,6 +67,45 @@ edge :: ~edge()
     WDEBUG << "deleting edge handle=" << get_handle() << std::endl;
 }
 
+void*
+edge :: operator new(size_t sz)
+{
+    return operator new(sz, default_slab());
+}
+
+void*
+edge :: operator new(size_t sz, db::slab<edge> &s)
+{
+    assert(sz == sizeof(edge));
+    UNUSED(sz);
+    void *p = s.allocate();
+    db::shard_memory().add(db::MEM_EDGES, charged_bytes);
+    return p;
+}
+
+void
+edge :: operator delete(void *p)
+{
+    if (p != nullptr) {
+        db::shard_memory().sub(db::MEM_EDGES, charged_bytes);
+    }
+    db::slab<edge>::release(p);
+}
+
+void
+edge :: operator delete(void *p, db::slab<edge> &s)
+{
+    db::shard_memory().sub(db::MEM_EDGES, charged_bytes);
+    s.free(p);
+}
+
+db::slab<edge>&
+edge :: default_slab()
+{
+    static db::slab<edge> s;
+    return s;
+}
+
 // caution: should be called with node mutex held
 // should always be called when an edge is traversed in a node program
 void
@@ -123,7 +169,7 @@ edge :: get_client_edge(const std::string &start_node, cl::edge &e)
     e.properties.clear();
 
     node_prog::prop_list plist = get_properties();
-    for (std::vector<std::shared_ptr<node_prog::property>> pvec: plist) {
-        e.properties.insert(e.properties.end(), pvec.begin(), pvec.end());
+    for (node_prog::prop_view p: plist) {
+        e.properties.emplace_back(std::make_shared<node_prog::property>(p.get_key(), p.get_value()));
     }
 }
@@ -22,6 +22,7 @@
 #include "node_prog/property.h"
 #include "db/remote_node.h"
 #include "db/element.h"
+#include "db/slab.h"
 #include "client/datastructures.h"
 
 namespace db
@@ -44,6 +45,7 @@ namespace db
             uint32_t msg_count; // number of messages sent on this link
 #endif
             uint64_t edge_id; // for new HD schema
+            uint32_t adj_slot; // index in owning node's adjacency block
             void traverse(); // indicate that this edge was traversed; useful for migration statistics
 
             const remote_node& get_neighbor() { return nbr; }
@@ -56,6 +58,13 @@ namespace db
             void get_client_edge(const std::string &node, cl::edge &e);
 
             static edge empty_edge;
+
+            // shards allocate edges from per node map slabs, all other allocations use default_slab
+            static void* operator new(size_t sz);
+            static void* operator new(size_t sz, slab<edge> &s);
+            static void operator delete(void *p);
+            static void operator delete(void *p, slab<edge> &s);
+            static slab<edge>& default_slab();
     };
 }
 
@@ -16,60 +16,74 @@
 
 using db::element;
 using db::property;
+using db::key_dictionary;
+using db::property_keys;
+
+thread_local vclock_ptr_t element::view_time;
+thread_local order::oracle *element::time_oracle = nullptr;
+
+element :: element()
+    : creat_id(vc::clock_table::null_id)
+    , del_id(vc::clock_table::null_id)
+{ }
 
 element :: element(const std::string &_handle, const vclock_ptr_t &vclk)
     : handle(_handle)
-    , creat_time(vclk)
-    , del_time(nullptr)
-    , time_oracle(nullptr)
+    , creat_id(vc::interned_clocks.intern(vclk))
+    , del_id(vc::clock_table::null_id)
 { }
 
-bool
-element :: add_property(const property &prop)
+element :: element(const element &other)
+    : handle(other.handle)
+    , creat_id(other.creat_id)
+    , del_id(other.del_id)
+    , properties(other.properties)
 {
-#ifdef weaver_large_property_maps_
+    vc::interned_clocks.acquire(creat_id);
+    vc::interned_clocks.acquire(del_id);
+}
 
-    auto find_iter = properties.find(prop.key);
-    if (find_iter == properties.end()) {
-        std::vector<std::shared_ptr<property>> new_vec;
-        new_vec.emplace_back(std::make_shared<property>(prop));
-        properties.emplace(prop.key, new_vec);
-        return true;
-    } else {
-        bool exists = false;
-        for (const std::shared_ptr<property> p: find_iter->second) {
-            if (*p == prop && !p->is_deleted()) {
-                exists = true;
-                break;
-            }
-        }
+element :: ~element()
+{
+    vc::interned_clocks.release(creat_id);
+    vc::interned_clocks.release(del_id);
+}
 
-        if (!exists) {
-            find_iter->second.emplace_back(std::make_shared<property>(prop));
-            return true;
-        } else {
-            return false;
-        }
+element&
+element :: operator=(const element &other)
+{
+    if (this != &other) {
+        vc::interned_clocks.acquire(other.creat_id);
+        vc::interned_clocks.acquire(other.del_id);
+        vc::interned_clocks.release(creat_id);
+        vc::interned_clocks.release(del_id);
+
+        handle = other.handle;
+        creat_id = other.creat_id;
+        del_id = other.del_id;
+        properties = other.properties;
     }
+    return *this;
+}
 
-#else
-
-    bool exists = false;
-    for (const std::shared_ptr<property> p: properties) {
-        if (*p == prop && !p->is_deleted()) {
-            exists = true;
-            break;
-        }
+bool
+element :: add_property(const property &prop)
+{
+    uint32_t kid = property_keys.intern(prop.key);
+    if (kid == key_dictionary::invalid_id) {
+        WDEBUG << "property key dictionary full, dropping property " << prop.key << std::endl;
+        return false;
     }
+    bool exists = properties.any_slot(kid, [&](uint64_t slot) {
+        return !properties.is_deleted(slot) && properties.value(slot) == prop.value;
+    });
 
     if (exists) {
         return false;
     } else {
-        properties.emplace_back(std::make_shared<property>(prop));
+        properties.append(kid, prop.value, prop.get_creat_time(), prop.get_del_time());
         return true;
     }
-
-#endif
 }
 
 bool
@@ -82,89 +96,44 @@ element :: add_property(const std::string &key, const std::string &value, const
 bool
 element :: delete_property(const std::string &key, const vclock_ptr_t &tdel)
 {
-#ifdef weaver_large_property_maps_
-
-    auto iter = properties.find(key);
-    if (iter == properties.end()) {
+    uint32_t kid = property_keys.lookup(key);
+    if (kid == key_dictionary::invalid_id) {
         return false;
-    } else {
-        for (std::shared_ptr<property> p: iter->second) {
-            if (!p->is_deleted()) {
-                p->update_del_time(tdel);
-            }
-        }
-        return true;
     }
 
-#else
-
     bool found = false;
-    for (std::shared_ptr<property> p: properties) {
-        if (p->key == key && !p->is_deleted()) {
-            p->update_del_time(tdel);
+    properties.any_slot(kid, [&](uint64_t slot) {
+        if (!properties.is_deleted(slot)) {
+            properties.mark_deleted(slot, tdel);
             found = true;
         }
-    }
+        return false;
+    });
     return found;
-
-#endif
 }
 
 bool
 element :: delete_property(const std::string &key, const std::string &value, const vclock_ptr_t &tdel)
 {
-#ifdef weaver_large_property_maps_
-
-    auto iter = properties.find(key);
-    if (iter == properties.end()) {
-        return false;
-    } else {
-        for (std::shared_ptr<property> p: iter->second) {
-            if (p->key == key && p->value == value && !p->is_deleted()) {
-                p->update_del_time(tdel);
-                return true;
-            }
-        }
+    uint32_t kid = property_keys.lookup(key);
+    if (kid == key_dictionary::invalid_id) {
         return false;
     }
 
-#else
-
-    for (std::shared_ptr<property> p: properties) {
-        if (p->key == key && p->value == value && !p->is_deleted()) {
-            p->update_del_time(tdel);
+    return properties.any_slot(kid, [&](uint64_t slot) {
+        if (!properties.is_deleted(slot) && properties.value(slot) == value) {
+            properties.mark_deleted(slot, tdel);
             return true;
         }
-    }
-    return false;
-
-#endif
+        return false;
+    });
 }
 
 bool
 element :: set_property(const property &prop)
 {
-#ifdef weaver_large_property_maps_
-
-    auto find_iter = properties.find(prop.key);
-    if (find_iter != properties.end()
-     && !find_iter->second.back()->is_deleted()) {
-        delete_property(prop.key, prop.get_creat_time());
-    }
-
-#else
-
-    for (const std::shared_ptr<property> p: properties) {
-        if (p->key == prop.key && !p->is_deleted()) {
-            delete_property(prop.key, prop.get_creat_time());
-        }
-    }
-
-
-#endif
-
-    add_property(prop);
-    return true;
+    delete_property(prop.key, prop.get_creat_time());
+    return add_property(prop);
 }
 
 bool
@@ -178,114 +147,57 @@ element :: set_property(const std::string &key, const std::string &value, const
 void
 element :: remove_property(const std::string &key)
 {
-#ifdef weaver_large_property_maps_
-    properties.erase(key);
-#else
-
-    std::vector<size_t> del_pos;
-    size_t pos = 0;
-
-    for (const std::shared_ptr<property> p: properties) {
-        if (p->key == key) {
-            del_pos.emplace_back(pos);
-        }
-        pos++;
-    }
-
-    for (size_t dp: del_pos) {
-        properties.erase(properties.begin() + dp);
+    uint32_t kid = property_keys.lookup(key);
+    if (kid != key_dictionary::invalid_id) {
+        properties.remove_key(kid);
     }
-
-#endif
 }
 
 std::string
 element :: get_property(const std::string &key)
 {
-#ifdef weaver_large_property_maps_
-
-    auto iter = properties.find(key);
-    if (iter != properties.end()) {
-        for (const std::shared_ptr<property> p: iter->second) {
-            if (time_oracle->clock_creat_before_del_after(*view_time, p->get_creat_time(), p->get_del_time())) {
-                return p->value;
-            }
-        }
+    uint32_t kid = property_keys.lookup(key);
+    if (kid == key_dictionary::invalid_id) {
+        return "";
     }
 
-    return "";
-
-#else
-
-    for (const std::shared_ptr<property> p: properties) {
-        if (p->key == key
-         && time_oracle->clock_creat_before_del_after(*view_time, p->get_creat_time(), p->get_del_time())) {
-            return p->value;
+    std::string ret;
+    properties.any_slot(kid, [&](uint64_t slot) {
+        if (time_oracle->clock_creat_before_del_after(*view_time, properties.creat_id(slot), properties.del_id(slot))) {
+            ret = properties.value(slot);
+            return true;
         }
-    }
-    return "";
-
-#endif
+        return false;
+    });
+    return ret;
 }
 
 bool
 element :: has_property(const std::string &key, const std::string &value)
 {
-#ifdef weaver_large_property_maps_
-
-    auto iter = properties.find(key);
-    if (iter != properties.end()) {
-        for (const std::shared_ptr<property> p: iter->second) {
-            if (p->value == value
-             && time_oracle->clock_creat_before_del_after(*view_time, p->get_creat_time(), p->get_del_time())) {
-                return true;
-            }
-        }
-    }
-
-    return false;
-
-#else
-
-    for (const std::shared_ptr<property> p: properties) {
-        if (p->key == key && p->value == value
-         && time_oracle->clock_creat_before_del_after(*view_time, p->get_creat_time(), p->get_del_time())) {
-            return true;
-        }
+    uint32_t kid = property_keys.lookup(key);
+    if (kid == key_dictionary::invalid_id) {
+        return false;
     }
-    return false;
 
-#endif
+    return properties.any_slot(kid, [&](uint64_t slot) {
+        return properties.value(slot) == value
+            && time_oracle->clock_creat_before_del_after(*view_time, properties.creat_id(slot), properties.del_id(slot));
+    });
 }
 
 bool
 element :: has_predicate(const predicate::prop_predicate &pred)
 {
-#ifdef weaver_large_property_maps_
-
-    auto iter = properties.find(key);
-    if (iter != properties.end()) {
-        for (const std::shared_ptr<property> p: iter->second) {
-            if (pred.check(*p)
-             && time_oracle->clock_creat_before_del_after(*view_time, p->get_creat_time(), p->get_del_time())) {
-                return true;
-            }
-        }
-    }
-
-    return false;
-
-#else
-
-    for (const std::shared_ptr<property> p: properties) {
-        if (pred.check(*p)
-         && time_oracle->clock_creat_before_del_after(*view_time, p->get_creat_time(), p->get_del_time())) {
-            return true;
-        }
+    uint32_t kid = property_keys.lookup(pred.key);
+    if (kid == key_dictionary::invalid_id) {
+        return false;
     }
-    return false;
 
-#endif
+    return properties.any_slot(kid, [&](uint64_t slot) {
+        return pred.check_value(properties.value(slot))
+            && time_oracle->clock_creat_before_del_after(*view_time, properties.creat_id(slot), properties.del_id(slot));
+    });
 }
 
 bool
@@ -320,25 +232,29 @@ void
 element :: update_del_time(const vclock_ptr_t &tdel)
 {
     // do not assert !del_time because node may have been swapped in with latest updates
-    del_time = tdel;
+    uint32_t old_id = del_id;
+    del_id = vc::interned_clocks.intern(tdel);
+    vc::interned_clocks.release(old_id);
 }
 
 const vclock_ptr_t&
 element :: get_del_time() const
 {
-    return del_time;
+    return vc::interned_clocks.get(del_id);
 }
 
 void
 element :: update_creat_time(const vclock_ptr_t &tcreat)
 {
-    creat_time = tcreat;
+    uint32_t old_id = creat_id;
+    creat_id = vc::interned_clocks.intern(tcreat);
+    vc::interned_clocks.release(old_id);
 }
 
 const vclock_ptr_t&
 element :: get_creat_time() const
 {
-    return creat_time;
+    return vc::interned_clocks.get(creat_id);
 }
 
 void
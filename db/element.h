@@ -23,8 +23,10 @@
 
 #include "common/weaver_constants.h"
 #include "common/event_order.h"
+#include "common/clock_table.h"
 #include "common/property_predicate.h"
 #include "db/property.h"
+#include "db/prop_block.h"
 
 using vc::vclock_ptr_t;
 
@@ -50,22 +52,24 @@ namespace db
     class element
     {
         public:
-            element() { }
+            element();
             element(const std::string &handle, const vclock_ptr_t &vclk);
+            element(const element &other);
+            ~element();
+            element& operator=(const element &other);
 
         protected:
             std::string handle;
-            vclock_ptr_t creat_time;
-            vclock_ptr_t del_time;
+            // ids in vc::interned_clocks
+            uint32_t creat_id;
+            uint32_t del_id;
 
         public:
-#ifdef weaver_large_property_maps_
-            std::unordered_map<std::string, std::vector<std::shared_ptr<property>>> properties;
-#else
-            std::vector<std::shared_ptr<property>> properties;
-#endif
-            vclock_ptr_t view_time;
-            order::oracle *time_oracle;
+            prop_block properties;
+            // read view of the node program running on this thread
+            // per thread so that concurrent readers of an element do not clobber each other
+            static thread_local vclock_ptr_t view_time;
+            static thread_local order::oracle *time_oracle;
 
         public:
             bool add_property(const property &prop);
@@ -85,15 +89,11 @@ namespace db
             const vclock_ptr_t& get_del_time() const;
             void update_creat_time(const vclock_ptr_t &creat_time);
             const vclock_ptr_t& get_creat_time() const;
+            uint32_t get_creat_id() const { return creat_id; }
+            uint32_t get_del_id() const { return del_id; }
             void set_handle(const std::string &handle);
             const std::string& get_handle() const;
-#ifdef weaver_large_property_maps_
-            void set_properties(std::unordered_map<std::string, std::vector<std::shared_ptr<property>>> &props) { properties = props; }
-            const std::unordered_map<std::string, std::vector<std::shared_ptr<property>>>* get_properties() const { return properties; }
-#else
-            void set_properties(std::vector<std::shared_ptr<property>> &props) { properties = props; }
-            const std::vector<std::shared_ptr<property>>* get_properties() const { return &properties; }
-#endif
+            const prop_block* get_properties() const { return &properties; }
     };
 
 }
@@ -0,0 +1,118 @@
+/*
+ * ===============================================================
+ *    Description:  Work stealing pool for pieces of a node program
+ *                  frontier. Each worker thread pushes the pieces it
+ *                  splits off onto its own deque and takes them back
+ *                  newest first, idle threads steal the oldest piece
+ *                  from some other thread's deque.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_frontier_pool_h_
+#define weaver_db_frontier_pool_h_
+
+#include <stdint.h>
+#include <assert.h>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <po6/threads/mutex.h>
+
+namespace db
+{
+    template <typename T>
+    class frontier_pool
+    {
+        private:
+            struct thread_deque
+            {
+                po6::threads::mutex mtx;
+                std::deque<T> pieces;
+            };
+
+            std::vector<std::unique_ptr<thread_deque>> deques;
+            std::atomic<uint64_t> num_pending;
+            std::atomic<uint64_t> num_pushed, num_stolen;
+
+        public:
+            frontier_pool(uint64_t num_threads);
+            frontier_pool(const frontier_pool&) = delete;
+            frontier_pool& operator=(const frontier_pool&) = delete;
+
+            void push(uint64_t tid, T piece);
+            // own deque first, newest first, then the oldest piece of another thread
+            bool take(uint64_t tid, T &piece);
+            uint64_t pending() const { return num_pending.load(std::memory_order_relaxed); }
+
+            // stats
+            uint64_t pushed() const { return num_pushed.load(std::memory_order_relaxed); }
+            uint64_t stolen() const { return num_stolen.load(std::memory_order_relaxed); }
+    };
+
+    template <typename T>
+    inline
+    frontier_pool<T> :: frontier_pool(uint64_t num_threads)
+        : num_pending(0)
+        , num_pushed(0)
+        , num_stolen(0)
+    {
+        assert(num_threads > 0);
+        deques.reserve(num_threads);
+        for (uint64_t i = 0; i < num_threads; i++) {
+            deques.emplace_back(new thread_deque());
+        }
+    }
+
+    template <typename T>
+    inline void
+    frontier_pool<T> :: push(uint64_t tid, T piece)
+    {
+        thread_deque &d = *deques[tid % deques.size()];
+        d.mtx.lock();
+        d.pieces.emplace_back(std::move(piece));
+        d.mtx.unlock();
+        num_pending++;
+        num_pushed++;
+    }
+
+    template <typename T>
+    inline bool
+    frontier_pool<T> :: take(uint64_t tid, T &piece)
+    {
+        if (num_pending.load(std::memory_order_relaxed) == 0) {
+            return false;
+        }
+
+        uint64_t num_deques = deques.size();
+        uint64_t own = tid % num_deques;
+        for (uint64_t i = 0; i < num_deques; i++) {
+            uint64_t victim = (own + i) % num_deques;
+            thread_deque &d = *deques[victim];
+            d.mtx.lock();
+            if (!d.pieces.empty()) {
+                if (victim == own) {
+                    piece = std::move(d.pieces.back());
+                    d.pieces.pop_back();
+                } else {
+                    piece = std::move(d.pieces.front());
+                    d.pieces.pop_front();
+                    num_stolen++;
+                }
+                d.mtx.unlock();
+                num_pending--;
+                return true;
+            }
+            d.mtx.unlock();
+        }
+
+        return false;
+    }
+}
+
+#endif
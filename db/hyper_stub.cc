@@ -117,7 +117,6 @@ hyper_stub :: fd()
 
 void
 hyper_stub :: restore_backup(db::data_map<std::shared_ptr<db::node_entry>> *nodes,
-    /*XXX std::unordered_map<node_handle_t, std::unordered_set<node_version_t, node_version_hash>> &edge_map,*/
     po6::threads::mutex *shard_mutexes)
 {
     const hyperdex_client_attribute *cl_attr;
@@ -197,13 +196,6 @@ hyper_stub :: restore_backup(db::data_map<std::shared_ptr<db::node_entry>> *node
             n = new node(node_handle, UINT64_MAX, dummy_clock, shard_mutexes+map_idx);
             recreate_node(node_attrs, *n);
 
-            //XXX edge map
-            //for (const auto &p: n->out_edges) {
-            //    assert(p.second.size() == 1);
-            //    edge *e = p.second.front();
-            //    edge_map[e->nbr.handle].emplace(std::make_pair(node_handle, e->base.get_creat_time()));
-            //}
-
             // node map
             auto &node_map = nodes[map_idx];
             assert(node_map.find(node_handle) == node_map.end());
@@ -773,7 +765,7 @@ hyper_stub :: done_get_op(async_call_ptr_t ac_ptr, int64_t op_id, db::node **n)
                     e->nbr.loc += (ShardIdIncr - 1);
 
                     age->n->recover_edge_mtx.lock();
-                    age->n->out_edges[age->handle].emplace_back(e);
+                    age->n->add_edge_version(e);
                     if (--age->n->pending_recover_edges == 0) {
                         *n = age->n;
                     }
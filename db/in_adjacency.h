@@ -0,0 +1,211 @@
+/*
+ * ===============================================================
+ *    Description:  In-neighbors of a node. The shard of an edge's
+ *                  source sends each create and delete of the edge
+ *                  to the shard of its target as an in_edge_update,
+ *                  batched per shard, see shard::flush_in_edge_updates.
+ *                  The target keeps one entry per edge version with
+ *                  the same clocks as the edge, so node programs see
+ *                  the in-neighbors at their clock once the updates
+ *                  have arrived. Updates may arrive in any order,
+ *                  e.g. when forwarded after a migration.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_in_adjacency_h_
+#define weaver_db_in_adjacency_h_
+
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#include "common/types.h"
+#include "common/vclock.h"
+#include "common/clock_table.h"
+#include "db/remote_node.h"
+#include "db/mem_accounting.h"
+#include "db/shard_constants.h"
+
+namespace db
+{
+    // create (del_time null) or delete of the edge handle from src to node
+    struct in_edge_update
+    {
+        node_handle_t node;
+        edge_handle_t edge;
+        remote_node src;
+        vc::vclock_ptr_t creat_time;
+        vc::vclock_ptr_t del_time;
+    };
+
+    // one version of an in edge, properties stay with the out edge at src
+    class in_edge
+    {
+        public:
+            edge_handle_t handle;
+            remote_node nbr; // source of the edge
+            uint32_t creat_id, del_id; // ids in vc::interned_clocks
+
+            const edge_handle_t& get_handle() const { return handle; }
+            const remote_node& get_neighbor() const { return nbr; }
+    };
+
+    // caution: writers hold the node latch exclusively
+    class in_adjacency
+    {
+        private:
+            std::vector<in_edge> entries;
+            // edges whose delete arrived before their create, the delete added the whole version
+            // -> nop at which the delete arrived, a create later than IN_EDGE_HOLD_NOPS is a new version
+            std::unordered_map<edge_handle_t, uint64_t> early_deletes;
+
+            void charge(uint64_t old_capacity);
+
+        public:
+            in_adjacency() { }
+            in_adjacency(const in_adjacency&) = delete;
+            in_adjacency& operator=(const in_adjacency&) = delete;
+            ~in_adjacency() { clear(); }
+
+            // creates append, deletes look for the live version from the back
+            // nop is the shard's current in-neighbor nop, for expiring early deletes
+            void apply(const in_edge_update &upd, uint64_t nop);
+            // adds the version as is, for nodes unpacked after migration
+            void append(const in_edge_update &upd);
+            // drops versions for which dead(del_id), returns how many
+            template <typename Func> uint64_t compact(Func dead);
+            // after node src moved from shard old_loc to new_loc, returns how many entries changed
+            uint64_t update_src_loc(const node_handle_t &src, uint64_t old_loc, uint64_t new_loc);
+            void clear();
+            // moves the versions without touching their clocks, for nodes evicted and recovered
+            void swap(in_adjacency &other);
+
+            bool empty() const { return entries.empty() && early_deletes.empty(); }
+            uint64_t size() const { return entries.size(); }
+            const in_edge& at(uint64_t i) const { return entries[i]; }
+    };
+
+    inline void
+    in_adjacency :: charge(uint64_t old_capacity)
+    {
+        uint64_t cap = entries.capacity();
+        if (cap > old_capacity) {
+            shard_memory().add(MEM_IN_EDGES, (cap - old_capacity) * sizeof(in_edge));
+        } else if (cap < old_capacity) {
+            shard_memory().sub(MEM_IN_EDGES, (old_capacity - cap) * sizeof(in_edge));
+        }
+    }
+
+    inline void
+    in_adjacency :: apply(const in_edge_update &upd, uint64_t nop)
+    {
+        if (!upd.del_time) {
+            auto early = early_deletes.find(upd.edge);
+            if (early != early_deletes.end()) {
+                bool held = nop - early->second <= IN_EDGE_HOLD_NOPS;
+                early_deletes.erase(early);
+                if (held) {
+                    return;
+                }
+            }
+        } else {
+            for (auto iter = entries.rbegin(); iter != entries.rend(); iter++) {
+                if (iter->handle == upd.edge && iter->del_id == vc::clock_table::null_id) {
+                    iter->del_id = vc::interned_clocks.intern(upd.del_time);
+                    return;
+                }
+            }
+            // creates are held no longer than IN_EDGE_HOLD_NOPS, neither are early deletes
+            for (auto iter = early_deletes.begin(); iter != early_deletes.end();) {
+                if (nop - iter->second > IN_EDGE_HOLD_NOPS) {
+                    iter = early_deletes.erase(iter);
+                } else {
+                    iter++;
+                }
+            }
+            early_deletes[upd.edge] = nop;
+        }
+
+        append(upd);
+    }
+
+    inline void
+    in_adjacency :: append(const in_edge_update &upd)
+    {
+        uint64_t old_capacity = entries.capacity();
+        entries.emplace_back();
+        in_edge &e = entries.back();
+        e.handle = upd.edge;
+        e.nbr = upd.src;
+        e.creat_id = vc::interned_clocks.intern(upd.creat_time);
+        e.del_id = upd.del_time? vc::interned_clocks.intern(upd.del_time) : vc::clock_table::null_id;
+        charge(old_capacity);
+    }
+
+    template <typename Func>
+    inline uint64_t
+    in_adjacency :: compact(Func dead)
+    {
+        uint64_t num = entries.size();
+        for (uint64_t i = 0; i < entries.size();) {
+            if (dead(entries[i].del_id)) {
+                vc::interned_clocks.release(entries[i].creat_id);
+                vc::interned_clocks.release(entries[i].del_id);
+                entries[i] = std::move(entries.back());
+                entries.pop_back();
+            } else {
+                i++;
+            }
+        }
+
+        if (entries.size() < num) {
+            uint64_t old_capacity = entries.capacity();
+            entries.shrink_to_fit();
+            charge(old_capacity);
+        }
+        return num - entries.size();
+    }
+
+    inline uint64_t
+    in_adjacency :: update_src_loc(const node_handle_t &src, uint64_t old_loc, uint64_t new_loc)
+    {
+        uint64_t num = 0;
+        for (in_edge &e: entries) {
+            if (e.nbr.loc == old_loc && e.nbr.handle == src) {
+                e.nbr.loc = new_loc;
+                e.nbr.id = UINT64_MAX;
+                num++;
+            }
+        }
+        return num;
+    }
+
+    inline void
+    in_adjacency :: clear()
+    {
+        for (in_edge &e: entries) {
+            vc::interned_clocks.release(e.creat_id);
+            vc::interned_clocks.release(e.del_id);
+        }
+        uint64_t old_capacity = entries.capacity();
+        entries.clear();
+        entries.shrink_to_fit();
+        charge(old_capacity);
+        early_deletes.clear();
+    }
+
+    inline void
+    in_adjacency :: swap(in_adjacency &other)
+    {
+        entries.swap(other.entries);
+        early_deletes.swap(other.early_deletes);
+    }
+}
+
+#endif
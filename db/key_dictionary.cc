@@ -0,0 +1,119 @@
+/*
+ * ===============================================================
+ *    Description:  Implementation of property key dictionary.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <assert.h>
+#include "db/key_dictionary.h"
+
+using db::key_dictionary;
+
+db::key_dictionary db::property_keys;
+
+key_dictionary :: id_table :: id_table(uint64_t sz)
+    : mask(sz-1)
+    , slots(new std::atomic<uint32_t>[sz])
+{
+    assert((sz & mask) == 0);
+    for (uint64_t i = 0; i < sz; i++) {
+        slots[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+key_dictionary :: key_dictionary()
+    : num_keys(0)
+{
+    tables.emplace_back(new id_table(InitTableSz));
+    table.store(tables.back().get(), std::memory_order_release);
+}
+
+// linear probing, stops at the first empty slot
+uint32_t
+key_dictionary :: find(const id_table &t, const std::string &k, uint64_t h) const
+{
+    for (uint64_t i = h & t.mask; ; i = (i+1) & t.mask) {
+        uint32_t s = t.slots[i].load(std::memory_order_acquire);
+        if (s == 0) {
+            return invalid_id;
+        }
+        if (key(s-1) == k) {
+            return s-1;
+        }
+    }
+}
+
+// caller holds write_lock
+void
+key_dictionary :: insert(id_table &t, uint32_t id, uint64_t h)
+{
+    uint64_t i = h & t.mask;
+    while (t.slots[i].load(std::memory_order_relaxed) != 0) {
+        i = (i+1) & t.mask;
+    }
+    t.slots[i].store(id+1, std::memory_order_release);
+}
+
+// caller holds write_lock
+// readers still probing the old table see every key added before the copy
+void
+key_dictionary :: grow()
+{
+    id_table *old = table.load(std::memory_order_relaxed);
+    id_table *fresh = new id_table(2*(old->mask+1));
+    uint32_t n = num_keys.load(std::memory_order_relaxed);
+    for (uint32_t id = 0; id < n; id++) {
+        insert(*fresh, id, hasher(key(id)));
+    }
+    tables.emplace_back(fresh);
+    table.store(fresh, std::memory_order_release);
+}
+
+// id for key, adds key to the dictionary if not already present
+uint32_t
+key_dictionary :: intern(const std::string &k)
+{
+    uint64_t h = hasher(k);
+    uint32_t id = find(*table.load(std::memory_order_acquire), k, h);
+    if (id != invalid_id) {
+        return id;
+    }
+
+    write_lock.lock();
+    id = find(*table.load(std::memory_order_relaxed), k, h);
+    if (id == invalid_id) {
+        id = num_keys.load(std::memory_order_relaxed);
+        if ((id >> ChunkBits) >= MaxChunks) {
+            // dictionary full
+            write_lock.unlock();
+            return invalid_id;
+        }
+        if (!chunks[id >> ChunkBits]) {
+            chunks[id >> ChunkBits].reset(new std::string[ChunkSz]);
+        }
+        chunks[id >> ChunkBits][id & (ChunkSz-1)] = k;
+        num_keys.store(id+1, std::memory_order_release);
+
+        // keep the table at most half full
+        if (2*(uint64_t)(id+1) > table.load(std::memory_order_relaxed)->mask+1) {
+            grow();
+        } else {
+            insert(*table.load(std::memory_order_relaxed), id, h);
+        }
+    }
+    write_lock.unlock();
+
+    return id;
+}
+
+// id for key, invalid_id if no element has ever had this key
+uint32_t
+key_dictionary :: lookup(const std::string &k) const
+{
+    return find(*table.load(std::memory_order_acquire), k, hasher(k));
+}
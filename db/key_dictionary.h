@@ -0,0 +1,84 @@
+/*
+ * ===============================================================
+ *    Description:  Dictionary encoding of property keys.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_key_dictionary_h_
+#define weaver_db_key_dictionary_h_
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <memory>
+#include <vector>
+#include <po6/threads/mutex.h>
+
+#include "common/utils.h"
+
+namespace db
+{
+    // property key string <-> 32-bit id, one dictionary per process (i.e. per shard)
+    // ids are never reused, so key() does not lock
+    //
+    // lookup() does not lock either: ids are kept in an open addressing table
+    // of atomic slots, writers fill a slot only after the key string is in
+    // place, and a full table is replaced by a larger copy that readers pick
+    // up through an atomic pointer. replaced tables are freed with the dictionary
+    class key_dictionary
+    {
+        public:
+            static const uint32_t invalid_id = UINT32_MAX;
+
+        private:
+            static const uint32_t ChunkBits = 12;
+            static const uint32_t ChunkSz = (1 << ChunkBits);
+            static const uint32_t MaxChunks = (1 << 10);
+            static const uint32_t InitTableSz = 1024;
+
+            // slots hold id+1, 0 is empty
+            struct id_table
+            {
+                uint64_t mask;
+                std::unique_ptr<std::atomic<uint32_t>[]> slots;
+
+                id_table(uint64_t sz);
+            };
+
+            po6::threads::mutex write_lock;
+            // fixed array, so that key() need not lock while new chunks are added
+            std::unique_ptr<std::string[]> chunks[MaxChunks];
+            std::atomic<uint32_t> num_keys;
+            std::atomic<id_table*> table;
+            std::vector<std::unique_ptr<id_table>> tables; // under write_lock
+            weaver_util::murmur_hasher<std::string> hasher;
+
+            uint32_t find(const id_table &t, const std::string &key, uint64_t h) const;
+            void insert(id_table &t, uint32_t id, uint64_t h);
+            void grow();
+
+        public:
+            key_dictionary();
+
+            // invalid_id once MaxChunks*ChunkSz keys are in use
+            uint32_t intern(const std::string &key);
+            uint32_t lookup(const std::string &key) const;
+            const std::string& key(uint32_t id) const;
+            uint32_t size() const { return num_keys.load(std::memory_order_acquire); }
+    };
+
+    inline const std::string&
+    key_dictionary :: key(uint32_t id) const
+    {
+        return chunks[id >> ChunkBits][id & (ChunkSz-1)];
+    }
+
+    extern key_dictionary property_keys;
+}
+
+#endif
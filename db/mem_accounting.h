@@ -0,0 +1,174 @@
+/*
+ * ===============================================================
+ *    Description:  Per subsystem byte counts for a shard, cheap
+ *                  enough to consult on every node creation. The
+ *                  counts are maintained where memory is acquired
+ *                  and released and are estimates of live bytes,
+ *                  not allocator footprint.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_mem_accounting_h_
+#define weaver_db_mem_accounting_h_
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include <fstream>
+#include <string>
+
+namespace db
+{
+    enum mem_type
+    {
+        MEM_NODES = 0,
+        MEM_EDGES,
+        MEM_PROPERTIES,
+        MEM_CLOCKS,
+        MEM_PROG_STATE,
+        MEM_QUEUED_REQUESTS,
+        MEM_MSG_BUFFERS,
+        MEM_IN_EDGES,
+        NUM_MEM_TYPES
+    };
+
+    inline const char*
+    to_string(mem_type t)
+    {
+        switch (t) {
+            case MEM_NODES:
+                return "nodes";
+            case MEM_EDGES:
+                return "edges";
+            case MEM_PROPERTIES:
+                return "properties";
+            case MEM_CLOCKS:
+                return "clocks";
+            case MEM_PROG_STATE:
+                return "prog_state";
+            case MEM_QUEUED_REQUESTS:
+                return "queued_requests";
+            case MEM_MSG_BUFFERS:
+                return "msg_buffers";
+            case MEM_IN_EDGES:
+                return "in_edges";
+            default:
+                return "unknown";
+        }
+    }
+
+    class mem_accounting
+    {
+        public:
+            // charged per node program state entry, state objects are opaque to the shard
+            static const uint64_t ProgStateEntryBytes = 96;
+            // charged per dense state page for its page directory entry
+            static const uint64_t DensePageEntryBytes = 48;
+
+        private:
+            std::atomic<int64_t> counts[NUM_MEM_TYPES];
+            std::atomic<uint64_t> budget;
+
+        public:
+            mem_accounting();
+            mem_accounting(const mem_accounting&) = delete;
+            mem_accounting& operator=(const mem_accounting&) = delete;
+
+            void add(mem_type t, uint64_t bytes) { counts[t].fetch_add(bytes, std::memory_order_relaxed); }
+            void sub(mem_type t, uint64_t bytes) { counts[t].fetch_sub(bytes, std::memory_order_relaxed); }
+            // for subsystems which are sampled rather than tracked incrementally
+            void set(mem_type t, uint64_t bytes) { counts[t].store(bytes, std::memory_order_relaxed); }
+            uint64_t get(mem_type t) const;
+            uint64_t total() const;
+            void snapshot(std::vector<uint64_t> &bytes) const;
+
+            // budget of 0 means unlimited
+            void set_budget(uint64_t b) { budget.store(b, std::memory_order_relaxed); }
+            uint64_t get_budget() const { return budget.load(std::memory_order_relaxed); }
+            bool available() const;
+
+            // MemTotal from /proc/meminfo in bytes, 0 if unreadable
+            static uint64_t physical_memory();
+    };
+
+    inline
+    mem_accounting :: mem_accounting()
+        : budget(0)
+    {
+        for (uint64_t i = 0; i < NUM_MEM_TYPES; i++) {
+            counts[i].store(0);
+        }
+    }
+
+    // concurrent add/sub may transiently drive a count below zero
+    inline uint64_t
+    mem_accounting :: get(mem_type t) const
+    {
+        int64_t c = counts[t].load(std::memory_order_relaxed);
+        return c < 0? 0 : c;
+    }
+
+    inline uint64_t
+    mem_accounting :: total() const
+    {
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < NUM_MEM_TYPES; i++) {
+            sum += get((mem_type)i);
+        }
+        return sum;
+    }
+
+    inline void
+    mem_accounting :: snapshot(std::vector<uint64_t> &bytes) const
+    {
+        bytes.resize(NUM_MEM_TYPES);
+        for (uint64_t i = 0; i < NUM_MEM_TYPES; i++) {
+            bytes[i] = get((mem_type)i);
+        }
+    }
+
+    inline bool
+    mem_accounting :: available() const
+    {
+        uint64_t b = get_budget();
+        return b == 0 || total() < b;
+    }
+
+    inline uint64_t
+    mem_accounting :: physical_memory()
+    {
+        std::ifstream meminfo_file;
+        meminfo_file.open("/proc/meminfo", std::ifstream::in);
+        if (!meminfo_file) {
+            return 0;
+        }
+
+        std::string token;
+        uint64_t totalram = 0;
+        while (meminfo_file >> token) {
+            if (token == "MemTotal:") {
+                meminfo_file >> totalram;
+                break;
+            }
+        }
+        meminfo_file.close();
+
+        // reported in kB
+        return totalram * 1024;
+    }
+
+    // one set of counts per process, i.e. per shard
+    inline mem_accounting&
+    shard_memory()
+    {
+        static mem_accounting m;
+        return m;
+    }
+}
+
+#endif
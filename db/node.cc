@@ -18,6 +18,7 @@
 #include "common/config_constants.h"
 #include "common/event_order.h"
 #include "db/node.h"
+#include "db/mem_accounting.h"
 
 using db::remote_node;
 using db::edge;
@@ -38,10 +39,15 @@ node :: node(const node_handle_t &_handle, uint64_t shrd, vclock_ptr_t &vclk, po
     , migr_cv(mtx)
     , in_use(true)
     , waiters(0)
+    , excl_waiters(0)
     , permanently_deleted(false)
     , evicted(false)
     , to_evict(false)
     , last_perm_deletion(nullptr)
+    , prog_visits(0)
+    , visit_window(0)
+    , replicated(false)
+    , replica_stale(false)
     , max_edge_id(0)
 {
     std::string empty("");
@@ -53,23 +59,131 @@ node :: ~node()
 {
     state = mode::DELETED; // track memory bugs
     assert(out_edges.empty());
+    assert(out_adjacency.empty());
 }
 
-// true if prog states is empty
+void*
+node :: operator new(size_t sz)
+{
+    return operator new(sz, default_slab());
+}
+
+void*
+node :: operator new(size_t sz, db::slab<node> &s)
+{
+    assert(sz == sizeof(node));
+    UNUSED(sz);
+    void *p = s.allocate();
+    db::shard_memory().add(db::MEM_NODES, sizeof(node));
+    return p;
+}
+
+void
+node :: operator delete(void *p)
+{
+    if (p != nullptr) {
+        db::shard_memory().sub(db::MEM_NODES, sizeof(node));
+    }
+    db::slab<node>::release(p);
+}
+
+void
+node :: operator delete(void *p, db::slab<node> &s)
+{
+    db::shard_memory().sub(db::MEM_NODES, sizeof(node));
+    s.free(p);
+}
+
+db::slab<node>&
+node :: default_slab()
+{
+    static db::slab<node> s;
+    return s;
+}
+
+// true if no queued txs, perm deletion clock or in edges
 bool
 node :: empty_evicted_node_state()
 {
-    if (!node_prog_states.empty() || !tx_queue.empty() || last_perm_deletion) {
+    if (!tx_queue.empty() || last_perm_deletion || !in_edges.empty()) {
         return false;
     }
 
     return true;
 }
 
+void
+node :: latch_exclusive()
+{
+    waiters++;
+    excl_waiters++;
+    while (is_latched()) {
+        cv.wait();
+    }
+    excl_waiters--;
+    waiters--;
+    in_use = true;
+}
+
+static bool
+reader_present(const std::vector<uint64_t> &reader_reqs, uint64_t req_id)
+{
+    for (uint64_t r: reader_reqs) {
+        if (r == req_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+node :: latch_shared(uint64_t req_id)
+{
+    waiters++;
+    while (in_use || excl_waiters > 0 || reader_present(reader_reqs, req_id)) {
+        cv.wait();
+    }
+    waiters--;
+    reader_reqs.emplace_back(req_id);
+}
+
+// waiters may be a mix of readers and writers, wake all of them
+void
+node :: unlatch()
+{
+    assert(in_use);
+    in_use = false;
+    if (waiters > 0) {
+        cv.broadcast();
+    }
+}
+
+void
+node :: unlatch_shared(uint64_t req_id)
+{
+    assert(!in_use);
+    auto iter = reader_reqs.begin();
+    for (; iter != reader_reqs.end(); iter++) {
+        if (*iter == req_id) {
+            break;
+        }
+    }
+    assert(iter != reader_reqs.end());
+    *iter = reader_reqs.back();
+    reader_reqs.pop_back();
+
+    if (waiters > 0) {
+        cv.broadcast();
+    }
+}
+
 void
 node :: add_edge_unique(edge *e)
 {
     out_edges[e->get_handle()] = std::vector<edge*>(1,e);
+    out_adjacency.append(e);
+    // bulk loading sets properties without the node, built again on the next write
+    out_adjacency.drop_prop_index();
 }
 
 void
@@ -78,11 +192,71 @@ node :: add_edge(edge *e)
     auto iter = out_edges.find(e->get_handle());
     if (iter == out_edges.end()) {
         out_edges[e->get_handle()] = std::vector<edge*>(1, e);
+        out_adjacency.append(e);
     } else {
         if (iter->second.back()->base.get_del_time()) {
             // if not deleted, then this node was swapped in from HyperDex
             // in that case we don't need to perform the write
             iter->second.emplace_back(e);
+            out_adjacency.append(e);
+        }
+    }
+}
+
+void
+node :: add_edge_version(edge *e)
+{
+    out_edges[e->get_handle()].emplace_back(e);
+    out_adjacency.append(e);
+}
+
+void
+node :: delete_edge(edge *e, vclock_ptr_t &tdel)
+{
+    e->base.update_del_time(tdel);
+    out_adjacency.refresh(e);
+}
+
+// remove edge from both indices, caller frees e
+void
+node :: remove_edge(edge *e)
+{
+    auto map_iter = out_edges.find(e->get_handle());
+    assert(map_iter != out_edges.end());
+
+    std::vector<edge*> &versions = map_iter->second;
+    for (auto iter = versions.begin(); iter != versions.end(); iter++) {
+        if (*iter == e) {
+            versions.erase(iter);
+            break;
+        }
+    }
+    if (versions.empty()) {
+        out_edges.erase(map_iter);
+    }
+
+    out_adjacency.remove(e);
+}
+
+void
+node :: free_edges()
+{
+    for (uint64_t i = 0; i < out_adjacency.size(); i++) {
+        delete out_adjacency.at(i);
+    }
+    out_adjacency.clear();
+    out_edges.clear();
+}
+
+// after out_edges is restored wholesale (unpack)
+void
+node :: rebuild_adjacency()
+{
+    out_adjacency.clear();
+    for (auto &x: out_edges) {
+        for (edge *e: x.second) {
+            e->adj_slot = UINT32_MAX;
+            out_adjacency.append(e);
         }
     }
 }
@@ -95,7 +269,7 @@ node :: edge_exists(const edge_handle_t &handle)
     auto find_iter = out_edges.find(handle);
     if (find_iter != out_edges.end()) {
         for (edge *e: find_iter->second) {
-            if (base.time_oracle->clock_creat_before_del_after(*base.view_time, e->base.get_creat_time(), e->base.get_del_time())) {
+            if (base.time_oracle->clock_creat_before_del_after(*base.view_time, e->base.get_creat_id(), e->base.get_del_id())) {
                 return true;
             }
         }
@@ -113,7 +287,7 @@ node :: get_edge(const edge_handle_t &handle)
     auto find_iter = out_edges.find(handle);
     if (find_iter != out_edges.end()) {
         for (edge *e: find_iter->second) {
-            if (base.time_oracle->clock_creat_before_del_after(*base.view_time, e->base.get_creat_time(), e->base.get_del_time())) {
+            if (base.time_oracle->clock_creat_before_del_after(*base.view_time, e->base.get_creat_id(), e->base.get_del_id())) {
                 e->base.view_time = base.view_time;
                 e->base.time_oracle = base.time_oracle;
                 return *e;
@@ -129,9 +303,17 @@ node :: get_edges()
 {
     assert(base.view_time != nullptr);
     assert(base.time_oracle != nullptr);
-    return node_prog::edge_list(out_edges, base.view_time, base.time_oracle);
+    return node_prog::edge_list(out_adjacency, base.view_time, base.time_oracle);
 };
 
+node_prog::in_edge_list
+node :: get_in_edges()
+{
+    assert(base.view_time != nullptr);
+    assert(base.time_oracle != nullptr);
+    return node_prog::in_edge_list(in_edges, base.view_time, base.time_oracle);
+}
+
 node_prog::prop_list
 node :: get_properties()
 {
@@ -197,6 +379,9 @@ node :: add_cache_value(vclock_ptr_t vc,
     cache_key_t key)
 {
     if (MaxCacheEntries) {
+        // replaces an older value for key
+        cache.erase(key);
+
         // clear oldest entry if cache is full
         if (cache.size() >= MaxCacheEntries) {
             std::vector<vc::vclock_t*> oldest(1, &vc->clock);
@@ -219,6 +404,17 @@ node :: add_cache_value(vclock_ptr_t vc,
     }
 }
 
+bool
+node :: written_since(const vc::vclock &clk) const
+{
+    if (last_upd_clk != nullptr && !order::oracle::happens_before_no_kronos(last_upd_clk->clock, clk.clock)) {
+        return true;
+    }
+
+    const vclock_ptr_t &creat_clk = base.get_creat_time();
+    return creat_clk != nullptr && !order::oracle::happens_before_no_kronos(creat_clk->clock, clk.clock);
+}
+
 void
 node :: get_client_node(cl::node &n, bool get_p, bool get_e, bool get_a)
 {
@@ -229,8 +425,8 @@ node :: get_client_node(cl::node &n, bool get_p, bool get_e, bool get_a)
 
     if (get_p) {
         node_prog::prop_list plist = get_properties();
-        for (std::vector<std::shared_ptr<node_prog::property>> pvec: plist) {
-            n.properties.insert(n.properties.end(), pvec.begin(), pvec.end());
+        for (node_prog::prop_view p: plist) {
+            n.properties.emplace_back(std::make_shared<node_prog::property>(p.get_key(), p.get_value()));
         }
     }
 
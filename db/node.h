@@ -31,6 +31,9 @@
 #include "db/cache_entry.h"
 #include "db/element.h"
 #include "db/edge.h"
+#include "db/adjacency.h"
+#include "db/in_adjacency.h"
+#include "db/slab.h"
 #include "client/datastructures.h"
 
 namespace message
@@ -78,12 +81,16 @@ namespace db
             element base;
             uint64_t shard;
             enum mode state;
-            data_map<std::vector<edge*>> out_edges;
+            data_map<std::vector<edge*>> out_edges; // handle -> edge versions, for lookups
+            adjacency out_adjacency; // all edge versions, for traversals
+            in_adjacency in_edges; // versions of edges to this node, see db/in_adjacency.h
             po6::threads::cond cv; // for locking node
             po6::threads::cond migr_cv; // make reads/writes wait while node is being migrated
             std::deque<std::pair<uint64_t, uint64_t>> tx_queue; // queued txs, identified by <vt_id, queue timestamp> tuple
-            bool in_use;
+            bool in_use; // latched exclusively
+            std::vector<uint64_t> reader_reqs; // node programs holding the shared latch
             uint32_t waiters; // count of number of waiters
+            uint32_t excl_waiters; // waiters for exclusive latch, new readers yield to these
             bool permanently_deleted, evicted, to_evict;
             std::unique_ptr<vc::vclock> last_perm_deletion; // vclock of last edge/property permanently deleted at this node
             string_set aliases;
@@ -91,16 +98,17 @@ namespace db
             // for migration
             std::unique_ptr<migr_data> migration;
 
-            // node program cache
+            // node program cache, access under prog_state_mtx
             std::unordered_map<cache_key_t, cache_entry> cache;
             void add_cache_value(vclock_ptr_t vc,
                 std::shared_ptr<node_prog::Cache_Value_Base> cache_value,
                 std::shared_ptr<std::vector<remote_node>> watch_set,
                 cache_key_t key);
+            // created or written after clk, or concurrently, caller holds the node map mutex
+            bool written_since(const vc::vclock &clk) const;
 
-            // node program state
-            typedef std::unordered_map<uint64_t, std::shared_ptr<node_prog::Node_State_Base>> prog_state_t;
-            prog_state_t node_prog_states;
+            // node program state is kept per request by the shard, see db/prog_state_arena.h
+            po6::threads::mutex prog_state_mtx;
 
             // node eviction
             bool empty_evicted_node_state();
@@ -108,19 +116,41 @@ namespace db
             po6::threads::mutex recover_edge_mtx;
 
             // fault tolerance
-            std::unique_ptr<vc::vclock> last_upd_clk;
+            vclock_ptr_t last_upd_clk; // set under the node map mutex, see shard::release_node_write
             std::unique_ptr<vc::vclock_t> restore_clk;
 
+            // read replicas at other shards, see shard::maintain_replicas
+            // prog_visits is counted under prog_state_mtx, for the second visit_window
+            uint32_t prog_visits;
+            uint64_t visit_window;
+            bool replicated, replica_stale;
+
             // separate edge space
             std::set<int64_t> edge_ids;
             uint64_t max_edge_id;
 
         public:
+            // node latch, caller holds the node map mutex that cv waits on
+            // exclusive for writes, shared for node programs which only read graph data
+            // readers of the same request still serialize because programs
+            // update their per-node state without locking
+            void latch_exclusive();
+            void latch_shared(uint64_t req_id);
+            void unlatch();
+            void unlatch_shared(uint64_t req_id);
+            bool is_latched() const { return in_use || !reader_reqs.empty(); }
+
             void add_edge_unique(edge *e); // bulk loading
             void add_edge(edge *e);
+            void add_edge_version(edge *e); // recovery
+            void delete_edge(edge *e, vclock_ptr_t &tdel);
+            void remove_edge(edge *e);
+            void free_edges();
+            void rebuild_adjacency();
             bool edge_exists(const edge_handle_t&);
             edge& get_edge(const edge_handle_t&);
             node_prog::edge_list get_edges();
+            node_prog::in_edge_list get_in_edges();
             node_prog::prop_list get_properties();
             std::string get_property(const std::string &key);
             bool has_property(std::pair<std::string, std::string> &p);
@@ -132,6 +162,13 @@ namespace db
             bool del_alias(const node_handle_t &alias);
             bool is_alias(const node_handle_t &alias) const;
             void get_client_node(cl::node &n, bool, bool, bool);
+
+            // shards allocate nodes from per node map slabs, all other allocations use default_slab
+            static void* operator new(size_t sz);
+            static void* operator new(size_t sz, slab<node> &s);
+            static void operator delete(void *p);
+            static void operator delete(void *p, slab<node> &s);
+            static slab<node>& default_slab();
     };
 
     using node_version_t = std::pair<node_handle_t, vclock_ptr_t>;
@@ -148,7 +185,8 @@ namespace db
     {
         std::deque<std::pair<uint64_t, uint64_t>> tx_queue;
         vc::vclock last_perm_deletion;
-        node::prog_state_t prog_states;
+        // in edges are not in HyperDex, they stay in memory while the node is evicted
+        std::shared_ptr<in_adjacency> in_edges;
     };
 }
 
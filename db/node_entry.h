@@ -21,14 +21,16 @@ namespace db
     struct node_entry
     {
         bool present, used;
+        uint64_t id; // in node_id_table of this node map
         std::vector<node*> nodes;
         std::shared_ptr<node_entry> prev, next;
 
-        node_entry() : present(false), used(true) { }
+        node_entry() : present(false), used(true), id(UINT64_MAX) { }
 
         node_entry(node *n)
             : present(true)
             , used(true)
+            , id(UINT64_MAX)
             , nodes(1, n)
         { }
     };
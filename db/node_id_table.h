@@ -0,0 +1,109 @@
+/*
+ * ===============================================================
+ *    Description:  Dense shard-internal ids for node map entries.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_node_id_table_h_
+#define weaver_db_node_id_table_h_
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+#include <assert.h>
+
+#include "db/shard_constants.h"
+#include "db/node_entry.h"
+
+namespace db
+{
+    // id -> entry for the nodes of one node map, guarded by that map's mutex
+    // handle -> id is node_entry::id, found through the node map itself
+    // id = generation << GenShift | (slot * NUM_NODE_MAPS + map_idx)
+    // so the node map of an id is known without hashing the handle
+    // slots are recycled with a new generation, so an id cached in an edge or
+    // a prog queue is only a hint: stale ids fail get() and callers fall back to the handle
+    class node_id_table
+    {
+        public:
+            static const uint64_t invalid_id = UINT64_MAX;
+            // marks a node prog hop to a read replica of a node owned by another shard
+            static const uint64_t replica_id = UINT64_MAX - 1;
+
+        private:
+            static const uint64_t GenShift = 40;
+            static const uint64_t SlotMask = (1ULL << GenShift) - 1;
+
+            struct slot
+            {
+                std::shared_ptr<node_entry> entry;
+                uint32_t gen;
+
+                slot() : gen(0) { }
+            };
+
+            std::vector<slot> slots;
+            std::vector<uint64_t> free_slots;
+
+        public:
+            static uint64_t map_idx(uint64_t id) { return (id & SlotMask) % NUM_NODE_MAPS; }
+            // dense over all node maps of the shard, for per request arrays indexed by node
+            static uint64_t dense_index(uint64_t id) { return id & SlotMask; }
+
+            uint64_t assign(uint64_t map_idx, std::shared_ptr<node_entry> entry);
+            void release(uint64_t id);
+            node_entry* get(uint64_t id) const;
+            uint64_t size() const { return slots.size() - free_slots.size(); }
+            // for scans over the map in slot order, entry is null for free slots
+            uint64_t num_slots() const { return slots.size(); }
+            const std::shared_ptr<node_entry>& slot_entry(uint64_t s) const { return slots[s].entry; }
+    };
+
+    inline uint64_t
+    node_id_table :: assign(uint64_t midx, std::shared_ptr<node_entry> entry)
+    {
+        uint64_t s;
+        if (free_slots.empty()) {
+            s = slots.size();
+            slots.emplace_back(slot());
+        } else {
+            s = free_slots.back();
+            free_slots.pop_back();
+        }
+        slots[s].entry = entry;
+
+        uint64_t id = ((uint64_t)(slots[s].gen & 0xFFFFFF) << GenShift) | (s * NUM_NODE_MAPS + midx);
+        assert(id != invalid_id);
+        entry->id = id;
+        return id;
+    }
+
+    inline void
+    node_id_table :: release(uint64_t id)
+    {
+        uint64_t s = (id & SlotMask) / NUM_NODE_MAPS;
+        assert(s < slots.size());
+        slots[s].entry.reset();
+        slots[s].gen++;
+        free_slots.emplace_back(s);
+    }
+
+    inline node_entry*
+    node_id_table :: get(uint64_t id) const
+    {
+        uint64_t s = (id & SlotMask) / NUM_NODE_MAPS;
+        if (s >= slots.size()
+         || !slots[s].entry
+         || (slots[s].gen & 0xFFFFFF) != (id >> GenShift)) {
+            return nullptr;
+        }
+        return slots[s].entry.get();
+    }
+}
+
+#endif
@@ -17,10 +17,14 @@
 
 #include <vector>
 #include <deque>
+#include <atomic>
 #include <unordered_map>
 
 #include "common/vclock.h"
 #include "node_prog/base_classes.h"
+#include "db/cache_entry.h"
+#include "db/prog_state_arena.h"
+#include "db/prog_aggregate.h"
 
 namespace db
 {
@@ -34,10 +38,18 @@ namespace db
         std::shared_ptr<vc::vclock> req_vclock;
         uint64_t req_id;
         uint64_t vt_prog_ptr;
-        std::deque<std::pair<node_handle_t, np_param_ptr_t>> start_node_params;
-        //std::unique_ptr<cache_response<CacheValueType>> cache_value;
-        std::unordered_map<uint64_t, std::deque<std::pair<node_handle_t, np_param_ptr_t>>> batched_node_progs;
-        std::vector<std::pair<node_handle_t, vclock_ptr_t>> nodes_that_created_state;
+        node_prog::np_const_ptr_t constants; // per request constants of this request, shared by all params
+        std::deque<std::pair<node_handle_t, node_prog::np_param_ptr_t>> start_node_params;
+        std::deque<uint64_t> start_node_ids; // internal id hints for start_node_params, same order
+        std::unordered_map<node_handle_t, uint64_t> replica_hops; // hops served from a local read replica -> owner shard
+        // outcome of validating a cache entry against other shards, by node it is cached at
+        std::unordered_map<node_handle_t, std::pair<cache_entry, bool>> cache_verdicts;
+        std::unordered_map<uint64_t, std::deque<std::pair<node_handle_t, node_prog::np_param_ptr_t>>> batched_node_progs;
+        std::shared_ptr<request_states> states; // set on first state access at this shard
+        // shared by the pieces of this request split across worker threads or waiting on cache validation,
+        // set when one of them returns to the VT
+        std::shared_ptr<std::atomic<bool>> frontier_done;
+        std::shared_ptr<prog_aggregate> agg; // aggregating programs only, shared by all pieces on this shard
    };
 }
 
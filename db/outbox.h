@@ -0,0 +1,366 @@
+/*
+ * ===============================================================
+ *    Description:  Per destination shard outbox which coalesces
+ *                  node program messages of many requests into one
+ *                  framed message. A batch is sent when it reaches
+ *                  the destination's current frame limit or when
+ *                  its oldest frame has waited for the flush
+ *                  interval. The limit grows while batches fill up
+ *                  before the timer and shrinks to what arrived in
+ *                  one interval otherwise, so that at low load
+ *                  frames are sent right away.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_outbox_h_
+#define weaver_db_outbox_h_
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <e/buffer.h>
+#include <po6/threads/mutex.h>
+#include <po6/threads/cond.h>
+
+#include "common/clock.h"
+
+namespace db
+{
+    // a batch is one buffer: header_sz bytes left for the caller's message header,
+    // the number of frames, then the frames each preceded by its length
+    // frames are packed in place by the caller, so a coalesced message is not copied
+    class outbox
+    {
+        public:
+            typedef std::unique_ptr<e::buffer> batch_t;
+
+        private:
+            struct dest_box
+            {
+                po6::threads::mutex mtx;
+                batch_t buf;
+                uint64_t count; // frames in buf
+                std::vector<std::pair<uint64_t, uint64_t>> frames; // request id and offset in buf of each frame
+                uint64_t oldest; // enqueue time of the first frame in buf
+                uint64_t limit;
+                uint64_t window_start, window_sends; // direct sends in the current interval
+
+                dest_box() : count(0), oldest(0), limit(1), window_start(0), window_sends(0) { }
+            };
+
+            const uint64_t header_sz, flush_ns, max_frames, max_bytes;
+            po6::threads::mutex map_mtx;
+            std::unordered_map<uint64_t, std::unique_ptr<dest_box>> boxes;
+            std::atomic<uint64_t> num_frames, num_batches, num_dropped;
+
+            // flush thread sleeps on wait_cond while every box is empty
+            // lock order is box.mtx, then wait_mtx
+            po6::threads::mutex wait_mtx;
+            po6::threads::cond wait_cond;
+            uint64_t nonempty;
+            bool stopped;
+
+            dest_box& get_box(uint64_t dest);
+            void start(dest_box &box, uint64_t frame_bytes, uint64_t now);
+            void take(dest_box &box, batch_t &batch);
+            uint64_t expired(uint64_t now, std::vector<std::pair<uint64_t, batch_t>> &batches);
+
+        public:
+            outbox(uint64_t header_sz, uint64_t flush_us, uint64_t max_frames, uint64_t max_bytes);
+            outbox(const outbox&) = delete;
+            outbox& operator=(const outbox&) = delete;
+
+            // false if the frame is not coalesced at the current load, caller should
+            // send the message directly, after batch if that is set
+            // otherwise pack_frame(e::packer&) packs the frame_sz byte frame into
+            // dest's batch, and batch is set if a batch is to be sent now
+            template <typename Func> bool add(uint64_t dest, uint64_t req_id, uint64_t frame_sz, Func pack_frame, uint64_t now, batch_t &batch);
+            // removes waiting frames of a cancelled request, returns how many
+            uint64_t drop(uint64_t req_id);
+            // blocks until some batch has waited for the flush interval and takes all such batches
+            // false once stop() has been called
+            bool wait_expired(std::vector<std::pair<uint64_t, batch_t>> &batches);
+            void stop();
+
+            // calls f(const uint8_t *frame, uint64_t frame_sz) for each frame of a received batch
+            template <typename Func> static void for_each_frame(const e::buffer &batch, uint64_t header_sz, Func f);
+
+            // stats
+            uint64_t frames() const { return num_frames.load(std::memory_order_relaxed); }
+            uint64_t batches() const { return num_batches.load(std::memory_order_relaxed); }
+            uint64_t dropped() const { return num_dropped.load(std::memory_order_relaxed); }
+    };
+
+    inline
+    outbox :: outbox(uint64_t header, uint64_t flush_us, uint64_t max_f, uint64_t max_b)
+        : header_sz(header)
+        , flush_ns(flush_us * 1000)
+        , max_frames(max_f)
+        , max_bytes(max_b)
+        , num_frames(0)
+        , num_batches(0)
+        , num_dropped(0)
+        , wait_cond(&wait_mtx)
+        , nonempty(0)
+        , stopped(false)
+    { }
+
+    inline outbox::dest_box&
+    outbox :: get_box(uint64_t dest)
+    {
+        map_mtx.lock();
+        std::unique_ptr<dest_box> &box = boxes[dest];
+        if (!box) {
+            box.reset(new dest_box());
+        }
+        dest_box &ret = *box;
+        map_mtx.unlock();
+        return ret;
+    }
+
+    // caution: assume holding box.mtx
+    // room for limit frames the size of the first one
+    inline void
+    outbox :: start(dest_box &box, uint64_t frame_bytes, uint64_t now)
+    {
+        uint64_t cap = std::max(frame_bytes, std::min(box.limit * frame_bytes, max_bytes));
+        box.buf.reset(e::buffer::create(header_sz + sizeof(uint32_t) + cap));
+        box.buf->resize(header_sz + sizeof(uint32_t));
+        box.count = 0;
+        box.frames.clear();
+        box.oldest = now;
+
+        wait_mtx.lock();
+        if (nonempty++ == 0) {
+            wait_cond.signal();
+        }
+        wait_mtx.unlock();
+    }
+
+    // caution: assume holding box.mtx
+    inline void
+    outbox :: take(dest_box &box, batch_t &batch)
+    {
+        box.buf->pack_at(header_sz) << (uint32_t)box.count;
+        num_frames += box.count;
+        num_batches++;
+        batch = std::move(box.buf);
+        box.count = 0;
+        box.frames.clear();
+
+        wait_mtx.lock();
+        nonempty--;
+        wait_mtx.unlock();
+    }
+
+    template <typename Func>
+    inline bool
+    outbox :: add(uint64_t dest, uint64_t req_id, uint64_t frame_sz, Func pack_frame, uint64_t now, batch_t &batch)
+    {
+        dest_box &box = get_box(dest);
+        uint64_t frame_bytes = sizeof(uint32_t) + frame_sz;
+
+        box.mtx.lock();
+        if (box.limit <= 1 && box.count == 0) {
+            if (now - box.window_start >= flush_ns) {
+                box.window_start = now;
+                box.window_sends = 0;
+            }
+            if (++box.window_sends < 2) {
+                box.mtx.unlock();
+                num_frames++;
+                num_batches++;
+                return false;
+            }
+            // second message within an interval, start coalescing
+            box.limit = 2;
+        }
+
+        if (frame_bytes > max_bytes) {
+            // goes alone, after what is waiting
+            if (box.count > 0) {
+                take(box, batch);
+            }
+            box.mtx.unlock();
+            num_frames++;
+            num_batches++;
+            return false;
+        }
+
+        if (box.count > 0 && box.buf->size() + frame_bytes > box.buf->capacity()) {
+            // frames larger than the first, send what fits
+            take(box, batch);
+        }
+        if (box.count == 0) {
+            start(box, frame_bytes, now);
+        }
+
+        box.frames.emplace_back(req_id, box.buf->size());
+        e::packer packer = box.buf->pack_at(box.buf->size());
+        packer = packer << (uint32_t)frame_sz;
+        pack_frame(packer);
+        assert(box.buf->size() <= box.buf->capacity());
+        box.count++;
+
+        if (!batch && box.count >= box.limit) {
+            // filled before the timer, load can take larger batches
+            take(box, batch);
+            box.limit = std::min(2*box.limit, max_frames);
+        }
+        box.mtx.unlock();
+
+        return true;
+    }
+
+    // kept frames are moved down over the dropped ones, a box left empty no longer waits
+    inline uint64_t
+    outbox :: drop(uint64_t req_id)
+    {
+        std::vector<dest_box*> all;
+        map_mtx.lock();
+        all.reserve(boxes.size());
+        for (auto &p: boxes) {
+            all.emplace_back(p.second.get());
+        }
+        map_mtx.unlock();
+
+        uint64_t ret = 0;
+        for (dest_box *b: all) {
+            dest_box &box = *b;
+            box.mtx.lock();
+            if (box.count > 0) {
+                uint8_t *data = box.buf->data();
+                uint64_t end = box.buf->size();
+                uint64_t to = box.frames.front().second;
+                uint64_t kept = 0;
+                for (uint64_t i = 0; i < box.frames.size(); i++) {
+                    uint64_t from = box.frames[i].second;
+                    uint64_t len = (i+1 < box.frames.size() ? box.frames[i+1].second : end) - from;
+                    if (box.frames[i].first != req_id) {
+                        if (to != from) {
+                            memmove(data + to, data + from, len);
+                        }
+                        box.frames[kept++] = std::make_pair(box.frames[i].first, to);
+                        to += len;
+                    }
+                }
+                uint64_t num = box.frames.size() - kept;
+                if (num > 0) {
+                    ret += num;
+                    box.frames.resize(kept);
+                    box.buf->resize(to);
+                    box.count = kept;
+                    if (kept == 0) {
+                        box.buf.reset();
+                        wait_mtx.lock();
+                        nonempty--;
+                        wait_mtx.unlock();
+                    }
+                }
+            }
+            box.mtx.unlock();
+        }
+
+        num_dropped += ret;
+        return ret;
+    }
+
+    // returns when the oldest frame still waiting has to go, UINT64_MAX if none is
+    inline uint64_t
+    outbox :: expired(uint64_t now, std::vector<std::pair<uint64_t, batch_t>> &batches)
+    {
+        std::vector<std::pair<uint64_t, dest_box*>> all;
+        map_mtx.lock();
+        all.reserve(boxes.size());
+        for (auto &p: boxes) {
+            all.emplace_back(p.first, p.second.get());
+        }
+        map_mtx.unlock();
+
+        uint64_t next = UINT64_MAX;
+        for (auto &p: all) {
+            dest_box &box = *p.second;
+            box.mtx.lock();
+            if (box.count > 0) {
+                if (now - box.oldest >= flush_ns) {
+                    // this many frames arrive in one interval
+                    box.limit = box.count;
+                    batches.emplace_back(p.first, batch_t());
+                    take(box, batches.back().second);
+                } else {
+                    next = std::min(next, box.oldest + flush_ns);
+                }
+            }
+            box.mtx.unlock();
+        }
+
+        return next;
+    }
+
+    inline bool
+    outbox :: wait_expired(std::vector<std::pair<uint64_t, batch_t>> &batches)
+    {
+        wclock::weaver_timer timer;
+
+        while (batches.empty()) {
+            wait_mtx.lock();
+            while (nonempty == 0 && !stopped) {
+                wait_cond.wait();
+            }
+            bool ret = !stopped;
+            wait_mtx.unlock();
+            if (!ret) {
+                return false;
+            }
+
+            uint64_t now = timer.get_time_elapsed();
+            uint64_t next = expired(now, batches);
+            if (batches.empty()) {
+                // a box that filled after the scan is due no sooner than a flush interval from now
+                uint64_t wait_ns = std::min(next, now + flush_ns) - now;
+                wait_mtx.lock();
+                if (nonempty > 0 && !stopped) {
+                    wait_cond.wait(wait_ns);
+                }
+                wait_mtx.unlock();
+            }
+        }
+
+        return true;
+    }
+
+    inline void
+    outbox :: stop()
+    {
+        wait_mtx.lock();
+        stopped = true;
+        wait_cond.broadcast();
+        wait_mtx.unlock();
+    }
+
+    template <typename Func>
+    inline void
+    outbox :: for_each_frame(const e::buffer &batch, uint64_t header_sz, Func f)
+    {
+        e::unpacker unpacker = batch.unpack_from(header_sz);
+        uint32_t count, frame_sz;
+        unpacker = unpacker >> count;
+        for (uint32_t i = 0; i < count; i++) {
+            unpacker = unpacker >> frame_sz;
+            assert(!unpacker.error() && unpacker.remain() >= frame_sz);
+            f(unpacker.as_slice().data(), frame_sz);
+            unpacker = unpacker.advance(frame_sz);
+        }
+    }
+}
+
+#endif
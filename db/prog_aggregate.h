@@ -0,0 +1,131 @@
+/*
+ * ===============================================================
+ *    Description:  Partial result of an aggregating node program
+ *                  on a shard. Programs which export merge_results
+ *                  fold what they return to the VT into one result
+ *                  per shard, instead of the first return ending the
+ *                  request. Every running or parked piece of the
+ *                  request holds the aggregate, when the last one
+ *                  lets go the deleter sends the result and the
+ *                  credit (see common/prog_credit.h) to the VT.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_prog_aggregate_h_
+#define weaver_db_prog_aggregate_h_
+
+#include <memory>
+#include <unordered_map>
+#include <po6/threads/mutex.h>
+
+#include "common/prog_credit.h"
+#include "node_prog/dynamic_prog_table.h"
+
+namespace db
+{
+    struct prog_aggregate
+    {
+        po6::threads::mutex mtx;
+        uint64_t req_id, vt_id;
+        std::string prog_type;
+        dynamic_prog_table *prog;
+        weaver_util::prog_credit_t credit;
+        node_prog::np_param_ptr_t result;
+
+        prog_aggregate(uint64_t rid, uint64_t vt, const std::string &type, dynamic_prog_table *p)
+            : req_id(rid)
+            , vt_id(vt)
+            , prog_type(type)
+            , prog(p)
+        { }
+
+        void add(node_prog::np_param_ptr_t res);
+        // credit for a message of this request to another shard
+        weaver_util::prog_credit_t split();
+    };
+
+    // aggregates of requests with work on this shard
+    class prog_aggregates
+    {
+        private:
+            po6::threads::mutex mtx;
+            std::unordered_map<uint64_t, std::weak_ptr<prog_aggregate>> active;
+
+        public:
+            prog_aggregates() { }
+            prog_aggregates(const prog_aggregates&) = delete;
+            prog_aggregates& operator=(const prog_aggregates&) = delete;
+
+            // aggregate of the request, made by make if there is none, takes the credit of a message
+            template <typename Make>
+            std::shared_ptr<prog_aggregate> join(uint64_t req_id, const weaver_util::prog_credit_t &credit, Make make);
+            // called by the deleter, a new aggregate may already have replaced this one
+            void release(uint64_t req_id);
+            uint64_t size();
+    };
+
+    inline void
+    prog_aggregate :: add(node_prog::np_param_ptr_t res)
+    {
+        mtx.lock();
+        prog->merge_results(result, std::move(res));
+        mtx.unlock();
+    }
+
+    inline weaver_util::prog_credit_t
+    prog_aggregate :: split()
+    {
+        mtx.lock();
+        assert(!credit.empty());
+        weaver_util::prog_credit_t half = weaver_util::split_credit(credit);
+        mtx.unlock();
+        return half;
+    }
+
+    template <typename Make>
+    inline std::shared_ptr<prog_aggregate>
+    prog_aggregates :: join(uint64_t req_id, const weaver_util::prog_credit_t &credit, Make make)
+    {
+        mtx.lock();
+        std::weak_ptr<prog_aggregate> &weak = active[req_id];
+        std::shared_ptr<prog_aggregate> agg = weak.lock();
+        if (!agg) {
+            agg = make();
+            weak = agg;
+        }
+        mtx.unlock();
+
+        agg->mtx.lock();
+        weaver_util::add_credit(agg->credit, credit);
+        agg->mtx.unlock();
+
+        return agg;
+    }
+
+    inline void
+    prog_aggregates :: release(uint64_t req_id)
+    {
+        mtx.lock();
+        auto iter = active.find(req_id);
+        if (iter != active.end() && iter->second.expired()) {
+            active.erase(iter);
+        }
+        mtx.unlock();
+    }
+
+    inline uint64_t
+    prog_aggregates :: size()
+    {
+        mtx.lock();
+        uint64_t sz = active.size();
+        mtx.unlock();
+        return sz;
+    }
+}
+
+#endif
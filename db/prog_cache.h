@@ -0,0 +1,122 @@
+/*
+ * ===============================================================
+ *    Description:  Validation of node program cache entries whose
+ *                  watch sets include nodes on other shards, and
+ *                  cache counters. A node program waits here while
+ *                  the other shards check that no node in the watch
+ *                  set changed after the entry was cached.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_prog_cache_h_
+#define weaver_db_prog_cache_h_
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <po6/threads/mutex.h>
+
+#include "db/cache_entry.h"
+#include "db/node_prog_running_state.h"
+
+namespace db
+{
+    class prog_cache
+    {
+        private:
+            struct validation
+            {
+                std::shared_ptr<node_prog_running_state> np;
+                node_handle_t handle;
+                cache_entry entry;
+                uint64_t outstanding;
+                bool valid;
+            };
+
+            po6::threads::mutex mtx;
+            std::unordered_map<uint64_t, validation> pending;
+            uint64_t next_token;
+            std::atomic<uint64_t> num_hits, num_misses, num_invalidations, num_stores;
+
+        public:
+            prog_cache();
+            prog_cache(const prog_cache&) = delete;
+            prog_cache& operator=(const prog_cache&) = delete;
+
+            // np waits for num_shards replies about entry, cached at node handle
+            uint64_t start_validation(std::shared_ptr<node_prog_running_state> np,
+                                      const node_handle_t &handle,
+                                      const cache_entry &entry,
+                                      uint64_t num_shards);
+            // true on the last reply for token, np then has the verdict and can resume
+            bool validation_reply(uint64_t token, bool unchanged, std::shared_ptr<node_prog_running_state> &np);
+
+            void hit() { num_hits++; }
+            void miss() { num_misses++; }
+            void invalidation() { num_invalidations++; }
+            void store() { num_stores++; }
+
+            // stats
+            uint64_t hits() const { return num_hits.load(std::memory_order_relaxed); }
+            uint64_t misses() const { return num_misses.load(std::memory_order_relaxed); }
+            uint64_t invalidations() const { return num_invalidations.load(std::memory_order_relaxed); }
+            uint64_t stores() const { return num_stores.load(std::memory_order_relaxed); }
+    };
+
+    inline
+    prog_cache :: prog_cache()
+        : next_token(0)
+        , num_hits(0)
+        , num_misses(0)
+        , num_invalidations(0)
+        , num_stores(0)
+    { }
+
+    inline uint64_t
+    prog_cache :: start_validation(std::shared_ptr<node_prog_running_state> np,
+                                   const node_handle_t &handle,
+                                   const cache_entry &entry,
+                                   uint64_t num_shards)
+    {
+        assert(num_shards > 0);
+
+        mtx.lock();
+        uint64_t token = next_token++;
+        validation &v = pending[token];
+        v.np = std::move(np);
+        v.handle = handle;
+        v.entry = entry;
+        v.outstanding = num_shards;
+        v.valid = true;
+        mtx.unlock();
+
+        return token;
+    }
+
+    inline bool
+    prog_cache :: validation_reply(uint64_t token, bool unchanged, std::shared_ptr<node_prog_running_state> &np)
+    {
+        mtx.lock();
+        auto iter = pending.find(token);
+        assert(iter != pending.end());
+        validation &v = iter->second;
+        v.valid = v.valid && unchanged;
+
+        bool done = (--v.outstanding == 0);
+        if (done) {
+            np = std::move(v.np);
+            np->cache_verdicts[v.handle] = std::make_pair(std::move(v.entry), v.valid);
+            pending.erase(iter);
+        }
+        mtx.unlock();
+
+        return done;
+    }
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * ===============================================================
+ *    Description:  Per request node program constants on a shard.
+ *                  The constants arrive with the first NODE_PROG
+ *                  message of a request from each sender, and are
+ *                  attached to the params of all later messages.
+ *                  A message which overtakes the one carrying the
+ *                  constants waits here until they arrive.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_prog_constants_h_
+#define weaver_db_prog_constants_h_
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <po6/threads/mutex.h>
+
+#include "common/vclock.h"
+#include "common/event_order.h"
+#include "db/node_prog_running_state.h"
+
+namespace db
+{
+    class prog_constants
+    {
+        private:
+            struct entry
+            {
+                vc::vclock clk;
+                node_prog::np_const_ptr_t constants;
+                std::unordered_set<uint64_t> sent_to; // shards which have received constants from this shard
+                std::vector<std::shared_ptr<node_prog_running_state>> waiting;
+            };
+
+            po6::threads::mutex mtx;
+            std::unordered_map<uint64_t, entry> entries;
+
+        public:
+            prog_constants() { }
+            prog_constants(const prog_constants&) = delete;
+            prog_constants& operator=(const prog_constants&) = delete;
+
+            // sets np->constants from the message or from an earlier one
+            // false if neither has them, np runs when they arrive
+            // ready holds waiting programs which can run now
+            bool attach(std::shared_ptr<node_prog_running_state> np,
+                        node_prog::np_const_ptr_t msg_constants,
+                        std::vector<std::shared_ptr<node_prog_running_state>> &ready);
+            // true if the next message for req_id to shard must carry the constants
+            bool must_send(uint64_t req_id, uint64_t shard);
+            // call after the message carrying the constants has been handed to busybee
+            void mark_sent(uint64_t req_id, uint64_t shard);
+            // forget requests which happen before done_clk, caution: assume caller serializes with done_clk updates
+            void cleanup(const std::vector<vc::vclock_t> &done_clk);
+    };
+
+    inline bool
+    prog_constants :: attach(std::shared_ptr<node_prog_running_state> np,
+                             node_prog::np_const_ptr_t msg_constants,
+                             std::vector<std::shared_ptr<node_prog_running_state>> &ready)
+    {
+        mtx.lock();
+        auto iter = entries.find(np->req_id);
+        if (iter == entries.end()) {
+            iter = entries.emplace(np->req_id, entry()).first;
+            iter->second.clk = *np->req_vclock;
+        }
+        entry &e = iter->second;
+
+        if (e.constants == nullptr && msg_constants != nullptr) {
+            e.constants = std::move(msg_constants);
+            ready = std::move(e.waiting);
+            e.waiting.clear();
+            for (auto &w: ready) {
+                w->constants = e.constants;
+            }
+        }
+
+        bool found = (e.constants != nullptr);
+        if (found) {
+            np->constants = e.constants;
+        } else {
+            e.waiting.emplace_back(std::move(np));
+        }
+        mtx.unlock();
+
+        return found;
+    }
+
+    inline bool
+    prog_constants :: must_send(uint64_t req_id, uint64_t shard)
+    {
+        mtx.lock();
+        auto iter = entries.find(req_id);
+        bool must = (iter == entries.end() || iter->second.sent_to.find(shard) == iter->second.sent_to.end());
+        mtx.unlock();
+        return must;
+    }
+
+    inline void
+    prog_constants :: mark_sent(uint64_t req_id, uint64_t shard)
+    {
+        mtx.lock();
+        auto iter = entries.find(req_id);
+        if (iter != entries.end()) {
+            iter->second.sent_to.emplace(shard);
+        }
+        mtx.unlock();
+    }
+
+    inline void
+    prog_constants :: cleanup(const std::vector<vc::vclock_t> &done_clk)
+    {
+        mtx.lock();
+        for (auto iter = entries.begin(); iter != entries.end();) {
+            const vc::vclock &clk = iter->second.clk;
+            if (order::oracle::happens_before_no_kronos(clk.clock, done_clk[clk.vt_id])) {
+                iter = entries.erase(iter);
+            } else {
+                iter++;
+            }
+        }
+        mtx.unlock();
+    }
+}
+
+#endif
@@ -0,0 +1,253 @@
+/*
+ * ===============================================================
+ *    Description:  Node program state of each request on a shard,
+ *                  keyed by node handle, or by dense node index for
+ *                  dense programs. States are allocated in blocks
+ *                  owned by the request, so that when the request
+ *                  completes all its state is freed at once without
+ *                  touching or locking the nodes it ran at.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_prog_state_arena_h_
+#define weaver_db_prog_state_arena_h_
+
+#include <stddef.h>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <po6/threads/mutex.h>
+
+#include "common/vclock.h"
+#include "common/event_order.h"
+#include "node_prog/dynamic_prog_table.h"
+#include "db/mem_accounting.h"
+#include "db/node_id_table.h"
+
+namespace db
+{
+    class request_states
+    {
+        public:
+            static const uint64_t ChunkBytes = 64*1024;
+            static const uint64_t DensePageSize = 16; // dense states per page, small so sparse traversals stay cheap
+
+        private:
+            po6::threads::mutex mtx;
+            std::unordered_map<node_handle_t, node_prog::Node_State_Base*> states;
+            std::vector<node_prog::Node_State_Base*> placed; // constructed in chunks
+            std::vector<node_prog::np_state_ptr_t> owned; // programs without a placement ctor
+            std::vector<std::unique_ptr<char[]>> chunks, large;
+            uint64_t chunk_used, bytes;
+            // dense states by node_id_table::dense_index, pages allocated on first touch
+            // and found by page number, so a request pays only for the pages it touched
+            // a slot is not reused while a request that visited its node may still run,
+            // because permanent deletion waits for those requests
+            std::unordered_map<uint64_t, std::unique_ptr<node_prog::dense_node_state[]>> dense_pages;
+            uint64_t last_page_num; // most recently used page, neighbouring nodes often share it
+            node_prog::dense_node_state *last_page;
+            std::unordered_map<node_handle_t, node_prog::dense_node_state> dense_by_handle; // node id unknown
+
+            void* allocate(uint64_t sz);
+
+        public:
+            request_states();
+            ~request_states();
+            request_states(const request_states&) = delete;
+            request_states& operator=(const request_states&) = delete;
+
+            // state of this request at node handle, created on first access
+            node_prog::Node_State_Base& get(const node_handle_t &handle, const dynamic_prog_table &prog);
+            node_prog::dense_node_state& get_dense(uint64_t node_id, const node_handle_t &handle);
+            uint64_t size();
+    };
+
+    class prog_state_arena
+    {
+        private:
+            po6::threads::mutex mtx;
+            std::unordered_map<uint64_t, std::pair<vc::vclock, std::shared_ptr<request_states>>> requests;
+
+        public:
+            prog_state_arena() { }
+            prog_state_arena(const prog_state_arena&) = delete;
+            prog_state_arena& operator=(const prog_state_arena&) = delete;
+
+            std::shared_ptr<request_states> request(uint64_t req_id, const vc::vclock &clk);
+            // removes requests which happen before done_clk
+            // states are freed when the caller drops done, or when the last running piece
+            // of the request lets go, whichever is later
+            void cleanup(const std::vector<vc::vclock_t> &done_clk, std::vector<std::shared_ptr<request_states>> &done);
+            void clear(std::vector<std::shared_ptr<request_states>> &done);
+            uint64_t num_requests();
+    };
+
+    inline
+    request_states :: request_states()
+        : chunk_used(ChunkBytes)
+        , bytes(0)
+        , last_page_num(UINT64_MAX)
+        , last_page(nullptr)
+    { }
+
+    inline
+    request_states :: ~request_states()
+    {
+        for (node_prog::Node_State_Base *s: placed) {
+            s->~Node_State_Base();
+        }
+        shard_memory().sub(MEM_PROG_STATE, bytes);
+    }
+
+    // caution: assume holding mtx
+    inline void*
+    request_states :: allocate(uint64_t sz)
+    {
+        const uint64_t align = alignof(max_align_t);
+        sz = (sz + align - 1) & ~(align - 1);
+
+        if (sz > ChunkBytes) {
+            large.emplace_back(new char[sz]);
+            bytes += sz;
+            shard_memory().add(MEM_PROG_STATE, sz);
+            return large.back().get();
+        }
+
+        if (chunk_used + sz > ChunkBytes) {
+            chunks.emplace_back(new char[ChunkBytes]);
+            chunk_used = 0;
+            bytes += ChunkBytes;
+            shard_memory().add(MEM_PROG_STATE, ChunkBytes);
+        }
+
+        void *mem = chunks.back().get() + chunk_used;
+        chunk_used += sz;
+        return mem;
+    }
+
+    inline node_prog::Node_State_Base&
+    request_states :: get(const node_handle_t &handle, const dynamic_prog_table &prog)
+    {
+        mtx.lock();
+        auto iter = states.find(handle);
+        if (iter == states.end()) {
+            node_prog::Node_State_Base *s;
+            if (prog.state_ctor_at != nullptr) {
+                s = prog.state_ctor_at(allocate(prog.state_bytes()));
+                placed.emplace_back(s);
+            } else {
+                owned.emplace_back(prog.state_ctor());
+                s = owned.back().get();
+                bytes += mem_accounting::ProgStateEntryBytes;
+                shard_memory().add(MEM_PROG_STATE, mem_accounting::ProgStateEntryBytes);
+            }
+            iter = states.emplace(handle, s).first;
+        }
+        node_prog::Node_State_Base &state = *iter->second;
+        mtx.unlock();
+
+        return state;
+    }
+
+    inline node_prog::dense_node_state&
+    request_states :: get_dense(uint64_t node_id, const node_handle_t &handle)
+    {
+        node_prog::dense_node_state *state;
+
+        mtx.lock();
+        if (node_id == node_id_table::invalid_id) {
+            auto iter = dense_by_handle.find(handle);
+            if (iter == dense_by_handle.end()) {
+                bytes += mem_accounting::ProgStateEntryBytes;
+                shard_memory().add(MEM_PROG_STATE, mem_accounting::ProgStateEntryBytes);
+                iter = dense_by_handle.emplace(handle, node_prog::dense_node_state()).first;
+            }
+            state = &iter->second;
+        } else {
+            uint64_t idx = node_id_table::dense_index(node_id);
+            uint64_t page_num = idx / DensePageSize;
+            if (page_num != last_page_num) {
+                std::unique_ptr<node_prog::dense_node_state[]> &page = dense_pages[page_num];
+                if (!page) {
+                    page.reset(new node_prog::dense_node_state[DensePageSize]);
+                    uint64_t page_bytes = DensePageSize * sizeof(node_prog::dense_node_state) + mem_accounting::DensePageEntryBytes;
+                    bytes += page_bytes;
+                    shard_memory().add(MEM_PROG_STATE, page_bytes);
+                }
+                last_page_num = page_num;
+                last_page = page.get();
+            }
+            state = &last_page[idx % DensePageSize];
+        }
+        mtx.unlock();
+
+        return *state;
+    }
+
+    inline uint64_t
+    request_states :: size()
+    {
+        mtx.lock();
+        uint64_t sz = states.size();
+        mtx.unlock();
+        return sz;
+    }
+
+    inline std::shared_ptr<request_states>
+    prog_state_arena :: request(uint64_t req_id, const vc::vclock &clk)
+    {
+        mtx.lock();
+        auto &entry = requests[req_id];
+        if (!entry.second) {
+            entry.first = clk;
+            entry.second = std::make_shared<request_states>();
+        }
+        std::shared_ptr<request_states> ret = entry.second;
+        mtx.unlock();
+
+        return ret;
+    }
+
+    inline void
+    prog_state_arena :: cleanup(const std::vector<vc::vclock_t> &done_clk, std::vector<std::shared_ptr<request_states>> &done)
+    {
+        mtx.lock();
+        for (auto iter = requests.begin(); iter != requests.end();) {
+            const vc::vclock &clk = iter->second.first;
+            if (order::oracle::happens_before_no_kronos(clk.clock, done_clk[clk.vt_id])) {
+                done.emplace_back(std::move(iter->second.second));
+                iter = requests.erase(iter);
+            } else {
+                iter++;
+            }
+        }
+        mtx.unlock();
+    }
+
+    inline void
+    prog_state_arena :: clear(std::vector<std::shared_ptr<request_states>> &done)
+    {
+        mtx.lock();
+        for (auto &p: requests) {
+            done.emplace_back(std::move(p.second.second));
+        }
+        requests.clear();
+        mtx.unlock();
+    }
+
+    inline uint64_t
+    prog_state_arena :: num_requests()
+    {
+        mtx.lock();
+        uint64_t num = requests.size();
+        mtx.unlock();
+        return num;
+    }
+}
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * ===============================================================
+ *    Description:  Implementation of flat property storage.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include "db/prop_block.h"
+
+using db::prop_block;
+
+prop_block :: prop_block(const prop_block &other)
+    : key_ids(other.key_ids)
+    , creat_ids(other.creat_ids)
+    , del_ids(other.del_ids)
+    , values(other.values)
+{
+    for (uint64_t i = 0; i < key_ids.size(); i++) {
+        vc::interned_clocks.acquire(creat_ids[i]);
+        vc::interned_clocks.acquire(del_ids[i]);
+    }
+    if (other.index) {
+        build_index();
+    }
+    db::shard_memory().add(db::MEM_PROPERTIES, total_bytes());
+}
+
+prop_block :: ~prop_block()
+{
+    clear();
+}
+
+prop_block&
+prop_block :: operator=(const prop_block &other)
+{
+    if (this != &other) {
+        for (uint64_t i = 0; i < other.key_ids.size(); i++) {
+            vc::interned_clocks.acquire(other.creat_ids[i]);
+            vc::interned_clocks.acquire(other.del_ids[i]);
+        }
+        clear();
+
+        key_ids = other.key_ids;
+        creat_ids = other.creat_ids;
+        del_ids = other.del_ids;
+        values = other.values;
+        if (other.index) {
+            build_index();
+        }
+        db::shard_memory().add(db::MEM_PROPERTIES, total_bytes());
+    }
+    return *this;
+}
+
+void
+prop_block :: build_index()
+{
+    index.reset(new std::unordered_map<uint32_t, std::vector<uint32_t>>());
+    for (uint64_t slot = 0; slot < key_ids.size(); slot++) {
+        (*index)[key_ids[slot]].emplace_back(slot);
+    }
+}
+
+uint64_t
+prop_block :: total_bytes() const
+{
+    uint64_t bytes = 0;
+    for (const std::string &v: values) {
+        bytes += slot_bytes(v);
+    }
+    return bytes;
+}
+
+void
+prop_block :: append(uint32_t kid, const std::string &value, const vclock_ptr_t &creat, const vclock_ptr_t &del)
+{
+    uint32_t slot = key_ids.size();
+    key_ids.emplace_back(kid);
+    creat_ids.emplace_back(vc::interned_clocks.intern(creat));
+    del_ids.emplace_back(vc::interned_clocks.intern(del));
+    values.emplace_back(value);
+    db::shard_memory().add(db::MEM_PROPERTIES, slot_bytes(value));
+
+    if (index) {
+        (*index)[kid].emplace_back(slot);
+    } else if (key_ids.size() > IndexThreshold) {
+        build_index();
+    }
+}
+
+bool
+prop_block :: append(const property &p)
+{
+    uint32_t kid = property_keys.intern(p.key);
+    if (kid == key_dictionary::invalid_id) {
+        return false;
+    }
+    append(kid, p.value, p.get_creat_time(), p.get_del_time());
+    return true;
+}
+
+void
+prop_block :: mark_deleted(uint64_t slot, const vclock_ptr_t &tdel)
+{
+    uint32_t old_id = del_ids[slot];
+    del_ids[slot] = vc::interned_clocks.intern(tdel);
+    vc::interned_clocks.release(old_id);
+}
+
+// permanently drop all versions of key
+void
+prop_block :: remove_key(uint32_t kid)
+{
+    remove_slots([&](uint64_t slot) { return key_ids[slot] == kid; });
+}
+
+void
+prop_block :: clear()
+{
+    if (!key_ids.empty()) {
+        db::shard_memory().sub(db::MEM_PROPERTIES, total_bytes());
+    }
+    for (uint64_t i = 0; i < key_ids.size(); i++) {
+        vc::interned_clocks.release(creat_ids[i]);
+        vc::interned_clocks.release(del_ids[i]);
+    }
+    key_ids.clear();
+    creat_ids.clear();
+    del_ids.clear();
+    values.clear();
+    index.reset();
+}
+
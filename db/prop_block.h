@@ -0,0 +1,159 @@
+/*
+ * ===============================================================
+ *    Description:  Flat per-element property storage.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_prop_block_h_
+#define weaver_db_prop_block_h_
+
+#include <stdint.h>
+#include <string>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include "common/vclock.h"
+#include "common/clock_table.h"
+#include "db/key_dictionary.h"
+#include "db/property.h"
+#include "db/mem_accounting.h"
+
+namespace db
+{
+    // all versions of all properties of an element, one slot per version
+    // keys are ids in db::property_keys and clocks are ids in vc::interned_clocks
+    // small blocks are scanned linearly by key id, blocks larger than
+    // IndexThreshold also keep a key id -> slots index
+    class prop_block
+    {
+        public:
+            static const uint32_t IndexThreshold = 16;
+
+        private:
+            std::vector<uint32_t> key_ids;
+            std::vector<uint32_t> creat_ids;
+            std::vector<uint32_t> del_ids;
+            std::vector<std::string> values;
+            std::unique_ptr<std::unordered_map<uint32_t, std::vector<uint32_t>>> index;
+
+            void build_index();
+            static uint64_t slot_bytes(const std::string &value) { return 3*sizeof(uint32_t) + sizeof(std::string) + value.size(); }
+            uint64_t total_bytes() const;
+            template <typename Func> uint64_t remove_slots(Func pred);
+
+        public:
+            prop_block() { }
+            prop_block(const prop_block &other);
+            ~prop_block();
+            prop_block& operator=(const prop_block &other);
+
+            uint64_t size() const { return key_ids.size(); }
+            bool empty() const { return key_ids.empty(); }
+            uint32_t key_id(uint64_t slot) const { return key_ids[slot]; }
+            const std::string& key(uint64_t slot) const { return property_keys.key(key_ids[slot]); }
+            const std::string& value(uint64_t slot) const { return values[slot]; }
+            uint32_t creat_id(uint64_t slot) const { return creat_ids[slot]; }
+            uint32_t del_id(uint64_t slot) const { return del_ids[slot]; }
+            bool is_deleted(uint64_t slot) const { return del_ids[slot] != vc::clock_table::null_id; }
+
+            void append(uint32_t key_id, const std::string &value, const vclock_ptr_t &creat, const vclock_ptr_t &del);
+            // false if the key cannot be added to property_keys
+            bool append(const property &p);
+            void mark_deleted(uint64_t slot, const vclock_ptr_t &tdel);
+            void remove_key(uint32_t key_id);
+            // permanently drop deleted versions whose delete clock id satisfies dead(id)
+            template <typename Func> uint64_t compact(Func dead);
+            void clear();
+
+            // true iff pred(slot) holds for some slot with key key_id
+            template <typename Func> bool any_slot(uint32_t key_id, Func pred) const;
+    };
+
+    // drop slots for which pred(slot) holds, keeping the order of the rest
+    template <typename Func>
+    inline uint64_t
+    prop_block :: remove_slots(Func pred)
+    {
+        uint64_t to = 0, freed = 0;
+        for (uint64_t from = 0; from < key_ids.size(); from++) {
+            if (pred(from)) {
+                freed += slot_bytes(values[from]);
+                vc::interned_clocks.release(creat_ids[from]);
+                vc::interned_clocks.release(del_ids[from]);
+                continue;
+            }
+            if (to != from) {
+                key_ids[to] = key_ids[from];
+                creat_ids[to] = creat_ids[from];
+                del_ids[to] = del_ids[from];
+                values[to] = std::move(values[from]);
+            }
+            to++;
+        }
+
+        uint64_t removed = key_ids.size() - to;
+        if (removed != 0) {
+            shard_memory().sub(MEM_PROPERTIES, freed);
+            key_ids.resize(to);
+            creat_ids.resize(to);
+            del_ids.resize(to);
+            values.resize(to);
+
+            if (key_ids.size() > IndexThreshold) {
+                build_index();
+            } else {
+                index.reset();
+            }
+        }
+        return removed;
+    }
+
+    template <typename Func>
+    inline uint64_t
+    prop_block :: compact(Func dead)
+    {
+        uint64_t removed = remove_slots([&](uint64_t slot) {
+            return is_deleted(slot) && dead(del_ids[slot]);
+        });
+
+        if (removed != 0 && key_ids.capacity() > 2*key_ids.size()) {
+            key_ids.shrink_to_fit();
+            creat_ids.shrink_to_fit();
+            del_ids.shrink_to_fit();
+            values.shrink_to_fit();
+        }
+        return removed;
+    }
+
+    template <typename Func>
+    inline bool
+    prop_block :: any_slot(uint32_t kid, Func pred) const
+    {
+        if (index) {
+            auto find_iter = index->find(kid);
+            if (find_iter != index->end()) {
+                for (uint32_t slot: find_iter->second) {
+                    if (pred(slot)) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        for (uint64_t slot = 0; slot < key_ids.size(); slot++) {
+            if (key_ids[slot] == kid && pred(slot)) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+#endif
@@ -17,24 +17,52 @@ using db::property;
 using db::property_key_hasher;
 
 property :: property()
+    : creat_id(vc::clock_table::null_id)
+    , del_id(vc::clock_table::null_id)
 { }
 
 property :: property(const std::string &k, const std::string &v)
     : node_prog::property(k, v)
+    , creat_id(vc::clock_table::null_id)
+    , del_id(vc::clock_table::null_id)
 { }
 
 property :: property(const std::string &k, const std::string &v, const vclock_ptr_t &creat)
     : node_prog::property(k, v)
-    , creat_time(creat)
+    , creat_id(vc::interned_clocks.intern(creat))
+    , del_id(vc::clock_table::null_id)
 { }
 
 property :: property(const property &other)
     : node_prog::property(other.key, other.value)
-    , creat_time(other.creat_time)
+    , creat_id(other.creat_id)
+    , del_id(other.del_id)
 {
-    if (other.del_time) {
-        del_time = other.del_time;
+    vc::interned_clocks.acquire(creat_id);
+    vc::interned_clocks.acquire(del_id);
+}
+
+property :: ~property()
+{
+    vc::interned_clocks.release(creat_id);
+    vc::interned_clocks.release(del_id);
+}
+
+property&
+property :: operator=(const property &other)
+{
+    if (this != &other) {
+        vc::interned_clocks.acquire(other.creat_id);
+        vc::interned_clocks.acquire(other.del_id);
+        vc::interned_clocks.release(creat_id);
+        vc::interned_clocks.release(del_id);
+
+        key = other.key;
+        value = other.value;
+        creat_id = other.creat_id;
+        del_id = other.del_id;
     }
+    return *this;
 }
 
 bool
@@ -46,31 +74,35 @@ property :: operator==(property const &other) const
 const vclock_ptr_t&
 property :: get_creat_time() const
 {
-    return creat_time;
+    return vc::interned_clocks.get(creat_id);
 }
 
 const vclock_ptr_t&
 property :: get_del_time() const
 {
-    return del_time;
+    return vc::interned_clocks.get(del_id);
 }
 
 bool
 property :: is_deleted() const
 {
-    return (del_time != nullptr);
+    return (del_id != vc::clock_table::null_id);
 }
 
 void
 property :: update_del_time(const vclock_ptr_t &tdel)
 {
-    del_time = tdel;
+    uint32_t old_id = del_id;
+    del_id = vc::interned_clocks.intern(tdel);
+    vc::interned_clocks.release(old_id);
 }
 
 void
 property :: update_creat_time(const vclock_ptr_t &tcreat)
 {
-    creat_time = tcreat;
+    uint32_t old_id = creat_id;
+    creat_id = vc::interned_clocks.intern(tcreat);
+    vc::interned_clocks.release(old_id);
 }
 
 size_t
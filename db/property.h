@@ -20,6 +20,7 @@
 
 #include "common/weaver_constants.h"
 #include "common/vclock.h"
+#include "common/clock_table.h"
 
 #include "node_prog/property.h"
 
@@ -30,19 +31,24 @@ namespace db
     class property : public node_prog::property
     {
         private:
-            vclock_ptr_t creat_time;
-            vclock_ptr_t del_time;
+            // ids in vc::interned_clocks
+            uint32_t creat_id;
+            uint32_t del_id;
 
         public:
             property();
             property(const std::string&, const std::string&);
             property(const std::string&, const std::string&, const vclock_ptr_t&);
             property(const property &other);
+            ~property();
+            property& operator=(const property &other);
 
             bool operator==(property const &p2) const;
 
             const vclock_ptr_t& get_creat_time() const;
             const vclock_ptr_t& get_del_time() const;
+            uint32_t get_creat_id() const { return creat_id; }
+            uint32_t get_del_id() const { return del_id; }
             bool is_deleted() const;
             void update_creat_time(const vclock_ptr_t&);
             void update_del_time(const vclock_ptr_t&);
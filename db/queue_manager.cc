@@ -18,11 +18,32 @@
 #include "common/config_constants.h"
 #include "common/event_order.h"
 #include "db/queue_manager.h"
+#include "db/mem_accounting.h"
 
 using db::queue_order;
 using db::queue_manager;
 using db::queued_request;
 
+// memory held by a queued request and by the message buffer it carries
+static void
+charge_request(const queued_request *t, bool enqueue)
+{
+    uint64_t req_bytes = sizeof(queued_request) + sizeof(db::message_wrapper) + t->vclock.clock.size()*sizeof(uint64_t);
+    uint64_t buf_bytes = 0;
+    if (t->arg != nullptr && t->arg->msg && t->arg->msg->buf.get() != nullptr) {
+        buf_bytes = t->arg->msg->buf->capacity();
+    }
+
+    db::mem_accounting &mem = db::shard_memory();
+    if (enqueue) {
+        mem.add(db::MEM_QUEUED_REQUESTS, req_bytes);
+        mem.add(db::MEM_MSG_BUFFERS, buf_bytes);
+    } else {
+        mem.sub(db::MEM_QUEUED_REQUESTS, req_bytes);
+        mem.sub(db::MEM_MSG_BUFFERS, buf_bytes);
+    }
+}
+
 queue_manager :: queue_manager()
     : rd_queues(NumVts, pqueue_t())
     , wr_queues(NumVts, pqueue_t())
@@ -39,6 +60,7 @@ queue_manager :: queue_manager()
 void
 queue_manager :: enqueue_read_request(uint64_t vt_id, queued_request *t)
 {
+    charge_request(t, true);
     queue_mutex.lock();
     rd_queues[vt_id].push(t);
     queue_mutex.unlock();
@@ -61,6 +83,7 @@ queue_manager :: enqueue_write_request(uint64_t vt_id, queued_request *t)
     queue_mutex.lock();
 
     if (t->vclock.clock[0] >= min_epoch[vt_id]) {
+        charge_request(t, true);
         wr_queues[vt_id].push(t);
     }
 
@@ -190,6 +213,7 @@ queue_manager :: exec_queued_request(uint64_t tid, order::oracle *time_oracle)
     if (req == nullptr) {
         return false;
     }
+    charge_request(req, false);
     req->arg->time_oracle = time_oracle;
     (*req->func)(tid, req->arg);
     // queue timestamp is incremented by the thread, upon enqueueing this tx on node queue
@@ -370,6 +394,7 @@ queue_manager :: reset(uint64_t dead_vt, uint64_t new_epoch)
     pqueue_t &dead_queue = wr_queues[dead_vt];
     while (!dead_queue.empty()
         && dead_queue.top()->vclock.clock[0] < min_epoch[dead_vt]) {
+        charge_request(dead_queue.top(), false);
         dead_queue.pop();
     }
 
@@ -379,5 +404,43 @@ queue_manager :: reset(uint64_t dead_vt, uint64_t new_epoch)
 void
 queue_manager :: clear_queued_reads()
 {
+    for (pqueue_t &pq: rd_queues) {
+        while (!pq.empty()) {
+            charge_request(pq.top(), false);
+            pq.pop();
+        }
+    }
     rd_queues = std::vector<pqueue_t>(NumVts, pqueue_t());
 }
+
+// drops node programs of a cancelled request still waiting for their clock, returns number dropped
+uint64_t
+queue_manager :: drop_queued_reads(uint64_t vt_id, uint64_t req_id)
+{
+    std::vector<queued_request*> dropped;
+
+    queue_mutex.lock();
+    pqueue_t &pq = rd_queues[vt_id];
+    if (!pq.empty()) {
+        pqueue_t kept;
+        while (!pq.empty()) {
+            queued_request *req = pq.top();
+            pq.pop();
+            if (req->type == NODE_PROG && req->req_id == req_id) {
+                dropped.emplace_back(req);
+            } else {
+                kept.push(req);
+            }
+        }
+        pq.swap(kept);
+    }
+    queue_mutex.unlock();
+
+    for (queued_request *req: dropped) {
+        charge_request(req, false);
+        delete req->arg;
+        delete req;
+    }
+
+    return dropped.size();
+}
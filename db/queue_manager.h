@@ -72,6 +72,7 @@ namespace db
             void record_completed_tx(vc::vclock &tx_clk);
             void reset(uint64_t dead_vt, uint64_t epoch);
             void clear_queued_reads();
+            uint64_t drop_queued_reads(uint64_t vt_id, uint64_t req_id);
     };
 
 }
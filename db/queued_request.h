@@ -42,6 +42,7 @@ namespace db
                 , func(f)
                 , arg(a)
                 , type(t)
+                , req_id(UINT64_MAX)
             { }
 
         public:
@@ -50,6 +51,7 @@ namespace db
             void (*func)(uint64_t, message_wrapper*);
             message_wrapper *arg;
             qreq_type type;
+            uint64_t req_id; // node programs only, for dropping cancelled requests
     };
 
     // for work queues
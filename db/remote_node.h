@@ -21,12 +21,15 @@ namespace db
     class remote_node
     {
         public:
-            remote_node() { }
-            remote_node(uint64_t l, const node_handle_t &h) : loc(l), handle(h) { }
+            remote_node() : id(UINT64_MAX) { }
+            remote_node(uint64_t l, const node_handle_t &h) : loc(l), handle(h), id(UINT64_MAX) { }
 
         public:
             uint64_t loc;
             node_handle_t handle;
+            // internal id at shard loc if known, UINT64_MAX otherwise
+            // a hint local to that shard, never serialized
+            uint64_t id;
             bool operator==(const db::remote_node &t) const { return (handle == t.handle) && (loc == t.loc); }
             bool operator!=(const db::remote_node &t) const { return (handle != t.handle) || (loc != t.loc); }
     };
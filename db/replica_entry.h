@@ -0,0 +1,39 @@
+/*
+ * ===============================================================
+ *    Description:  Read-only copy of a hot node owned by another
+ *                  shard.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_replica_entry_h_
+#define weaver_db_replica_entry_h_
+
+#include "common/vclock.h"
+#include "db/node.h"
+
+namespace db
+{
+    // the owner had applied every write to the node preceding valid_until
+    // when it sent or extended this copy, so node programs with clocks
+    // before valid_until read the same versions here as at the owner
+    struct replica_entry
+    {
+        node *n;
+        uint64_t owner;
+        uint64_t seq; // snapshot number at the owner, extensions only apply to the same snapshot
+        vc::vclock valid_until;
+
+        replica_entry() : n(nullptr), owner(UINT64_MAX), seq(0) { }
+    };
+
+    // thrown by the state getter when a node program at a replica asks for
+    // per node state, which lives only at the owner
+    struct replica_state_access { };
+}
+
+#endif
@@ -14,6 +14,7 @@
 
 #include <deque>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <random>
 #include <signal.h>
@@ -623,7 +624,7 @@ load_xml_edge(pugi::xml_document &doc,
                static_args,
                elem_count);
 
-    db::edge *e = S->create_edge_bulk_load(edge_handle, id1, loc1, zero_clk);
+    db::edge *e = S->create_edge_bulk_load(edge_handle, map_idx, id1, loc1, zero_clk);
     bool in_mem = S->add_edge_to_node_bulk_load(e, id0, map_idx);
 
     if (in_mem || static_args.call_hdex) {
@@ -923,12 +924,13 @@ load_graph(void *args)
 }
 
 void
-migrated_nbr_update(std::unique_ptr<message::message> msg)
+migrated_nbr_update(uint64_t tid, std::unique_ptr<message::message> msg)
 {
     node_handle_t node;
     uint64_t old_loc, new_loc;
-    msg->unpack_message(message::MIGRATED_NBR_UPDATE, nullptr, node, old_loc, new_loc);
-    S->update_migrated_nbr(node, old_loc, new_loc);
+    std::vector<node_handle_t> srcs, dsts;
+    msg->unpack_message(message::MIGRATED_NBR_UPDATE, nullptr, node, old_loc, new_loc, srcs, dsts);
+    S->update_migrated_nbr(tid, node, old_loc, new_loc, srcs, dsts);
 }
 
 void
@@ -950,7 +952,7 @@ unpack_migrate_request(uint64_t tid, db::message_wrapper *request)
 {
     switch (request->type) {
         case message::MIGRATED_NBR_UPDATE:
-            migrated_nbr_update(std::move(request->msg));
+            migrated_nbr_update(tid, std::move(request->msg));
             break;
 
         case message::MIGRATE_SEND_NODE:
@@ -1096,6 +1098,21 @@ nop(uint64_t tid, db::message_wrapper *request)
     std::unordered_map<uint64_t, uint64_t> recovery_counts;
     if (++nop_count % 10000 == 0) {
         recovery_counts = S->cleanup_prog_states(tid);
+        WDEBUG << "compaction reclaimed " << S->get_versions_reclaimed() << " versions so far" << std::endl;
+        WDEBUG << "frontier pieces split " << S->frontier.pushed() << ", stolen " << S->frontier.stolen() << std::endl;
+        WDEBUG << "outbox sent " << S->prog_outbox.frames() << " node prog messages in " << S->prog_outbox.batches() << " busybee messages, dropped " << S->prog_outbox.dropped() << " of cancelled requests" << std::endl;
+        WDEBUG << "node prog hops run " << S->prog_hops << ", dropped as done " << S->dropped_hops
+               << ", queued requests dropped " << S->dropped_queued << std::endl;
+        WDEBUG << "in-edge updates queued " << S->in_edge_queued << " in " << S->in_edge_batches << " messages, applied "
+               << S->in_edge_applied << ", forwarded " << S->in_edge_forwarded << ", dropped " << S->in_edge_dropped << std::endl;
+        WDEBUG << "prog cache hits " << S->prog_cached.hits() << ", misses " << S->prog_cached.misses()
+               << ", invalidations " << S->prog_cached.invalidations() << ", stores " << S->prog_cached.stores() << std::endl;
+        db::mem_accounting &mem = db::shard_memory();
+        std::ostringstream mem_types;
+        for (uint64_t i = 0; i < db::NUM_MEM_TYPES; i++) {
+            mem_types << " " << db::to_string((db::mem_type)i) << "=" << mem.get((db::mem_type)i);
+        }
+        WDEBUG << "tracked memory " << mem.total() << " of budget " << mem.get_budget() << " bytes:" << mem_types.str() << std::endl;
     }
 
     // cleanup done txs
@@ -1160,12 +1177,24 @@ nop(uint64_t tid, db::message_wrapper *request)
 
     // initiate permanent deletion
     S->permanent_delete_loop(tid, vt_id, nop_arg->outstanding_progs != 0, request->time_oracle);
+    S->compact_versions(request->time_oracle);
+    S->flush_in_edge_updates(tid);
 
     // record clock; reads go through
     S->record_completed_tx(tx.timestamp);
 
+    if (HOT_REPLICA_VISITS > 0) {
+        S->maintain_replicas(tid, tx.timestamp);
+    }
+
+    // clocks are sampled, other subsystems are tracked as they change
+    db::mem_accounting &mem = db::shard_memory();
+    mem.set(db::MEM_CLOCKS, vc::interned_clocks.bytes());
+    std::vector<uint64_t> mem_bytes;
+    mem.snapshot(mem_bytes);
+
     // ack to VT
-    msg.prepare_message(message::VT_NOP_ACK, nullptr, shard_id, qts, cur_node_count, recovery_counts);
+    msg.prepare_message(message::VT_NOP_ACK, nullptr, shard_id, qts, cur_node_count, recovery_counts, mem_bytes);
     S->comm.send(vt_id, msg.buf);
 
     // call appropriate function based on check after acked to vt
@@ -1196,324 +1225,236 @@ nop(uint64_t tid, db::message_wrapper *request)
 //    return nullptr;
 //}
 
-node_prog::Node_State_Base& get_state(std::shared_ptr<node_prog::Node_State_Base> (*create_state)(),
-    uint64_t req_id,
-    db::node *node,
-    std::vector<db::node_version_t> *nodes_that_created_state)
-{
-    auto state_iter = node->node_prog_states.find(req_id);
-    if (state_iter == node->node_prog_states.end()) {
-        std::shared_ptr<node_prog::Node_State_Base> state_ptr = create_state();
-        node->node_prog_states[req_id] = state_ptr;
-        assert(nodes_that_created_state != nullptr);
-        nodes_that_created_state->emplace_back(std::make_pair(node->get_handle(), node->base.get_creat_time()));
-        return *state_ptr;
-    } else {
-        return *state_iter->second;
-    }
-}
-
-
-
-///// vector pointers can be null if we don't want to fill that vector
-///inline void
-///fill_changed_properties(
-///#ifdef weaver_large_property_maps_
-///    std::unordered_map<std::string, std::vector<std::shared_ptr<db::property>>> &props,
-///#else
-///    std::vector<std::shared_ptr<db::property>> &props,
-///#endif
-///    std::vector<node_prog::property> *props_added,
-///    std::vector<node_prog::property> *props_deleted,
-///    vc::vclock &time_cached,
-///    vc::vclock &cur_time,
-///    order::oracle *time_oracle)
-///{
-///#ifdef weaver_large_property_maps_
-///    for (auto &iter : props) {
-///        for (std::shared_ptr<db::property> p: iter.second) {
-///#else
-///    for (std::shared_ptr<db::property> p: props) {
-///#endif
-///            db::property &prop = *p;
-///            const vclock_ptr_t &tdel = prop.get_del_time();
-///            bool del_before_cur = (tdel != nullptr) && (time_oracle->compare_two_vts(*tdel, cur_time) == 0);
-///
-///            if (props_added != nullptr) {
-///                bool creat_after_cached = (time_oracle->compare_two_vts(*prop.get_creat_time(), time_cached) == 1);
-///                bool creat_before_cur = (time_oracle->compare_two_vts(*prop.get_creat_time(), cur_time) == 0);
-///
-///                if (creat_after_cached && creat_before_cur && !del_before_cur) {
-///                    props_added->emplace_back(prop.key, prop.value);
-///                }
-///            }
-///
-///            if (props_deleted != nullptr) {
-///                bool del_after_cached = (tdel != nullptr) && (time_oracle->compare_two_vts(*tdel, time_cached) == 1);
-///
-///                if (del_after_cached && del_before_cur) {
-///                    props_deleted->emplace_back(prop.key, prop.value);
-///                }
-///            }
-///#ifndef weaver_large_property_maps_
-///    }
-///#else
-///        }
-///    }
-///#endif
-///}
-
-//// records all changes to nodes given in ids vector between time_cached and cur_time
-//// returns false if cache should be invalidated
-//inline bool
-//fetch_node_cache_contexts(uint64_t tid,
-//    uint64_t loc,
-//    std::vector<node_handle_t> &handles,
-//    std::vector<node_prog::node_cache_context> &toFill,
-//    vc::vclock& time_cached,
-//    vc::vclock& cur_time,
-//    order::oracle *time_oracle)
-//{
-//    for (node_handle_t &handle: handles) {
-//        db::node *node = S->acquire_node_version(tid, handle, time_cached, time_oracle);
-//
-//        if (node == nullptr
-//         || node->state == db::node::mode::MOVED
-//         || (node->last_perm_deletion != nullptr && time_oracle->compare_two_vts(time_cached, *node->last_perm_deletion) == 0)) {
-//            if (node != nullptr) {
-//                S->release_node(node);
-//            }
-//            WDEBUG << "node not found or migrated or some data permanently deleted, invalidating cached value" << std::endl;
-//            toFill.clear(); // contexts aren't valid so don't send back
-//            return false;
-//        } else {
-//            // node exists
-//
-//            if (node->base.get_del_time()
-//             && time_oracle->compare_two_vts(*node->base.get_del_time(), cur_time) == 0) { // node has been deleted
-//                toFill.emplace_back(loc, handle, true);
-//            } else {
-//                node_prog::node_cache_context *context = nullptr;
-//                std::vector<node_prog::property> temp_props_added;
-//                std::vector<node_prog::property> temp_props_deleted;
-//
-//                fill_changed_properties(node->base.properties, &temp_props_added, &temp_props_deleted, time_cached, cur_time, time_oracle);
-//                // check for changes to node properties
-//                if (!temp_props_added.empty() || !temp_props_deleted.empty()) {
-//                    toFill.emplace_back(loc, handle, false);
-//                    context = &toFill.back();
-//
-//                    context->props_added = std::move(temp_props_added);
-//                    context->props_deleted = std::move(temp_props_deleted);
-//                    temp_props_added.clear();
-//                    temp_props_deleted.clear();
-//                }
-//                // now check for any edge changes
-//                for (auto &iter: node->out_edges) {
-//                    for (db::edge *e: iter.second) {
-//                        assert(e != nullptr);
-//                        const vclock_ptr_t &e_del_time = e->base.get_del_time();
-//
-//                        bool del_after_cached = (e_del_time != nullptr) && (time_oracle->compare_two_vts(time_cached, *e_del_time) == 0);
-//                        bool creat_after_cached = (time_oracle->compare_two_vts(time_cached, *e->base.get_creat_time()) == 0);
-//
-//                        bool del_before_cur = (e_del_time != nullptr) && (time_oracle->compare_two_vts(*e_del_time, cur_time) == 0);
-//                        bool creat_before_cur = (time_oracle->compare_two_vts(*e->base.get_creat_time(), cur_time) == 0);
-//
-//                        if (creat_after_cached && creat_before_cur && !del_before_cur) {
-//                            if (context == nullptr) {
-//                                toFill.emplace_back(loc, handle, false);
-//                                context = &toFill.back();
-//                            }
-//
-//                            context->edges_added.emplace_back(e->get_handle(), e->nbr);
-//                            node_prog::edge_cache_context &edge_context = context->edges_added.back();
-//                            // don't care about props deleted before req time for an edge created after cache value was stored
-//                            fill_changed_properties(e->base.properties, &edge_context.props_added, nullptr, time_cached, cur_time, time_oracle);
-//                        } else if (del_after_cached && del_before_cur) {
-//                            if (context == nullptr) {
-//                                toFill.emplace_back(loc, handle, false);
-//                                context = &toFill.back();
-//                            }
-//                            context->edges_deleted.emplace_back(e->get_handle(), e->nbr);
-//                            node_prog::edge_cache_context &edge_context = context->edges_deleted.back();
-//                            // don't care about props added after cache time on a deleted edge
-//                            fill_changed_properties(e->base.properties, nullptr, &edge_context.props_deleted, time_cached, cur_time, time_oracle);
-//                        } else if (del_after_cached && !creat_after_cached) {
-//                            // see if any properties changed on edge that didnt change
-//                            fill_changed_properties(e->base.properties, &temp_props_added,
-//                                    &temp_props_deleted, time_cached, cur_time, time_oracle);
-//                            if (!temp_props_added.empty() || !temp_props_deleted.empty()) {
-//                                if (context == nullptr) {
-//                                    toFill.emplace_back(loc, handle, false);
-//                                    context = &toFill.back();
-//                                }
-//                                context->edges_modified.emplace_back(e->get_handle(), e->nbr);
-//
-//                                context->edges_modified.back().props_added = std::move(temp_props_added);
-//                                context->edges_modified.back().props_deleted = std::move(temp_props_deleted);
-//
-//                                temp_props_added.clear();
-//                                temp_props_deleted.clear();
-//                            }
-//                        }
-//                    }
-//                }
-//            }
-//        }
-//        S->release_node(node);
-//    }
-//    return true;
-//}
+inline db::request_states&
+request_states_of(db::node_prog_running_state &np)
+{
+    if (!np.states) {
+        np.states = S->prog_arena.request(np.req_id, *np.req_vclock);
+    }
+    return *np.states;
+}
 
-//void
-//unpack_and_fetch_context(uint64_t tid, db::message_wrapper *request)
-//{
-//    std::vector<node_handle_t> ids;
-//    vc::vclock req_vclock, time_cached;
-//    uint64_t vt_id, req_id, from_shard;
-//    std::tuple<cache_key_t, uint64_t, node_handle_t> cache_tuple;
-//    node_prog::prog_type pType;
-//
-//    request->msg->unpack_message(message::NODE_CONTEXT_FETCH, nullptr, pType, req_id, vt_id, req_vclock, time_cached, cache_tuple, ids, from_shard);
-//    std::vector<node_prog::node_cache_context> contexts;
-//
-//    bool cache_valid = fetch_node_cache_contexts(tid, S->shard_id, ids, contexts, time_cached, req_vclock, request->time_oracle);
-//
-//    message::message m;
-//    m.prepare_message(message::NODE_CONTEXT_REPLY, nullptr, pType, req_id, vt_id, req_vclock, cache_tuple, contexts, cache_valid);
-//    S->comm.send(from_shard, m.buf);
-//    delete request;
-//}
+// state lives in the request's arena on this shard, the node is not touched
+node_prog::Node_State_Base&
+get_state(db::node_prog_running_state &np,
+    const dynamic_prog_table &prog_table,
+    const node_handle_t &handle)
+{
+    return request_states_of(np).get(handle, prog_table);
+}
 
-//template <typename ParamsType, typename NodeStateType, typename CacheValueType>
-//struct fetch_state
-//{
-//    std::shared_ptr<node_prog::node_prog_running_state<ParamsType, NodeStateType, CacheValueType>> prog_state;
-//    po6::threads::mutex monitor;
-//    uint64_t replies_left;
-//    bool cache_valid;
-//
-//    fetch_state(node_prog::node_prog_running_state<ParamsType, NodeStateType, CacheValueType> &copy_from)
-//        : prog_state(new node_prog::node_prog_running_state<ParamsType, NodeStateType, CacheValueType>(copy_from.clone_without_start_node_params()))
-//        , cache_valid(false) { }
-//
-//    // delete standard copy onstructors
-//    fetch_state(const fetch_state&) = delete;
-//    fetch_state& operator=(fetch_state const&) = delete;
-//};
-
-///* precondition: node_to_check is locked when called
-//   returns true if it has updated cached value or there is no valid one and the node prog loop should continue
-//   returns false and frees node if it needs to fetch context on other shards, saves required state to continue node program later
-// */
-//template <typename ParamsType, typename NodeStateType, typename CacheValueType>
-//inline bool cache_lookup(db::node*& node_to_check,
-//    cache_key_t cache_key,
-//    node_prog::node_prog_running_state<ParamsType, NodeStateType, CacheValueType> &np,
-//    std::pair<node_handle_t, ParamsType> &cur_node_params,
-//    order::oracle *time_oracle)
-//{
-//    assert(node_to_check != nullptr);
-//    assert(!np.cache_value); // cache_value is not already assigned
-//    np.cache_value = nullptr; // it is unallocated anyway
-//    if (node_to_check->cache.find(cache_key) == node_to_check->cache.end()) {
-//        return true;
-//    } else {
-//        auto entry = node_to_check->cache[cache_key];
-//        std::shared_ptr<node_prog::Cache_Value_Base> cval = entry.val;
-//        std::shared_ptr<vc::vclock> time_cached(entry.clk);
-//        std::shared_ptr<std::vector<db::remote_node>> watch_set = entry.watch_set;
-//
-//        auto state = get_state_if_exists(*node_to_check, np.req_id, np.m_type);
-//        if (state != nullptr && state->contexts_found.find(np.req_id) != state->contexts_found.end()) {
-//            np.cache_value.reset(new node_prog::cache_response<CacheValueType>(node_to_check->cache, cache_key, cval, watch_set));
-//#ifdef weaver_debug_
-//            S->watch_set_lookups_mutex.lock();
-//            S->watch_set_nops++;
-//            S->watch_set_lookups_mutex.unlock();
-//#endif
-//            return true;
-//        }
-//
-//        int64_t cmp_1 = time_oracle->compare_two_vts(*time_cached, *np.req_vclock);
-//        if (cmp_1 >= 1) { // cached value is newer or from this same request
-//            return true;
-//        }
-//        assert(cmp_1 == 0);
-//
-//        if (watch_set->empty()) { // no context needs to be fetched
-//            np.cache_value.reset(new node_prog::cache_response<CacheValueType>(node_to_check->cache, cache_key, cval, watch_set));
-//            return true;
-//        }
-//
-//        std::tuple<cache_key_t, uint64_t, node_handle_t> cache_tuple(cache_key, np.req_id, node_to_check->get_handle());
-//
-//        S->node_prog_running_states_mutex.lock();
-//        if (S->node_prog_running_states.find(cache_tuple) != S->node_prog_running_states.end()) {
-//            fetch_state<ParamsType, NodeStateType, CacheValueType> *fstate = (fetch_state<ParamsType, NodeStateType, CacheValueType> *)S->node_prog_running_states[cache_tuple];
-//            fstate->monitor.lock(); // maybe move up
-//            S->node_prog_running_states_mutex.unlock();
-//            assert(fstate->replies_left > 0);
-//            fstate->prog_state->start_node_params.push_back(cur_node_params);
-//            fstate->monitor.unlock();
-//
-//            S->release_node(node_to_check);
-//            node_to_check = nullptr;
-//
-//#ifdef weaver_debug_
-//            S->watch_set_lookups_mutex.lock();
-//            S->watch_set_piggybacks++;
-//            S->watch_set_lookups_mutex.unlock();
-//#endif
-//            return false;
-//        }
-//
-//        std::unique_ptr<node_prog::cache_response<CacheValueType>> future_cache_response(
-//                new node_prog::cache_response<CacheValueType>(node_to_check->cache, cache_key, cval, watch_set));
-//        S->release_node(node_to_check);
-//        node_to_check = nullptr;
-//
-//        // add running state to shard global structure while context is being fetched
-//        fetch_state<ParamsType, NodeStateType, CacheValueType> *fstate = new fetch_state<ParamsType, NodeStateType, CacheValueType>(np);
-//        fstate->monitor.lock();
-//        S->node_prog_running_states[cache_tuple] = fstate; 
-//        S->node_prog_running_states_mutex.unlock();
-//
-//#ifdef weaver_debug_
-//        S->watch_set_lookups_mutex.lock();
-//        S->watch_set_lookups++;
-//        S->watch_set_lookups_mutex.unlock();
-//#endif
-//
-//        // map from loc to list of ids on that shard we need context from for this request
-//        std::unordered_map<uint64_t, std::vector<node_handle_t>> contexts_to_fetch; 
-//
-//        for (db::remote_node &watch_node : *watch_set) {
-//            contexts_to_fetch[watch_node.loc].emplace_back(watch_node.handle);
-//        }
-//
-//        fstate->replies_left = contexts_to_fetch.size();
-//        fstate->prog_state->cache_value.swap(future_cache_response);
-//        fstate->prog_state->start_node_params.push_back(cur_node_params);
-//        fstate->cache_valid = true;
-//        assert(fstate->prog_state->start_node_params.size() == 1);
-//        fstate->monitor.unlock();
-//
-//        uint64_t num_shards = get_num_shards();
-//        for (uint64_t i = ShardIdIncr; i < num_shards + ShardIdIncr; i++) {
-//            if (contexts_to_fetch.find(i) != contexts_to_fetch.end()) {
-//                auto &context_list = contexts_to_fetch[i];
-//                assert(context_list.size() > 0);
-//                std::unique_ptr<message::message> m(new message::message());
-//                m->prepare_message(message::NODE_CONTEXT_FETCH, nullptr, np.m_type, np.req_id, np.vt_id, *np.req_vclock, *time_cached, cache_tuple, context_list, S->shard_id);
-//                S->comm.send(i, m->buf);
-//            }
-//        }
-//        return false;
-//    } 
-//}
+// context of the state_accessor handed to typed programs, on the stack for one hop
+struct hop_state_ctx
+{
+    db::node_prog_running_state *np;
+    const dynamic_prog_table *prog_table;
+    const node_handle_t *handle;
+};
+
+node_prog::Node_State_Base&
+get_hop_state(void *ctx)
+{
+    hop_state_ctx *hop = (hop_state_ctx*)ctx;
+    return get_state(*hop->np, *hop->prog_table, *hop->handle);
+}
+
+node_prog::Node_State_Base&
+replica_hop_state(void*)
+{
+    throw db::replica_state_access();
+}
+
+
+
+// check nodes of a cache entry's watch set on this shard, for the shard holding the entry
+void
+unpack_and_fetch_context(uint64_t, db::message_wrapper *request)
+{
+    uint64_t vt_id, token, from_shard;
+    vc::vclock req_vclock, cache_clk;
+    std::vector<node_handle_t> handles;
+    request->msg->unpack_message(message::NODE_CONTEXT_FETCH, nullptr, vt_id, req_vclock, token, cache_clk, handles, from_shard);
+
+    bool unchanged = S->nodes_unchanged_since(handles, cache_clk);
+
+    message::message m;
+    m.prepare_message(message::NODE_CONTEXT_REPLY, nullptr, token, unchanged);
+    S->comm.send(from_shard, m.buf);
+    delete request;
+}
+
+inline void
+erase_cache_entry(db::node *node, const cache_key_t &key, const vclock_ptr_t &clk)
+{
+    node->prog_state_mtx.lock();
+    auto cache_iter = node->cache.find(key);
+    if (cache_iter != node->cache.end() && cache_iter->second.clk == clk) {
+        node->cache.erase(cache_iter);
+    }
+    node->prog_state_mtx.unlock();
+}
+
+// running state for part of np's local frontier, shares everything else of np's request on this shard
+// np stops once any of its pieces has returned to the VT
+inline std::shared_ptr<db::node_prog_running_state>
+new_frontier_piece(db::node_prog_running_state &np)
+{
+    if (!np.frontier_done) {
+        np.frontier_done = std::make_shared<std::atomic<bool>>(false);
+    }
+
+    auto piece = std::make_shared<db::node_prog_running_state>();
+    piece->m_type = np.m_type;
+    piece->m_handle = np.m_handle;
+    piece->vt_id = np.vt_id;
+    piece->req_vclock = np.req_vclock;
+    piece->req_id = np.req_id;
+    piece->vt_prog_ptr = np.vt_prog_ptr;
+    piece->constants = np.constants;
+    piece->states = np.states;
+    piece->frontier_done = np.frontier_done;
+    piece->agg = np.agg;
+    return piece;
+}
+
+/* precondition: node is latched, and is the front of np.start_node_params
+   a valid cached value is handed to params with set_cache_value
+   returns false if the entry has to be validated on other shards first, the node
+   then moves to a new piece of np which runs once all of them have replied
+ */
+inline bool
+cache_lookup(db::node *node,
+             np_param_ptr_t &params,
+             std::shared_ptr<db::node_prog_running_state> &np_ptr)
+{
+    db::node_prog_running_state &np = *np_ptr;
+    const node_handle_t &handle = node->get_handle();
+    cache_key_t key = params->cache_key();
+
+    // resumed after validation on other shards
+    auto verdict_iter = np.cache_verdicts.find(handle);
+    if (verdict_iter != np.cache_verdicts.end()) {
+        db::cache_entry entry = std::move(verdict_iter->second.first);
+        bool valid = verdict_iter->second.second;
+        np.cache_verdicts.erase(verdict_iter);
+        if (valid) {
+            S->prog_cached.hit();
+            params->set_cache_value(entry.val);
+        } else {
+            S->prog_cached.invalidation();
+            erase_cache_entry(node, key, entry.clk);
+        }
+        return true;
+    }
+
+    db::cache_entry entry;
+    node->prog_state_mtx.lock();
+    auto cache_iter = node->cache.find(key);
+    if (cache_iter != node->cache.end()) {
+        entry = cache_iter->second;
+    }
+    node->prog_state_mtx.unlock();
+
+    if (entry.val == nullptr
+     || !order::oracle::happens_before_no_kronos(entry.clk->clock, np.req_vclock->clock)) {
+        S->prog_cached.miss();
+        return true;
+    }
+
+    std::vector<node_handle_t> local_nodes;
+    std::unordered_map<uint64_t, std::vector<node_handle_t>> remote_nodes;
+    for (const db::remote_node &rn: *entry.watch_set) {
+        if (rn.loc == S->shard_id) {
+            local_nodes.emplace_back(rn.handle);
+        } else {
+            remote_nodes[rn.loc].emplace_back(rn.handle);
+        }
+    }
+
+    if (!S->nodes_unchanged_since(local_nodes, *entry.clk)) {
+        S->prog_cached.invalidation();
+        erase_cache_entry(node, key, entry.clk);
+        return true;
+    }
+
+    if (remote_nodes.empty()) {
+        S->prog_cached.hit();
+        params->set_cache_value(entry.val);
+        return true;
+    }
+
+    // the rest of np keeps running while this node waits for replies
+    auto waiting = new_frontier_piece(np);
+    waiting->start_node_params.emplace_back(np.start_node_params.front());
+    waiting->start_node_ids.emplace_back(np.start_node_ids.front());
+
+    uint64_t token = S->prog_cached.start_validation(waiting, handle, entry, remote_nodes.size());
+    for (auto &p: remote_nodes) {
+        message::message m;
+        m.prepare_message(message::NODE_CONTEXT_FETCH, nullptr, np.vt_id, *np.req_vclock, token, *entry.clk, p.second, S->shard_id);
+        S->comm.send(p.first, m.buf);
+    }
+
+    return false;
+}
 
+inline void
+send_prog_batch(uint64_t loc, db::outbox::batch_t &batch)
+{
+    e::packer packer = batch->pack_at(BUSYBEE_HEADER_SIZE);
+    message::pack_buffer(packer, message::NODE_PROG_BATCH);
+    std::auto_ptr<e::buffer> buf(batch.release());
+    S->comm.send(loc, buf);
+}
+
+// under load, node programs of different requests headed to the same shard share a message
+// args are those of a NODE_PROG message for request req_id, packed straight into the outbox batch when coalesced
+template <typename... Args>
+inline void
+send_node_prog(uint64_t loc, uint64_t req_id, void *aux_args, const Args&... args)
+{
+    bool queued = false;
+    db::outbox::batch_t batch;
+    if (OUTBOX_FLUSH_US > 0) {
+        uint64_t frame_sz = message::body_size(message::NODE_PROG, aux_args, args...);
+        auto pack_frame = [&](e::packer &packer) {
+            message::pack_body(packer, message::NODE_PROG, aux_args, args...);
+        };
+        uint64_t now = wclock::weaver_timer().get_time_elapsed();
+        queued = S->prog_outbox.add(loc, req_id, frame_sz, pack_frame, now, batch);
+        if (batch) {
+            send_prog_batch(loc, batch);
+        }
+    }
+
+    if (!queued) {
+        message::message msg;
+        msg.prepare_message(message::NODE_PROG, aux_args, args...);
+        S->comm.send(loc, msg.buf);
+    }
+}
+
+// hops of np which have not run yet, here or at other shards
+inline uint64_t
+pending_hops(db::node_prog_running_state &np)
+{
+    uint64_t hops = np.start_node_params.size();
+    for (auto &p: np.batched_node_progs) {
+        hops += p.second.size();
+    }
+    return hops;
+}
+
+// credit for a message of np's request to another shard
+inline weaver_util::prog_credit_t
+prog_credit(db::node_prog_running_state &np)
+{
+    if (np.agg) {
+        return np.agg->split();
+    } else {
+        return weaver_util::prog_credit_t();
+    }
+}
 
 inline void
 propagate_node_progs(db::node_prog_running_state &np,
@@ -1546,17 +1487,28 @@ propagate_node_progs(db::node_prog_running_state &np,
         prop_progs.erase(prop_progs.begin(), prop_progs.begin() + num_progs);
     }
 
+    // constants go with messages to prop_shard until one carrying them has been sent
+    np_const_ptr_t constants;
+    if (np.constants != nullptr && S->prog_consts.must_send(np.req_id, prop_shard)) {
+        constants = np.constants;
+    }
+
     for (auto &progs: prog_batches) {
-        message::message out_msg;
-        out_msg.prepare_message(message::NODE_PROG,
-                                np.m_handle,
-                                np.m_type,
-                                np.vt_id,
-                                *np.req_vclock,
-                                np.req_id,
-                                np.vt_prog_ptr,
-                                std::move(progs));
-        S->comm.send(prop_shard, out_msg.buf);
+        send_node_prog(prop_shard,
+                       np.req_id,
+                       np.m_handle,
+                       np.m_type,
+                       np.vt_id,
+                       *np.req_vclock,
+                       np.req_id,
+                       np.vt_prog_ptr,
+                       constants,
+                       prog_credit(np),
+                       progs);
+        if (constants != nullptr) {
+            S->prog_consts.mark_sent(np.req_id, prop_shard);
+            constants.reset();
+        }
     }
 }
 
@@ -1816,6 +1768,84 @@ propagate_node_progs(db::node_prog_running_state &np,
 //    WDEBUG << "here node program at node=" << node_handle << std::endl;
 //}
 
+// hand the back of a wide local frontier to idle worker threads
+// visits of one request to a node are serialized by the shared latch, so pieces can share per node state
+inline void
+split_frontier(uint64_t tid, db::node_prog_running_state &np)
+{
+    while (np.start_node_params.size() >= 2*FRONTIER_PIECE_SIZE
+        && S->frontier.pending() < (uint64_t)NUM_SHARD_THREADS) {
+        auto piece = new_frontier_piece(np);
+
+        auto params_begin = np.start_node_params.end() - FRONTIER_PIECE_SIZE;
+        auto ids_begin = np.start_node_ids.end() - FRONTIER_PIECE_SIZE;
+        piece->start_node_params.assign(std::make_move_iterator(params_begin), std::make_move_iterator(np.start_node_params.end()));
+        piece->start_node_ids.assign(ids_begin, np.start_node_ids.end());
+        np.start_node_params.erase(params_begin, np.start_node_params.end());
+        np.start_node_ids.erase(ids_begin, np.start_node_ids.end());
+
+        for (uint64_t i = 0; i < piece->start_node_ids.size(); i++) {
+            if (piece->start_node_ids[i] == db::node_id_table::replica_id) {
+                const node_handle_t &handle = piece->start_node_params[i].first;
+                piece->replica_hops[handle] = np.replica_hops[handle];
+            }
+        }
+
+        S->frontier.push(tid, std::move(piece));
+
+        // some thread blocked in recv picks up the piece
+        message::message msg;
+        msg.prepare_message(message::FRONTIER_PIECE);
+        S->comm.send(S->shard_id, msg.buf);
+    }
+}
+
+// make hops at the same node adjacent in the local frontier, in the order of their first hop
+inline void
+group_by_node(db::node_prog_running_state &np)
+{
+    std::unordered_map<node_handle_t, uint64_t> group_of;
+    std::vector<std::vector<uint64_t>> groups;
+    for (uint64_t i = 0; i < np.start_node_params.size(); i++) {
+        auto iter = group_of.emplace(np.start_node_params[i].first, groups.size()).first;
+        if (iter->second == groups.size()) {
+            groups.emplace_back();
+        }
+        groups[iter->second].emplace_back(i);
+    }
+    if (groups.size() == np.start_node_params.size()) {
+        return;
+    }
+
+    std::deque<std::pair<node_handle_t, np_param_ptr_t>> params;
+    std::deque<uint64_t> ids;
+    for (const std::vector<uint64_t> &g: groups) {
+        for (uint64_t i: g) {
+            params.emplace_back(std::move(np.start_node_params[i]));
+            ids.emplace_back(np.start_node_ids[i]);
+        }
+    }
+    np.start_node_params = std::move(params);
+    np.start_node_ids = std::move(ids);
+}
+
+// params of the hops at the front of the local frontier which can run in one call
+inline void
+take_node_batch(db::node_prog_running_state &np, bool replica, std::vector<np_param_ptr_t> &batch)
+{
+    const node_handle_t &handle = np.start_node_params.front().first;
+    batch.emplace_back(np.start_node_params.front().second);
+    for (uint64_t i = 1; i < np.start_node_params.size() && batch.size() < MAX_NODE_BATCH; i++) {
+        auto &p = np.start_node_params[i];
+        if (p.first != handle
+         || (np.start_node_ids[i] == db::node_id_table::replica_id) != replica
+         || (MaxCacheEntries && p.second->search_cache())) {
+            break;
+        }
+        batch.emplace_back(p.second);
+    }
+}
+
 inline void node_prog_loop(uint64_t tid,
                            std::shared_ptr<db::node_prog_running_state> np_ptr,
                            order::oracle *time_oracle,
@@ -1832,16 +1862,58 @@ inline void node_prog_loop(uint64_t tid,
     bool done_request = false;
     db::remote_node this_node(S->shard_id, "");
 
+    // the local frontier is regrouped by node once it has grown by as much as it had when last grouped
+    dynamic_prog_table *prog_table = (dynamic_prog_table*)prog_handle;
+    bool batching = MAX_NODE_BATCH > 1 && prog_table->node_program != nullptr && prog_table->batch_node_program != nullptr;
+    uint64_t grouped_size = 0, appended = np.start_node_params.size();
+
+    auto release_visit = [&np](db::node *n, bool replica) {
+        if (replica) {
+            S->release_replica_nodeprog(n, np.req_id);
+        } else {
+            S->release_node_nodeprog(n, np.req_id);
+        }
+    };
+
     while (!done_request && !np.start_node_params.empty()) {
+        if (np.frontier_done && np.frontier_done->load(std::memory_order_relaxed)) {
+            // another piece of this frontier, split off or waiting on cache validation, returned to the VT
+            done_request = true;
+            break;
+        }
+
+        if (batching && appended > 0 && appended >= grouped_size) {
+            group_by_node(np);
+            grouped_size = np.start_node_params.size();
+            appended = 0;
+        }
+
         auto &id_params = np.start_node_params.front();
         node_handle = id_params.first;
         np_param_ptr_t params = id_params.second;
+        uint64_t node_id = np.start_node_ids.front();
+        bool replica = (node_id == db::node_id_table::replica_id);
         this_node.handle = node_handle;
+        this_node.id = replica? db::node_id_table::invalid_id : node_id;
+        this_node.loc = S->shard_id;
         //WDEBUG << "thread=" << tid << " exec node prog at node=" << node_handle << std::endl;
 
         db::node *node = nullptr;
 
-        if (first_node != nullptr) {
+        if (replica) {
+            auto hop_iter = np.replica_hops.find(node_handle);
+            assert(hop_iter != np.replica_hops.end());
+            uint64_t owner = hop_iter->second;
+            node = S->acquire_replica_nodeprog(node_handle, *np.req_vclock, np.req_id);
+            if (node == nullptr) {
+                // copy dropped or not valid for this request anymore, hop to the owner
+                np.batched_node_progs[owner].emplace_back(node_handle, params);
+                np.start_node_params.pop_front();
+                np.start_node_ids.pop_front();
+                continue;
+            }
+            this_node.loc = owner;
+        } else if (first_node != nullptr) {
             assert(first_node->get_handle() == node_handle);
             node = first_node;
             first_node = nullptr;
@@ -1851,9 +1923,11 @@ inline void node_prog_loop(uint64_t tid,
             std::shared_ptr<void> np_void = std::static_pointer_cast<void>(np_ptr);
             node = S->acquire_node_nodeprog(tid,
                                             node_handle,
+                                            node_id,
                                             *np.req_vclock,
                                             time_oracle,
                                             np.m_type,
+                                            prog_id,
                                             np_void,
                                             recover);
 
@@ -1864,12 +1938,13 @@ inline void node_prog_loop(uint64_t tid,
                 S->record_node_recovery(prog_id, *np.req_vclock);
                 return;
             }
+            this_node.id = node_id;
         }
 
         if (node == nullptr
          || (node->base.get_del_time() != nullptr && time_oracle->compare_two_vts(*node->base.get_del_time(), *np.req_vclock) == 0)) {
             if (node != nullptr) {
-                S->release_node(node);
+                release_visit(node, replica);
             } else {
                 // node is being migrated here, but not yet completed
                 std::vector<std::pair<node_handle_t, np_param_ptr_t>> buf_node_params;
@@ -1883,6 +1958,8 @@ inline void node_prog_loop(uint64_t tid,
                                    *np.req_vclock,
                                    np.req_id,
                                    np.vt_prog_ptr,
+                                   np.constants,
+                                   prog_credit(np),
                                    buf_node_params);
                 S->migration_mutex.lock();
                 if (S->deferred_reads.find(node_handle) == S->deferred_reads.end()) {
@@ -1893,6 +1970,7 @@ inline void node_prog_loop(uint64_t tid,
                 S->migration_mutex.unlock();
             }
             np.start_node_params.pop_front(); // pop off this one
+            np.start_node_ids.pop_front();
         } else if (node->state == db::node::mode::MOVED) {
             // queueing/forwarding node program
             std::vector<std::pair<node_handle_t, np_param_ptr_t>> fwd_node_params;
@@ -1906,11 +1984,14 @@ inline void node_prog_loop(uint64_t tid,
                                *np.req_vclock,
                                np.req_id,
                                np.vt_prog_ptr,
+                               np.constants,
+                               prog_credit(np),
                                fwd_node_params);
             uint64_t new_loc = node->migration->new_loc;
-            S->release_node(node);
+            S->release_node_nodeprog(node, np.req_id);
             S->comm.send(new_loc, m->buf);
             np.start_node_params.pop_front(); // pop off this one
+            np.start_node_ids.pop_front();
         } else { // node does exist
             assert(node->state == db::node::mode::STABLE);
 #ifdef WEAVER_NEW_CLDG
@@ -1921,18 +2002,42 @@ inline void node_prog_loop(uint64_t tid,
                 }
                 */
 #endif
-            if (S->check_done_prog(*np.req_vclock)) {
+            if (S->check_done_prog(*np.req_vclock, np.req_id)) {
                 done_request = true;
-                S->release_node(node);
+                release_visit(node, replica);
+                S->dropped_hops += pending_hops(np);
                 break;
             }
+            if (MaxCacheEntries && !replica && params->search_cache()
+             && !cache_lookup(node, params, np_ptr)) {
+                // runs once other shards have validated the cached value
+                S->prog_hops++;
+                release_visit(node, replica);
+                np.start_node_params.pop_front();
+                np.start_node_ids.pop_front();
+                continue;
+            }
 
-            dynamic_prog_table *prog_table = (dynamic_prog_table*)prog_handle;
-            node_state_getter = std::bind(get_state,
-                                          prog_table->state_ctor,
-                                          np.req_id,
-                                          node,
-                                          &np.nodes_that_created_state);
+            // hops of this request queued right behind this one at the same node
+            std::vector<np_param_ptr_t> batch;
+            if (batching) {
+                take_node_batch(np, replica, batch);
+            }
+            uint64_t num_hops = batch.empty()? 1 : batch.size();
+            S->prog_hops += num_hops;
+
+            hop_state_ctx state_ctx = { &np, prog_table, &node->get_handle() };
+            node_prog::state_accessor state_acc = { replica? replica_hop_state : get_hop_state, &state_ctx };
+            if (prog_table->typed_node_program == nullptr) {
+                if (replica) {
+                    node_state_getter = []() -> node_prog::Node_State_Base& { throw db::replica_state_access(); };
+                } else if (prog_table->dense_node_program == nullptr) {
+                    node_state_getter = std::bind(get_state,
+                                                  std::ref(np),
+                                                  std::cref(*prog_table),
+                                                  std::cref(node->get_handle()));
+                }
+            }
 
             node->base.view_time = np.req_vclock; 
             node->base.time_oracle = time_oracle;
@@ -1947,13 +2052,62 @@ inline void node_prog_loop(uint64_t tid,
 
             // call node program
             std::pair<node_prog::search_type, std::vector<std::pair<db::remote_node, np_param_ptr_t>>> next_node_params;
-            next_node_params = prog_ptr(*node, this_node, params, node_state_getter);
+            try {
+                if (!batch.empty()) {
+                    next_node_params = prog_table->batch_node_program(*node, this_node, batch, node_state_getter);
+                } else if (prog_table->typed_node_program != nullptr) {
+                    next_node_params = prog_table->typed_node_program(*node, this_node, params, state_acc);
+                } else if (prog_table->dense_node_program == nullptr) {
+                    next_node_params = prog_ptr(*node, this_node, params, node_state_getter);
+                } else if (replica) {
+                    throw db::replica_state_access();
+                } else {
+                    node_prog::dense_node_state &state = request_states_of(np).get_dense(node_id, node_handle);
+                    next_node_params = prog_table->dense_node_program(*node, this_node, params, state);
+                }
+            } catch (db::replica_state_access&) {
+                // program keeps per node state, run it at the owner from now on
+                node->base.view_time = nullptr;
+                node->base.time_oracle = nullptr;
+                release_visit(node, replica);
+                S->mark_replica_unsafe(np.m_type);
+                for (uint64_t i = 0; i < num_hops; i++) {
+                    np.batched_node_progs[this_node.loc].emplace_back(std::move(np.start_node_params.front()));
+                    np.start_node_params.pop_front();
+                    np.start_node_ids.pop_front();
+                }
+                continue;
+            }
 
             node->base.view_time = nullptr; 
             node->base.time_oracle = nullptr;
-            S->release_node(node);
+            if (MaxCacheEntries && !replica) {
+                if (batch.empty()) {
+                    batch.emplace_back(params);
+                }
+                for (np_param_ptr_t &p: batch) {
+                    std::vector<db::remote_node> watch_set;
+                    std::shared_ptr<node_prog::Cache_Value_Base> to_cache = p->take_cache_value(watch_set);
+                    if (to_cache != nullptr) {
+                        node->prog_state_mtx.lock();
+                        node->add_cache_value(np.req_vclock, to_cache,
+                                              std::make_shared<std::vector<db::remote_node>>(std::move(watch_set)),
+                                              p->cache_key());
+                        node->prog_state_mtx.unlock();
+                        S->prog_cached.store();
+                    }
+                }
+            }
+            if (HOT_REPLICA_VISITS > 0 && !replica) {
+                S->note_prog_visit(node);
+            }
+            release_visit(node, replica);
 
-            np.start_node_params.pop_front(); // pop off this one before potentially add new front
+            // pop off these before potentially add new front
+            for (uint64_t i = 0; i < num_hops; i++) {
+                np.start_node_params.pop_front();
+                np.start_node_ids.pop_front();
+            }
 
             // batch the newly generated node programs for onward propagation
 #ifdef WEAVER_CLDG
@@ -1963,20 +2117,43 @@ inline void node_prog_loop(uint64_t tid,
             for (std::pair<db::remote_node, np_param_ptr_t> &res : next_node_params.second) {
                 db::remote_node& rn = res.first; 
                 assert(rn.loc < num_shards + ShardIdIncr);
-                if (rn == db::coordinator || rn.loc == np.vt_id) {
+                if ((rn == db::coordinator || rn.loc == np.vt_id) && np.agg) {
+                    // request goes on, result is sent when this shard has no more work for it
+                    np.agg->add(std::move(res.second));
+                } else if (rn == db::coordinator || rn.loc == np.vt_id) {
                     // mark requests as done, will be done for other shards by no-ops from coordinator
                     done_request = true;
                     // signal to send back to vector timestamper that issued request
                     std::unique_ptr<message::message> m(new message::message());
                     m->prepare_message(message::NODE_PROG_RETURN, prog_handle, np.m_type, np.req_id, np.vt_prog_ptr, res.second);
                     S->comm.send(np.vt_id, m->buf);
+                    if (np.frontier_done) {
+                        np.frontier_done->store(true);
+                    }
                     break; // can only send one message back
                 } else {
-                    std::deque<std::pair<node_handle_t, np_param_ptr_t>> &next_deque = (rn.loc == S->shard_id) ? np.start_node_params : np.batched_node_progs[rn.loc];
+                    bool local = (rn.loc == S->shard_id);
+                    uint64_t next_id = rn.id;
+                    uint64_t owner;
+                    if (!local
+                     && HOT_REPLICA_VISITS > 0
+                     && S->replica_servable(rn.handle, *np.req_vclock, np.m_type, owner)) {
+                        local = true;
+                        next_id = db::node_id_table::replica_id;
+                        np.replica_hops[rn.handle] = owner;
+                    }
+                    std::deque<std::pair<node_handle_t, np_param_ptr_t>> &next_deque = local ? np.start_node_params : np.batched_node_progs[rn.loc];
                     if (next_node_params.first == node_prog::search_type::DEPTH_FIRST) {
                         next_deque.emplace_front(rn.handle, std::move(res.second));
+                        if (local) {
+                            np.start_node_ids.emplace_front(next_id);
+                        }
                     } else { // BREADTH_FIRST
                         next_deque.emplace_back(rn.handle, std::move(res.second));
+                        if (local) {
+                            np.start_node_ids.emplace_back(next_id);
+                            appended++;
+                        }
                     }
 #ifdef WEAVER_CLDG
                     agg_msg_count[node_handle]++;
@@ -1990,6 +2167,13 @@ inline void node_prog_loop(uint64_t tid,
             }
             S->msg_count_mutex.unlock();
 #endif
+
+            if (FRONTIER_PIECE_SIZE > 0
+             && !done_request
+             && next_node_params.first == node_prog::search_type::BREADTH_FIRST
+             && np.start_node_params.size() >= 2*FRONTIER_PIECE_SIZE) {
+                split_frontier(tid, np);
+            }
         }
 
         uint64_t num_shards = get_num_shards();
@@ -1998,10 +2182,6 @@ inline void node_prog_loop(uint64_t tid,
         for (auto &loc_progs_pair : np.batched_node_progs) {
             propagate_node_progs(np, loc_progs_pair.first, num_shards, loc_progs_pair.second);
         }
-
-        if (MaxCacheEntries) {
-            //assert(np.cache_value == false); // unique ptr is not assigned
-        }
     }
 
     uint64_t num_shards = get_num_shards();
@@ -2010,10 +2190,25 @@ inline void node_prog_loop(uint64_t tid,
             propagate_node_progs(np, loc_progs_pair.first, num_shards, loc_progs_pair.second);
         }
     }
+}
 
-    if (!np.nodes_that_created_state.empty()) {
-        S->mark_nodes_using_state(np.req_id, *np.req_vclock, np.nodes_that_created_state);
+// run one piece of a split frontier, false if none are waiting
+bool
+take_frontier_piece(uint64_t tid, order::oracle *time_oracle)
+{
+    std::shared_ptr<db::node_prog_running_state> piece;
+    if (!S->frontier.take(tid, piece)) {
+        return false;
     }
+
+    if (piece->frontier_done->load()) {
+        // nothing
+    } else if (S->check_done_prog(*piece->req_vclock, piece->req_id)) {
+        S->dropped_hops += piece->start_node_params.size();
+    } else {
+        node_prog_loop(tid, piece, time_oracle, nullptr);
+    }
+    return true;
 }
 
 void
@@ -2027,6 +2222,31 @@ continue_execution(uint64_t tid,
     node_prog_loop(tid, np_ptr, time_oracle, first_node);
 }
 
+inline void
+set_prog_constants(db::node_prog_running_state &np)
+{
+    for (auto &p: np.start_node_params) {
+        p.second->set_constants(np.constants);
+    }
+}
+
+// deleter of a prog_aggregate, runs when no piece of the request is left on this shard
+void
+send_prog_partial(db::prog_aggregate *agg)
+{
+    S->prog_aggs.release(agg->req_id);
+
+    message::message msg;
+    if (agg->result == nullptr) {
+        msg.prepare_message(message::NODE_PROG_PARTIAL, nullptr, agg->prog_type, agg->req_id, agg->credit, false);
+    } else {
+        msg.prepare_message(message::NODE_PROG_PARTIAL, agg->prog, agg->prog_type, agg->req_id, agg->credit, true, agg->result);
+    }
+    S->comm.send(agg->vt_id, msg.buf);
+
+    delete agg;
+}
+
 void
 unpack_and_run_db(uint64_t tid, std::unique_ptr<message::message> msg, order::oracle *time_oracle)
 {
@@ -2045,6 +2265,8 @@ unpack_and_run_db(uint64_t tid, std::unique_ptr<message::message> msg, order::or
     assert(np->m_handle != nullptr);
 
     // unpack the node program
+    np_const_ptr_t constants;
+    weaver_util::prog_credit_t credit;
     try {
         np->req_vclock.reset(new vc::vclock());
         msg->unpack_message(message::NODE_PROG,
@@ -2054,8 +2276,12 @@ unpack_and_run_db(uint64_t tid, std::unique_ptr<message::message> msg, order::or
                             *np->req_vclock,
                             np->req_id,
                             np->vt_prog_ptr,
+                            constants,
+                            credit,
                             np->start_node_params);
         assert(np->req_vclock->clock.size() == ClkSz);
+        // internal ids are local to a shard, resolve handles on first hop
+        np->start_node_ids.assign(np->start_node_params.size(), db::node_id_table::invalid_id);
     } catch (std::bad_alloc &ba) {
         WDEBUG << "bad_alloc caught " << ba.what() << std::endl;
         assert(false);
@@ -2070,11 +2296,35 @@ unpack_and_run_db(uint64_t tid, std::unique_ptr<message::message> msg, order::or
     S->migration_mutex.unlock();
 
     // check if request completed
-    if (S->check_done_prog(*np->req_vclock)) {
+    if (S->check_done_prog(*np->req_vclock, np->req_id)) {
+        S->dropped_hops += np->start_node_params.size();
         return; // done request
     }
 
-    //assert(!np->cache_value); // a cache value should not be allocated yet
+    dynamic_prog_table *prog_table = (dynamic_prog_table*)np->m_handle;
+    if (prog_table->merge_results != nullptr && prog_table->bsp_node_program == nullptr) {
+        np->agg = S->prog_aggs.join(np->req_id, credit, [&np, prog_table]() {
+            auto agg = new db::prog_aggregate(np->req_id, np->vt_id, np->m_type, prog_table);
+            return std::shared_ptr<db::prog_aggregate>(agg, send_prog_partial);
+        });
+    }
+
+    if (prog_table->const_ctor != nullptr) {
+        std::vector<std::shared_ptr<db::node_prog_running_state>> ready;
+        bool found = S->prog_consts.attach(np, std::move(constants), ready);
+
+        // programs that arrived before the constants of their request
+        for (auto &waiting_np: ready) {
+            set_prog_constants(*waiting_np);
+            node_prog_loop(tid, waiting_np, time_oracle, nullptr);
+        }
+
+        if (!found) {
+            return; // runs when the constants arrive
+        }
+        set_prog_constants(*np);
+    }
+
     node_prog_loop(tid, np, time_oracle, nullptr);
 }
 
@@ -2085,74 +2335,311 @@ unpack_node_program(uint64_t tid, db::message_wrapper *request)
     delete request;
 }
 
-//void
-//unpack_context_reply(uint64_t tid, db::message_wrapper *request)
-//{
-//    node_prog::prog_type pType;
-//
-//    request->msg->unpack_partial_message(message::NODE_CONTEXT_REPLY, pType);
-//    assert(node_prog::programs.find(pType) != node_prog::programs.end());
-//    node_prog::programs[pType]->unpack_context_reply_db(tid, std::move(request->msg), request->time_oracle);
-//    delete request;
-//}
+// last reply for a cache validation resumes the node program waiting on it
+void
+unpack_context_reply(uint64_t tid, std::unique_ptr<message::message> msg, order::oracle *time_oracle)
+{
+    uint64_t token;
+    bool unchanged;
+    msg->unpack_message(message::NODE_CONTEXT_REPLY, nullptr, token, unchanged);
 
-//template <typename ParamsType, typename NodeStateType, typename CacheValueType>
-//void
-//node_prog
-//    :: particular_node_program<ParamsType, NodeStateType, CacheValueType>
-//    :: unpack_context_reply_db(uint64_t tid,
-//                               std::unique_ptr<message::message> msg,
-//                               order::oracle *time_oracle)
-//{
-//    vc::vclock req_vclock;
-//    node_prog::prog_type pType;
-//    uint64_t req_id, vt_id;
-//    std::tuple<cache_key_t, uint64_t, node_handle_t> cache_tuple;
-//    std::vector<node_prog::node_cache_context> contexts_to_add; 
-//    bool cache_valid;
-//    msg->unpack_message(message::NODE_CONTEXT_REPLY, nullptr, pType, req_id, vt_id, req_vclock,
-//            cache_tuple, contexts_to_add, cache_valid);
-//
-//    S->node_prog_running_states_mutex.lock();
-//    auto lookup_iter = S->node_prog_running_states.find(cache_tuple);
-//    assert(lookup_iter != S->node_prog_running_states.end());
-//    struct fetch_state<ParamsType, NodeStateType, CacheValueType> *fstate = (struct fetch_state<ParamsType, NodeStateType, CacheValueType> *) lookup_iter->second;
-//    fstate->monitor.lock();
-//    fstate->replies_left--;
-//    bool run_now = fstate->replies_left == 0;
-//    if (run_now) {
-//        //remove from map
-//        size_t num_erased = S->node_prog_running_states.erase(cache_tuple);
-//        assert(num_erased == 1);
-//        UNUSED(num_erased); // if asserts are off
-//    }
-//    S->node_prog_running_states_mutex.unlock();
-//
-//    auto& existing_context = fstate->prog_state->cache_value->get_context();
-//
-//    if (fstate->cache_valid) {
-//        if (cache_valid) {
-//            existing_context.insert(existing_context.end(), contexts_to_add.begin(), contexts_to_add.end()); // XXX try to avoid copy here
-//        } else {
-//            // invalidate cache
-//            existing_context.clear();
-//            assert(fstate->prog_state->cache_value != nullptr);
-//            fstate->prog_state->cache_value->invalidate();
-//            fstate->prog_state->cache_value.reset(nullptr); // clear cached value
-//            fstate->cache_valid = false;
-//        }
-//    }
-//
-//    if (run_now) {
-//        //fstate->prog_state->m_func = m_func;
-//        node_prog_loop<ParamsType, NodeStateType, CacheValueType>(tid, fstate->prog_state, time_oracle, nullptr);
-//        fstate->monitor.unlock();
-//        delete fstate;
-//    }
-//    else {
-//        fstate->monitor.unlock();
-//    }
-//}
+    std::shared_ptr<db::node_prog_running_state> np;
+    if (S->prog_cached.validation_reply(token, unchanged, np)
+     && !np->frontier_done->load()
+     && !S->check_done_prog(*np->req_vclock, np->req_id)) {
+        node_prog_loop(tid, np, time_oracle, nullptr);
+    }
+}
+
+// whole graph node programs, see db/bsp_job.h
+
+inline dynamic_prog_table*
+find_prog(const std::string &prog_type)
+{
+    dynamic_prog_table *prog = nullptr;
+    S->m_dyn_prog_mtx.lock();
+    auto prog_iter = S->m_dyn_prog_map.find(prog_type);
+    if (prog_iter != S->m_dyn_prog_map.end()) {
+        prog = prog_iter->second.get();
+    }
+    S->m_dyn_prog_mtx.unlock();
+
+    assert(prog != nullptr);
+    return prog;
+}
+
+// fold the value of every node into this shard's result, and send it to the VT
+void
+send_bsp_result(db::bsp_job &job)
+{
+    np_param_ptr_t result;
+    db::remote_node rn(S->shard_id, "");
+    for (uint32_t i = 0; i < job.handles.size(); i++) {
+        if (job.values[i]) {
+            rn.handle = job.handles[i];
+            rn.id = job.ids[i];
+            job.prog->bsp_result(rn, job.global, *job.values[i], result);
+        }
+    }
+
+    message::message m;
+    if (result == nullptr) {
+        m.prepare_message(message::BSP_RESULT, nullptr, job.prog_type, job.req_id, false);
+    } else {
+        m.prepare_message(message::BSP_RESULT, job.prog, job.prog_type, job.req_id, true, result);
+    }
+    S->comm.send(job.vt_id, m.buf);
+    S->bsp.finish(job.req_id);
+}
+
+// run the program at every node which has not voted to halt or has messages
+void
+run_superstep(uint64_t tid, db::bsp_job &job, db::bsp_msgs_t &arrived, order::oracle *time_oracle)
+{
+    uint32_t step = job.next;
+    dynamic_prog_table *prog = job.prog;
+    uint64_t num_nodes = job.handles.size();
+
+    for (auto &p: arrived) {
+        uint32_t idx = job.local_index(db::node_id_table::invalid_id, p.first);
+        if (idx != UINT32_MAX) {
+            job.deliver(idx, std::move(p.second));
+        }
+    }
+    arrived.clear();
+
+    // messages sent in this superstep go to the next one
+    std::vector<std::vector<np_param_ptr_t>> incoming(num_nodes);
+    incoming.swap(job.inbox);
+
+    uint64_t active = 0, sent = 0;
+    std::unordered_map<uint64_t, db::bsp_msgs_t> out_remote;
+    std::unordered_map<uint64_t, std::unordered_map<node_handle_t, uint64_t>> out_pos; // for combining
+    std::vector<std::pair<db::remote_node, np_param_ptr_t>> outgoing;
+    std::shared_ptr<vc::vclock> view_clk = std::make_shared<vc::vclock>(job.clk);
+    db::remote_node this_node(S->shard_id, "");
+
+    for (uint32_t i = 0; i < num_nodes; i++) {
+        if (step > 0 && job.halted[i] && incoming[i].empty()) {
+            continue;
+        }
+
+        db::node *node = S->acquire_node_bsp(tid, job.handles[i], job.ids[i], job.clk, time_oracle, job.req_id);
+        if (node == nullptr) {
+            // created after the request, or deleted before it
+            job.halted[i] = true;
+            continue;
+        }
+        if (node->state == db::node::mode::MOVED) {
+            // runs at the shard it moved to
+            S->release_node_nodeprog(node, job.req_id);
+            job.halted[i] = true;
+            continue;
+        }
+
+        if (!job.values[i]) {
+            job.values[i] = prog->state_ctor();
+        }
+        this_node.handle = job.handles[i];
+        this_node.id = job.ids[i];
+
+        node->base.view_time = view_clk;
+        node->base.time_oracle = time_oracle;
+        job.halted[i] = prog->bsp_node_program(*node, this_node, step, job.global, incoming[i], *job.values[i], outgoing);
+        node->base.view_time = nullptr;
+        node->base.time_oracle = nullptr;
+        S->release_node_nodeprog(node, job.req_id);
+        incoming[i].clear();
+
+        if (!job.halted[i]) {
+            active++;
+        }
+        sent += outgoing.size();
+
+        for (auto &p: outgoing) {
+            db::remote_node &rn = p.first;
+            if (rn.loc == S->shard_id) {
+                uint32_t idx = job.local_index(rn.id, rn.handle);
+                if (idx != UINT32_MAX) {
+                    job.deliver(idx, std::move(p.second));
+                }
+                continue;
+            }
+
+            db::bsp_msgs_t &msgs = out_remote[rn.loc];
+            if (prog->bsp_combine != nullptr) {
+                std::unordered_map<node_handle_t, uint64_t> &pos = out_pos[rn.loc];
+                auto pos_iter = pos.find(rn.handle);
+                if (pos_iter != pos.end()) {
+                    prog->bsp_combine(msgs[pos_iter->second].second, std::move(p.second));
+                    continue;
+                }
+                pos.emplace(rn.handle, msgs.size());
+            }
+            msgs.emplace_back(rn.handle, std::move(p.second));
+        }
+        outgoing.clear();
+    }
+
+    // every other shard waits for one message from this shard, even if empty
+    message::message m;
+    for (uint64_t loc = ShardIdIncr; loc < ShardIdIncr + job.num_shards; loc++) {
+        if (loc != S->shard_id) {
+            m.prepare_message(message::BSP_MSGS, prog, job.prog_type, job.req_id, job.clk, step+1, out_remote[loc]);
+            S->comm.send(loc, m.buf);
+        }
+    }
+
+    job.mtx.lock();
+    job.next = step+1;
+    job.running = false;
+    job.mtx.unlock();
+
+    m.prepare_message(message::BSP_STEP_DONE, nullptr, job.req_id, step, active, sent);
+    S->comm.send(job.vt_id, m.buf);
+}
+
+// run the next superstep or send the result, if this thread gets to
+void
+try_run_bsp(uint64_t tid, std::shared_ptr<db::bsp_job> job, order::oracle *time_oracle)
+{
+    db::bsp_msgs_t arrived;
+
+    job->mtx.lock();
+    bool finish = job->claim_finish();
+    bool run = !finish && job->claim(arrived);
+    job->mtx.unlock();
+
+    if (finish) {
+        send_bsp_result(*job);
+    } else if (run) {
+        run_superstep(tid, *job, arrived, time_oracle);
+    }
+}
+
+// list the nodes of this shard and run the first superstep
+void
+unpack_bsp_prog(uint64_t tid, db::message_wrapper *request)
+{
+    std::unique_ptr<message::message> msg = std::move(request->msg);
+    order::oracle *time_oracle = request->time_oracle;
+    delete request;
+
+    std::string prog_type;
+    msg->unpack_partial_message(message::BSP_PROG, prog_type);
+    dynamic_prog_table *prog = find_prog(prog_type);
+
+    uint64_t vt_id, req_id, vt_prog_ptr, num_shards;
+    vc::vclock clk;
+    np_param_ptr_t global;
+    msg->unpack_message(message::BSP_PROG, prog, prog_type, vt_id, clk, req_id, vt_prog_ptr, num_shards, global);
+    assert(prog->bsp_node_program != nullptr);
+
+    std::shared_ptr<db::bsp_job> job = S->bsp.get(req_id, clk);
+    assert(job);
+
+    // nodes created after clk are listed too, and skipped when the program runs
+    for (uint64_t map_idx = 0; map_idx < NUM_NODE_MAPS; map_idx++) {
+        S->node_map_mutexes[map_idx].lock();
+        for (const auto &p: S->nodes[map_idx]) {
+            job->add_node(p.first, p.second->id);
+        }
+        S->node_map_mutexes[map_idx].unlock();
+    }
+    uint64_t num_nodes = job->handles.size();
+    job->values.resize(num_nodes);
+    job->halted.assign(num_nodes, false);
+    job->inbox.resize(num_nodes);
+
+    job->mtx.lock();
+    job->prog_type = prog_type;
+    job->prog = prog;
+    job->vt_id = vt_id;
+    job->vt_prog_ptr = vt_prog_ptr;
+    job->num_shards = num_shards;
+    job->global = global;
+    job->started = true;
+    job->mtx.unlock();
+
+    try_run_bsp(tid, job, time_oracle);
+}
+
+// first superstep reads at the request clock, like any node program
+void
+receive_bsp_prog(uint64_t thread_id, std::unique_ptr<message::message> msg, order::oracle *time_oracle)
+{
+    std::string prog_type;
+    uint64_t vt_id;
+    vc::vclock vclk;
+    msg->unpack_partial_message(message::BSP_PROG, prog_type, vt_id, vclk);
+    assert(vclk.clock.size() == ClkSz);
+
+    db::message_wrapper *mwrap = new db::message_wrapper(message::BSP_PROG, std::move(msg));
+    if (S->qm.check_rd_request(vclk.clock)) {
+        mwrap->time_oracle = time_oracle;
+        unpack_bsp_prog(thread_id, mwrap);
+    } else {
+        db::queued_request *qreq = new db::queued_request(vclk.get_clock(), vclk, unpack_bsp_prog, mwrap, db::NODE_PROG);
+        S->qm.enqueue_read_request(vt_id, qreq);
+    }
+}
+
+// messages from another shard for a superstep
+void
+receive_bsp_msgs(uint64_t tid, std::unique_ptr<message::message> msg, order::oracle *time_oracle)
+{
+    std::string prog_type;
+    msg->unpack_partial_message(message::BSP_MSGS, prog_type);
+    dynamic_prog_table *prog = find_prog(prog_type);
+
+    uint64_t req_id;
+    vc::vclock clk;
+    uint32_t step;
+    db::bsp_msgs_t msgs;
+    msg->unpack_message(message::BSP_MSGS, prog, prog_type, req_id, clk, step, msgs);
+
+    std::shared_ptr<db::bsp_job> job = S->bsp.get(req_id, clk);
+    if (!job) {
+        return; // sent in the last superstep
+    }
+
+    job->mtx.lock();
+    auto &step_msgs = job->remote[step];
+    step_msgs.first++;
+    if (step_msgs.second.empty()) {
+        step_msgs.second = std::move(msgs);
+    } else {
+        step_msgs.second.insert(step_msgs.second.end(),
+                                std::make_move_iterator(msgs.begin()),
+                                std::make_move_iterator(msgs.end()));
+    }
+    job->mtx.unlock();
+
+    try_run_bsp(tid, job, time_oracle);
+}
+
+// VT heard from all shards, start the next superstep or finish
+void
+bsp_step(uint64_t tid, std::unique_ptr<message::message> msg, order::oracle *time_oracle)
+{
+    uint64_t req_id;
+    uint32_t step;
+    bool finish;
+    msg->unpack_message(message::BSP_STEP, nullptr, req_id, step, finish);
+
+    std::shared_ptr<db::bsp_job> job = S->bsp.find(req_id);
+    assert(job);
+
+    job->mtx.lock();
+    if (finish) {
+        job->finish = true;
+    } else if (step > job->allowed) {
+        job->allowed = step;
+    }
+    job->mtx.unlock();
+
+    try_run_bsp(tid, job, time_oracle);
+}
 
 inline uint64_t
 get_balanced_assignment(std::vector<uint64_t> &shard_node_count, std::vector<uint32_t> &max_indices)
@@ -2216,16 +2703,7 @@ migrate_node_step1(uint64_t tid, db::node *n,
     S->migr_node = n->get_handle();
     S->migr_shard = migr_loc;
 
-    // XXX updating edge map
-    //S->edge_map_mutex.lock();
-    //for (auto &x: n->out_edges) {
-    //    for (db::edge *e: x.second) {
-    //        const node_handle_t &remote_node = e->nbr.handle;
-    //        node_version_t local_node = std::make_pair(S->migr_node, e->base.get_creat_time());
-    //        S->remove_from_edge_map(remote_node, local_node);
-    //    }
-    //}
-    //S->edge_map_mutex.unlock();
+    S->in_edge_node_moved(S->migr_node, migr_loc);
 
     S->release_node(n);
 
@@ -2287,20 +2765,14 @@ migrate_node_step2_resp(uint64_t tid, std::unique_ptr<message::message> msg, ord
         return;
     }
 
-    // XXX updating edge map
-    //S->edge_map_mutex.lock();
-    //for (auto &x: n->out_edges) {
-    //    for (db::edge *e: x.second) {
-    //        const node_handle_t &remote_node = e->nbr.handle;
-    //        S->edge_map[remote_node].emplace(std::make_pair(node_handle, e->base.get_creat_time()));
-    //    }
-    //}
-    //S->edge_map_mutex.unlock();
+    S->in_edge_node_arrived(n);
 
     S->migration_mutex.lock();
     // apply buffered writes
+    vclock_ptr_t last_write_clk;
     if (S->deferred_writes.find(node_handle) != S->deferred_writes.end()) {
         for (auto &dw: S->deferred_writes[node_handle]) {
+            last_write_clk = dw.vclk;
             switch (dw.type) {
                 case transaction::NODE_DELETE_REQ:
                     S->delete_node_nonlocking(n, dw.vclk);
@@ -2321,13 +2793,31 @@ migrate_node_step2_resp(uint64_t tid, std::unique_ptr<message::message> msg, ord
         S->deferred_writes.erase(node_handle);
     }
 
-    // update nbrs
+    // update nbrs, in-neighbors of the node point their edges here and out-neighbors their in edges
+    uint64_t num_shards = S->migr_edge_acks.size();
+    std::vector<std::vector<node_handle_t>> srcs(num_shards), dsts(num_shards);
+    for (uint64_t i = 0; i < n->in_edges.size(); i++) {
+        const db::remote_node &src = n->in_edges.at(i).get_neighbor();
+        srcs[src.loc - ShardIdIncr].emplace_back(src.handle);
+    }
+    db::adjacency &adj = n->out_adjacency;
+    for (uint64_t i = 0; i < adj.size(); i++) {
+        dsts[adj.nbr_loc(i) - ShardIdIncr].emplace_back(adj.at(i)->nbr.handle);
+    }
+    for (uint64_t i = 0; i < num_shards; i++) {
+        std::sort(srcs[i].begin(), srcs[i].end());
+        srcs[i].erase(std::unique(srcs[i].begin(), srcs[i].end()), srcs[i].end());
+        std::sort(dsts[i].begin(), dsts[i].end());
+        dsts[i].erase(std::unique(dsts[i].begin(), dsts[i].end()), dsts[i].end());
+    }
+
     S->migr_updating_nbrs = true;
-    for (uint64_t upd_shard = ShardIdIncr; upd_shard < ShardIdIncr + S->migr_edge_acks.size(); upd_shard++) {
+    for (uint64_t upd_shard = ShardIdIncr; upd_shard < ShardIdIncr + num_shards; upd_shard++) {
         if (upd_shard == shard_id) {
             continue;
         }
-        msg->prepare_message(message::MIGRATED_NBR_UPDATE, nullptr, node_handle, from_loc, shard_id);
+        msg->prepare_message(message::MIGRATED_NBR_UPDATE, nullptr, node_handle, from_loc, shard_id,
+            srcs[upd_shard - ShardIdIncr], dsts[upd_shard - ShardIdIncr]);
         S->comm.send(upd_shard, msg->buf);
     }
     n->state = db::node::mode::STABLE;
@@ -2341,7 +2831,11 @@ migrate_node_step2_resp(uint64_t tid, std::unique_ptr<message::message> msg, ord
 
     // release node for new reads and writes
     std::vector<node_version_t> this_node_vec(1, std::make_pair(node_handle, n->base.get_creat_time()));
-    S->release_node(n);
+    if (last_write_clk) {
+        S->release_node_write(n, last_write_clk);
+    } else {
+        S->release_node(n);
+    }
 
     //for (uint64_t req_id: prog_state_reqs) {
     //    //XXX migration need req_vclock S->mark_nodes_using_state(req_id, this_node_vec);
@@ -2356,7 +2850,7 @@ migrate_node_step2_resp(uint64_t tid, std::unique_ptr<message::message> msg, ord
     S->migration_mutex.unlock();
 
     // update local nbrs
-    S->update_migrated_nbr(node_handle, from_loc, shard_id);
+    S->update_migrated_nbr(tid, node_handle, from_loc, shard_id, srcs[shard_id - ShardIdIncr], dsts[shard_id - ShardIdIncr]);
 
     // apply buffered reads
     for (auto &m: deferred_reads) {
@@ -2432,13 +2926,12 @@ cldg_migration_wrapper(uint64_t tid, std::vector<uint64_t> &shard_node_count, ui
             cnt = 0;
         }
 
-        db::edge *e;
         // get aggregate msg counts per shard
         //std::vector<uint64_t> msg_count(NumShards, 0);
-        for (auto &e_iter: n->out_edges) {
-            e = e_iter.second;
-            //msg_count[e->nbr.loc - ShardIdIncr] += e->msg_count;
-            n->migration->msg_count[e->nbr.loc - ShardIdIncr] += e->msg_count;
+        db::adjacency &adj = n->out_adjacency;
+        for (uint64_t i = 0; i < adj.size(); i++) {
+            //msg_count[adj.nbr_loc(i) - ShardIdIncr] += adj.at(i)->msg_count;
+            n->migration->msg_count[adj.nbr_loc(i) - ShardIdIncr] += adj.at(i)->msg_count;
         }
         // EWMA update to msg count
         //for (uint64_t i = 0; i < NumShards; i++) {
@@ -2480,10 +2973,9 @@ ldg_migration_wrapper(uint64_t tid, std::vector<uint64_t> &shard_node_count, uin
         }
 
         // regular LDG
-        for (auto &e_iter: n->out_edges) {
-            for (db::edge *e: e_iter.second) {
-                n->migration->migr_score[e->nbr.loc - ShardIdIncr] += 1;
-            }
+        db::adjacency &adj = n->out_adjacency;
+        for (uint64_t i = 0; i < adj.size(); i++) {
+            n->migration->migr_score[adj.nbr_loc(i) - ShardIdIncr] += 1;
         }
         for (uint64_t j = 0; j < migr_num_shards; j++) {
             n->migration->migr_score[j] *= (1 - ((double)shard_node_count[j])/shard_cap);
@@ -2647,16 +3139,51 @@ block_signals()
     return true;
 }
 
+// run node program now if reads at its clock can go through, else queue it
+void
+receive_node_prog(uint64_t thread_id, std::unique_ptr<message::message> msg, order::oracle *time_oracle)
+{
+    std::string prog_type;
+    uint64_t vt_id, req_id;
+    vc::vclock vclk;
+    msg->unpack_partial_message(message::NODE_PROG, prog_type, vt_id, vclk, req_id);
+    assert(vclk.clock.size() == ClkSz);
+
+    db::message_wrapper *mwrap = new db::message_wrapper(message::NODE_PROG, std::move(msg));
+    if (S->qm.check_rd_request(vclk.clock)) {
+        mwrap->time_oracle = time_oracle;
+        unpack_node_program(thread_id, mwrap);
+    } else {
+        db::queued_request *qreq = new db::queued_request(vclk.get_clock(), vclk, unpack_node_program, mwrap, db::NODE_PROG);
+        qreq->req_id = req_id;
+        S->qm.enqueue_read_request(vt_id, qreq);
+    }
+}
+
+// VT returned the request to the client, drop its work here without waiting for the done clock
+void
+cancel_node_prog(std::unique_ptr<message::message> msg)
+{
+    uint64_t req_id;
+    vc::vclock vclk;
+    msg->unpack_message(message::NODE_PROG_CANCEL, nullptr, req_id, vclk);
+
+    if (S->cancel_prog(vclk, req_id)) {
+        S->dropped_queued += S->qm.drop_queued_reads(vclk.vt_id, req_id);
+        // frames still waiting in the outbox would only be dropped at their destination
+        S->prog_outbox.drop(req_id);
+    }
+}
+
 // server busybee msg recv loop for the shard server
 void
 server_loop_busybee(uint64_t thread_id)
 {
-    uint64_t vt_id, req_id;
+    uint64_t vt_id;
     enum message::msg_type mtype;
     std::unique_ptr<message::message> rec_msg;
     db::queued_request *qreq;
     db::message_wrapper *mwrap;
-    std::string prog_type;
     vc::vclock vclk;
     uint64_t qts;
     transaction::tx_type txtype;
@@ -2759,42 +3286,39 @@ server_loop_busybee(uint64_t thread_id)
                 break;
             }
 
-            case message::NODE_PROG: {
-                rec_msg->unpack_partial_message(message::NODE_PROG, prog_type, vt_id, vclk, req_id);
-                assert(vclk.clock.size() == ClkSz);
+            case message::NODE_PROG:
+                receive_node_prog(thread_id, std::move(rec_msg), time_oracle);
+                break;
 
+            case message::NODE_PROG_BATCH: {
+                uint64_t header_sz = BUSYBEE_HEADER_SIZE + message::size(message::NODE_PROG_BATCH);
+                db::outbox::for_each_frame(*rec_msg->buf, header_sz, [&](const uint8_t *frame, uint64_t frame_sz) {
+                    std::unique_ptr<message::message> prog_msg(new message::message(message::NODE_PROG));
+                    prog_msg->buf.reset(e::buffer::create(BUSYBEE_HEADER_SIZE + frame_sz));
+                    prog_msg->buf->pack_at(BUSYBEE_HEADER_SIZE).copy(e::slice(frame, frame_sz));
+                    receive_node_prog(thread_id, std::move(prog_msg), time_oracle);
+                });
+                break;
+            }
+
+            case message::NODE_CONTEXT_FETCH: {
+                rec_msg->unpack_partial_message(message::NODE_CONTEXT_FETCH, vt_id, vclk);
+                assert(vclk.clock.size() == ClkSz);
                 mwrap = new db::message_wrapper(mtype, std::move(rec_msg));
                 if (S->qm.check_rd_request(vclk.clock)) {
                     mwrap->time_oracle = time_oracle;
-                    unpack_node_program(thread_id, mwrap);
+                    unpack_and_fetch_context(thread_id, mwrap);
                 } else {
-                    qreq = new db::queued_request(vclk.get_clock(), vclk, unpack_node_program, mwrap, db::NODE_PROG);
+                    // writes before the request must be applied first
+                    qreq = new db::queued_request(vclk.get_clock(), vclk, unpack_and_fetch_context, mwrap, db::OTHER);
                     S->qm.enqueue_read_request(vt_id, qreq);
                 }
                 break;
             }
 
-            case message::NODE_CONTEXT_FETCH:
-            case message::NODE_CONTEXT_REPLY: {
-                assert(false);
-                //void (*f)(uint64_t, db::message_wrapper*);
-                //if (mtype == message::NODE_CONTEXT_FETCH) {
-                //    f = unpack_and_fetch_context;
-                //} else { // NODE_CONTEXT_REPLY
-                //    f = unpack_context_reply;
-                //}
-                //rec_msg->unpack_partial_message(mtype, prog_type, req_id, vt_id, vclk);
-                //assert(vclk.clock.size() == ClkSz);
-                //mwrap = new db::message_wrapper(mtype, std::move(rec_msg));
-                //if (S->qm.check_rd_request(vclk.clock)) {
-                //    mwrap->time_oracle = time_oracle;
-                //    f(thread_id, mwrap);
-                //} else {
-                //    qreq = new db::queued_request(vclk.get_clock(), vclk, f, mwrap);
-                //    S->qm.enqueue_read_request(vt_id, qreq);
-                //}
+            case message::NODE_CONTEXT_REPLY:
+                unpack_context_reply(thread_id, std::move(rec_msg), time_oracle);
                 break;
-            }
 
             case message::MIGRATE_SEND_NODE:
             case message::MIGRATED_NBR_UPDATE:
@@ -2804,6 +3328,52 @@ server_loop_busybee(uint64_t thread_id)
                 unpack_migrate_request(thread_id, mwrap);
                 break;
 
+            case message::REPLICA_PUSH:
+                S->install_replica(*rec_msg);
+                break;
+
+            case message::REPLICA_EXTEND:
+                S->extend_replicas(*rec_msg);
+                break;
+
+            case message::REPLICA_DROP:
+                S->drop_replicas(*rec_msg);
+                break;
+
+            case message::FRONTIER_PIECE:
+                // pieces are taken below
+                break;
+
+            case message::NODE_PROG_CANCEL:
+                cancel_node_prog(std::move(rec_msg));
+                break;
+
+            case message::IN_EDGE_UPDATES: {
+                std::vector<db::in_edge_update> updates;
+                rec_msg->unpack_message(message::IN_EDGE_UPDATES, nullptr, updates);
+                S->apply_in_edge_updates(thread_id, updates);
+                break;
+            }
+
+            case message::IN_EDGE_RESYNC: {
+                uint64_t from;
+                rec_msg->unpack_message(message::IN_EDGE_RESYNC, nullptr, from);
+                S->resync_in_edges(thread_id, from);
+                break;
+            }
+
+            case message::BSP_PROG:
+                receive_bsp_prog(thread_id, std::move(rec_msg), time_oracle);
+                break;
+
+            case message::BSP_MSGS:
+                receive_bsp_msgs(thread_id, std::move(rec_msg), time_oracle);
+                break;
+
+            case message::BSP_STEP:
+                bsp_step(thread_id, std::move(rec_msg), time_oracle);
+                break;
+
             case message::MIGRATION_TOKEN:
                 S->migration_mutex.lock();
                 rec_msg->unpack_message(mtype, nullptr, S->migr_token_hops, S->migr_num_shards, S->migr_vt);
@@ -2866,6 +3436,7 @@ server_loop_busybee(uint64_t thread_id)
         // execute all queued requests that can be executed now
         // will break from loop when no more requests can be executed, in which case we need to recv
         while (S->qm.exec_queued_request(thread_id, time_oracle));
+        while (take_frontier_piece(thread_id, time_oracle));
     }
 }
 
@@ -2883,6 +3454,25 @@ server_loop_hyperdex(uint64_t thread_id)
     }
 }
 
+// sends batches which have waited for OUTBOX_FLUSH_US, sleeps while the outbox is empty
+void*
+outbox_flush_loop(void*)
+{
+    if (!block_signals()) {
+        return nullptr;
+    }
+
+    std::vector<std::pair<uint64_t, db::outbox::batch_t>> batches;
+    while (S->prog_outbox.wait_expired(batches)) {
+        for (auto &p: batches) {
+            send_prog_batch(p.first, p.second);
+        }
+        batches.clear();
+    }
+
+    return nullptr;
+}
+
 #ifdef weaver_async_node_recover_
 void*
 server_loop(void *args)
@@ -3079,6 +3669,12 @@ init_worker_threads(std::vector<std::shared_ptr<pthread_t>> &threads)
         assert(rc == 0);
         threads.emplace_back(t);
     }
+    if (OUTBOX_FLUSH_US > 0) {
+        std::shared_ptr<pthread_t> t(new pthread_t());
+        int rc = pthread_create(t.get(), nullptr, &outbox_flush_loop, nullptr);
+        assert(rc == 0);
+        threads.emplace_back(t);
+    }
     S->pause_bb = true;
 }
 
@@ -3301,8 +3897,22 @@ main(int argc, const char *argv[])
 
             bulk_load_threads.clear();
 
+            S->resolve_local_nbr_ids();
+
             load_time = timer.get_time_elapsed() - load_time;
             WDEBUG << "Completed bulk load at this shard, time taken=" << load_time/MEGA << " ms." << std::endl;
+            uint64_t clk_refs = vc::interned_clocks.num_references();
+            WDEBUG << "Version stamps: " << vc::interned_clocks.num_clocks() << " distinct clocks, "
+                   << clk_refs << " references, "
+                   << (clk_refs*sizeof(uint32_t) + vc::interned_clocks.bytes()) << " bytes interned vs. "
+                   << clk_refs*sizeof(vclock_ptr_t) << " bytes of shared_ptr stamps." << std::endl;
+            db::slab_stats node_stats, edge_stats;
+            S->get_slab_stats(node_stats, edge_stats);
+            WDEBUG << "Slabs: " << node_stats.live() << " nodes, " << edge_stats.live() << " edges live, "
+                   << node_stats.allocs << "/" << node_stats.frees << " node allocs/frees, "
+                   << edge_stats.allocs << "/" << edge_stats.frees << " edge allocs/frees, "
+                   << (node_stats.chunk_bytes + edge_stats.chunk_bytes) << " bytes in "
+                   << (node_stats.chunks + edge_stats.chunks) << " chunks." << std::endl;
             message::message msg;
             msg.prepare_message(message::LOADED_GRAPH, nullptr, S->shard_id, load_time);
             S->comm.send(ShardIdIncr, msg.buf);
@@ -16,9 +16,11 @@
 #define weaver_db_shard_h_
 
 #include <set>
+#include <algorithm>
 #include <map>
 #include <vector>
 #include <unordered_map>
+#include <atomic>
 #include <sys/types.h>
 #include <po6/threads/mutex.h>
 #include <po6/net/location.h>
@@ -44,69 +46,32 @@
 #include "db/element.h"
 #include "db/node.h"
 #include "db/edge.h"
+#include "db/in_adjacency.h"
 #include "db/queue_manager.h"
 #include "db/deferred_write.h"
 #include "db/del_obj.h"
 #include "db/node_entry.h"
+#include "db/node_id_table.h"
+#include "db/slab.h"
+#include "db/mem_accounting.h"
+#include "db/replica_entry.h"
+#include "db/frontier_pool.h"
+#include "db/outbox.h"
+#include "db/prog_constants.h"
+#include "db/prog_cache.h"
+#include "db/prog_state_arena.h"
+#include "db/bsp_job.h"
+#include "db/prog_aggregate.h"
+#include "db/node_prog_running_state.h"
 #include "db/hyper_stub.h"
 #include "db/async_nodeprog_state.h"
 #include "node_prog/dynamic_prog_table.h"
 
-bool
+// shard's own tracked usage against its budget, cheap enough for the node creation path
+inline bool
 available_memory()
 {
-    std::ifstream meminfo_file;
-    meminfo_file.open("/proc/meminfo", std::ifstream::in);
-    if (!meminfo_file) {
-        // can't open /proc/meminfo for some reason
-        WDEBUG << "error opening /proc/meminfo" << std::endl;
-        return true;
-    }
-
-    double totalram, freeram, bufferram, cacheram;
-    bool got_total  = false;
-    bool got_free   = false;
-    bool got_buffer = false;
-    bool got_cache  = false;
-    std::string token;
-
-    while (meminfo_file >> token) {
-        if (token == "MemTotal:") {
-            meminfo_file >> totalram;
-            got_total = true;
-        } else if (token == "MemFree:") {
-            meminfo_file >> freeram;
-            got_free = true;
-        } else if (token == "Buffers:") {
-            meminfo_file >> bufferram;
-            got_buffer = true;
-        } else if (token == "Cached:") {
-            meminfo_file >> cacheram;
-            got_cache = true;
-        }
-
-        if (got_total && got_free && got_buffer && got_cache) {
-            break;
-        }
-    }
-
-    meminfo_file.close();
-
-    double usedram = totalram - (freeram + bufferram + cacheram);
-
-    if (usedram/totalram > MaxMemory) {
-        WDEBUG << "mem usage:\t"
-               << " used=" << usedram
-               << " total=" << totalram
-               << " buffer=" << bufferram
-               << " cacheram=" << cacheram
-               << " ratio=" << usedram/totalram
-               << " max=" << MaxMemory
-               << std::endl;
-        return false;
-    } else {
-        return true;
-    }
+    return db::shard_memory().available();
 }
 
 namespace db
@@ -165,35 +130,52 @@ namespace db
             node* acquire_node_write(uint64_t tid, const node_handle_t &node, uint64_t vt_id, uint64_t qts);
             node* acquire_node_nodeprog(uint64_t tid,
                                         const node_handle_t &node_handle,
+                                        uint64_t &node_id,
                                         const vc::vclock &vclk,
                                         order::oracle*,
                                         const std::string &p_type,
+                                        uint64_t req_id,
                                         std::shared_ptr<void> prog_state,
                                         bool &recover);
-            node* finish_acquire_node_nodeprog(db::data_map<std::shared_ptr<node_entry>>::iterator&,
+            node* finish_acquire_node_nodeprog(node_entry &entry,
                                                const vc::vclock &prog_clk,
+                                               uint64_t req_id,
                                                order::oracle *time_oracle);
+            node* acquire_node_bsp(uint64_t tid,
+                                   const node_handle_t &node_handle,
+                                   uint64_t node_id,
+                                   const vc::vclock &vclk,
+                                   order::oracle*,
+                                   uint64_t req_id);
             bool loop_recover_node(int tid, order::oracle*, async_nodeprog_state&);
             void save_evicted_node_state(node *n, uint64_t map_idx);
             void evict_all(uint64_t map_idx);
             void node_evict(node*, uint64_t map_idx);
             void choose_node_to_evict(uint64_t map_idx, std::shared_ptr<node_entry> cur_entry);
-            void release_node_write(node *n);
+            void release_node_write(node *n, const vclock_ptr_t &clk);
             void release_node(node *n, bool migr_node);
+            void release_node_nodeprog(node *n, uint64_t req_id);
+            void finish_release_node(node *n, uint64_t map_idx);
+            bool nodes_unchanged_since(const std::vector<node_handle_t> &handles, const vc::vclock &clk);
 
             // Graph state
-            //XXX po6::threads::mutex edge_map_mutex;
             po6::threads::mutex node_map_mutexes[NUM_NODE_MAPS];
             uint64_t shard_id;
             server_id serv_id;
             // node handle -> ptr to node object
             db::data_map<std::shared_ptr<node_entry>> nodes[NUM_NODE_MAPS];
+            // internal node id -> ptr to node object
+            node_id_table node_ids[NUM_NODE_MAPS];
+            // allocation of node and edge objects, edges come from the slab of their source node's map
+            slab<node> node_slabs[NUM_NODE_MAPS];
+            slab<edge> edge_slabs[NUM_NODE_MAPS];
+            void get_slab_stats(slab_stats &node_stats, slab_stats &edge_stats);
+            uint64_t local_node_id(const node_handle_t &handle);
+            void resolve_local_nbr_ids();
             std::shared_ptr<node_entry> node_queue_clock_hand[NUM_NODE_MAPS];
             std::shared_ptr<node_entry> node_queue_last[NUM_NODE_MAPS];
             db::data_map<evicted_node_state> evicted_nodes_states[NUM_NODE_MAPS];
             uint32_t nodes_in_memory[NUM_NODE_MAPS];
-            std::unordered_map<node_handle_t, // node handle n ->
-                std::unordered_set<node_version_t, node_version_hash>> edge_map; // in-neighbors of n
             node* create_node(const node_handle_t &node_handle,
                 vclock_ptr_t vclk,
                 bool migrate);
@@ -217,6 +199,7 @@ namespace db
                 vclock_ptr_t vclk,
                 uint64_t qts);
             edge* create_edge_bulk_load(const edge_handle_t &handle,
+                uint64_t map_idx,
                 const node_handle_t &remote_node, uint64_t remote_loc,
                 vclock_ptr_t vclk);
             bool add_edge_to_node_bulk_load(edge *e, const node_handle_t &node, uint64_t map_idx);
@@ -281,9 +264,17 @@ namespace db
             std::deque<del_obj*> perm_del_queue;
             std::vector<vc::vclock_t> permdel_done_clk;
             void delete_migrated_node(uint64_t tid, const node_handle_t &migr_node);
-            // XXX void remove_from_edge_map(const node_handle_t &remote_node, const node_version_t &local_node);
             void permanent_delete_loop(uint64_t tid, uint64_t vt_id, bool outstanding_progs, order::oracle *time_oracle);
             void permanent_node_delete(node *n);
+            // incremental compaction of versions deleted before permdel_done_clk
+            // each call visits a few nodes of the next node map
+            uint64_t compact_next_map; // guarded by perm_del_mutex
+            uint64_t compact_cursor[NUM_NODE_MAPS]; // node id slot, guarded by node map mutex
+            uint64_t versions_reclaimed; // guarded by perm_del_mutex
+            bool version_dead(uint32_t del_id, const std::vector<vc::vclock_t> &horizon);
+            uint64_t compact_node(node *n, const std::vector<vc::vclock_t> &horizon, order::oracle *time_oracle);
+            void compact_versions(order::oracle *time_oracle);
+            uint64_t get_versions_reclaimed();
 
             // Migration
         public:
@@ -312,7 +303,8 @@ namespace db
             vc::vclock max_clk // to compare against for checking if node is deleted
                 , zero_clk; // all zero clock for migration thread in queue
             void update_migrated_nbr_nonlocking(node *n, const node_handle_t &migr_node, uint64_t old_loc, uint64_t new_loc);
-            void update_migrated_nbr(const node_handle_t &node, uint64_t old_loc, uint64_t new_loc);
+            void update_migrated_nbr(uint64_t tid, const node_handle_t &migr_node, uint64_t old_loc, uint64_t new_loc,
+                const std::vector<node_handle_t> &srcs, const std::vector<node_handle_t> &dsts);
             void update_node_mapping(uint64_t tid, const node_handle_t &node, uint64_t shard);
             std::vector<vc::vclock_t> max_seen_clk // largest clock seen from each vector timestamper
                 , target_prog_clk
@@ -322,20 +314,22 @@ namespace db
             // node programs
         private:
             po6::threads::mutex node_prog_state_mutex;
-            using out_prog_map_t = std::unordered_map<uint64_t, std::pair<vc::vclock, std::vector<node_version_t>>>;
-            out_prog_map_t outstanding_prog_states; // maps request_id to list of nodes that have created prog state for that req id
             std::vector<vc::vclock_t> prog_done_clk; // largest clock of cumulative completed node prog for each VT
+            // returned to the client but not yet covered by prog_done_clk, req id -> clock
+            std::unordered_map<uint64_t, vc::vclock> cancelled_progs;
             std::unordered_map<node_handle_t, async_nodeprog_state> async_get_prog_states[NUM_NODE_MAPS];
             std::unordered_map<uint64_t, std::pair<vc::vclock, uint64_t>> m_prog_node_recover_counts;
-            void clear_all_state(uint64_t tid, const out_prog_map_t &outstanding_prog_states);
-            void delete_prog_states(uint64_t tid, uint64_t req_id, std::vector<node_version_t> &node_handles);
         public:
+            prog_state_arena prog_arena; // per request node program state
             void record_node_recovery(uint64_t prog_id, const vc::vclock&);
-            void mark_nodes_using_state(uint64_t req_id, const vc::vclock &clk, std::vector<node_version_t> &node_handles);
             void done_prog_clk(const vc::vclock_t *prog_clk, uint64_t vt_id);
             void done_permdel_clk(const vc::vclock_t *permdel_clk, uint64_t vt_id);
             std::unordered_map<uint64_t, uint64_t> cleanup_prog_states(uint64_t tid);
             bool check_done_prog(vc::vclock &clk);
+            bool check_done_prog(vc::vclock &clk, uint64_t req_id);
+            bool cancel_prog(const vc::vclock &clk, uint64_t req_id);
+            // node program hops run, and hops and queued requests dropped because their request was done
+            std::atomic<uint64_t> prog_hops, dropped_hops, dropped_queued;
 
             std::unordered_map<std::tuple<cache_key_t, uint64_t, node_handle_t>, void *> node_prog_running_states; // used for fetching cache contexts
             po6::threads::mutex node_prog_running_states_mutex;
@@ -350,6 +344,62 @@ namespace db
             // key = sha256 hash of node prog library so, value = dynamically linked prog handle
             std::unordered_map<std::string, std::shared_ptr<dynamic_prog_table>> m_dyn_prog_map;
 
+            // read replicas of hot nodes
+            // owner side: nodes visited more than HOT_REPLICA_VISITS times in a second are
+            // copied to all other shards, copies are refreshed after writes or extended on nops
+            // replica side: node program hops to a hot node are served from the local copy
+            // when the request clock precedes the copy's valid_until
+            po6::threads::mutex replica_mutex;
+            std::unordered_map<node_handle_t, replica_entry> replicas; // copies of nodes owned by other shards
+            std::unordered_map<node_handle_t, uint64_t> hot_nodes; // owned nodes that are replicated -> snapshot seq
+            std::vector<node_handle_t> hot_candidates;
+            std::vector<vc::vclock> replica_prev_nop; // per VT, clock of the previous nop
+            std::unordered_set<std::string> replica_unsafe_progs; // prog types that need node state
+            uint64_t replica_seq, replica_visits;
+            void note_prog_visit(node *n);
+            void maintain_replicas(uint64_t tid, const vc::vclock &nop_clk);
+            void install_replica(message::message &msg);
+            void extend_replicas(message::message &msg);
+            void drop_replicas(message::message &msg);
+            void retire_replica(node *n);
+            bool replica_servable(const node_handle_t &handle, const vc::vclock &req_clk, const std::string &prog_type, uint64_t &owner);
+            node* acquire_replica_nodeprog(const node_handle_t &handle, const vc::vclock &req_clk, uint64_t req_id);
+            void release_replica_nodeprog(node *n, uint64_t req_id);
+            void mark_replica_unsafe(const std::string &prog_type);
+
+            // pieces of wide local frontiers, run by whichever worker thread is idle
+            frontier_pool<std::shared_ptr<node_prog_running_state>> frontier;
+
+            // node programs headed to other shards
+            outbox prog_outbox;
+            // in-neighbor updates for the shards of edge targets, sent on each nop
+            po6::threads::mutex in_edge_mtx;
+            std::unordered_map<uint64_t, std::vector<in_edge_update>> in_edge_pending;
+            // nodes migrated away from this shard, updates for them are forwarded
+            std::unordered_map<node_handle_t, uint64_t> in_edge_moved;
+            // updates which arrived before their node was created or migrated here, retried on each nop
+            // for IN_EDGE_HOLD_NOPS, with the nop at which they arrived
+            std::unordered_map<node_handle_t, std::pair<uint64_t, std::vector<in_edge_update>>> in_edge_early;
+            uint64_t in_edge_nops;
+            // updates queued and the messages they went out in, and updates applied, forwarded
+            // to a migrated node and dropped for a missing one, for the write amplification
+            std::atomic<uint64_t> in_edge_queued, in_edge_batches, in_edge_applied, in_edge_forwarded, in_edge_dropped;
+            void queue_in_edge_update(const node_handle_t &src, const edge *e, const vclock_ptr_t &tdel);
+            void flush_in_edge_updates(uint64_t tid);
+            void apply_in_edge_updates(uint64_t tid, std::vector<in_edge_update> &updates, uint64_t arrived_nop = UINT64_MAX);
+            void in_edge_node_moved(const node_handle_t &handle, uint64_t new_loc);
+            void in_edge_node_arrived(node *n);
+            // resends updates of all edges to nodes at shard loc, after it restored from backup
+            void resync_in_edges(uint64_t tid, uint64_t loc);
+            // per request node program constants
+            prog_constants prog_consts;
+            // node program cache validations waiting on other shards, and counters
+            prog_cache prog_cached;
+            // whole graph node programs running in supersteps
+            bsp_jobs bsp;
+            // partial results of aggregating node programs with work on this shard
+            prog_aggregates prog_aggs;
+
             // fault tolerance
         private:
             std::vector<hyper_stub*> hstub;
@@ -386,6 +436,8 @@ namespace db
         , max_load_time(0)
         , load_count(0)
         , permdel_done_clk(NumVts, vc::vclock_t(ClkSz, 0))
+        , compact_next_map(0)
+        , versions_reclaimed(0)
         , current_migr(false)
         , migr_updating_nbrs(false)
         , migr_token(false)
@@ -398,16 +450,32 @@ namespace db
         , target_prog_clk(NumVts, vc::vclock_t(ClkSz, 0))
         , migr_done_clk(NumVts, vc::vclock_t(ClkSz, 0))
         , prog_done_clk(NumVts, vc::vclock_t(ClkSz, 0))
+        , prog_hops(0)
+        , dropped_hops(0)
+        , dropped_queued(0)
         , watch_set_lookups(0)
         , watch_set_nops(0)
         , watch_set_piggybacks(0)
+        , replica_prev_nop(NumVts)
+        , replica_seq(0)
+        , replica_visits(0)
+        , frontier(NUM_SHARD_THREADS)
+        , prog_outbox(BUSYBEE_HEADER_SIZE + message::size(message::NODE_PROG_BATCH), OUTBOX_FLUSH_US, OUTBOX_MAX_FRAMES, OUTBOX_MAX_BYTES)
+        , in_edge_nops(0)
+        , in_edge_queued(0)
+        , in_edge_batches(0)
+        , in_edge_applied(0)
+        , in_edge_forwarded(0)
+        , in_edge_dropped(0)
         , min_prog_epoch(0)
     {
         for (uint64_t i = 0; i < NUM_NODE_MAPS; i++) {
             nodes[i].set_deleted_key("");
             nodes_in_memory[i] = 0;
             evicted_nodes_states[i].set_deleted_key("");
+            compact_cursor[i] = 0;
         }
+        shard_memory().set_budget((uint64_t)(MaxMemory * mem_accounting::physical_memory()));
     }
 
     // initialize: msging layer
@@ -489,7 +557,7 @@ namespace db
         // reset qts if a VTS died
         std::vector<server> delta = prev_config.delta(config);
         bool clear_queued = false;
-        out_prog_map_t clear_map;
+        std::vector<std::shared_ptr<request_states>> cleared_states;
         for (const server &srv: delta) {
             if (srv.type == server::VT) {
                 server::state_t prev_state = prev_config.get_state(srv.id);
@@ -509,7 +577,8 @@ namespace db
                 if (prev_type == server::BACKUP_SHARD) {
                     node_prog_state_mutex.lock();
                     min_prog_epoch = config.version();
-                    clear_map = std::move(outstanding_prog_states);
+                    prog_arena.clear(cleared_states);
+                    cancelled_progs.clear();
                     node_prog_state_mutex.unlock();
 
                     clear_queued = true;
@@ -520,7 +589,6 @@ namespace db
         if (clear_queued) {
             // drop reads
             qm.clear_queued_reads();
-            clear_all_state(NUM_SHARD_THREADS, clear_map);
         }
     }
 
@@ -579,12 +647,7 @@ namespace db
     inline void
     shard :: node_wait_and_mark_busy(node *n)
     {
-        n->waiters++;
-        while (n->in_use) {
-            n->cv.wait();
-        }
-        n->waiters--;
-        n->in_use = true;
+        n->latch_exclusive();
     }
 
     inline void
@@ -620,7 +683,9 @@ namespace db
                 if (s.last_perm_deletion.vt_id != UINT64_MAX) {
                     n->last_perm_deletion.reset(new vc::vclock((s.last_perm_deletion)));
                 }
-                n->node_prog_states = std::move(s.prog_states);
+                if (s.in_edges) {
+                    n->in_edges.swap(*s.in_edges);
+                }
                 node_state_map.erase(n->get_handle());
             }
 
@@ -648,7 +713,7 @@ namespace db
             if (!entry.present) {
                 // fetch node from HyperDex
                 vclock_ptr_t dummy_clk;
-                node *n = new node(node_handle, UINT64_MAX, dummy_clk, node_map_mutexes+map_idx);
+                node *n = new (node_slabs[map_idx]) node(node_handle, UINT64_MAX, dummy_clk, node_map_mutexes+map_idx);
                 WDEBUG << "recovering node " << node_handle << std::endl;
                 wclock::weaver_timer timer;
                 uint64_t start = timer.get_real_time_millis();
@@ -669,6 +734,59 @@ namespace db
         return node_iter;
     }
 
+    // internal id of a node on this shard, invalid if not found
+    inline uint64_t
+    shard :: local_node_id(const node_handle_t &handle)
+    {
+        uint64_t map_idx = get_map_idx(handle);
+        uint64_t id = node_id_table::invalid_id;
+
+        node_map_mutexes[map_idx].lock();
+        auto node_iter = nodes[map_idx].find(handle);
+        if (node_iter != nodes[map_idx].end()) {
+            id = node_iter->second->id;
+        }
+        node_map_mutexes[map_idx].unlock();
+
+        return id;
+    }
+
+    // after bulk load, edges may have been created before their local nbrs
+    // called before worker threads start, so no locking
+    inline void
+    shard :: resolve_local_nbr_ids()
+    {
+        for (uint64_t map_idx = 0; map_idx < NUM_NODE_MAPS; map_idx++) {
+            for (auto &p: nodes[map_idx]) {
+                for (node *n: p.second->nodes) {
+                    adjacency &adj = n->out_adjacency;
+                    for (uint64_t i = 0; i < adj.size(); i++) {
+                        edge *e = adj.at(i);
+                        if (e->nbr.loc != shard_id || e->nbr.id != node_id_table::invalid_id) {
+                            continue;
+                        }
+                        uint64_t nbr_map_idx = get_map_idx(e->nbr.handle);
+                        auto nbr_iter = nodes[nbr_map_idx].find(e->nbr.handle);
+                        if (nbr_iter != nodes[nbr_map_idx].end()) {
+                            e->nbr.id = nbr_iter->second->id;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    inline void
+    shard :: get_slab_stats(slab_stats &node_stats, slab_stats &edge_stats)
+    {
+        for (uint64_t map_idx = 0; map_idx < NUM_NODE_MAPS; map_idx++) {
+            node_stats += node_slabs[map_idx].stats();
+            edge_stats += edge_slabs[map_idx].stats();
+        }
+        node_stats += node::default_slab().stats();
+        edge_stats += edge::default_slab().stats();
+    }
+
     // return value indicates if node found and in memory
     inline bool
     shard :: async_node_present(uint64_t tid,
@@ -682,7 +800,7 @@ namespace db
             if (!entry.present) {
                 // fetch node from HyperDex
                 vclock_ptr_t dummy_clk;
-                node *n = new node(node_handle, UINT64_MAX, dummy_clk, node_map_mutexes+map_idx);
+                node *n = new (node_slabs[map_idx]) node(node_handle, UINT64_MAX, dummy_clk, node_map_mutexes+map_idx);
                 hstub[tid]->get_node_no_loop(n);
                 return false;
             } else {
@@ -734,10 +852,7 @@ namespace db
                     n = n_ver;
                     break;
                 } else {
-                    n_ver->in_use = false;
-                    if (n_ver->waiters > 0) {
-                        n_ver->cv.signal();
-                    }
+                    n_ver->unlatch();
                 }
             }
         }
@@ -760,14 +875,11 @@ namespace db
             for (node *n_ver: node_iter->second->nodes) {
                 node_wait_and_mark_busy(n_ver);
 
-                if (time_oracle->clock_creat_before_del_after(vclk, n_ver->base.get_creat_time(), n_ver->base.get_del_time())) {
+                if (time_oracle->clock_creat_before_del_after(vclk, n_ver->base.get_creat_id(), n_ver->base.get_del_id())) {
                     n = n_ver;
                     break;
                 } else {
-                    n_ver->in_use = false;
-                    if (n_ver->waiters > 0) {
-                        n_ver->cv.signal();
-                    }
+                    n_ver->unlatch();
                 }
             }
         }
@@ -790,6 +902,7 @@ namespace db
             n->waiters++;
 
             // first wait for node to become free
+            // readers do not touch tx_queue, so need not wait for them here
             while (n->in_use) {
                 n->cv.wait();
             }
@@ -804,15 +917,19 @@ namespace db
             }
             assert(exists);
 
-            if (n->tx_queue.front() != comp) {
-                // write exists in queue, but cannot be executed right now
-                while (n->in_use || n->tx_queue.front() != comp) {
-                    n->cv.wait();
+            // wait for preceding writes, then for readers to drain
+            // once this write is next in line new readers yield to it
+            bool excl_waiting = false;
+            while (n->is_latched() || n->tx_queue.front() != comp) {
+                if (!excl_waiting && n->tx_queue.front() == comp) {
+                    n->excl_waiters++;
+                    excl_waiting = true;
                 }
-                n->tx_queue.pop_front();
-            } else {
-                // write exists in queue and is the first
-                n->tx_queue.pop_front();
+                n->cv.wait();
+            }
+            n->tx_queue.pop_front();
+            if (excl_waiting) {
+                n->excl_waiters--;
             }
 
             n->waiters--;
@@ -827,19 +944,36 @@ namespace db
     // get node that existed at time vclk, i.e. create time < vclk < delete time
     // strict inequality because vector clocks are unique.  no two clocks have exact same value
     // async get node for better performance
+    // node_id is a hint, set to the id of the node map entry when found through the handle
     inline node*
     shard :: acquire_node_nodeprog(uint64_t tid,
                                    const node_handle_t &node_handle,
+                                   uint64_t &node_id,
                                    const vc::vclock &vclk,
                                    order::oracle *time_oracle,
                                    const std::string &p_type,
+                                   uint64_t req_id,
                                    std::shared_ptr<void> prog_state,
                                    bool &recover)
     {
-        uint64_t map_idx = get_map_idx(node_handle);
         node *n = nullptr;
         recover = false;
 
+        if (node_id != node_id_table::invalid_id) {
+            // fast path for local hops, no handle hashing
+            uint64_t map_idx = node_id_table::map_idx(node_id);
+            node_map_mutexes[map_idx].lock();
+            node_entry *entry = node_ids[map_idx].get(node_id);
+            if (entry != nullptr && entry->present) {
+                entry->used = true;
+                n = finish_acquire_node_nodeprog(*entry, vclk, req_id, time_oracle);
+                node_map_mutexes[map_idx].unlock();
+                return n;
+            }
+            node_map_mutexes[map_idx].unlock();
+        }
+
+        uint64_t map_idx = get_map_idx(node_handle);
         node_map_mutexes[map_idx].lock();
 
         auto node_iter = nodes[map_idx].end();
@@ -852,13 +986,15 @@ namespace db
         bool node_exists = (node_iter != nodes[map_idx].end());
 
         if (found) {
-            n = finish_acquire_node_nodeprog(node_iter, vclk, time_oracle);
+            node_id = node_iter->second->id;
+            n = finish_acquire_node_nodeprog(*node_iter->second, vclk, req_id, time_oracle);
         } else if (node_exists) {
             // node exists but currently not in memory
             // save prog state until node is recovered from HyperDex
             async_nodeprog_state delayed_prog;
             delayed_prog.type  = p_type;
             delayed_prog.clk   = vclk;
+            delayed_prog.req_id = req_id;
             delayed_prog.state = prog_state;
             async_get_prog_states[map_idx][node_handle] = delayed_prog;
             recover = true;
@@ -870,28 +1006,54 @@ namespace db
     }
 
     inline node*
-    shard :: finish_acquire_node_nodeprog(db::data_map<std::shared_ptr<node_entry>>::iterator &node_iter,
+    shard :: finish_acquire_node_nodeprog(node_entry &entry,
                                           const vc::vclock &prog_clk,
+                                          uint64_t req_id,
                                           order::oracle *time_oracle)
     {
+        // node programs only read graph data, shared latch
         db::node *n = nullptr;
-        for (node *n_ver: node_iter->second->nodes) {
-            node_wait_and_mark_busy(n_ver);
+        for (node *n_ver: entry.nodes) {
+            n_ver->latch_shared(req_id);
 
-            if (time_oracle->clock_creat_before_del_after(prog_clk, n_ver->base.get_creat_time(), n_ver->base.get_del_time())) {
+            if (time_oracle->clock_creat_before_del_after(prog_clk, n_ver->base.get_creat_id(), n_ver->base.get_del_id())) {
                 n = n_ver;
                 break;
             } else {
-                n_ver->in_use = false;
-                if (n_ver->waiters > 0) {
-                    n_ver->cv.signal();
-                }
+                n_ver->unlatch_shared(req_id);
             }
         }
 
         return n;
     }
 
+    // node of a whole graph program, by the id it was listed with at the start of the program
+    // not in memory nodes are recovered in place, a whole graph scan has no use for parking the program
+    inline node*
+    shard :: acquire_node_bsp(uint64_t tid,
+                              const node_handle_t &node_handle,
+                              uint64_t node_id,
+                              const vc::vclock &vclk,
+                              order::oracle *time_oracle,
+                              uint64_t req_id)
+    {
+        node *n = nullptr;
+        uint64_t map_idx = node_id_table::map_idx(node_id);
+
+        node_map_mutexes[map_idx].lock();
+        node_entry *entry = node_ids[map_idx].get(node_id);
+        if (entry != nullptr && !entry->present) {
+            node_present(tid, map_idx, node_handle);
+        }
+        if (entry != nullptr && entry->present) {
+            entry->used = true;
+            n = finish_acquire_node_nodeprog(*entry, vclk, req_id, time_oracle);
+        }
+        node_map_mutexes[map_idx].unlock();
+
+        return n;
+    }
+
     inline bool
     shard :: loop_recover_node(int tid,
                                order::oracle *time_oracle,
@@ -929,8 +1091,9 @@ namespace db
         auto progstate_iter = progstate_map.find(n->get_handle());
         assert(progstate_iter != progstate_map.end());
         delayed_prog = progstate_iter->second;
-        n = finish_acquire_node_nodeprog(node_iter,
+        n = finish_acquire_node_nodeprog(entry,
                                          delayed_prog.clk,
+                                         delayed_prog.req_id,
                                          time_oracle);
 
         node_map_mutexes[map_idx].unlock();
@@ -940,25 +1103,30 @@ namespace db
         return true;
     }
 
+    // clk is the clock of the write, for node program cache validation
     inline void
-    shard :: release_node_write(node *n)
+    shard :: release_node_write(node *n, const vclock_ptr_t &clk)
     {
-        release_node(n, false);
+        if (n->replicated) {
+            n->replica_stale = true;
+        }
+
+        uint64_t map_idx = get_map_idx(n->get_handle());
+
+        node_map_mutexes[map_idx].lock();
+        n->last_upd_clk = clk;
+        n->unlatch();
+        finish_release_node(n, map_idx);
     }
 
     inline void
     shard :: permanent_node_delete(node *n)
     {
         assert(n->waiters == 0);
-        assert(!n->in_use);
+        assert(!n->is_latched());
         // this code isn't executed in case of deletion of migrated nodes
         if (n->state != node::mode::MOVED) {
-            for (auto &x: n->out_edges) {
-                for (db::edge *e: x.second) {
-                    delete e;
-                }
-            }
-            n->out_edges.clear();
+            n->free_edges();
         }
         delete n;
     }
@@ -974,7 +1142,10 @@ namespace db
             if (n->last_perm_deletion) {
                 s.last_perm_deletion = *n->last_perm_deletion;
             }
-            s.prog_states = std::move(n->node_prog_states);
+            if (!n->in_edges.empty()) {
+                s.in_edges.reset(new in_adjacency());
+                s.in_edges->swap(n->in_edges);
+            }
         }
     }
 
@@ -1054,7 +1225,7 @@ namespace db
                     node *evict_node = entry->nodes.back();
 
                     evict_node->waiters++;
-                    while (evict_node->in_use) {
+                    while (evict_node->is_latched()) {
                         evict_node->cv.wait();
                     }
                     evict_node->waiters--;
@@ -1063,7 +1234,7 @@ namespace db
                         --nodes_in_memory[map_idx]; // eventually this node will be evicted, proactively reduce count to prevent multiple evictions
                         if (evict_node->waiters > 0) {
                             evict_node->evicted = true;
-                            evict_node->cv.signal();
+                            evict_node->cv.broadcast();
                         } else {
                             node_evict(evict_node, map_idx);
                         }
@@ -1074,6 +1245,36 @@ namespace db
         }
     }
 
+    // true if no version of any of the nodes was created or written after clk
+    // missing and evicted nodes count as changed
+    inline bool
+    shard :: nodes_unchanged_since(const std::vector<node_handle_t> &handles, const vc::vclock &clk)
+    {
+        for (const node_handle_t &handle: handles) {
+            uint64_t map_idx = get_map_idx(handle);
+            bool changed = true;
+
+            node_map_mutexes[map_idx].lock();
+            auto node_iter = nodes[map_idx].find(handle);
+            if (node_iter != nodes[map_idx].end() && node_iter->second->present && !node_iter->second->nodes.empty()) {
+                changed = false;
+                for (node *n_ver: node_iter->second->nodes) {
+                    if (n_ver->written_since(clk)) {
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+            node_map_mutexes[map_idx].unlock();
+
+            if (changed) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     // unlock the previously acquired node, and wake any waiting threads
     inline void
     shard :: release_node(node *n, bool migr_done=false)
@@ -1081,19 +1282,42 @@ namespace db
         uint64_t map_idx = get_map_idx(n->get_handle());
 
         node_map_mutexes[map_idx].lock();
-        n->in_use = false;
+        n->unlatch();
 
         if (migr_done) {
             n->migr_cv.broadcast();
         }
 
+        finish_release_node(n, map_idx);
+    }
+
+    inline void
+    shard :: release_node_nodeprog(node *n, uint64_t req_id)
+    {
+        uint64_t map_idx = get_map_idx(n->get_handle());
+
+        node_map_mutexes[map_idx].lock();
+        n->unlatch_shared(req_id);
+
+        if (n->is_latched()) {
+            // last reader out does eviction and deletion
+            node_map_mutexes[map_idx].unlock();
+        } else {
+            finish_release_node(n, map_idx);
+        }
+    }
+
+    // node unlatched, waiters already woken
+    // unlocks node map mutex
+    inline void
+    shard :: finish_release_node(node *n, uint64_t map_idx)
+    {
         if (n->to_evict && !n->permanently_deleted) {
             n->to_evict = false;
             choose_node_to_evict(map_idx, nodes[map_idx][n->get_handle()]);
         }
 
         if (n->waiters > 0) {
-            n->cv.signal();
             node_map_mutexes[map_idx].unlock();
         } else if (n->permanently_deleted) {
             const node_handle_t &node_handle = n->get_handle();
@@ -1110,6 +1334,7 @@ namespace db
             entry.nodes.erase(node_iter);
             --nodes_in_memory[map_idx];
             if (entry.nodes.empty()) {
+                node_ids[map_idx].release(entry.id);
                 nodes[map_idx].erase(node_handle);
             }
             node_map_mutexes[map_idx].unlock();
@@ -1148,13 +1373,14 @@ namespace db
         bool migrate)
     {
         uint64_t map_idx = get_map_idx(node_handle);
-        node *new_node = new node(node_handle, shard_id, vclk, node_map_mutexes+map_idx);
+        node *new_node = new (node_slabs[map_idx]) node(node_handle, shard_id, vclk, node_map_mutexes+map_idx);
 
         node_map_mutexes[map_idx].lock();
         auto map_iter = nodes[map_idx].find(node_handle);
         if (map_iter == nodes[map_idx].end()) {
             auto new_entry = std::make_shared<node_entry>(new_node);
             nodes[map_idx][node_handle] = new_entry;
+            node_ids[map_idx].assign(map_idx, new_entry);
             new_node_entry(map_idx, new_entry);
         } else {
             map_iter->second->nodes.emplace_back(new_node);
@@ -1185,7 +1411,7 @@ namespace db
                                    uint64_t map_idx,
                                    vclock_ptr_t vclk)
     {
-        node *new_node = new node(node_handle, shard_id, vclk, node_map_mutexes+map_idx);
+        node *new_node = new (node_slabs[map_idx]) node(node_handle, shard_id, vclk, node_map_mutexes+map_idx);
         new_node->state = node::mode::STABLE;
 #ifdef WEAVER_CLDG
         new_node->msg_count.resize(get_num_shards(), 0);
@@ -1211,8 +1437,7 @@ namespace db
             assert(false && err_msg.c_str());
         }
         std::shared_ptr<node_entry> new_entry;
-        if (nodes_in_memory[map_idx] < NodesPerMap) {
-        //if (available_memory()) {
+        if (nodes_in_memory[map_idx] < NodesPerMap && available_memory()) {
         //if (block_index >= 199999 && block_index <= 200101) {
             new_entry = std::make_shared<node_entry>(n);
             new_node_entry(map_idx, new_entry);
@@ -1224,6 +1449,7 @@ namespace db
             in_mem = false;
         }
         nodes[map_idx][n->get_handle()] = new_entry;
+        node_ids[map_idx].assign(map_idx, new_entry);
         node_map_mutexes[map_idx].unlock();
 
         return in_mem;
@@ -1251,6 +1477,14 @@ namespace db
         vclock_ptr_t tdel)
     {
         n->base.update_del_time(tdel);
+
+        // out edges go with the node, for the in-neighbors at their targets
+        adjacency &adj = n->out_adjacency;
+        for (uint64_t i = 0; i < adj.size(); i++) {
+            if (adj.del_id_block()[i] == vc::clock_table::null_id) {
+                queue_in_edge_update(n->get_handle(), adj.at(i), tdel);
+            }
+        }
     }
 
     inline void
@@ -1267,7 +1501,7 @@ namespace db
         } else {
             delete_node_nonlocking(n, tdel);
             del_obj *dobj = new del_obj(transaction::NODE_DELETE_REQ, tdel, n->base.get_creat_time(), node_handle, "");
-            release_node_write(n);
+            release_node_write(n, tdel);
             // record object for permanent deletion later on
             perm_del_mutex.lock();
             perm_del_queue.emplace_back(dobj);
@@ -1281,17 +1515,14 @@ namespace db
         const node_handle_t &remote_node, uint64_t remote_loc,
         vclock_ptr_t vclk)
     {
-        edge *new_edge = new edge(handle, vclk, remote_loc, remote_node);
+        uint64_t map_idx = get_map_idx(n->get_handle());
+        edge *new_edge = new (edge_slabs[map_idx]) edge(handle, vclk, remote_loc, remote_node);
+        if (remote_loc == shard_id) {
+            new_edge->nbr.id = local_node_id(remote_node);
+        }
         n->add_edge(new_edge);
-
-        // XXX update edge map
-        //if (!init_load) {
-        //    edge_map_mutex.lock();
-        //}
-        //edge_map[remote_node].emplace(std::make_pair(n->get_handle(), vclk));
-        //if (!init_load) {
-        //    edge_map_mutex.unlock();
-        //}
+        n->out_adjacency.maybe_build_prop_index();
+        queue_in_edge_update(n->get_handle(), new_edge, nullptr);
     }
 
     inline void
@@ -1315,16 +1546,17 @@ namespace db
         } else {
             assert(n->get_handle() == local_node);
             create_edge_nonlocking(n, handle, remote_node, remote_loc, vclk);
-            release_node_write(n);
+            release_node_write(n, vclk);
         }
     }
 
     inline edge*
     shard :: create_edge_bulk_load(const edge_handle_t &handle,
+        uint64_t map_idx,
         const node_handle_t &remote_node, uint64_t remote_loc,
         vclock_ptr_t vclk)
     {
-        edge *new_edge = new edge(handle, vclk, remote_loc, remote_node);
+        edge *new_edge = new (edge_slabs[map_idx]) edge(handle, vclk, remote_loc, remote_node);
         return new_edge;
     }
 
@@ -1348,6 +1580,9 @@ namespace db
             found = true;
         }
         node_map_mutexes[map_idx].unlock();
+        if (found) {
+            queue_in_edge_update(node_handle, e, nullptr);
+        }
 
         return found;
     }
@@ -1364,7 +1599,8 @@ namespace db
         edge *e = out_edge_iter->second.back();
         // XXX nodeswap
         assert(!e->base.get_del_time());
-        e->base.update_del_time(tdel);
+        n->delete_edge(e, tdel);
+        queue_in_edge_update(n->get_handle(), e, tdel);
     }
 
     inline void
@@ -1383,7 +1619,7 @@ namespace db
         } else {
             delete_edge_nonlocking(n, edge_handle, tdel);
             del_obj *dobj = new del_obj(transaction::EDGE_DELETE_REQ, tdel, n->base.get_creat_time(), node_handle, edge_handle);
-            release_node_write(n);
+            release_node_write(n, tdel);
             // record object for permanent deletion later on
             perm_del_mutex.lock();
             perm_del_queue.emplace_back(dobj);
@@ -1391,6 +1627,179 @@ namespace db
         }
     }
 
+    // in-neighbor update for the target of edge e from node src, a create if tdel is null
+    inline void
+    shard :: queue_in_edge_update(const node_handle_t &src, const edge *e, const vclock_ptr_t &tdel)
+    {
+        in_edge_update upd;
+        upd.node = e->nbr.handle;
+        upd.edge = e->get_handle();
+        upd.src = remote_node(shard_id, src);
+        upd.creat_time = e->base.get_creat_time();
+        upd.del_time = tdel;
+
+        in_edge_mtx.lock();
+        in_edge_pending[e->nbr.loc].emplace_back(std::move(upd));
+        in_edge_mtx.unlock();
+        in_edge_queued++;
+    }
+
+    inline void
+    shard :: flush_in_edge_updates(uint64_t tid)
+    {
+        std::unordered_map<node_handle_t, std::pair<uint64_t, std::vector<in_edge_update>>> retry;
+        in_edge_mtx.lock();
+        uint64_t now = ++in_edge_nops;
+        retry.swap(in_edge_early);
+        in_edge_mtx.unlock();
+
+        for (auto &p: retry) {
+            if (now - p.second.first > IN_EDGE_HOLD_NOPS) {
+                in_edge_dropped += p.second.second.size();
+            } else {
+                apply_in_edge_updates(tid, p.second.second, p.second.first);
+            }
+        }
+
+        std::unordered_map<uint64_t, std::vector<in_edge_update>> batches;
+        in_edge_mtx.lock();
+        batches.swap(in_edge_pending);
+        in_edge_mtx.unlock();
+
+        message::message msg;
+        for (auto &p: batches) {
+            msg.prepare_message(message::IN_EDGE_UPDATES, nullptr, p.second);
+            comm.send(p.first, msg.buf);
+            in_edge_batches++;
+        }
+    }
+
+    // updates for nodes which are moving or moved away go on to their new shard
+    // updates for nodes not here are held, as the node may not have been created or migrated here yet
+    // arrived_nop is the nop at which held updates first arrived
+    inline void
+    shard :: apply_in_edge_updates(uint64_t tid, std::vector<in_edge_update> &updates, uint64_t arrived_nop)
+    {
+        std::stable_sort(updates.begin(), updates.end(),
+            [](const in_edge_update &u1, const in_edge_update &u2) { return u1.node < u2.node; });
+
+        in_edge_mtx.lock();
+        uint64_t nop = in_edge_nops;
+        in_edge_mtx.unlock();
+
+        std::vector<std::pair<uint64_t, in_edge_update*>> forward;
+        for (uint64_t i = 0; i < updates.size();) {
+            uint64_t j = i;
+            uint64_t new_loc = UINT64_MAX;
+            node *n = acquire_node_latest(tid, updates[i].node);
+            if (n != nullptr && n->state == node::mode::MOVED) {
+                new_loc = n->migration->new_loc;
+                release_node(n);
+                n = nullptr;
+            } else if (n == nullptr) {
+                in_edge_mtx.lock();
+                auto moved_iter = in_edge_moved.find(updates[i].node);
+                if (moved_iter != in_edge_moved.end()) {
+                    new_loc = moved_iter->second;
+                }
+                in_edge_mtx.unlock();
+            }
+
+            if (n != nullptr) {
+                for (; j < updates.size() && updates[j].node == updates[i].node; j++) {
+                    n->in_edges.apply(updates[j], nop);
+                }
+                release_node(n);
+                in_edge_applied += j - i;
+            } else if (new_loc != UINT64_MAX) {
+                for (; j < updates.size() && updates[j].node == updates[i].node; j++) {
+                    forward.emplace_back(new_loc, &updates[j]);
+                }
+            } else {
+                in_edge_mtx.lock();
+                auto &held = in_edge_early[updates[i].node];
+                if (held.second.empty()) {
+                    held.first = arrived_nop == UINT64_MAX? in_edge_nops : arrived_nop;
+                }
+                for (; j < updates.size() && updates[j].node == updates[i].node; j++) {
+                    held.second.emplace_back(std::move(updates[j]));
+                }
+                in_edge_mtx.unlock();
+            }
+            i = j;
+        }
+
+        if (!forward.empty()) {
+            in_edge_mtx.lock();
+            for (auto &f: forward) {
+                in_edge_pending[f.first].emplace_back(std::move(*f.second));
+            }
+            in_edge_mtx.unlock();
+            in_edge_forwarded += forward.size();
+        }
+    }
+
+    inline void
+    shard :: in_edge_node_moved(const node_handle_t &handle, uint64_t new_loc)
+    {
+        in_edge_mtx.lock();
+        in_edge_moved[handle] = new_loc;
+        in_edge_mtx.unlock();
+    }
+
+    // caution: assume holding node n
+    inline void
+    shard :: in_edge_node_arrived(node *n)
+    {
+        std::vector<in_edge_update> early;
+        in_edge_mtx.lock();
+        uint64_t nop = in_edge_nops;
+        auto early_iter = in_edge_early.find(n->get_handle());
+        if (early_iter != in_edge_early.end()) {
+            early = std::move(early_iter->second.second);
+            in_edge_early.erase(early_iter);
+        }
+        in_edge_moved.erase(n->get_handle());
+        in_edge_mtx.unlock();
+
+        for (const in_edge_update &upd: early) {
+            n->in_edges.apply(upd, nop);
+        }
+        in_edge_applied += early.size();
+    }
+
+    inline void
+    shard :: resync_in_edges(uint64_t tid, uint64_t loc)
+    {
+        std::vector<node_handle_t> handles;
+        for (uint64_t map_idx = 0; map_idx < NUM_NODE_MAPS; map_idx++) {
+            node_map_mutexes[map_idx].lock();
+            for (const auto &p: nodes[map_idx]) {
+                handles.emplace_back(p.first);
+            }
+            node_map_mutexes[map_idx].unlock();
+        }
+
+        for (const node_handle_t &handle: handles) {
+            node *n = acquire_node_latest(tid, handle);
+            if (n == nullptr) {
+                continue;
+            }
+            adjacency &adj = n->out_adjacency;
+            for (uint64_t i = 0; i < adj.size(); i++) {
+                if (adj.nbr_loc(i) != loc) {
+                    continue;
+                }
+                edge *e = adj.at(i);
+                queue_in_edge_update(handle, e, nullptr);
+                if (e->base.get_del_time()) {
+                    queue_in_edge_update(handle, e, e->base.get_del_time());
+                }
+            }
+            release_node(n);
+        }
+    }
+
     inline void
     shard :: set_node_property_nonlocking(node *n,
         std::string &key, std::string &value,
@@ -1416,7 +1825,7 @@ namespace db
             migration_mutex.unlock();
         } else {
             set_node_property_nonlocking(n, *key, *value, vclk);
-            release_node_write(n);
+            release_node_write(n, vclk);
         }
     }
 
@@ -1440,6 +1849,11 @@ namespace db
         edge *e = out_edge_iter->second.back();
         assert(!e->base.get_del_time());
         e->base.set_property(key, value, vclk);
+        if (n->out_adjacency.prop_indexed()) {
+            n->out_adjacency.index_property(e, property_keys.lookup(key), value);
+        } else {
+            n->out_adjacency.maybe_build_prop_index();
+        }
     }
 
     inline void
@@ -1460,7 +1874,7 @@ namespace db
             migration_mutex.unlock();
         } else {
             set_edge_property_nonlocking(n, edge_handle, *key, *value, vclk);
-            release_node_write(n);
+            release_node_write(n, vclk);
         }
     }
 
@@ -1493,7 +1907,7 @@ namespace db
             migration_mutex.unlock();
         } else {
             add_node_alias_nonlocking(n, alias);
-            release_node_write(n);
+            release_node_write(n, vclk);
         }
     }
 
@@ -1525,12 +1939,7 @@ namespace db
         n->permanently_deleted = true;
         // deleting edges now so as to prevent sending messages to neighbors for permanent edge deletion
         // rest of deletion happens in release_node()
-        for (auto &x: n->out_edges) {
-            for (db::edge *e: x.second) {
-                delete e;
-            }
-        }
-        n->out_edges.clear();
+        n->free_edges();
         release_node(n);
     }
 
@@ -1549,20 +1958,6 @@ namespace db
         return false;
     }
 
-    // assuming caller holds edge_map_mutex
-    // XXX
-    //inline void
-    //shard :: remove_from_edge_map(const node_handle_t &remote_node, const node_version_t &local_node)
-    //{
-    //    auto edge_map_iter = edge_map.find(remote_node);
-    //    assert(edge_map_iter != edge_map.end());
-    //    auto &node_version_set = edge_map_iter->second;
-    //    node_version_set.erase(local_node);
-    //    if (node_version_set.empty()) {
-    //        edge_map.erase(remote_node);
-    //    }
-    //}
-
     inline void
     shard :: permanent_delete_loop(uint64_t tid, uint64_t vt_id, bool outstanding_progs, order::oracle *time_oracle)
     {
@@ -1601,13 +1996,6 @@ namespace db
                     n = acquire_node_specific(tid, dobj->node, dobj->version, nullptr);
                     if (n != nullptr) {
                         n->permanently_deleted = true;
-                        for (auto &x: n->out_edges) {
-                            for (db::edge *e: x.second) {
-                                // XXX const node_handle_t &remote_node = e->nbr.handle;
-                                node_version_t local_node = std::make_pair(dobj->node, e->base.get_creat_time());
-                                // XXX remove_from_edge_map(remote_node, local_node);
-                            }
-                        }
                         release_node(n);
                     }
                     break;
@@ -1616,29 +2004,30 @@ namespace db
                     n = acquire_node_specific(tid, dobj->node, dobj->version, nullptr);
                     if (n != nullptr) {
                         auto map_iter = n->out_edges.find(dobj->edge);
-                        assert(map_iter != n->out_edges.end());
 
                         edge *e = nullptr;
-                        auto edge_iter = map_iter->second.begin();
-                        for (; edge_iter != map_iter->second.end(); edge_iter++) {
-                            vclock_ptr_t tdel = (*edge_iter)->base.get_del_time();
-                            if (tdel && *tdel == *dobj->tdel) {
-                                e = *edge_iter;
-                                break;
+                        if (map_iter != n->out_edges.end()) {
+                            for (edge *version: map_iter->second) {
+                                vclock_ptr_t tdel = version->base.get_del_time();
+                                if (tdel && *tdel == *dobj->tdel) {
+                                    e = version;
+                                    break;
+                                }
                             }
                         }
-                        assert(e);
+                        if (e == nullptr) {
+                            // already reclaimed by compact_versions
+                            release_node(n);
+                            break;
+                        }
 
                         if (n->last_perm_deletion == nullptr
                          || time_oracle->compare_two_vts(*n->last_perm_deletion, *e->base.get_del_time()) == 0) {
                             n->last_perm_deletion.reset(new vc::vclock(*e->base.get_del_time()));
                         }
 
+                        n->remove_edge(e);
                         delete e;
-                        map_iter->second.erase(edge_iter);
-                        if (map_iter->second.empty()) {
-                            n->out_edges.erase(dobj->edge);
-                        }
                         release_node(n);
                     }
                     break;
@@ -1667,103 +2056,184 @@ namespace db
     }
 
 
-    // migration methods
-
-    inline void
-    shard :: update_migrated_nbr_nonlocking(node *n, const node_handle_t &migr_node, uint64_t old_loc, uint64_t new_loc)
+    // same rule as permanent_delete_loop: deleted before the done clock of every VT
+    inline bool
+    shard :: version_dead(uint32_t del_id, const std::vector<vc::vclock_t> &horizon)
     {
-        for (auto &x: n->out_edges) {
-            for (db::edge *e: x.second) {
-                if (e->nbr.handle == migr_node && e->nbr.loc == old_loc) {
-                    e->nbr.loc = new_loc;
-                }
+        if (del_id == vc::clock_table::null_id) {
+            return false;
+        }
+
+        const vclock_ptr_t &tdel = vc::interned_clocks.get(del_id);
+        for (uint64_t i = 0; i < NumVts; i++) {
+            if (horizon[i].size() < ClkSz
+             || !order::oracle::happens_before_no_kronos(tdel->clock, horizon[i])) {
+                return false;
             }
         }
+        return true;
     }
 
-    inline void
-    shard :: update_migrated_nbr(const node_handle_t &, uint64_t, uint64_t) { }
-    //XXX shard :: update_migrated_nbr(const node_handle_t &migr_node, uint64_t old_loc, uint64_t new_loc)
-    //{
-    //    std::unordered_set<node_version_t, node_version_hash> nbrs;
-    //    node *n;
-    //    edge_map_mutex.lock();
-    //    auto find_iter = edge_map.find(migr_node);
-    //    if (find_iter != edge_map.end()) {
-    //        nbrs = find_iter->second;
-    //    }
-    //    edge_map_mutex.unlock();
-
-    //    for (const node_version_t &nv: nbrs) {
-    //        n = acquire_node_specific(nv.first, &nv.second, nullptr);
-    //        update_migrated_nbr_nonlocking(n, migr_node, old_loc, new_loc);
-    //        release_node(n);
-    //    }
-    //    migration_mutex.lock();
-    //    if (old_loc != shard_id) {
-    //        message::message msg;
-    //        msg.prepare_message(message::MIGRATED_NBR_ACK, shard_id, max_seen_clk, shard_node_count[shard_id-ShardIdIncr]);
-    //        comm.send(old_loc, msg.buf);
-    //    } else {
-    //        for (uint64_t i = 0; i < NumVts; i++) {
-    //            if (order::oracle::happens_before_no_kronos(target_prog_clk[i], max_seen_clk[i])) {
-    //                target_prog_clk[i] = max_seen_clk[i];
-    //            }
-    //        }
-    //        migr_edge_acks[shard_id - ShardIdIncr] = true;
-    //    }
-    //    migration_mutex.unlock();
-    //}
-
-    inline void
-    shard :: update_node_mapping(uint64_t tid, const node_handle_t &handle, uint64_t shard)
+    // caution: assuming n is latched exclusively
+    inline uint64_t
+    shard :: compact_node(node *n, const std::vector<vc::vclock_t> &horizon, order::oracle *time_oracle)
     {
-        hstub[tid]->update_mapping(handle, shard);
-    }
+        auto dead = [&](uint32_t del_id) { return version_dead(del_id, horizon); };
+        uint64_t reclaimed = n->base.properties.compact(dead);
 
-    // node program
+        std::vector<edge*> dead_edges;
+        adjacency &adj = n->out_adjacency;
+        for (uint64_t i = 0; i < adj.size(); i++) {
+            edge *e = adj.at(i);
+            if (dead(e->base.get_del_id())) {
+                dead_edges.emplace_back(e);
+            } else {
+                reclaimed += e->base.properties.compact(dead);
+            }
+        }
 
+        reclaimed += n->in_edges.compact(dead);
+
+        for (edge *e: dead_edges) {
+            if (n->last_perm_deletion == nullptr
+             || time_oracle->compare_two_vts(*n->last_perm_deletion, *e->base.get_del_time()) == 0) {
+                n->last_perm_deletion.reset(new vc::vclock(*e->base.get_del_time()));
+            }
+            n->remove_edge(e);
+            delete e;
+        }
+        if (!dead_edges.empty()) {
+            adj.shrink();
+        }
+
+        return reclaimed + dead_edges.size();
+    }
+
+    // called on each nop, so the whole shard is swept over time without a separate thread
+    // busy nodes are skipped rather than waited on, and picked up in the next sweep
     inline void
-    shard :: clear_all_state(uint64_t tid, const out_prog_map_t &prog_states)
+    shard :: compact_versions(order::oracle *time_oracle)
     {
-        std::unordered_map<node_handle_t, std::vector<vclock_ptr_t>> cleared;
+        perm_del_mutex.lock();
+        std::vector<vc::vclock_t> horizon = permdel_done_clk;
+        uint64_t map_idx = compact_next_map++ % NUM_NODE_MAPS;
+        perm_del_mutex.unlock();
 
-        for (auto &p: prog_states) {
-            for (const node_version_t &nv: p.second.second) {
-                bool found = false;
+        uint64_t reclaimed = 0;
+        for (uint64_t visited = 0; visited < COMPACT_NODES_PER_NOP; visited++) {
+            node *n = nullptr;
 
-                std::vector<vclock_ptr_t> &clk_vec = cleared[nv.first];
-                for (vclock_ptr_t vclk: clk_vec) {
-                    if (*vclk == *nv.second) {
-                        found = true;
+            node_map_mutexes[map_idx].lock();
+            node_id_table &ids = node_ids[map_idx];
+            if (visited >= ids.num_slots()) {
+                node_map_mutexes[map_idx].unlock();
+                break;
+            }
+            uint64_t &cursor = compact_cursor[map_idx];
+            if (cursor >= ids.num_slots()) {
+                cursor = 0;
+            }
+            const std::shared_ptr<node_entry> &entry = ids.slot_entry(cursor++);
+            if (entry && entry->present) {
+                for (node *n_ver: entry->nodes) {
+                    if (!n_ver->is_latched()
+                     && n_ver->state == node::mode::STABLE
+                     && !n_ver->permanently_deleted) {
+                        n_ver->latch_exclusive();
+                        n = n_ver;
                         break;
                     }
                 }
+            }
+            node_map_mutexes[map_idx].unlock();
 
-                if (!found) {
-                    node *n = acquire_node_specific(tid, nv.first, nv.second, nullptr);
-                    n->node_prog_states.clear();
-                    release_node(n);
-                    clk_vec.emplace_back(nv.second);
-                }
+            if (n != nullptr) {
+                reclaimed += compact_node(n, horizon, time_oracle);
+                release_node(n);
             }
         }
+
+        if (reclaimed != 0) {
+            perm_del_mutex.lock();
+            versions_reclaimed += reclaimed;
+            perm_del_mutex.unlock();
+        }
+    }
+
+    inline uint64_t
+    shard :: get_versions_reclaimed()
+    {
+        perm_del_mutex.lock();
+        uint64_t reclaimed = versions_reclaimed;
+        perm_del_mutex.unlock();
+        return reclaimed;
     }
 
+
+    // migration methods
+
     inline void
-    shard :: delete_prog_states(uint64_t tid, uint64_t req_id, std::vector<node_version_t> &state_nodes)
+    shard :: update_migrated_nbr_nonlocking(node *n, const node_handle_t &migr_node, uint64_t old_loc, uint64_t new_loc)
     {
-        for (const node_version_t &nv: state_nodes) {
-            node *n = acquire_node_specific(tid, nv.first, nv.second, nullptr);
+        adjacency &adj = n->out_adjacency;
+        for (uint64_t i = 0; i < adj.size(); i++) {
+            if (adj.nbr_loc(i) != old_loc) {
+                continue;
+            }
+            edge *e = adj.at(i);
+            if (e->nbr.handle == migr_node) {
+                e->nbr.loc = new_loc;
+                e->nbr.id = node_id_table::invalid_id;
+                adj.refresh(e);
+            }
+        }
+    }
 
-            // check that node not migrated or permanently deleted
+    // srcs are nodes here with edges to migr_node, dsts nodes here with edges from it
+    inline void
+    shard :: update_migrated_nbr(uint64_t tid, const node_handle_t &migr_node, uint64_t old_loc, uint64_t new_loc,
+        const std::vector<node_handle_t> &srcs, const std::vector<node_handle_t> &dsts)
+    {
+        node *n;
+        for (const node_handle_t &src: srcs) {
+            n = acquire_node_latest(tid, src);
+            if (n != nullptr) {
+                update_migrated_nbr_nonlocking(n, migr_node, old_loc, new_loc);
+                release_node(n);
+            }
+        }
+        for (const node_handle_t &dst: dsts) {
+            n = acquire_node_latest(tid, dst);
             if (n != nullptr) {
-                assert(n->node_prog_states.erase(req_id) > 0);
+                n->in_edges.update_src_loc(migr_node, old_loc, new_loc);
                 release_node(n);
             }
         }
+
+        migration_mutex.lock();
+        if (old_loc != shard_id) {
+            message::message msg;
+            msg.prepare_message(message::MIGRATED_NBR_ACK, nullptr, shard_id, max_seen_clk, shard_node_count[shard_id-ShardIdIncr]);
+            comm.send(old_loc, msg.buf);
+        } else {
+            for (uint64_t i = 0; i < NumVts; i++) {
+                if (order::oracle::happens_before_no_kronos(target_prog_clk[i], max_seen_clk[i])) {
+                    target_prog_clk[i] = max_seen_clk[i];
+                }
+            }
+            migr_edge_acks[shard_id - ShardIdIncr] = true;
+        }
+        migration_mutex.unlock();
     }
 
+    inline void
+    shard :: update_node_mapping(uint64_t tid, const node_handle_t &handle, uint64_t shard)
+    {
+        hstub[tid]->update_mapping(handle, shard);
+    }
+
+    // node program
+
     inline void
     shard :: record_node_recovery(uint64_t prog_id, const vc::vclock &vclk)
     {
@@ -1777,21 +2247,6 @@ namespace db
         node_prog_state_mutex.unlock();
     }
 
-    inline void
-    shard :: mark_nodes_using_state(uint64_t req_id, const vc::vclock &clk, std::vector<node_version_t> &state_nodes)
-    {
-        node_prog_state_mutex.lock();
-        auto state_list_iter = outstanding_prog_states.find(req_id);
-        if (state_list_iter == outstanding_prog_states.end()) {
-            outstanding_prog_states.emplace(req_id, std::make_pair(clk, std::move(state_nodes)));
-        } else {
-            std::vector<node_version_t> &add_to = state_list_iter->second.second;
-            add_to.reserve(add_to.size() + state_nodes.size());
-            add_to.insert(add_to.end(), state_nodes.begin(), state_nodes.end());
-        }
-        node_prog_state_mutex.unlock();
-    }
-
     inline void
     shard :: done_prog_clk(const vc::vclock_t *prog_clk, uint64_t vt_id)
     {
@@ -1799,13 +2254,25 @@ namespace db
             return;
         }
 
+        std::vector<std::shared_ptr<request_states>> done;
         node_prog_state_mutex.lock();
 
         if (order::oracle::happens_before_no_kronos(prog_done_clk[vt_id], *prog_clk)) {
             prog_done_clk[vt_id] = *prog_clk;
+            prog_arena.cleanup(prog_done_clk, done);
+
+            for (auto iter = cancelled_progs.begin(); iter != cancelled_progs.end();) {
+                const vc::vclock &clk = iter->second;
+                if (order::oracle::happens_before_no_kronos(clk.clock, prog_done_clk[clk.vt_id])) {
+                    iter = cancelled_progs.erase(iter);
+                } else {
+                    iter++;
+                }
+            }
         }
 
         node_prog_state_mutex.unlock();
+        // states of completed requests are freed as done goes out of scope, outside the lock
     }
 
     inline void
@@ -1825,21 +2292,11 @@ namespace db
     }
 
     inline std::unordered_map<uint64_t, uint64_t>
-    shard :: cleanup_prog_states(uint64_t tid)
+    shard :: cleanup_prog_states(uint64_t)
     {
-        std::vector<std::pair<uint64_t, std::vector<node_version_t>>> to_delete;
-
         node_prog_state_mutex.lock();
-        for (const auto &p: outstanding_prog_states) {
-            const vc::vclock &clk = p.second.first;
-            if (order::oracle::happens_before_no_kronos(clk.clock, prog_done_clk[clk.vt_id])) {
-                to_delete.emplace_back(std::make_pair(p.first, std::move(p.second.second)));
-            }
-        }
-
-        for (const auto &p: to_delete) {
-            outstanding_prog_states.erase(p.first);
-        }
+        prog_consts.cleanup(prog_done_clk);
+        bsp.cleanup(prog_done_clk);
 
         std::unordered_map<uint64_t, uint64_t> node_recover_counts;
         std::vector<uint64_t> del_node_counts;
@@ -1857,10 +2314,6 @@ namespace db
 
         node_prog_state_mutex.unlock();
 
-        for (auto &p: to_delete) {
-            delete_prog_states(tid, p.first, p.second);
-        }
-
         return node_recover_counts;
     }
 
@@ -1874,6 +2327,291 @@ namespace db
         return done;
     }
 
+    // also true once the VT has cancelled the request, before the done clock catches up
+    inline bool
+    shard :: check_done_prog(vc::vclock &clk, uint64_t req_id)
+    {
+        node_prog_state_mutex.lock();
+        bool done = (clk.get_epoch() < min_prog_epoch)
+                 || (order::oracle::happens_before_no_kronos(clk.clock, prog_done_clk[clk.vt_id]))
+                 || (!cancelled_progs.empty() && cancelled_progs.find(req_id) != cancelled_progs.end());
+        node_prog_state_mutex.unlock();
+        return done;
+    }
+
+    // false if the done clock already covers the request
+    inline bool
+    shard :: cancel_prog(const vc::vclock &clk, uint64_t req_id)
+    {
+        node_prog_state_mutex.lock();
+        bool cancel = (clk.get_epoch() >= min_prog_epoch)
+                   && !order::oracle::happens_before_no_kronos(clk.clock, prog_done_clk[clk.vt_id]);
+        if (cancel) {
+            cancelled_progs.emplace(req_id, clk);
+        }
+        node_prog_state_mutex.unlock();
+        return cancel;
+    }
+
+
+    // Read replicas
+
+    // caller holds a latch on n, which is owned by this shard
+    inline void
+    shard :: note_prog_visit(node *n)
+    {
+        wclock::weaver_timer timer;
+        uint64_t window = timer.ts.tv_sec;
+        bool hot = false;
+
+        n->prog_state_mtx.lock();
+        if (n->visit_window != window) {
+            n->visit_window = window;
+            n->prog_visits = 0;
+        }
+        if (++n->prog_visits == HOT_REPLICA_VISITS && !n->replicated) {
+            hot = true;
+        }
+        n->prog_state_mtx.unlock();
+
+        if (hot) {
+            replica_mutex.lock();
+            hot_candidates.emplace_back(n->get_handle());
+            replica_mutex.unlock();
+        }
+    }
+
+    // called on each nop from VT vt_id with nop_clk
+    // snapshots are labeled with the previous nop clock of that VT, once reads at
+    // that clock are allowed here all writes preceding it have been applied
+    inline void
+    shard :: maintain_replicas(uint64_t tid, const vc::vclock &nop_clk)
+    {
+        replica_mutex.lock();
+        vc::vclock snap_clk = replica_prev_nop[nop_clk.vt_id];
+        replica_prev_nop[nop_clk.vt_id] = nop_clk;
+        for (const node_handle_t &h: hot_candidates) {
+            hot_nodes.emplace(h, 0);
+        }
+        hot_candidates.clear();
+        std::vector<node_handle_t> hot_handles;
+        hot_handles.reserve(hot_nodes.size());
+        for (const auto &p: hot_nodes) {
+            hot_handles.emplace_back(p.first);
+        }
+        replica_mutex.unlock();
+
+        if (hot_handles.empty()
+         || snap_clk.vt_id == UINT64_MAX
+         || !qm.check_rd_request(snap_clk.clock)) {
+            return;
+        }
+
+        uint64_t num_shards = get_num_shards();
+        std::vector<std::pair<node_handle_t, uint64_t>> extended;
+        std::vector<node_handle_t> dropped;
+        message::message msg;
+
+        for (const node_handle_t &h: hot_handles) {
+            node *n = acquire_node_latest(tid, h);
+            if (n == nullptr
+             || n->state != node::mode::STABLE
+             || n->base.get_del_time() != nullptr) {
+                if (n != nullptr) {
+                    n->replicated = false;
+                    release_node(n);
+                }
+                dropped.emplace_back(h);
+                continue;
+            }
+
+            replica_mutex.lock();
+            uint64_t &seq = hot_nodes[h];
+            if (seq == 0 || n->replica_stale) {
+                seq = ++replica_seq;
+                replica_mutex.unlock();
+
+                for (uint64_t loc = ShardIdIncr; loc < ShardIdIncr + num_shards; loc++) {
+                    if (loc != shard_id) {
+                        msg.prepare_message(message::REPLICA_PUSH, nullptr, h, shard_id, seq, snap_clk, *n);
+                        comm.send(loc, msg.buf);
+                    }
+                }
+                if (!n->replicated) {
+                    WDEBUG << "replicating hot node " << h << std::endl;
+                }
+                n->replicated = true;
+                n->replica_stale = false;
+            } else {
+                extended.emplace_back(h, seq);
+                replica_mutex.unlock();
+            }
+            release_node(n);
+        }
+
+        if (!dropped.empty()) {
+            replica_mutex.lock();
+            for (const node_handle_t &h: dropped) {
+                hot_nodes.erase(h);
+            }
+            replica_mutex.unlock();
+        }
+
+        for (uint64_t loc = ShardIdIncr; loc < ShardIdIncr + num_shards; loc++) {
+            if (loc == shard_id) {
+                continue;
+            }
+            if (!extended.empty()) {
+                msg.prepare_message(message::REPLICA_EXTEND, nullptr, snap_clk, extended);
+                comm.send(loc, msg.buf);
+            }
+            if (!dropped.empty()) {
+                msg.prepare_message(message::REPLICA_DROP, nullptr, dropped);
+                comm.send(loc, msg.buf);
+            }
+        }
+    }
+
+    // node state is kept only at the owner
+    inline void
+    shard :: install_replica(message::message &msg)
+    {
+        node_handle_t handle;
+        uint64_t owner, seq;
+        vc::vclock snap_clk;
+        vclock_ptr_t dummy_clk;
+        msg.unpack_partial_message(message::REPLICA_PUSH, handle);
+
+        node *n = new node(handle, UINT64_MAX, dummy_clk, &replica_mutex);
+        msg.unpack_message(message::REPLICA_PUSH, nullptr, handle, owner, seq, snap_clk, *n);
+        n->shard = owner;
+        n->state = node::mode::STABLE;
+        n->in_use = false;
+
+        replica_mutex.lock();
+        replica_entry &entry = replicas[handle];
+        if (entry.n != nullptr && entry.seq >= seq) {
+            // older snapshot arrived late
+            replica_mutex.unlock();
+            n->free_edges();
+            delete n;
+            return;
+        }
+        if (entry.n != nullptr) {
+            retire_replica(entry.n);
+        }
+        entry.n = n;
+        entry.owner = owner;
+        entry.seq = seq;
+        entry.valid_until = snap_clk;
+        replica_mutex.unlock();
+    }
+
+    inline void
+    shard :: extend_replicas(message::message &msg)
+    {
+        vc::vclock valid_clk;
+        std::vector<std::pair<node_handle_t, uint64_t>> extended;
+        msg.unpack_message(message::REPLICA_EXTEND, nullptr, valid_clk, extended);
+
+        replica_mutex.lock();
+        for (const auto &p: extended) {
+            auto iter = replicas.find(p.first);
+            if (iter != replicas.end() && iter->second.seq == p.second) {
+                iter->second.valid_until = valid_clk;
+            }
+        }
+        replica_mutex.unlock();
+    }
+
+    inline void
+    shard :: drop_replicas(message::message &msg)
+    {
+        std::vector<node_handle_t> dropped;
+        msg.unpack_message(message::REPLICA_DROP, nullptr, dropped);
+
+        replica_mutex.lock();
+        for (const node_handle_t &h: dropped) {
+            auto iter = replicas.find(h);
+            if (iter != replicas.end()) {
+                retire_replica(iter->second.n);
+                replicas.erase(iter);
+            }
+        }
+        replica_mutex.unlock();
+    }
+
+    // caution: assuming caller holds replica_mutex
+    // last reader frees a replica that is still being read
+    inline void
+    shard :: retire_replica(node *n)
+    {
+        if (n->is_latched() || n->waiters > 0) {
+            n->permanently_deleted = true;
+        } else {
+            n->free_edges();
+            delete n;
+        }
+    }
+
+    inline bool
+    shard :: replica_servable(const node_handle_t &handle, const vc::vclock &req_clk, const std::string &prog_type, uint64_t &owner)
+    {
+        bool servable = false;
+
+        replica_mutex.lock();
+        if (!replicas.empty() && replica_unsafe_progs.find(prog_type) == replica_unsafe_progs.end()) {
+            auto iter = replicas.find(handle);
+            if (iter != replicas.end()
+             && order::oracle::happens_before_no_kronos(req_clk.clock, iter->second.valid_until.clock)) {
+                owner = iter->second.owner;
+                servable = true;
+            }
+        }
+        replica_mutex.unlock();
+
+        return servable;
+    }
+
+    // shared latch on the current copy, nullptr if it was dropped or refreshed to a copy
+    // that is no longer valid for req_clk, in which case the hop goes to the owner
+    inline node*
+    shard :: acquire_replica_nodeprog(const node_handle_t &handle, const vc::vclock &req_clk, uint64_t req_id)
+    {
+        node *n = nullptr;
+
+        replica_mutex.lock();
+        auto iter = replicas.find(handle);
+        if (iter != replicas.end()
+         && order::oracle::happens_before_no_kronos(req_clk.clock, iter->second.valid_until.clock)) {
+            n = iter->second.n;
+            n->latch_shared(req_id);
+            replica_visits++;
+        }
+        replica_mutex.unlock();
+
+        return n;
+    }
+
+    inline void
+    shard :: release_replica_nodeprog(node *n, uint64_t req_id)
+    {
+        replica_mutex.lock();
+        n->unlatch_shared(req_id);
+        if (n->permanently_deleted && !n->is_latched() && n->waiters == 0) {
+            n->free_edges();
+            delete n;
+        }
+        replica_mutex.unlock();
+    }
+
+    inline void
+    shard :: mark_replica_unsafe(const std::string &prog_type)
+    {
+        replica_mutex.lock();
+        replica_unsafe_progs.emplace(prog_type);
+        replica_mutex.unlock();
+    }
 
     // Fault tolerance
 
@@ -1914,10 +2652,17 @@ namespace db
     }
 
     // restore state when backup becomes primary due to failure
+    // in-neighbors are not backed up, every shard resends the edges to nodes here
     inline void
     shard :: restore_backup()
     {
-        hstub.back()->restore_backup(nodes, /*XXX edge_map,*/ node_map_mutexes);
+        hstub.back()->restore_backup(nodes, node_map_mutexes);
+
+        message::message msg;
+        for (uint64_t loc = ShardIdIncr; loc < ShardIdIncr + get_num_shards(); loc++) {
+            msg.prepare_message(message::IN_EDGE_RESYNC, nullptr, shard_id);
+            comm.send(loc, msg.buf);
+        }
     }
 }
 
@@ -23,6 +23,26 @@
 
 #define BATCH_MSG_SIZE 10 // 1 == no batching
 
+// coalescing node programs of different requests to the same shard
+#define OUTBOX_FLUSH_US 50 // longest a node program message waits in the outbox, 0 == no coalescing
+#define OUTBOX_MAX_FRAMES 256 // upper bound on node program messages per coalesced message
+#define OUTBOX_MAX_BYTES (1 << 20)
+
+// intra-request parallelism
+#define FRONTIER_PIECE_SIZE 1024 // local frontier entries handed to another worker thread at once, 0 == no splitting
+
+// node program hops at one node
+#define MAX_NODE_BATCH 64 // hops of a request at one node run in one call, for programs with batch_node_program, 1 == no batching
+
+// read replicas of hot nodes
+#define HOT_REPLICA_VISITS 0 // node prog visits to a node within one second that make it hot, 0 == no replicas
+
+// version compaction
+#define COMPACT_NODES_PER_NOP 16 // nodes of one node map visited by the compactor on each nop
+
+// in-neighbors
+#define IN_EDGE_HOLD_NOPS 100 // nops an in-neighbor update waits for its node to be created or migrated here
+
 // migration
 //#define WEAVER_CLDG // defined if communication-based LDG, undef otherwise
 //#define WEAVER_NEW_CLDG // defined if communication-based LDG, undef otherwise
@@ -0,0 +1,171 @@
+/*
+ * ===============================================================
+ *    Description:  Fixed size slab allocator for graph elements.
+ *                  Objects are carved out of aligned chunks, and
+ *                  each chunk records its owning slab so that an
+ *                  object can be freed without knowing where it
+ *                  was allocated.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_db_slab_h_
+#define weaver_db_slab_h_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <new>
+#include <vector>
+#include <po6/threads/mutex.h>
+
+namespace db
+{
+    struct slab_stats
+    {
+        uint64_t allocs, frees, chunks, chunk_bytes;
+
+        slab_stats() : allocs(0), frees(0), chunks(0), chunk_bytes(0) { }
+
+        uint64_t live() const { return allocs - frees; }
+
+        slab_stats&
+        operator+=(const slab_stats &other)
+        {
+            allocs += other.allocs;
+            frees += other.frees;
+            chunks += other.chunks;
+            chunk_bytes += other.chunk_bytes;
+            return *this;
+        }
+    };
+
+    template <typename T>
+    class slab
+    {
+        private:
+            // chunks are aligned to their size, so the chunk header is found by masking the object address
+            static const uint64_t chunk_sz = 1 << 16;
+            struct chunk_header
+            {
+                slab<T> *owner;
+            };
+            struct free_slot
+            {
+                free_slot *next;
+            };
+            static const uint64_t slot_sz = ((sizeof(T) > sizeof(free_slot)? sizeof(T) : sizeof(free_slot)) + alignof(T) - 1) / alignof(T) * alignof(T);
+            static const uint64_t first_slot = (sizeof(chunk_header) + alignof(T) - 1) / alignof(T) * alignof(T);
+            static_assert(first_slot + slot_sz <= chunk_sz, "slab chunk too small for element");
+
+            po6::threads::mutex mtx;
+            std::vector<void*> chunks;
+            free_slot *free_list;
+            char *bump, *bump_end;
+            slab_stats counters;
+
+        public:
+            slab();
+            ~slab();
+            slab(const slab&) = delete;
+            slab& operator=(const slab&) = delete;
+
+            void* allocate();
+            void free(void *p);
+            slab_stats stats();
+
+            // return p to the slab that allocated it
+            static void release(void *p);
+    };
+
+    template <typename T>
+    inline
+    slab<T> :: slab()
+        : free_list(nullptr)
+        , bump(nullptr)
+        , bump_end(nullptr)
+    { }
+
+    // objects still allocated are not destructed, slabs live as long as the shard
+    template <typename T>
+    inline
+    slab<T> :: ~slab()
+    {
+        for (void *c: chunks) {
+            ::free(c);
+        }
+    }
+
+    template <typename T>
+    inline void*
+    slab<T> :: allocate()
+    {
+        void *p;
+
+        mtx.lock();
+        if (free_list != nullptr) {
+            p = free_list;
+            free_list = free_list->next;
+        } else {
+            if (bump == bump_end) {
+                void *c = nullptr;
+                if (posix_memalign(&c, chunk_sz, chunk_sz) != 0) {
+                    mtx.unlock();
+                    throw std::bad_alloc();
+                }
+                ((chunk_header*)c)->owner = this;
+                chunks.emplace_back(c);
+                counters.chunks++;
+                counters.chunk_bytes += chunk_sz;
+                bump = (char*)c + first_slot;
+                bump_end = bump + (chunk_sz - first_slot) / slot_sz * slot_sz;
+            }
+            p = bump;
+            bump += slot_sz;
+        }
+        counters.allocs++;
+        mtx.unlock();
+
+        return p;
+    }
+
+    template <typename T>
+    inline void
+    slab<T> :: free(void *p)
+    {
+        mtx.lock();
+        free_slot *s = (free_slot*)p;
+        s->next = free_list;
+        free_list = s;
+        counters.frees++;
+        assert(counters.frees <= counters.allocs);
+        mtx.unlock();
+    }
+
+    template <typename T>
+    inline slab_stats
+    slab<T> :: stats()
+    {
+        mtx.lock();
+        slab_stats s = counters;
+        mtx.unlock();
+        return s;
+    }
+
+    template <typename T>
+    inline void
+    slab<T> :: release(void *p)
+    {
+        if (p == nullptr) {
+            return;
+        }
+        chunk_header *c = (chunk_header*)((uintptr_t)p & ~(uintptr_t)(chunk_sz-1));
+        c->owner->free(p);
+    }
+}
+
+#endif
@@ -2,16 +2,13 @@
 #define weaver_node_prog_base_classes_h_
 
 #include <e/buffer.h>
+#include <memory>
 #include <vector>
 #include <unordered_set>
 #include <iostream>
 
 #include "common/types.h"
-
-namespace db
-{
-    class remote_node;
-}
+#include "db/remote_node.h"
 
 namespace node_prog
 {
@@ -42,10 +39,34 @@ namespace node_prog
         /* destructor must be defined */ 
     }
 
+    // immutable per request data, shipped to a shard once per request instead of with every hop
+    class Node_Constants_Base : public virtual Packable, public virtual Deletable
+    {
+        public:
+            virtual ~Node_Constants_Base() { }
+    };
+
+    typedef std::shared_ptr<Node_Constants_Base> np_const_ptr_t;
+
+    class Cache_Value_Base : public virtual Packable, public virtual Deletable
+    {
+    };
+
     class Node_Parameters_Base : public virtual Packable
     {
-        virtual bool search_cache() = 0;
-        virtual cache_key_t cache_key() = 0;
+        public:
+            // result caching at a node, keyed by cache_key() if search_cache()
+            virtual bool search_cache() = 0;
+            virtual cache_key_t cache_key() = 0;
+            // value cached at this node before the program runs, only if no node in its watch set changed since
+            virtual void set_cache_value(std::shared_ptr<Cache_Value_Base>) { }
+            // value to cache at this node after the program ran, with the nodes it was computed from
+            virtual std::shared_ptr<Cache_Value_Base> take_cache_value(std::vector<db::remote_node>&) { return nullptr; }
+
+            // programs with per request constants move them out of the params at the client,
+            // and get them back on every shard before the first hop runs
+            virtual np_const_ptr_t extract_constants() { return np_const_ptr_t(); }
+            virtual void set_constants(np_const_ptr_t) { }
     };
 
     class Node_State_Base : public virtual Packable, public virtual Deletable 
@@ -55,8 +76,19 @@ namespace node_prog
             std::unordered_set<uint64_t> contexts_found;
     };
 
-    class Cache_Value_Base : public virtual Packable, public virtual Deletable
+    // fixed size per node state, for traversals which only need a visited flag,
+    // a parent and a few counters. The shard keeps these in a dense array per
+    // request indexed by the node's slot, instead of a Node_State_Base per node.
+    // Zeroed on the first visit of a request, see dense_prog_ptr_t
+    struct dense_node_state
     {
+        bool visited;
+        uint32_t hops;
+        uint32_t out_count;
+        uint32_t flags; // program defined
+        db::remote_node parent;
+
+        dense_node_state() : visited(false), hops(0), out_count(0), flags(0) { }
     };
 
     typedef std::shared_ptr<Node_Parameters_Base> np_param_ptr_t;
@@ -67,15 +99,68 @@ namespace node_prog
     typedef void (*param_pack_func_t)(const Node_Parameters_Base&, e::packer&, void*);
     typedef void (*param_unpack_func_t)(Node_Parameters_Base&, e::unpacker&, void*);
 
+    typedef np_const_ptr_t (*const_ctor_func_t)();
+    typedef uint64_t (*const_size_func_t)(const Node_Constants_Base&, void*);
+    typedef void (*const_pack_func_t)(const Node_Constants_Base&, e::packer&, void*);
+    typedef void (*const_unpack_func_t)(Node_Constants_Base&, e::unpacker&, void*);
+
     typedef np_state_ptr_t (*state_ctor_func_t)();
     typedef uint64_t (*state_size_func_t)(const Node_State_Base&, void*);
     typedef void (*state_pack_func_t)(const Node_State_Base&, e::packer&, void*);
     typedef void (*state_unpack_func_t)(Node_State_Base&, e::unpacker&, void*);
+    typedef uint64_t (*state_bytes_func_t)();
+    typedef Node_State_Base* (*state_ctor_at_func_t)(void*);
 
     typedef std::pair<node_prog::search_type, std::vector<std::pair<db::remote_node, np_param_ptr_t>>> (*prog_ptr_t)(node_prog::node &n,
             db::remote_node &rn,
             np_param_ptr_t,
             std::function<Node_State_Base&()> state_getter);
+
+    // optional second entry point of programs with prog_ptr_t, runs several hops of a request
+    // at one node in one call, under one acquisition of the node. next hops of all of them
+    // are returned together, and all share the search type
+    typedef std::pair<node_prog::search_type, std::vector<std::pair<db::remote_node, np_param_ptr_t>>> (*batch_prog_ptr_t)(node_prog::node &n,
+            db::remote_node &rn,
+            std::vector<np_param_ptr_t> &params,
+            std::function<Node_State_Base&()> state_getter);
+
+    // entry point of programs whose only per node state is a dense_node_state
+    typedef std::pair<node_prog::search_type, std::vector<std::pair<db::remote_node, np_param_ptr_t>>> (*dense_prog_ptr_t)(node_prog::node &n,
+            db::remote_node &rn,
+            np_param_ptr_t,
+            dense_node_state &state);
+
+    // state of the node a typed program runs at, see node_prog/typed_program.h
+    // a plain function and its context instead of a std::function, built on the shard's stack every hop
+    struct state_accessor
+    {
+        Node_State_Base& (*get)(void *ctx);
+        void *ctx;
+
+        Node_State_Base& operator()() const { return get(ctx); }
+    };
+
+    typedef std::pair<node_prog::search_type, std::vector<std::pair<db::remote_node, np_param_ptr_t>>> (*typed_prog_ptr_t)(node_prog::node &n,
+            db::remote_node &rn,
+            np_param_ptr_t,
+            const state_accessor &state);
+
+    // whole graph programs, run at every node of every shard in supersteps, see db/bsp_job.h
+    // incoming are the messages sent to this node in the previous superstep,
+    // value persists across supersteps, returns true to vote to halt
+    typedef bool (*bsp_prog_ptr_t)(node_prog::node &n,
+            db::remote_node &rn,
+            uint32_t superstep,
+            np_param_ptr_t global,
+            std::vector<np_param_ptr_t> &incoming,
+            Node_State_Base &value,
+            std::vector<std::pair<db::remote_node, np_param_ptr_t>> &outgoing);
+    // optional, folds a message into another one headed to the same node
+    typedef void (*bsp_combine_func_t)(np_param_ptr_t &into, np_param_ptr_t from);
+    // folds the final value of a node into the result of its shard, result starts out null
+    typedef void (*bsp_result_func_t)(db::remote_node &rn, np_param_ptr_t global, Node_State_Base &value, np_param_ptr_t &result);
+    // merges two partial results of a request, on a shard or at the timestamper, into may be null
+    typedef void (*merge_results_func_t)(np_param_ptr_t &into, np_param_ptr_t from);
 }
 
 #endif
@@ -0,0 +1,187 @@
+/*
+ * ===============================================================
+ *    Description:  Implementation of bidirectional reachability.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include "common/stl_serialization.h"
+#include "node_prog/edge.h"
+#include "node_prog/bireach_program.h"
+
+using node_prog::Node_Parameters_Base;
+using node_prog::search_type;
+using node_prog::dense_node_state;
+using node_prog::bireach_params;
+
+static const uint32_t ReachableFlag = 1;
+static const uint32_t BackwardFlag = 2;
+
+// params
+bireach_params :: bireach_params()
+    : backward(false)
+    , returning(false)
+    , hops(0)
+    , max_back_hops(UINT32_MAX)
+    , reachable(false)
+{ }
+
+uint64_t
+bireach_params :: size(void *aux_args) const
+{
+    return message::size(aux_args, backward)
+         + message::size(aux_args, returning)
+         + message::size(aux_args, prev_node)
+         + message::size(aux_args, source)
+         + message::size(aux_args, dest)
+         + message::size(aux_args, via)
+         + message::size(aux_args, hops)
+         + message::size(aux_args, max_back_hops)
+         + message::size(aux_args, edge_props)
+         + message::size(aux_args, reachable);
+}
+
+void
+bireach_params :: pack(e::packer &packer, void *aux_args) const
+{
+    message::pack_buffer(packer, aux_args, backward);
+    message::pack_buffer(packer, aux_args, returning);
+    message::pack_buffer(packer, aux_args, prev_node);
+    message::pack_buffer(packer, aux_args, source);
+    message::pack_buffer(packer, aux_args, dest);
+    message::pack_buffer(packer, aux_args, via);
+    message::pack_buffer(packer, aux_args, hops);
+    message::pack_buffer(packer, aux_args, max_back_hops);
+    message::pack_buffer(packer, aux_args, edge_props);
+    message::pack_buffer(packer, aux_args, reachable);
+}
+
+void
+bireach_params :: unpack(e::unpacker &unpacker, void *aux_args)
+{
+    message::unpack_buffer(unpacker, aux_args, backward);
+    message::unpack_buffer(unpacker, aux_args, returning);
+    message::unpack_buffer(unpacker, aux_args, prev_node);
+    message::unpack_buffer(unpacker, aux_args, source);
+    message::unpack_buffer(unpacker, aux_args, dest);
+    message::unpack_buffer(unpacker, aux_args, via);
+    message::unpack_buffer(unpacker, aux_args, hops);
+    message::unpack_buffer(unpacker, aux_args, max_back_hops);
+    message::unpack_buffer(unpacker, aux_args, edge_props);
+    message::unpack_buffer(unpacker, aux_args, reachable);
+}
+
+typedef std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>> next_hops_t;
+
+// the source reaches dest through this node
+search_type
+bireach_found(bireach_params &params, dense_node_state &state, next_hops_t &next)
+{
+    state.flags |= ReachableFlag;
+    params.backward = false;
+    params.returning = true;
+    params.reachable = true;
+    next.emplace_back(std::make_pair(db::coordinator, std::make_shared<bireach_params>(params)));
+    return search_type::DEPTH_FIRST;
+}
+
+// hop of the backward search, params.via is an edge from this node to a node which reaches dest
+search_type
+bireach_backward(node_prog::node &n, db::remote_node &rn, bireach_params &params, dense_node_state &state, next_hops_t &next)
+{
+    if (!params.via.empty()) {
+        // the in edge may have been deleted, or not have the props, at the request clock
+        if (!n.edge_exists(params.via)
+         || !n.get_edge(params.via).has_all_properties(params.edge_props)) {
+            return search_type::BREADTH_FIRST;
+        }
+    }
+
+    if (state.visited || n.get_handle() == params.source) {
+        return bireach_found(params, state, next);
+    }
+    if (state.flags & BackwardFlag) {
+        return search_type::BREADTH_FIRST;
+    }
+    state.flags |= BackwardFlag;
+
+    if (params.hops >= params.max_back_hops) {
+        return search_type::BREADTH_FIRST;
+    }
+
+    params.prev_node = rn;
+    params.hops++;
+    for (const db::in_edge &e: n.get_in_edges()) {
+        auto nbr_params = std::make_shared<bireach_params>(params);
+        nbr_params->via = e.get_handle();
+        next.emplace_back(std::make_pair(e.get_neighbor(), nbr_params));
+    }
+    return search_type::BREADTH_FIRST;
+}
+
+extern "C" {
+
+PROG_DENSE_FUNC_DEFINE(bireach);
+
+std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>>
+node_prog :: dense_node_program(node &n,
+   db::remote_node &rn,
+   std::shared_ptr<Node_Parameters_Base> param_ptr,
+   dense_node_state &state)
+{
+    Node_Parameters_Base &param_base = *param_ptr;
+    bireach_params &params = dynamic_cast<bireach_params&>(param_base);
+
+    next_hops_t next;
+    if (state.flags & ReachableFlag) {
+        return std::make_pair(search_type::BREADTH_FIRST, next);
+    }
+
+    if (params.backward) {
+        search_type type = bireach_backward(n, rn, params, state, next);
+        return std::make_pair(type, next);
+    }
+
+    bool false_reply = false;
+    db::remote_node prev_node = params.prev_node;
+    params.prev_node = rn;
+    if (!params.returning) { // request mode
+        if (params.dest == n.get_handle() || (state.flags & BackwardFlag)) {
+            return std::make_pair(bireach_found(params, state, next), next);
+        }
+
+        if (!state.visited) {
+            state.parent = prev_node;
+            state.visited = true;
+
+            for (edge &e: n.get_edges().filter(params.edge_props)) {
+                next.emplace_back(std::make_pair(e.get_neighbor(), std::make_shared<bireach_params>(params)));
+                state.out_count++;
+            }
+            if (state.out_count == 0) {
+                false_reply = true;
+            }
+        } else {
+            false_reply = true;
+        }
+
+        if (false_reply) {
+            params.returning = true;
+            params.reachable = false;
+            next.emplace_back(std::make_pair(prev_node, std::make_shared<bireach_params>(params)));
+        }
+        return std::make_pair(search_type::BREADTH_FIRST, next);
+    } else { // reply mode, only false replies travel up the forward tree
+        assert(state.out_count > 0);
+        if (--state.out_count == 0) {
+            next.emplace_back(std::make_pair(state.parent, std::make_shared<bireach_params>(params)));
+        }
+        return std::make_pair(search_type::BREADTH_FIRST, next);
+    }
+}
+
+}
@@ -0,0 +1,61 @@
+/*
+ * ===============================================================
+ *    Description:  Bidirectional reachability. A forward search
+ *                  from the source over out edges, as in
+ *                  pathless_reach, meets a backward search from
+ *                  the destination over in edges, see
+ *                  db/in_adjacency.h. In edges may lag the out
+ *                  edges, so a backward hop over an in edge is
+ *                  checked against the out edge at its source
+ *                  before it counts. The forward search answers
+ *                  false on its own, the backward search only
+ *                  shortens the way to true.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_node_prog_bireach_program_h_
+#define weaver_node_prog_bireach_program_h_
+
+#include <vector>
+#include <string>
+
+#include "node_prog/boilerplate.h"
+
+namespace node_prog
+{
+    struct bireach_params : public virtual Node_Parameters_Base
+    {
+        bool backward; // hop of the search from dest
+        bool returning; // false = request, true = reply of the forward search
+        db::remote_node prev_node;
+        node_handle_t source, dest;
+        edge_handle_t via; // backward: edge from this node to prev_node, empty at dest
+        uint32_t hops, max_back_hops; // backward hops so far, and the most to take
+        std::vector<std::pair<std::string, std::string>> edge_props;
+        bool reachable;
+
+        bireach_params();
+        ~bireach_params() { }
+        uint64_t size(void*) const;
+        void pack(e::packer &packer, void*) const;
+        void unpack(e::unpacker &unpacker, void*);
+
+        // no caching
+        bool search_cache() { return false; }
+        cache_key_t cache_key() { return cache_key_t(); }
+    };
+
+    // per node state is a dense_node_state: visited, parent and out_count of the
+    // forward search, flags bit 0 once the reachable reply has been sent and
+    // bit 1 once the backward search reached the node
+    extern "C" {
+        PROG_DENSE_FUNC_DECLARE;
+    }
+}
+
+#endif
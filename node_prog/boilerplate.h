@@ -13,6 +13,7 @@
 #ifndef weaver_node_prog_boilerplate_h_
 #define weaver_node_prog_boilerplate_h_
 
+#include <new>
 #include <memory>
 #include <vector>
 #include <deque>
@@ -22,17 +23,24 @@
 #include "node_prog/node.h"
 #include "db/remote_node.h"
 
-#define PROG_FUNC_DECLARE \
+#define PROG_PARAM_FUNC_DECLARE \
     std::shared_ptr<Node_Parameters_Base> param_ctor(); \
-    std::shared_ptr<Node_State_Base> state_ctor(); \
-    \
     uint64_t param_size(const Node_Parameters_Base&, void*); \
     void param_pack(const Node_Parameters_Base&, e::packer&, void*); \
-    void param_unpack(Node_Parameters_Base&, e::unpacker&, void*); \
+    void param_unpack(Node_Parameters_Base&, e::unpacker&, void*);
+
+#define PROG_STATE_FUNC_DECLARE \
+    std::shared_ptr<Node_State_Base> state_ctor(); \
+    uint64_t state_bytes(); \
+    Node_State_Base* state_ctor_at(void*); \
     \
     uint64_t state_size(const Node_State_Base&, void*); \
     void state_pack(const Node_State_Base&, e::packer&, void*); \
-    void state_unpack(Node_State_Base&, e::unpacker&, void*); \
+    void state_unpack(Node_State_Base&, e::unpacker&, void*);
+
+#define PROG_FUNC_DECLARE \
+    PROG_PARAM_FUNC_DECLARE \
+    PROG_STATE_FUNC_DECLARE \
     \
     std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>> \
     node_program(node &n, \
@@ -40,10 +48,66 @@
         std::shared_ptr<Node_Parameters_Base> param_ptr, \
         std::function<Node_State_Base&()> state_getter);
 
+// optional for programs with PROG_FUNC_DECLARE, hops of a request queued at the same node
+// on a shard run in one call
+#define PROG_BATCH_DECLARE \
+    std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>> \
+    batch_node_program(node &n, \
+        db::remote_node &rn, \
+        std::vector<std::shared_ptr<Node_Parameters_Base>> &params, \
+        std::function<Node_State_Base&()> state_getter);
+
+// for programs which keep only a dense_node_state per node, instead of PROG_FUNC_DECLARE
+#define PROG_DENSE_FUNC_DECLARE \
+    PROG_PARAM_FUNC_DECLARE \
+    \
+    std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>> \
+    dense_node_program(node &n, \
+        db::remote_node &rn, \
+        std::shared_ptr<Node_Parameters_Base> param_ptr, \
+        dense_node_state &state);
+
+// folds two results of a request, into is null for the first one
+// traversal programs which export it may return to the coordinator from any number of nodes,
+// each shard merges what its nodes return and the VT merges the shards' results
+#define PROG_MERGE_DECLARE \
+    void merge_results(std::shared_ptr<Node_Parameters_Base> &into, std::shared_ptr<Node_Parameters_Base> from);
+
+// for whole graph programs run in supersteps, instead of PROG_FUNC_DECLARE
+// the state is the value of a node across supersteps
+#define PROG_BSP_FUNC_DECLARE \
+    PROG_PARAM_FUNC_DECLARE \
+    PROG_STATE_FUNC_DECLARE \
+    \
+    bool \
+    bsp_node_program(node &n, \
+        db::remote_node &rn, \
+        uint32_t superstep, \
+        std::shared_ptr<Node_Parameters_Base> global, \
+        std::vector<std::shared_ptr<Node_Parameters_Base>> &incoming, \
+        Node_State_Base &value, \
+        std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>> &outgoing); \
+    void bsp_result(db::remote_node &rn, \
+        std::shared_ptr<Node_Parameters_Base> global, \
+        Node_State_Base &value, \
+        std::shared_ptr<Node_Parameters_Base> &result); \
+    PROG_MERGE_DECLARE
+
+// optional for whole graph programs, messages to the same node are folded before sending
+#define PROG_BSP_COMBINE_DECLARE \
+    void bsp_combine(std::shared_ptr<Node_Parameters_Base> &into, std::shared_ptr<Node_Parameters_Base> from);
+
+// for programs which split per request constants out of their params
+#define PROG_CONST_FUNC_DECLARE \
+    std::shared_ptr<Node_Constants_Base> const_ctor(); \
+    uint64_t const_size(const Node_Constants_Base&, void*); \
+    void const_pack(const Node_Constants_Base&, e::packer&, void*); \
+    void const_unpack(Node_Constants_Base&, e::unpacker&, void*);
+
 #define CAST_ARG_REF(type, arg) \
     type &tp = dynamic_cast<type&>(p);
 
-#define PROG_FUNC_DEFINE(PREFIX) \
+#define PROG_PARAM_FUNC_DEFINE(PREFIX) \
     std::shared_ptr<Node_Parameters_Base> \
     param_ctor() \
     { \
@@ -51,13 +115,6 @@
         return std::dynamic_pointer_cast<Node_Parameters_Base>(new_params); \
     } \
     \
-    std::shared_ptr<Node_State_Base> \
-    state_ctor() \
-    { \
-        auto new_state = std::make_shared<PREFIX##_state>(); \
-        return std::dynamic_pointer_cast<Node_State_Base>(new_state); \
-    } \
-    \
     uint64_t \
     param_size(const Node_Parameters_Base &p, void *aux_args) \
     { \
@@ -77,6 +134,29 @@
     { \
         CAST_ARG_REF(PREFIX##_params, p); \
         tp.unpack(unpacker, aux_args); \
+    }
+
+#define PROG_FUNC_DEFINE(PREFIX) \
+    PROG_PARAM_FUNC_DEFINE(PREFIX) \
+    \
+    std::shared_ptr<Node_State_Base> \
+    state_ctor() \
+    { \
+        auto new_state = std::make_shared<PREFIX##_state>(); \
+        return std::dynamic_pointer_cast<Node_State_Base>(new_state); \
+    } \
+    \
+    uint64_t \
+    state_bytes() \
+    { \
+        return sizeof(PREFIX##_state); \
+    } \
+    \
+    /* construct in memory owned by the shard, see db::request_states */ \
+    Node_State_Base* \
+    state_ctor_at(void *mem) \
+    { \
+        return new (mem) PREFIX##_state(); \
     } \
     \
     uint64_t \
@@ -100,5 +180,41 @@
         tp.unpack(unpacker, aux_args); \
     }
 
+// dense programs define only their params, the shard owns their state
+#define PROG_DENSE_FUNC_DEFINE(PREFIX) \
+    PROG_PARAM_FUNC_DEFINE(PREFIX)
+
+#define PROG_BSP_FUNC_DEFINE(PREFIX) \
+    PROG_FUNC_DEFINE(PREFIX)
+
+#define PROG_CONST_FUNC_DEFINE(PREFIX) \
+    std::shared_ptr<Node_Constants_Base> \
+    const_ctor() \
+    { \
+        auto new_constants = std::make_shared<PREFIX##_constants>(); \
+        return std::dynamic_pointer_cast<Node_Constants_Base>(new_constants); \
+    } \
+    \
+    uint64_t \
+    const_size(const Node_Constants_Base &p, void *aux_args) \
+    { \
+        CAST_ARG_REF(const PREFIX##_constants, p); \
+        return tp.size(aux_args); \
+    } \
+    \
+    void \
+    const_pack(const Node_Constants_Base &p, e::packer &packer, void *aux_args) \
+    { \
+        CAST_ARG_REF(const PREFIX##_constants, p); \
+        tp.pack(packer, aux_args); \
+    } \
+    \
+    void \
+    const_unpack(Node_Constants_Base &p, e::unpacker &unpacker, void *aux_args) \
+    { \
+        CAST_ARG_REF(PREFIX##_constants, p); \
+        tp.unpack(unpacker, aux_args); \
+    }
+
 
 #endif
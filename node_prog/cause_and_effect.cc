@@ -309,10 +309,10 @@ node_prog :: cause_and_effect_node_program(node_prog::node &n,
                         if (params.ancestors.find(nbr.handle) == params.ancestors.end()
                             && e.has_all_predicates(params.edge_preds)) {
                             double confid = -1;
-                            for (auto iter: e.get_properties()) {
-                                if (iter[0]->key == "confidence")
+                            for (prop_view p: e.get_properties()) {
+                                if (p.get_key() == "confidence")
                                 {
-                                    confid = std::stod(iter[0]->value);
+                                    confid = std::stod(p.get_value());
                                     break;
                                 }
                             }
@@ -212,15 +212,14 @@ node_prog :: discover_paths_node_program(node_prog::node &n,
                     std::unordered_set<uint32_t> choose_idx;
 
                     uint32_t edge_iter_idx = 0;
-                    for (edge &e: n.get_edges()) {
+                    for (edge &e: n.get_edges().filter(params.edge_preds)) {
                         const db::remote_node &nbr = e.get_neighbor();
-                        if (params.path_ancestors.find(nbr.handle) == params.path_ancestors.end()
-                        &&  e.has_all_predicates(params.edge_preds)) {
+                        if (params.path_ancestors.find(nbr.handle) == params.path_ancestors.end()) {
                             uint32_t v = 0;
                             if (!params.branching_property.empty()) {
-                                for (auto p_vec: e.get_properties()) {
-                                    std::string key = p_vec[0]->get_key();
-                                    std::string val = p_vec[0]->get_value();
+                                for (node_prog::prop_view p: e.get_properties()) {
+                                    const std::string &key = p.get_key();
+                                    const std::string &val = p.get_value();
                                     if (key == params.branching_property) {
                                         try {
                                             v = std::stoi(val);
@@ -318,9 +317,9 @@ node_prog :: discover_paths_node_program(node_prog::node &n,
                 cur_node = n.get_handle();
             }
             edge_set &eset = dp_state.paths[cur_node];
-            for (edge &e: n.get_edges()) {
+            for (edge &e: n.get_edges().filter(params.edge_preds)) {
                 node_handle_t nbr = e.get_neighbor().handle;
-                if (e.has_all_predicates(params.edge_preds) && dp_state.paths.find(nbr) != dp_state.paths.end()) {
+                if (dp_state.paths.find(nbr) != dp_state.paths.end()) {
                     cl::edge cl_e;
                     e.get_client_edge(n.get_handle(), cl_e);
                     eset.emplace(cl_e);
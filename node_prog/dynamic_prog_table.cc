@@ -23,7 +23,23 @@ dynamic_prog_table :: dynamic_prog_table(void *prog_handle)
     state_size = (state_size_func_t)dlsym(prog_handle, "state_size");
     state_pack = (state_pack_func_t)dlsym(prog_handle, "state_pack");
     state_unpack = (state_unpack_func_t)dlsym(prog_handle, "state_unpack");
+    state_bytes = (state_bytes_func_t)dlsym(prog_handle, "state_bytes");
+    state_ctor_at = (state_ctor_at_func_t)dlsym(prog_handle, "state_ctor_at");
+    if (state_bytes == nullptr) {
+        state_ctor_at = nullptr;
+    }
+    const_ctor = (const_ctor_func_t)dlsym(prog_handle, "const_ctor");
+    const_size = (const_size_func_t)dlsym(prog_handle, "const_size");
+    const_pack = (const_pack_func_t)dlsym(prog_handle, "const_pack");
+    const_unpack = (const_unpack_func_t)dlsym(prog_handle, "const_unpack");
     node_program = (prog_ptr_t)dlsym(prog_handle, "node_program");
+    dense_node_program = (dense_prog_ptr_t)dlsym(prog_handle, "dense_node_program");
+    typed_node_program = (typed_prog_ptr_t)dlsym(prog_handle, "typed_node_program");
+    batch_node_program = (batch_prog_ptr_t)dlsym(prog_handle, "batch_node_program");
+    bsp_node_program = (bsp_prog_ptr_t)dlsym(prog_handle, "bsp_node_program");
+    bsp_combine = (bsp_combine_func_t)dlsym(prog_handle, "bsp_combine");
+    bsp_result = (bsp_result_func_t)dlsym(prog_handle, "bsp_result");
+    merge_results = (merge_results_func_t)dlsym(prog_handle, "merge_results");
 
     m_prog_handle = prog_handle;
 }
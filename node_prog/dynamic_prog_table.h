@@ -17,6 +17,7 @@
 
 using node_prog::np_param_ptr_t;
 using node_prog::np_state_ptr_t;
+using node_prog::np_const_ptr_t;
 using node_prog::param_ctor_func_t;
 using node_prog::param_size_func_t;
 using node_prog::param_pack_func_t;
@@ -25,7 +26,20 @@ using node_prog::state_ctor_func_t;
 using node_prog::state_size_func_t;
 using node_prog::state_pack_func_t;
 using node_prog::state_unpack_func_t;
+using node_prog::state_bytes_func_t;
+using node_prog::state_ctor_at_func_t;
+using node_prog::const_ctor_func_t;
+using node_prog::const_size_func_t;
+using node_prog::const_pack_func_t;
+using node_prog::const_unpack_func_t;
 using node_prog::prog_ptr_t;
+using node_prog::batch_prog_ptr_t;
+using node_prog::dense_prog_ptr_t;
+using node_prog::typed_prog_ptr_t;
+using node_prog::bsp_prog_ptr_t;
+using node_prog::bsp_combine_func_t;
+using node_prog::bsp_result_func_t;
+using node_prog::merge_results_func_t;
 
 struct dynamic_prog_table
 {
@@ -38,8 +52,29 @@ struct dynamic_prog_table
     state_size_func_t   state_size;
     state_pack_func_t   state_pack;
     state_unpack_func_t state_unpack;
+    // null for programs built before states were placed in request arenas
+    state_bytes_func_t   state_bytes;
+    state_ctor_at_func_t state_ctor_at;
 
+    // null unless the program defines per request constants
+    const_ctor_func_t   const_ctor;
+    const_size_func_t   const_size;
+    const_pack_func_t   const_pack;
+    const_unpack_func_t const_unpack;
+
+    // exactly one of these is set, dense programs have no state functions
     prog_ptr_t node_program;
+    dense_prog_ptr_t dense_node_program;
+    typed_prog_ptr_t typed_node_program;
+    // optional, for programs with node_program
+    batch_prog_ptr_t batch_node_program;
+    bsp_prog_ptr_t bsp_node_program;
+
+    // whole graph programs only, bsp_combine is optional
+    bsp_combine_func_t bsp_combine;
+    bsp_result_func_t bsp_result;
+    // whole graph programs, and traversal programs which aggregate their results
+    merge_results_func_t merge_results;
 
     void *m_prog_handle;
 
@@ -11,83 +11,90 @@
  * ===============================================================
  */
 
+#include <algorithm>
+#include "db/key_dictionary.h"
 #include "node_prog/edge_list.h"
 
 using node_prog::edge_map_iter;
+using node_prog::filtered_edge_iter;
+using node_prog::filtered_edge_list;
 using node_prog::edge_list;
+using node_prog::in_edge_iter;
+using node_prog::in_edge_list;
 
-edge_map_iter&
-edge_map_iter :: operator++()
-{
-    while (++internal_cur != internal_end) {
-        bool to_break = false;
+static const uint64_t VisibilityBlockSz = 64;
+static const std::vector<uint32_t> NoSlots;
 
-        for (db::edge *e: internal_cur->second) {
-            assert(internal_cur->first == e->get_handle());
-            if (time_oracle->clock_creat_before_del_after(*req_time, e->base.get_creat_time(), e->base.get_del_time())) {
-                cur_edge = e;
-                to_break = true;
-                break;
-            }
+// advance cur to the next visible slot, computing block masks as needed
+void
+edge_map_iter :: next_visible()
+{
+    uint64_t sz = adj->size();
+    while (block_mask == 0) {
+        block_start += VisibilityBlockSz;
+        if (block_start >= sz) {
+            cur = sz;
+            return;
         }
+        uint32_t num = std::min(VisibilityBlockSz, sz - block_start);
+        block_mask = time_oracle->visible_mask(*req_time,
+            adj->creat_id_block() + block_start,
+            adj->del_id_block() + block_start,
+            num);
+    }
 
-        if (to_break) {
-            break;
-        }
+    uint64_t offset = __builtin_ctzll(block_mask);
+    block_mask &= (block_mask-1);
+    cur = block_start + offset;
+}
+
+edge_map_iter&
+edge_map_iter :: operator++()
+{
+    if (cur < adj->size()) {
+        next_visible();
     }
     return *this;
 }
 
-edge_map_iter :: edge_map_iter(edge_map_t::iterator begin,
-    edge_map_t::iterator end,
+edge_map_iter :: edge_map_iter(db::adjacency *a,
+    uint64_t start,
     std::shared_ptr<vc::vclock> &req_time,
     order::oracle *to)
-    : cur_edge(nullptr)
-    , internal_cur(begin)
-    , internal_end(end)
+    : adj(a)
+    , cur(start)
+    , block_start(start - VisibilityBlockSz) // wraps, next_visible adds it back
+    , block_mask(0)
     , req_time(req_time)
     , time_oracle(to)
 {
-    if (internal_cur != internal_end) {
-        bool to_break = false;
-
-        for (db::edge *e: internal_cur->second) {
-            assert(internal_cur->first == e->get_handle());
-            if (time_oracle->clock_creat_before_del_after(*req_time, e->base.get_creat_time(), e->base.get_del_time())) {
-                cur_edge = e;
-                to_break = true;
-                break;
-            }
-        }
-
-        if (!to_break) {
-            ++(*this);
-        }
+    if (cur < adj->size()) {
+        next_visible();
     }
 }
 
 bool
 edge_map_iter :: operator==(const edge_map_iter& rhs)
 {
-    return internal_cur == rhs.internal_cur && *req_time == *rhs.req_time;
+    return cur == rhs.cur && *req_time == *rhs.req_time;
 }
 
 bool
 edge_map_iter :: operator!=(const edge_map_iter& rhs)
 {
-    return internal_cur != rhs.internal_cur || !(*req_time == *rhs.req_time);
+    return cur != rhs.cur || !(*req_time == *rhs.req_time);
 }
 
 node_prog::edge&
 edge_map_iter :: operator*()
 {
-    db::edge &toRet = *cur_edge;
+    db::edge &toRet = *adj->at(cur);
     toRet.base.view_time = req_time;
     toRet.base.time_oracle = time_oracle;
     return toRet;
 }
 
-edge_list :: edge_list(edge_map_t &edge_list,
+edge_list :: edge_list(db::adjacency &edge_list,
     std::shared_ptr<vc::vclock> &req_time,
     order::oracle *to)
     : wrapped(edge_list)
@@ -98,13 +105,13 @@ edge_list :: edge_list(edge_map_t &edge_list,
 edge_map_iter
 edge_list :: begin()
 {
-    return edge_map_iter(wrapped.begin(), wrapped.end(), req_time, time_oracle);
+    return edge_map_iter(&wrapped, 0, req_time, time_oracle);
 }
 
 edge_map_iter
 edge_list :: end()
 {
-    return edge_map_iter(wrapped.end(), wrapped.end(), req_time, time_oracle);
+    return edge_map_iter(&wrapped, wrapped.size(), req_time, time_oracle);
 }
 
 uint64_t
@@ -112,3 +119,202 @@ edge_list :: count()
 {
     return wrapped.size();
 }
+
+filtered_edge_list
+edge_list :: filter(std::vector<std::pair<std::string, std::string>> &props)
+{
+    return filtered_edge_list(wrapped, &props, nullptr, req_time, time_oracle);
+}
+
+filtered_edge_list
+edge_list :: filter(std::vector<predicate::prop_predicate> &preds)
+{
+    return filtered_edge_list(wrapped, nullptr, &preds, req_time, time_oracle);
+}
+
+// slots of the most selective equality, nullptr if the block has no index or there is no equality
+inline const std::vector<uint32_t>*
+fewest_slots(db::adjacency &adj, const std::string &key, const std::string &value, const std::vector<uint32_t> *fewest)
+{
+    uint32_t kid = db::property_keys.lookup(key);
+    if (kid == db::key_dictionary::invalid_id) {
+        return &NoSlots;
+    }
+    const std::vector<uint32_t> &slots = adj.prop_slots(kid, value);
+    return (fewest == nullptr || slots.size() < fewest->size())? &slots : fewest;
+}
+
+filtered_edge_list :: filtered_edge_list(db::adjacency &edge_list,
+    std::vector<std::pair<std::string, std::string>> *p,
+    std::vector<predicate::prop_predicate> *pr,
+    std::shared_ptr<vc::vclock> &req_time,
+    order::oracle *to)
+    : wrapped(edge_list)
+    , props(p)
+    , preds(pr)
+    , slots(nullptr)
+    , req_time(req_time)
+    , time_oracle(to)
+{
+    if (!wrapped.prop_indexed()) {
+        return;
+    }
+
+    if (props != nullptr) {
+        for (const auto &kv: *props) {
+            slots = fewest_slots(wrapped, kv.first, kv.second, slots);
+        }
+    } else {
+        for (const predicate::prop_predicate &pred: *preds) {
+            if (pred.rel == predicate::EQUALS) {
+                slots = fewest_slots(wrapped, pred.key, pred.value, slots);
+            }
+        }
+    }
+}
+
+filtered_edge_iter
+filtered_edge_list :: begin()
+{
+    return filtered_edge_iter(&wrapped, props, preds, slots, false, req_time, time_oracle);
+}
+
+filtered_edge_iter
+filtered_edge_list :: end()
+{
+    return filtered_edge_iter(&wrapped, props, preds, slots, true, req_time, time_oracle);
+}
+
+filtered_edge_iter :: filtered_edge_iter(db::adjacency *a,
+    std::vector<std::pair<std::string, std::string>> *p,
+    std::vector<predicate::prop_predicate> *pr,
+    const std::vector<uint32_t> *s,
+    bool at_end,
+    std::shared_ptr<vc::vclock> &req_time,
+    order::oracle *to)
+    : adj(a)
+    , props(p)
+    , preds(pr)
+    , slots(s)
+    , pos(0)
+    , scan(a, (at_end || s != nullptr)? a->size() : 0, req_time, to)
+    , scan_end(a, a->size(), req_time, to)
+    , cur(nullptr)
+    , req_time(req_time)
+    , time_oracle(to)
+{
+    if (!at_end) {
+        next_match();
+    }
+}
+
+bool
+filtered_edge_iter :: matches(edge &e)
+{
+    return props != nullptr? e.has_all_properties(*props) : e.has_all_predicates(*preds);
+}
+
+void
+filtered_edge_iter :: next_match()
+{
+    cur = nullptr;
+
+    if (slots == nullptr) {
+        while (scan != scan_end) {
+            edge &e = *scan;
+            ++scan;
+            if (matches(e)) {
+                cur = &e;
+                return;
+            }
+        }
+        return;
+    }
+
+    // the index may list slots past the end, of edges removed since
+    uint64_t sz = adj->size();
+    while (pos < slots->size() && (*slots)[pos] < sz) {
+        uint32_t slot = (*slots)[pos++];
+        if (!time_oracle->clock_creat_before_del_after(*req_time, adj->creat_id_block()[slot], adj->del_id_block()[slot])) {
+            continue;
+        }
+        db::edge &e = *adj->at(slot);
+        e.base.view_time = req_time;
+        e.base.time_oracle = time_oracle;
+        if (matches(e)) {
+            cur = &e;
+            return;
+        }
+    }
+}
+
+filtered_edge_iter&
+filtered_edge_iter :: operator++()
+{
+    if (cur != nullptr) {
+        next_match();
+    }
+    return *this;
+}
+
+// in edges
+void
+in_edge_iter :: next_visible()
+{
+    uint64_t sz = adj->size();
+    while (cur < sz) {
+        const db::in_edge &e = adj->at(cur);
+        if (time_oracle->clock_creat_before_del_after(*req_time, e.creat_id, e.del_id)) {
+            return;
+        }
+        cur++;
+    }
+}
+
+in_edge_iter&
+in_edge_iter :: operator++()
+{
+    if (cur < adj->size()) {
+        cur++;
+        next_visible();
+    }
+    return *this;
+}
+
+in_edge_iter :: in_edge_iter(const db::in_adjacency *a,
+    uint64_t start,
+    std::shared_ptr<vc::vclock> &req_time,
+    order::oracle *to)
+    : adj(a)
+    , cur(start)
+    , req_time(req_time)
+    , time_oracle(to)
+{
+    next_visible();
+}
+
+in_edge_list :: in_edge_list(const db::in_adjacency &in_edges,
+    std::shared_ptr<vc::vclock> &req_time,
+    order::oracle *to)
+    : wrapped(in_edges)
+    , req_time(req_time)
+    , time_oracle(to)
+{ }
+
+in_edge_iter
+in_edge_list :: begin()
+{
+    return in_edge_iter(&wrapped, 0, req_time, time_oracle);
+}
+
+in_edge_iter
+in_edge_list :: end()
+{
+    return in_edge_iter(&wrapped, wrapped.size(), req_time, time_oracle);
+}
+
+uint64_t
+in_edge_list :: count()
+{
+    return wrapped.size();
+}
@@ -16,27 +16,35 @@
 
 #include <stdint.h>
 #include <iterator>
+#include <string>
+#include <vector>
 
 #include "db/edge.h"
-#include "db/types.h"
+#include "db/adjacency.h"
+#include "db/in_adjacency.h"
 #include "common/event_order.h"
+#include "common/property_predicate.h"
 #include "node_prog/edge.h"
 
 namespace node_prog
 {
-    using edge_map_t = db::data_map<std::vector<db::edge*>>;
+    // visits edges of an adjacency block visible at req_time
+    // visibility is computed 64 slots at a time by order::oracle::visible_mask
     class edge_map_iter : public std::iterator<std::input_iterator_tag, edge>
     {
-        db::edge *cur_edge;
-        edge_map_t::iterator internal_cur;
-        edge_map_t::iterator internal_end;
+        db::adjacency *adj;
+        uint64_t cur; // current slot, == adj->size() at end
+        uint64_t block_start;
+        uint64_t block_mask; // visible slots in current block not yet visited
         std::shared_ptr<vc::vclock> req_time;
         order::oracle *time_oracle;
 
+        void next_visible();
+
         public:
             edge_map_iter& operator++();
-            edge_map_iter(edge_map_t::iterator begin,
-                edge_map_t::iterator end,
+            edge_map_iter(db::adjacency *adj,
+                uint64_t start,
                 std::shared_ptr<vc::vclock> &req_time,
                 order::oracle *time_oracle);
             bool operator==(const edge_map_iter& rhs);
@@ -44,20 +52,113 @@ namespace node_prog
             edge& operator*();
     };
 
+    // visits edges visible at req_time which have all of props, or satisfy all of preds
+    // if the adjacency block has a property index, only the slots listed for the most
+    // selective equality are checked, otherwise all visible edges are
+    class filtered_edge_iter : public std::iterator<std::input_iterator_tag, edge>
+    {
+        db::adjacency *adj;
+        std::vector<std::pair<std::string, std::string>> *props;
+        std::vector<predicate::prop_predicate> *preds;
+        const std::vector<uint32_t> *slots; // nullptr if scanning
+        uint64_t pos; // in slots
+        edge_map_iter scan, scan_end;
+        edge *cur; // nullptr at end
+        std::shared_ptr<vc::vclock> req_time;
+        order::oracle *time_oracle;
+
+        bool matches(edge &e);
+        void next_match();
+
+        public:
+            filtered_edge_iter& operator++();
+            filtered_edge_iter(db::adjacency *adj,
+                std::vector<std::pair<std::string, std::string>> *props,
+                std::vector<predicate::prop_predicate> *preds,
+                const std::vector<uint32_t> *slots,
+                bool at_end,
+                std::shared_ptr<vc::vclock> &req_time,
+                order::oracle *time_oracle);
+            bool operator==(const filtered_edge_iter& rhs) { return cur == rhs.cur; }
+            bool operator!=(const filtered_edge_iter& rhs) { return cur != rhs.cur; }
+            edge& operator*() { return *cur; }
+    };
+
+    class filtered_edge_list
+    {
+        private:
+            db::adjacency &wrapped;
+            std::vector<std::pair<std::string, std::string>> *props;
+            std::vector<predicate::prop_predicate> *preds;
+            const std::vector<uint32_t> *slots;
+            std::shared_ptr<vc::vclock> &req_time;
+            order::oracle *time_oracle;
+
+        public:
+            filtered_edge_list(db::adjacency &edge_list,
+                std::vector<std::pair<std::string, std::string>> *props,
+                std::vector<predicate::prop_predicate> *preds,
+                std::shared_ptr<vc::vclock> &req_time,
+                order::oracle *time_oracle);
+            filtered_edge_iter begin();
+            filtered_edge_iter end();
+    };
+
     class edge_list
     {
         private:
-            edge_map_t &wrapped;
+            db::adjacency &wrapped;
             std::shared_ptr<vc::vclock> &req_time;
             order::oracle *time_oracle;
 
         public:
-            edge_list(edge_map_t &edge_list,
+            edge_list(db::adjacency &edge_list,
                 std::shared_ptr<vc::vclock> &req_time,
                 order::oracle *time_oracle);
             edge_map_iter begin();
             edge_map_iter end();
             uint64_t count();
+            // edges with all of props, props must outlive the iteration
+            filtered_edge_list filter(std::vector<std::pair<std::string, std::string>> &props);
+            // edges which satisfy all of preds, preds must outlive the iteration
+            filtered_edge_list filter(std::vector<predicate::prop_predicate> &preds);
+    };
+
+    // visits in edges visible at req_time, see db/in_adjacency.h
+    class in_edge_iter : public std::iterator<std::input_iterator_tag, db::in_edge>
+    {
+        const db::in_adjacency *adj;
+        uint64_t cur; // == adj->size() at end
+        std::shared_ptr<vc::vclock> req_time;
+        order::oracle *time_oracle;
+
+        void next_visible();
+
+        public:
+            in_edge_iter& operator++();
+            in_edge_iter(const db::in_adjacency *adj,
+                uint64_t start,
+                std::shared_ptr<vc::vclock> &req_time,
+                order::oracle *time_oracle);
+            bool operator==(const in_edge_iter& rhs) { return cur == rhs.cur; }
+            bool operator!=(const in_edge_iter& rhs) { return cur != rhs.cur; }
+            const db::in_edge& operator*() { return adj->at(cur); }
+    };
+
+    class in_edge_list
+    {
+        private:
+            const db::in_adjacency &wrapped;
+            std::shared_ptr<vc::vclock> &req_time;
+            order::oracle *time_oracle;
+
+        public:
+            in_edge_list(const db::in_adjacency &in_edges,
+                std::shared_ptr<vc::vclock> &req_time,
+                order::oracle *time_oracle);
+            in_edge_iter begin();
+            in_edge_iter end();
+            uint64_t count();
     };
 }
 
@@ -0,0 +1,287 @@
+/*
+ * ===============================================================
+ *    Description:  Implementation of multi source BFS.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <algorithm>
+
+#include "common/stl_serialization.h"
+#include "node_prog/edge.h"
+#include "node_prog/msbfs_program.h"
+
+using node_prog::Node_Parameters_Base;
+using node_prog::Node_State_Base;
+using node_prog::search_type;
+using node_prog::Node_Constants_Base;
+using node_prog::np_const_ptr_t;
+using node_prog::msbfs_constants;
+using node_prog::msbfs_params;
+using node_prog::msbfs_state;
+
+// constants
+msbfs_constants :: msbfs_constants()
+    : max_hops(UINT32_MAX)
+{ }
+
+uint64_t
+msbfs_constants :: size(void *aux_args) const
+{
+    return message::size(aux_args, targets)
+         + message::size(aux_args, max_hops)
+         + message::size(aux_args, edge_props);
+}
+
+void
+msbfs_constants :: pack(e::packer &packer, void *aux_args) const
+{
+    message::pack_buffer(packer, aux_args, targets);
+    message::pack_buffer(packer, aux_args, max_hops);
+    message::pack_buffer(packer, aux_args, edge_props);
+}
+
+void
+msbfs_constants :: unpack(e::unpacker &unpacker, void *aux_args)
+{
+    message::unpack_buffer(unpacker, aux_args, targets);
+    message::unpack_buffer(unpacker, aux_args, max_hops);
+    message::unpack_buffer(unpacker, aux_args, edge_props);
+}
+
+// params
+msbfs_params :: msbfs_params()
+    : max_hops(UINT32_MAX)
+    , frontier(0)
+    , hops(0)
+{ }
+
+uint64_t
+msbfs_params :: size(void *aux_args) const
+{
+    return message::size(aux_args, frontier)
+         + message::size(aux_args, hops)
+         + message::size(aux_args, distances);
+}
+
+void
+msbfs_params :: pack(e::packer &packer, void *aux_args) const
+{
+    message::pack_buffer(packer, aux_args, frontier);
+    message::pack_buffer(packer, aux_args, hops);
+    message::pack_buffer(packer, aux_args, distances);
+}
+
+void
+msbfs_params :: unpack(e::unpacker &unpacker, void *aux_args)
+{
+    message::unpack_buffer(unpacker, aux_args, frontier);
+    message::unpack_buffer(unpacker, aux_args, hops);
+    message::unpack_buffer(unpacker, aux_args, distances);
+}
+
+np_const_ptr_t
+msbfs_params :: extract_constants()
+{
+    constants = std::make_shared<msbfs_constants>();
+    constants->targets = std::move(targets);
+    constants->max_hops = max_hops;
+    constants->edge_props = std::move(edge_props);
+    targets.clear();
+    edge_props.clear();
+    return constants;
+}
+
+void
+msbfs_params :: set_constants(np_const_ptr_t c)
+{
+    constants = std::dynamic_pointer_cast<msbfs_constants>(c);
+}
+
+// state
+uint64_t
+msbfs_state :: size(void *aux_args) const
+{
+    return message::size(aux_args, reached);
+}
+
+void
+msbfs_state :: pack(e::packer &packer, void *aux_args) const
+{
+    message::pack_buffer(packer, aux_args, reached);
+}
+
+void
+msbfs_state :: unpack(e::unpacker &unpacker, void *aux_args)
+{
+    message::unpack_buffer(unpacker, aux_args, reached);
+}
+
+typedef std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>> next_hops_t;
+
+// records that the queries in frontier reached the node in hops hops,
+// returns those for which no fewer hops had reached it before
+uint64_t
+msbfs_reach(msbfs_state &state, uint32_t hops, uint64_t frontier)
+{
+    std::vector<uint64_t> &reached = state.reached;
+
+    uint64_t earlier = 0;
+    for (uint32_t h = 0; h < reached.size() && h <= hops; h++) {
+        earlier |= reached[h];
+    }
+
+    uint64_t fresh = frontier & ~earlier;
+    if (fresh == 0) {
+        return 0;
+    }
+
+    if (reached.size() <= hops) {
+        reached.resize(hops+1, 0);
+    }
+    reached[hops] |= fresh;
+    for (uint32_t h = hops+1; h < reached.size(); h++) {
+        reached[h] &= ~fresh;
+    }
+
+    return fresh;
+}
+
+// one BFS level at node n for the queries in fresh
+// queries whose target is n return their distance, the rest go on to the neighbors
+void
+msbfs_expand(node_prog::node &n,
+    const std::shared_ptr<msbfs_constants> &constants,
+    uint32_t hops,
+    uint64_t fresh,
+    next_hops_t &next)
+{
+    using node_prog::edge;
+
+    std::shared_ptr<msbfs_params> result;
+    const node_handle_t &handle = n.get_handle();
+    for (uint64_t bits = fresh; bits != 0; bits &= bits-1) {
+        uint32_t q = __builtin_ctzll(bits);
+        if (constants->targets[q] == handle) {
+            if (result == nullptr) {
+                result = std::make_shared<msbfs_params>();
+                result->distances.resize(constants->targets.size(), node_prog::MsbfsUnreachable);
+            }
+            result->distances[q] = hops;
+            fresh &= ~(1ULL << q);
+        }
+    }
+
+    if (result != nullptr) {
+        next.emplace_back(std::make_pair(db::coordinator, result));
+    }
+
+    if (fresh == 0 || hops >= constants->max_hops) {
+        return;
+    }
+
+    // one params for all neighbors, the program never modifies params it receives
+    auto nbr_params = std::make_shared<msbfs_params>();
+    nbr_params->constants = constants;
+    nbr_params->frontier = fresh;
+    nbr_params->hops = hops+1;
+
+    for (edge &e: n.get_edges().filter(constants->edge_props)) {
+        next.emplace_back(std::make_pair(e.get_neighbor(), nbr_params));
+    }
+}
+
+extern "C" {
+
+PROG_FUNC_DEFINE(msbfs);
+PROG_CONST_FUNC_DEFINE(msbfs);
+
+std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>>
+node_prog :: node_program(node &n,
+   db::remote_node&,
+   std::shared_ptr<Node_Parameters_Base> param_ptr,
+   std::function<Node_State_Base&()> state_getter)
+{
+    Node_State_Base &state_base = state_getter();
+    msbfs_state &state = dynamic_cast<msbfs_state&>(state_base);
+
+    Node_Parameters_Base &param_base = *param_ptr;
+    msbfs_params &params = dynamic_cast<msbfs_params&>(param_base);
+    assert(params.constants);
+
+    next_hops_t next;
+    uint64_t fresh = msbfs_reach(state, params.hops, params.frontier);
+    if (fresh != 0) {
+        msbfs_expand(n, params.constants, params.hops, fresh, next);
+    }
+
+    return std::make_pair(search_type::BREADTH_FIRST, next);
+}
+
+// hops from different neighbors carrying different queries to this node are merged
+// by hop count, and the edges scanned once per hop count
+std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>>
+node_prog :: batch_node_program(node &n,
+   db::remote_node&,
+   std::vector<std::shared_ptr<Node_Parameters_Base>> &params,
+   std::function<Node_State_Base&()> state_getter)
+{
+    Node_State_Base &state_base = state_getter();
+    msbfs_state &state = dynamic_cast<msbfs_state&>(state_base);
+
+    std::shared_ptr<msbfs_constants> constants;
+    std::vector<std::pair<uint32_t, uint64_t>> levels; // hops, queries
+    for (std::shared_ptr<Node_Parameters_Base> &p: params) {
+        msbfs_params &hop = dynamic_cast<msbfs_params&>(*p);
+        assert(hop.constants);
+        constants = hop.constants;
+
+        uint64_t fresh = msbfs_reach(state, hop.hops, hop.frontier);
+        if (fresh == 0) {
+            continue;
+        }
+        auto iter = std::find_if(levels.begin(), levels.end(),
+            [&hop](const std::pair<uint32_t, uint64_t> &l) { return l.first == hop.hops; });
+        if (iter == levels.end()) {
+            levels.emplace_back(hop.hops, fresh);
+        } else {
+            iter->second |= fresh;
+        }
+    }
+    std::sort(levels.begin(), levels.end());
+
+    next_hops_t next;
+    for (auto &l: levels) {
+        // a later hop of the batch may have reached the node with fewer hops
+        uint64_t fresh = l.second & state.reached[l.first];
+        if (fresh != 0) {
+            msbfs_expand(n, constants, l.first, fresh, next);
+        }
+    }
+
+    return std::make_pair(search_type::BREADTH_FIRST, next);
+}
+
+void
+node_prog :: merge_results(std::shared_ptr<Node_Parameters_Base> &into, std::shared_ptr<Node_Parameters_Base> from)
+{
+    if (into == nullptr) {
+        into = from;
+        return;
+    }
+
+    std::vector<uint32_t> &res = dynamic_cast<msbfs_params&>(*into).distances;
+    std::vector<uint32_t> &other = dynamic_cast<msbfs_params&>(*from).distances;
+    if (res.size() < other.size()) {
+        res.resize(other.size(), MsbfsUnreachable);
+    }
+    for (uint64_t q = 0; q < other.size(); q++) {
+        res[q] = std::min(res[q], other[q]);
+    }
+}
+
+}
@@ -0,0 +1,94 @@
+/*
+ * ===============================================================
+ *    Description:  Multi source BFS. Answers up to MaxQueries
+ *                  hop distance queries (source, target) in one
+ *                  request. Each query is a bit of a 64 bit mask,
+ *                  a hop carries the mask of queries whose BFS
+ *                  reached the node, so queries share the edge
+ *                  scans and the messages of the traversal. Hops
+ *                  queued at the same node on a shard are merged
+ *                  by hop count before the edges are scanned.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_node_prog_msbfs_program_h_
+#define weaver_node_prog_msbfs_program_h_
+
+#include <vector>
+#include <string>
+
+#include "node_prog/boilerplate.h"
+
+namespace node_prog
+{
+    static const uint32_t MaxMsbfsQueries = 64;
+    static const uint32_t MsbfsUnreachable = UINT32_MAX;
+
+    // target of each query, and the hop limit and edge props of all of them
+    struct msbfs_constants: public virtual Node_Constants_Base
+    {
+        std::vector<node_handle_t> targets;
+        uint32_t max_hops;
+        std::vector<std::pair<std::string, std::string>> edge_props;
+
+        msbfs_constants();
+        ~msbfs_constants() { }
+        uint64_t size(void*) const;
+        void pack(e::packer &packer, void*) const;
+        void unpack(e::unpacker &unpacker, void*);
+    };
+
+    struct msbfs_params: public virtual Node_Parameters_Base
+    {
+        // filled in by the client, moved to constants before the request is sent
+        std::vector<node_handle_t> targets;
+        uint32_t max_hops;
+        std::vector<std::pair<std::string, std::string>> edge_props;
+        std::shared_ptr<msbfs_constants> constants;
+        // hop: queries which reached this node in hops hops
+        uint64_t frontier;
+        uint32_t hops;
+        // result: hops from source to target per query, MsbfsUnreachable if not found
+        std::vector<uint32_t> distances;
+
+        msbfs_params();
+        ~msbfs_params() { }
+        uint64_t size(void*) const;
+        void pack(e::packer &packer, void*) const;
+        void unpack(e::unpacker &unpacker, void*);
+
+        np_const_ptr_t extract_constants();
+        void set_constants(np_const_ptr_t c);
+
+        // no caching
+        bool search_cache() { return false; }
+        cache_key_t cache_key() { return cache_key_t(); }
+    };
+
+    struct msbfs_state: public virtual Node_State_Base
+    {
+        // queries by the fewest hops they reached this node with, reached[h] for h hops
+        // hops across shards arrive out of BFS order, a query reaching the node
+        // again with fewer hops moves down and is expanded again
+        std::vector<uint64_t> reached;
+
+        ~msbfs_state() { }
+        uint64_t size(void*) const;
+        void pack(e::packer &packer, void*) const;
+        void unpack(e::unpacker &unpacker, void*);
+    };
+
+    extern "C" {
+        PROG_FUNC_DECLARE;
+        PROG_BATCH_DECLARE;
+        PROG_CONST_FUNC_DECLARE;
+        PROG_MERGE_DECLARE;
+    }
+}
+
+#endif
@@ -229,9 +229,9 @@ node_prog :: n_gram_path_node_program(node_prog::node &n,
                     if (e.has_all_predicates(params.edge_preds)) {
                         doc_id = -1;
                         date   = "";
-                        for (auto iter: e.get_properties()) {
-                            if (iter[0]->key == "locs") {
-                                parse_locs(iter[0]->value, params.doc_map);
+                        for (prop_view p: e.get_properties()) {
+                            if (p.get_key() == "locs") {
+                                parse_locs(p.get_value(), params.doc_map);
                             }
                         }
                     }
@@ -263,9 +263,9 @@ node_prog :: n_gram_path_node_program(node_prog::node &n,
                 edge &e = n.get_edge(eh);
                 if (e.has_all_predicates(params.edge_preds)) {
                     const db::remote_node &nbr = e.get_neighbor();
-                    for (auto iter: e.get_properties()) {
-                        if (iter[0]->key == "locs") {
-                            std::string value = iter[0]->value;
+                    for (prop_view p: e.get_properties()) {
+                        if (p.get_key() == "locs") {
+                            std::string value = p.get_value();
                             value.erase(remove_if(value.begin(), value.end(), isspace), value.end()); // remove whitespace
                             std::stringstream ss(value);
                             std::string item;
@@ -20,11 +20,36 @@
 using node_prog::Node_Parameters_Base;
 using node_prog::Node_State_Base;
 using node_prog::search_type;
+using node_prog::Node_Constants_Base;
+using node_prog::np_const_ptr_t;
+using node_prog::nn_constants;
 using node_prog::nn_params;
 using node_prog::nn_state;
 using node_prog::node;
 using node_prog::edge;
 
+// constants
+uint64_t
+nn_constants :: size(void *aux_args) const
+{
+    return message::size(aux_args, network_description)
+         + message::size(aux_args, act_func);
+}
+
+void
+nn_constants :: pack(e::packer &packer, void *aux_args) const
+{
+    message::pack_buffer(packer, aux_args, network_description);
+    message::pack_buffer(packer, aux_args, act_func);
+}
+
+void
+nn_constants :: unpack(e::unpacker &unpacker, void *aux_args)
+{
+    message::unpack_buffer(unpacker, aux_args, network_description);
+    message::unpack_buffer(unpacker, aux_args, act_func);
+}
+
 // params
 nn_params :: nn_params()
     : order(-1)
@@ -34,10 +59,8 @@ nn_params :: nn_params()
 uint64_t
 nn_params :: size(void *aux_args) const
 {
-    return message::size(aux_args, network_description)
-         + message::size(aux_args, input)
+    return message::size(aux_args, input)
          + message::size(aux_args, order)
-         + message::size(aux_args, act_func)
          + message::size(aux_args, layer_type)
          + message::size(aux_args, layer_op);
 }
@@ -45,10 +68,8 @@ nn_params :: size(void *aux_args) const
 void
 nn_params :: pack(e::packer &packer, void *aux_args) const
 {
-    message::pack_buffer(packer, aux_args, network_description);
     message::pack_buffer(packer, aux_args, input);
     message::pack_buffer(packer, aux_args, order);
-    message::pack_buffer(packer, aux_args, act_func);
     message::pack_buffer(packer, aux_args, layer_type);
     message::pack_buffer(packer, aux_args, layer_op);
 }
@@ -56,14 +77,30 @@ nn_params :: pack(e::packer &packer, void *aux_args) const
 void
 nn_params :: unpack(e::unpacker &unpacker, void *aux_args)
 {
-    message::unpack_buffer(unpacker, aux_args, network_description);
     message::unpack_buffer(unpacker, aux_args, input);
     message::unpack_buffer(unpacker, aux_args, order);
-    message::unpack_buffer(unpacker, aux_args, act_func);
     message::unpack_buffer(unpacker, aux_args, layer_type);
     message::unpack_buffer(unpacker, aux_args, layer_op);
 }
 
+np_const_ptr_t
+nn_params :: extract_constants()
+{
+    constants = std::make_shared<nn_constants>();
+    constants->network_description = std::move(network_description);
+    constants->act_func = std::move(act_func);
+    network_description.first.clear();
+    network_description.second.clear();
+    act_func.clear();
+    return constants;
+}
+
+void
+nn_params :: set_constants(np_const_ptr_t c)
+{
+    constants = std::dynamic_pointer_cast<nn_constants>(c);
+}
+
 // state
 nn_state :: nn_state()
     : visited(false)
@@ -203,6 +240,7 @@ apply_activation_function(double val, const std::string &func)
 extern "C" {
 
 PROG_FUNC_DEFINE(nn);
+PROG_CONST_FUNC_DEFINE(nn);
 
 std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>>
 node_prog :: node_program(node &n,
@@ -220,7 +258,10 @@ node_prog :: node_program(node &n,
 
     std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>> next;
 
-    if (n.get_handle() == params.network_description.first) {
+    assert(params.constants);
+    const nn_constants &constants = *params.constants;
+
+    if (n.get_handle() == constants.network_description.first) {
         // first node/layer
         state.visited = true;
         auto input = params.input;
@@ -244,7 +285,7 @@ node_prog :: node_program(node &n,
                                                  std::make_shared<nn_params>(params)));
             }
         }
-    } else if (n.get_handle() == params.network_description.second) {
+    } else if (n.get_handle() == constants.network_description.second) {
         // last node/layer
         if (!state.visited) {
             state.visited = true;
@@ -281,7 +322,7 @@ node_prog :: node_program(node &n,
 
         if (--state.in_count == 0) {
             //WDEBUG << "in count zero" << std::endl;
-            state.value[0] = apply_activation_function(state.value[0], params.act_func);
+            state.value[0] = apply_activation_function(state.value[0], constants.act_func);
             //WDEBUG << "val=" << state.value[0]
             //       << " val sz=" << state.value.size()
             //       << std::endl;
@@ -18,9 +18,21 @@
 
 namespace node_prog
 {
+    struct nn_constants: public virtual Node_Constants_Base
+    {
+        std::pair<std::string, std::string> network_description;
+        std::string act_func;
+
+        ~nn_constants() { }
+        uint64_t size(void*) const;
+        void pack(e::packer &packer, void*) const;
+        void unpack(e::unpacker &unpacker, void*);
+    };
+
     struct nn_params: public virtual Node_Parameters_Base
     {
         // handles of first and last node
+        // network_description and act_func are filled in by the client, moved to constants before the request is sent
         std::pair<std::string, std::string> network_description;
         // input vector or value
         std::vector<double> input;
@@ -31,6 +43,7 @@ namespace node_prog
         std::string act_func;
         std::string layer_type;
         std::string layer_op;
+        std::shared_ptr<nn_constants> constants;
 
         nn_params();
         ~nn_params() { }
@@ -38,6 +51,9 @@ namespace node_prog
         void pack(e::packer &packer, void*) const;
         void unpack(e::unpacker &unpacker, void*);
 
+        np_const_ptr_t extract_constants();
+        void set_constants(np_const_ptr_t c);
+
         // no caching
         bool search_cache() { return false; }
         cache_key_t cache_key() { return cache_key_t(); }
@@ -58,6 +74,7 @@ namespace node_prog
 
     extern "C" {
         PROG_FUNC_DECLARE;
+        PROG_CONST_FUNC_DECLARE;
     }
 }
 
@@ -29,6 +29,8 @@ namespace node_prog
             virtual bool edge_exists(const edge_handle_t&) = 0;
             virtual edge& get_edge(const edge_handle_t&) = 0;
             virtual edge_list get_edges() = 0;
+            // in-neighbors, updates made at other shards show up after they arrive
+            virtual in_edge_list get_in_edges() = 0;
             virtual prop_list get_properties() = 0;
             virtual std::string get_property(const std::string &key) = 0;
             virtual bool has_property(std::pair<std::string, std::string> &p) = 0;
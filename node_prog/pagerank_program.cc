@@ -0,0 +1,196 @@
+/*
+ * ===============================================================
+ *    Description:  PageRank over the whole graph, run in supersteps.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <algorithm>
+
+#include "common/stl_serialization.h"
+#include "node_prog/edge.h"
+#include "node_prog/pagerank_program.h"
+
+using node_prog::Node_Parameters_Base;
+using node_prog::Node_State_Base;
+using node_prog::search_type;
+using node_prog::pagerank_params;
+using node_prog::pagerank_state;
+
+// params
+pagerank_params :: pagerank_params()
+    : damping(0.85)
+    , num_supersteps(30)
+    , top_k(10)
+    , rank(0)
+    , total_rank(0)
+    , num_nodes(0)
+{ }
+
+uint64_t
+pagerank_params :: size(void *aux_args) const
+{
+    return message::size(aux_args, damping)
+         + message::size(aux_args, num_supersteps)
+         + message::size(aux_args, top_k)
+         + message::size(aux_args, rank)
+         + message::size(aux_args, total_rank)
+         + message::size(aux_args, num_nodes)
+         + message::size(aux_args, top);
+}
+
+void
+pagerank_params :: pack(e::packer &packer, void *aux_args) const
+{
+    message::pack_buffer(packer, aux_args, damping);
+    message::pack_buffer(packer, aux_args, num_supersteps);
+    message::pack_buffer(packer, aux_args, top_k);
+    message::pack_buffer(packer, aux_args, rank);
+    message::pack_buffer(packer, aux_args, total_rank);
+    message::pack_buffer(packer, aux_args, num_nodes);
+    message::pack_buffer(packer, aux_args, top);
+}
+
+void
+pagerank_params :: unpack(e::unpacker &unpacker, void *aux_args)
+{
+    message::unpack_buffer(unpacker, aux_args, damping);
+    message::unpack_buffer(unpacker, aux_args, num_supersteps);
+    message::unpack_buffer(unpacker, aux_args, top_k);
+    message::unpack_buffer(unpacker, aux_args, rank);
+    message::unpack_buffer(unpacker, aux_args, total_rank);
+    message::unpack_buffer(unpacker, aux_args, num_nodes);
+    message::unpack_buffer(unpacker, aux_args, top);
+}
+
+// state
+uint64_t
+pagerank_state :: size(void *aux_args) const
+{
+    return message::size(aux_args, rank);
+}
+
+void
+pagerank_state :: pack(e::packer &packer, void *aux_args) const
+{
+    message::pack_buffer(packer, aux_args, rank);
+}
+
+void
+pagerank_state :: unpack(e::unpacker &unpacker, void *aux_args)
+{
+    message::unpack_buffer(unpacker, aux_args, rank);
+}
+
+inline bool
+higher_rank(const std::pair<node_handle_t, double> &p1, const std::pair<node_handle_t, double> &p2)
+{
+    return p1.second > p2.second;
+}
+
+// keep the top k of both lists in into
+inline void
+merge_top(pagerank_params &into, const pagerank_params &from)
+{
+    into.top.insert(into.top.end(), from.top.begin(), from.top.end());
+    std::sort(into.top.begin(), into.top.end(), higher_rank);
+    if (into.top.size() > into.top_k) {
+        into.top.resize(into.top_k);
+    }
+}
+
+extern "C" {
+
+PROG_BSP_FUNC_DEFINE(pagerank);
+
+bool
+node_prog :: bsp_node_program(node &n,
+    db::remote_node&,
+    uint32_t superstep,
+    std::shared_ptr<Node_Parameters_Base> global,
+    std::vector<std::shared_ptr<Node_Parameters_Base>> &incoming,
+    Node_State_Base &value,
+    std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>> &outgoing)
+{
+    pagerank_params &params = dynamic_cast<pagerank_params&>(*global);
+    pagerank_state &state = dynamic_cast<pagerank_state&>(value);
+
+    if (superstep == 0) {
+        state.rank = 1;
+    } else {
+        double sum = 0;
+        for (std::shared_ptr<Node_Parameters_Base> &msg: incoming) {
+            sum += dynamic_cast<pagerank_params&>(*msg).rank;
+        }
+        state.rank = (1 - params.damping) + params.damping * sum;
+    }
+
+    if (superstep >= params.num_supersteps) {
+        return true;
+    }
+
+    edge_list edges = n.get_edges();
+    uint64_t out_degree = edges.count();
+    for (edge &e: edges) {
+        auto msg = std::make_shared<pagerank_params>();
+        msg->rank = state.rank / out_degree;
+        outgoing.emplace_back(e.get_neighbor(), msg);
+    }
+
+    return false;
+}
+
+void
+node_prog :: bsp_combine(std::shared_ptr<Node_Parameters_Base> &into, std::shared_ptr<Node_Parameters_Base> from)
+{
+    dynamic_cast<pagerank_params&>(*into).rank += dynamic_cast<pagerank_params&>(*from).rank;
+}
+
+void
+node_prog :: bsp_result(db::remote_node &rn,
+    std::shared_ptr<Node_Parameters_Base> global,
+    Node_State_Base &value,
+    std::shared_ptr<Node_Parameters_Base> &result)
+{
+    pagerank_params &params = dynamic_cast<pagerank_params&>(*global);
+    pagerank_state &state = dynamic_cast<pagerank_state&>(value);
+
+    if (result == nullptr) {
+        auto shard_result = std::make_shared<pagerank_params>();
+        shard_result->damping = params.damping;
+        shard_result->num_supersteps = params.num_supersteps;
+        shard_result->top_k = params.top_k;
+        result = shard_result;
+    }
+
+    pagerank_params &res = dynamic_cast<pagerank_params&>(*result);
+    res.total_rank += state.rank;
+    res.num_nodes++;
+    if (res.top_k > 0
+     && (res.top.size() < res.top_k || state.rank > res.top.back().second)) {
+        pagerank_params node_top;
+        node_top.top.emplace_back(rn.handle, state.rank);
+        merge_top(res, node_top);
+    }
+}
+
+void
+node_prog :: merge_results(std::shared_ptr<Node_Parameters_Base> &into, std::shared_ptr<Node_Parameters_Base> from)
+{
+    if (into == nullptr) {
+        into = from;
+        return;
+    }
+
+    pagerank_params &res = dynamic_cast<pagerank_params&>(*into);
+    pagerank_params &other = dynamic_cast<pagerank_params&>(*from);
+    res.total_rank += other.total_rank;
+    res.num_nodes += other.num_nodes;
+    merge_top(res, other);
+}
+
+}
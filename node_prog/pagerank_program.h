@@ -0,0 +1,66 @@
+/*
+ * ===============================================================
+ *    Description:  PageRank over the whole graph, run in supersteps.
+ *                  Returns the total rank, the number of nodes and
+ *                  the top_k nodes by rank.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_node_prog_pagerank_program_h_
+#define weaver_node_prog_pagerank_program_h_
+
+#include <vector>
+#include <string>
+
+#include "node_prog/boilerplate.h"
+
+namespace node_prog
+{
+    // used for the request, the messages between nodes and the result
+    struct pagerank_params : public virtual Node_Parameters_Base
+    {
+        // request
+        double damping;
+        uint32_t num_supersteps;
+        uint32_t top_k;
+        // message
+        double rank;
+        // result
+        double total_rank;
+        uint64_t num_nodes;
+        std::vector<std::pair<node_handle_t, double>> top; // descending rank
+
+        pagerank_params();
+        ~pagerank_params() { }
+        uint64_t size(void*) const;
+        void pack(e::packer &packer, void*) const;
+        void unpack(e::unpacker &unpacker, void*);
+
+        // no caching
+        bool search_cache() { return false; }
+        cache_key_t cache_key() { return cache_key_t(); }
+    };
+
+    struct pagerank_state : public virtual Node_State_Base
+    {
+        double rank;
+
+        pagerank_state() : rank(0) { }
+        ~pagerank_state() { }
+        uint64_t size(void*) const;
+        void pack(e::packer &packer, void*) const;
+        void unpack(e::unpacker &unpacker, void*);
+    };
+
+    extern "C" {
+        PROG_BSP_FUNC_DECLARE;
+        PROG_BSP_COMBINE_DECLARE;
+    }
+}
+
+#endif
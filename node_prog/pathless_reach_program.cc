@@ -13,15 +13,15 @@
  */
 
 #include "common/stl_serialization.h"
-#include "node_prog/node_prog_type.h"
 #include "node_prog/edge.h"
 #include "node_prog/pathless_reach_program.h"
 
+using node_prog::Node_Parameters_Base;
 using node_prog::search_type;
+using node_prog::dense_node_state;
 using node_prog::pathless_reach_params;
-using node_prog::pathless_reach_node_state;
-using node_prog::node_cache_context;
-using node_prog::cache_response;
+
+static const uint32_t ReachableFlag = 1;
 
 // params
 pathless_reach_params :: pathless_reach_params()
@@ -29,96 +29,54 @@ pathless_reach_params :: pathless_reach_params()
     , reachable(false)
 { }
 
-bool
-pathless_reach_params :: search_cache()
-{
-    return false;
-}
-
 uint64_t
-pathless_reach_params :: size() const 
+pathless_reach_params :: size(void *aux_args) const
 {
-    uint64_t toRet = message::size(returning)
-        + message::size(prev_node)
-        + message::size(dest) 
-        + message::size(edge_props)
-        + message::size(reachable);
-    return toRet;
+    return message::size(aux_args, returning)
+         + message::size(aux_args, prev_node)
+         + message::size(aux_args, dest)
+         + message::size(aux_args, edge_props)
+         + message::size(aux_args, reachable);
 }
 
 void
-pathless_reach_params :: pack(e::packer &packer) const 
+pathless_reach_params :: pack(e::packer &packer, void *aux_args) const
 {
-    message::pack_buffer(packer, returning);
-    message::pack_buffer(packer, prev_node);
-    message::pack_buffer(packer, dest);
-    message::pack_buffer(packer, edge_props);
-    message::pack_buffer(packer, reachable);
+    message::pack_buffer(packer, aux_args, returning);
+    message::pack_buffer(packer, aux_args, prev_node);
+    message::pack_buffer(packer, aux_args, dest);
+    message::pack_buffer(packer, aux_args, edge_props);
+    message::pack_buffer(packer, aux_args, reachable);
 }
 
 void
-pathless_reach_params :: unpack(e::unpacker &unpacker)
+pathless_reach_params :: unpack(e::unpacker &unpacker, void *aux_args)
 {
-    message::unpack_buffer(unpacker, returning);
-    message::unpack_buffer(unpacker, prev_node);
-    message::unpack_buffer(unpacker, dest);
-    message::unpack_buffer(unpacker, edge_props);
-    message::unpack_buffer(unpacker, reachable);
+    message::unpack_buffer(unpacker, aux_args, returning);
+    message::unpack_buffer(unpacker, aux_args, prev_node);
+    message::unpack_buffer(unpacker, aux_args, dest);
+    message::unpack_buffer(unpacker, aux_args, edge_props);
+    message::unpack_buffer(unpacker, aux_args, reachable);
 }
 
-// state
-pathless_reach_node_state :: pathless_reach_node_state()
-: visited(false)
-, out_count(0)
-, reachable(false)
-{ }
+extern "C" {
 
-uint64_t
-pathless_reach_node_state :: size() const 
-{
-    uint64_t toRet = message::size(visited)
-        + message::size(prev_node)
-        + message::size(out_count)
-        + message::size(reachable);
-    return toRet;
-}
+PROG_DENSE_FUNC_DEFINE(pathless_reach);
 
-void
-pathless_reach_node_state :: pack(e::packer& packer) const 
+std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>>
+node_prog :: dense_node_program(node &n,
+   db::remote_node &rn,
+   std::shared_ptr<Node_Parameters_Base> param_ptr,
+   dense_node_state &state)
 {
-    message::pack_buffer(packer, visited);
-    message::pack_buffer(packer, prev_node);
-    message::pack_buffer(packer, out_count);
-    message::pack_buffer(packer, reachable);
-}
+    Node_Parameters_Base &param_base = *param_ptr;
+    pathless_reach_params &params = dynamic_cast<pathless_reach_params&>(param_base);
 
-void
-pathless_reach_node_state :: unpack(e::unpacker& unpacker)
-{
-    message::unpack_buffer(unpacker, visited);
-    message::unpack_buffer(unpacker, prev_node);
-    message::unpack_buffer(unpacker, out_count);
-    message::unpack_buffer(unpacker, reachable);
-}
-
-
-// node prog code
-
-std::pair<search_type, std::vector<std::pair<db::remote_node, pathless_reach_params>>>
-node_prog :: pathless_reach_node_program(
-        node &n,
-        db::remote_node &rn,
-        pathless_reach_params &params,
-        std::function<pathless_reach_node_state&()> state_getter,
-        std::function<void(std::shared_ptr<Cache_Value_Base>,
-            std::shared_ptr<std::vector<db::remote_node>>, cache_key_t)>&,
-        cache_response<Cache_Value_Base>*)
-{
-    pathless_reach_node_state &state = state_getter();
-    std::vector<std::pair<db::remote_node, pathless_reach_params>> next;
-    if (state.reachable == true) {
+    std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>> next;
+    if (state.flags & ReachableFlag) {
         return std::make_pair(search_type::BREADTH_FIRST, next);
     }
+
     bool false_reply = false;
     db::remote_node prev_node = params.prev_node;
     params.prev_node = rn;
@@ -126,23 +84,17 @@ node_prog :: pathless_reach_node_program(
         if (params.dest == n.get_handle()) {
             // we found the node we are looking for, prepare a reply
             params.reachable = true;
-            //    WDEBUG  << "found dest!" << std::endl;
-            next.emplace_back(std::make_pair(db::coordinator, params));
+            next.emplace_back(std::make_pair(db::coordinator, std::make_shared<pathless_reach_params>(params)));
             return std::make_pair(search_type::DEPTH_FIRST, next);
         } else {
             // have not found it yet so follow all out edges
             if (!state.visited) {
-                state.prev_node = prev_node;
+                state.parent = prev_node;
                 state.visited = true;
 
                 for (edge &e: n.get_edges()) {
-                    // checking edge properties
                     if (e.has_all_properties(params.edge_props)) {
-                        // e->traverse(); no more traversal recording
-
-                        // propagate reachability request
-                        next.emplace_back(std::make_pair(e.get_neighbor(), params));
-                        //WDEBUG  << "emplacing " << e.get_neighbor().id << " to next" << std::endl;
+                        next.emplace_back(std::make_pair(e.get_neighbor(), std::make_shared<pathless_reach_params>(params)));
                         state.out_count++;
                     }
                 }
@@ -156,17 +108,16 @@ node_prog :: pathless_reach_node_program(
         if (false_reply) {
             params.returning = true;
             params.reachable = false;
-            next.emplace_back(std::make_pair(prev_node, params));
+            next.emplace_back(std::make_pair(prev_node, std::make_shared<pathless_reach_params>(params)));
         }
         return std::make_pair(search_type::BREADTH_FIRST, next);
     } else { // reply mode
-        if (((--state.out_count == 0) || params.reachable) && !state.reachable) {
-            state.reachable |= params.reachable;
-            next.emplace_back(std::make_pair(state.prev_node, params));
-        }
-        if ((int)state.out_count < 0) {
-            WDEBUG << "ALERT! Bad state value in reach program" << std::endl;
-            next.clear();
+        assert(state.out_count > 0);
+        if (--state.out_count == 0 || params.reachable) {
+            if (params.reachable) {
+                state.flags |= ReachableFlag;
+            }
+            next.emplace_back(std::make_pair(state.parent, std::make_shared<pathless_reach_params>(params)));
         }
         if (params.reachable) {
             return std::make_pair(search_type::DEPTH_FIRST, next);
@@ -175,3 +126,5 @@ node_prog :: pathless_reach_node_program(
         }
     }
 }
+
+}
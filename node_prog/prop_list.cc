@@ -18,29 +18,16 @@
 using node_prog::prop_iter;
 
 bool
-prop_iter :: check_props_iter(props_ds_t::iterator &iter)
+prop_iter :: check_props_iter(uint64_t slot)
 {
-#ifdef weaver_large_property_maps_
-    for (const std::shared_ptr<db::property> p: iter->second) {
-        if (time_oracle->clock_creat_before_del_after(req_time, p->get_creat_time(), p->get_del_time())) {
-            return true;
-        }
-    }
-#else
-    const std::shared_ptr<db::property> p = *iter;
-    if (time_oracle->clock_creat_before_del_after(req_time, p->get_creat_time(), p->get_del_time())) {
-        return true;
-    }
-#endif
-
-    return false;
+    return time_oracle->clock_creat_before_del_after(req_time, block->creat_id(slot), block->del_id(slot));
 }
 
 prop_iter&
 prop_iter :: operator++()
 {
-    while (++internal_cur != internal_end) {
-        if (check_props_iter(internal_cur)) {
+    while (++cur < block->size()) {
+        if (check_props_iter(cur)) {
             break;
         }
     }
@@ -48,17 +35,17 @@ prop_iter :: operator++()
     return *this;
 }
 
-prop_iter :: prop_iter(props_ds_t::iterator begin,
-    props_ds_t::iterator end,
+prop_iter :: prop_iter(const props_ds_t *b,
+    uint64_t start,
     vc::vclock &req_time,
     order::oracle *to)
-    : internal_cur(begin)
-    , internal_end(end)
+    : block(b)
+    , cur(start)
     , req_time(req_time)
     , time_oracle(to)
 {
-    if (internal_cur != internal_end) {
-        if (!check_props_iter(internal_cur)) {
+    if (cur < block->size()) {
+        if (!check_props_iter(cur)) {
             ++(*this);
         }
     }
@@ -67,23 +54,11 @@ prop_iter :: prop_iter(props_ds_t::iterator begin,
 bool
 prop_iter :: operator!=(const prop_iter& rhs) const
 {
-    return internal_cur != rhs.internal_cur || !(req_time == rhs.req_time);
+    return cur != rhs.cur || block != rhs.block || !(req_time == rhs.req_time);
 }
 
-std::vector<std::shared_ptr<node_prog::property>>
+node_prog::prop_view
 prop_iter :: operator*()
 {
-    std::vector<std::shared_ptr<property>> ret;
-
-#ifdef weaver_large_property_maps_
-    for (const std::shared_ptr<db::property> p: internal_cur->second) {
-        if (time_oracle->clock_creat_before_del_after(req_time, p->get_creat_time(), p->get_del_time())) {
-            ret.emplace_back(p);
-        }
-    }
-#else
-    ret.emplace_back(*internal_cur);
-#endif
-
-    return ret;
+    return prop_view(block, cur);
 }
@@ -16,33 +16,48 @@
 #define weaver_node_prog_prop_list_h_
 
 #include <iterator>
-#include <unordered_map>
 
 #include "common/weaver_constants.h"
 #include "common/event_order.h"
-#include "db/property.h"
+#include "db/prop_block.h"
 
 namespace node_prog
 {
-#ifdef weaver_large_property_maps_
-    typedef std::unordered_map<std::string, std::vector<std::shared_ptr<db::property>>> props_ds_t;
-#else
-    typedef std::vector<std::shared_ptr<db::property>> props_ds_t;
-#endif
-    class prop_iter : public std::iterator<std::input_iterator_tag, property>
+    typedef db::prop_block props_ds_t;
+
+    // one property version visible to the node program, read in place from the element
+    // valid while the program runs on the element
+    class prop_view
+    {
+        private:
+            const props_ds_t *block;
+            uint64_t slot;
+
+        public:
+            prop_view(const props_ds_t *b, uint64_t s) : block(b), slot(s) { }
+
+            const std::string& get_key() const { return block->key(slot); }
+            const std::string& get_value() const { return block->value(slot); }
+            uint32_t get_key_id() const { return block->key_id(slot); }
+            // ids in vc::interned_clocks
+            uint32_t get_creat_id() const { return block->creat_id(slot); }
+            uint32_t get_del_id() const { return block->del_id(slot); }
+    };
+
+    class prop_iter : public std::iterator<std::input_iterator_tag, prop_view>
     {
         private:
-            props_ds_t::iterator internal_cur;
-            props_ds_t::iterator internal_end;
+            const props_ds_t *block;
+            uint64_t cur;
             vc::vclock &req_time;
             order::oracle *time_oracle;
-            bool check_props_iter(props_ds_t::iterator&);
+            bool check_props_iter(uint64_t slot);
 
         public:
             prop_iter& operator++();
-            prop_iter(props_ds_t::iterator begin, props_ds_t::iterator end, vc::vclock& req_time, order::oracle *time_oracle);
+            prop_iter(const props_ds_t *block, uint64_t start, vc::vclock& req_time, order::oracle *time_oracle);
             bool operator!=(const prop_iter& rhs) const;
-            std::vector<std::shared_ptr<property>> operator*();
+            prop_view operator*();
     };
 
     class prop_list
@@ -58,12 +73,12 @@ namespace node_prog
 
             prop_iter begin()
             {
-                return prop_iter(wrapped.begin(), wrapped.end(), req_time, time_oracle);
+                return prop_iter(&wrapped, 0, req_time, time_oracle);
             }
 
             prop_iter end()
             {
-                return prop_iter(wrapped.end(), wrapped.end(), req_time, time_oracle);
+                return prop_iter(&wrapped, wrapped.size(), req_time, time_oracle);
             }
     };
 }
@@ -55,12 +55,10 @@ node_prog :: read_node_props_node_program(
         cache_response<Cache_Value_Base>*)
 {
     bool fetch_all = params.keys.empty();
-    for (std::vector<std::shared_ptr<property>> prop_vec : n.get_properties()) {
-        std::string key = prop_vec[0]->get_key();
+    for (prop_view prop: n.get_properties()) {
+        const std::string &key = prop.get_key();
         if (fetch_all || (std::find(params.keys.begin(), params.keys.end(), key) != params.keys.end())) {
-            for (std::shared_ptr<property> prop: prop_vec) {
-                params.node_props.emplace_back(key, prop->get_value());
-            }
+            params.node_props.emplace_back(key, prop.get_value());
         }
     }
 
@@ -20,13 +20,42 @@
 using node_prog::Node_Parameters_Base;
 using node_prog::Node_State_Base;
 using node_prog::search_type;
+using node_prog::Node_Constants_Base;
+using node_prog::np_const_ptr_t;
+using node_prog::traverse_props_constants;
 using node_prog::traverse_props_params;
 using node_prog::traverse_props_state;
 using node_prog::cache_response;
 
+// constants
+uint64_t
+traverse_props_constants :: size(void *aux_args) const
+{
+    return message::size(aux_args, node_aliases)
+         + message::size(aux_args, node_props)
+         + message::size(aux_args, edge_props);
+}
+
+void
+traverse_props_constants :: pack(e::packer &packer, void *aux_args) const
+{
+    message::pack_buffer(packer, aux_args, node_aliases);
+    message::pack_buffer(packer, aux_args, node_props);
+    message::pack_buffer(packer, aux_args, edge_props);
+}
+
+void
+traverse_props_constants :: unpack(e::unpacker &unpacker, void *aux_args)
+{
+    message::unpack_buffer(unpacker, aux_args, node_aliases);
+    message::unpack_buffer(unpacker, aux_args, node_props);
+    message::unpack_buffer(unpacker, aux_args, edge_props);
+}
+
 // params
 traverse_props_params :: traverse_props_params()
     : returning(false)
+    , hop(0)
     , collect_nodes(false)
     , collect_edges(false)
 { }
@@ -36,9 +65,7 @@ traverse_props_params :: size(void *aux_args) const
 {
     return message::size(aux_args, returning)
          + message::size(aux_args, prev_node)
-         + message::size(aux_args, node_aliases)
-         + message::size(aux_args, node_props)
-         + message::size(aux_args, edge_props)
+         + message::size(aux_args, hop)
          + message::size(aux_args, collect_nodes)
          + message::size(aux_args, collect_edges)
          + message::size(aux_args, return_nodes)
@@ -50,9 +77,7 @@ traverse_props_params :: pack(e::packer &packer, void *aux_args) const
 {
     message::pack_buffer(packer, aux_args, returning);
     message::pack_buffer(packer, aux_args, prev_node);
-    message::pack_buffer(packer, aux_args, node_aliases);
-    message::pack_buffer(packer, aux_args, node_props);
-    message::pack_buffer(packer, aux_args, edge_props);
+    message::pack_buffer(packer, aux_args, hop);
     message::pack_buffer(packer, aux_args, collect_nodes);
     message::pack_buffer(packer, aux_args, collect_edges);
     message::pack_buffer(packer, aux_args, return_nodes);
@@ -64,15 +89,32 @@ traverse_props_params :: unpack(e::unpacker &unpacker, void *aux_args)
 {
     message::unpack_buffer(unpacker, aux_args, returning);
     message::unpack_buffer(unpacker, aux_args, prev_node);
-    message::unpack_buffer(unpacker, aux_args, node_aliases);
-    message::unpack_buffer(unpacker, aux_args, node_props);
-    message::unpack_buffer(unpacker, aux_args, edge_props);
+    message::unpack_buffer(unpacker, aux_args, hop);
     message::unpack_buffer(unpacker, aux_args, collect_nodes);
     message::unpack_buffer(unpacker, aux_args, collect_edges);
     message::unpack_buffer(unpacker, aux_args, return_nodes);
     message::unpack_buffer(unpacker, aux_args, return_edges);
 }
 
+np_const_ptr_t
+traverse_props_params :: extract_constants()
+{
+    constants = std::make_shared<traverse_props_constants>();
+    constants->node_aliases = std::move(node_aliases);
+    constants->node_props = std::move(node_props);
+    constants->edge_props = std::move(edge_props);
+    node_aliases.clear();
+    node_props.clear();
+    edge_props.clear();
+    return constants;
+}
+
+void
+traverse_props_params :: set_constants(np_const_ptr_t c)
+{
+    constants = std::dynamic_pointer_cast<traverse_props_constants>(c);
+}
+
 // state
 traverse_props_state :: traverse_props_state()
     : visited(false)
@@ -121,28 +163,23 @@ check_aliases(const node_prog::node &n, const std::vector<std::string> &aliases)
     return true;
 }
 
-extern "C" {
-
-PROG_FUNC_DEFINE(traverse_props);
-
-std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>>
-node_prog :: node_program(node &n,
-   db::remote_node &rn,
-   std::shared_ptr<Node_Parameters_Base> param_ptr,
-   std::function<Node_State_Base&()> state_getter)
+// one hop at node n, appends the next hops to next
+void
+traverse_props_hop(node_prog::node &n,
+    db::remote_node &rn,
+    traverse_props_params &params,
+    traverse_props_state &state,
+    std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>> &next)
 {
-    Node_State_Base &state_base = state_getter();
-    traverse_props_state& state = dynamic_cast<traverse_props_state&>(state_base);
-
-    Node_Parameters_Base &param_base = *param_ptr;
-    traverse_props_params &params = dynamic_cast<traverse_props_params&>(param_base);
-
-    std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>> next;
+    using node_prog::edge;
 
     if (!params.returning) {
         // request spreading out
+        assert(params.constants);
+        traverse_props_constants &constants = *params.constants;
+        uint32_t hop = params.hop;
 
-        if (state.visited || !n.has_all_properties(params.node_props.front()) || !check_aliases(n, params.node_aliases.front())) {
+        if (state.visited || !n.has_all_properties(constants.node_props[hop]) || !check_aliases(n, constants.node_aliases[hop])) {
             // either this node already visited
             // or node does not have requisite params
             // return now
@@ -151,36 +188,32 @@ node_prog :: node_program(node &n,
         } else {
             state.prev_node = params.prev_node;
             params.prev_node = rn; // this node
-            params.node_aliases.pop_front();
-            params.node_props.pop_front();
+            params.hop = hop + 1;
 
-            if (params.edge_props.empty()) {
+            if (hop == constants.edge_props.size()) {
                 // reached the max hop, return now
-                assert(params.node_props.empty());
+                assert(params.hop == constants.node_props.size());
                 params.return_nodes.emplace(n.get_handle());
             } else {
                 if (params.collect_nodes) {
                     params.return_nodes.emplace(n.get_handle());
                 }
-                auto edge_props = params.edge_props.front();
-                params.edge_props.pop_front();
+                auto &edge_props = constants.edge_props[hop];
 
                 bool collect_edges = params.collect_edges;
-                bool propagate = !params.node_props.empty();
+                bool propagate = params.hop < constants.node_props.size();
                 if (!propagate) {
-                    assert(params.edge_props.empty());
+                    assert(params.hop == constants.edge_props.size());
                     collect_edges = true;
                 }
 
-                for (edge &e: n.get_edges()) {
-                    if (e.has_all_properties(edge_props)) {
-                        if (collect_edges) {
-                            params.return_edges.emplace(e.get_handle());
-                        }
-                        if (propagate) {
-                            next.emplace_back(std::make_pair(e.get_neighbor(), std::make_shared<traverse_props_params>(params)));
-                            state.out_count++;
-                        }
+                for (edge &e: n.get_edges().filter(edge_props)) {
+                    if (collect_edges) {
+                        params.return_edges.emplace(e.get_handle());
+                    }
+                    if (propagate) {
+                        next.emplace_back(std::make_pair(e.get_neighbor(), std::make_shared<traverse_props_params>(params)));
+                        state.out_count++;
                     }
                 }
             }
@@ -212,6 +245,45 @@ node_prog :: node_program(node &n,
             next.emplace_back(std::make_pair(state.prev_node, std::make_shared<traverse_props_params>(params)));
         }
     }
+}
+
+extern "C" {
+
+PROG_FUNC_DEFINE(traverse_props);
+PROG_CONST_FUNC_DEFINE(traverse_props);
+
+std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>>
+node_prog :: node_program(node &n,
+   db::remote_node &rn,
+   std::shared_ptr<Node_Parameters_Base> param_ptr,
+   std::function<Node_State_Base&()> state_getter)
+{
+    Node_State_Base &state_base = state_getter();
+    traverse_props_state& state = dynamic_cast<traverse_props_state&>(state_base);
+
+    Node_Parameters_Base &param_base = *param_ptr;
+    traverse_props_params &params = dynamic_cast<traverse_props_params&>(param_base);
+
+    std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>> next;
+    traverse_props_hop(n, rn, params, state, next);
+
+    return std::make_pair(search_type::BREADTH_FIRST, next);
+}
+
+// replies from the children of a node and repeated requests arrive together
+std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>>
+node_prog :: batch_node_program(node &n,
+   db::remote_node &rn,
+   std::vector<std::shared_ptr<Node_Parameters_Base>> &params,
+   std::function<Node_State_Base&()> state_getter)
+{
+    Node_State_Base &state_base = state_getter();
+    traverse_props_state& state = dynamic_cast<traverse_props_state&>(state_base);
+
+    std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>> next;
+    for (std::shared_ptr<Node_Parameters_Base> &p: params) {
+        traverse_props_hop(n, rn, dynamic_cast<traverse_props_params&>(*p), state, next);
+    }
 
     return std::make_pair(search_type::BREADTH_FIRST, next);
 }
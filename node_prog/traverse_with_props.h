@@ -26,13 +26,29 @@
 
 namespace node_prog
 {
+    // aliases and props to match at each hop, same for all hops of a request
+    struct traverse_props_constants: public virtual Node_Constants_Base
+    {
+        std::deque<std::vector<std::string>> node_aliases;
+        std::deque<std::vector<std::pair<std::string, std::string>>> node_props;
+        std::deque<std::vector<std::pair<std::string, std::string>>> edge_props;
+
+        ~traverse_props_constants() { }
+        uint64_t size(void*) const;
+        void pack(e::packer &packer, void*) const;
+        void unpack(e::unpacker &unpacker, void*);
+    };
+
     struct traverse_props_params: public virtual Node_Parameters_Base
     {
         bool returning; // false = request spreading out, true = request return
         db::remote_node prev_node;
+        // filled in by the client, moved to constants before the request is sent
         std::deque<std::vector<std::string>> node_aliases;
         std::deque<std::vector<std::pair<std::string, std::string>>> node_props;
         std::deque<std::vector<std::pair<std::string, std::string>>> edge_props;
+        uint32_t hop; // index into the per hop aliases and props
+        std::shared_ptr<traverse_props_constants> constants;
         bool collect_nodes;
         bool collect_edges;
         std::unordered_set<node_handle_t> return_nodes;
@@ -44,6 +60,9 @@ namespace node_prog
         void pack(e::packer &packer, void*) const;
         void unpack(e::unpacker &unpacker, void*);
 
+        np_const_ptr_t extract_constants();
+        void set_constants(np_const_ptr_t c);
+
         // no caching
         bool search_cache() { return false; }
         cache_key_t cache_key() { return cache_key_t(); }
@@ -66,6 +85,8 @@ namespace node_prog
 
     extern "C" {
         PROG_FUNC_DECLARE;
+        PROG_BATCH_DECLARE;
+        PROG_CONST_FUNC_DECLARE;
     }
 }
 
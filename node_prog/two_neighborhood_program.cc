@@ -1,6 +1,7 @@
 /*
  * ===============================================================
- *    Description:  Node program to read properties of a single node
+ *    Description:  Node program to read a property of all nodes
+ *                  within two hops of a center node
  *
  *        Created:  Friday 17 January 2014 11:00:03  EDT
  *
@@ -14,312 +15,280 @@
 
 #include "common/stl_serialization.h"
 #include "common/cache_constants.h"
-#include "node_prog/node_prog_type.h"
 #include "node_prog/edge.h"
 #include "node_prog/two_neighborhood_program.h"
 
+using node_prog::Node_Parameters_Base;
+using node_prog::Node_State_Base;
+using node_prog::Cache_Value_Base;
 using node_prog::search_type;
 using node_prog::two_neighborhood_params;
 using node_prog::two_neighborhood_state;
 using node_prog::two_neighborhood_cache_value;
-using node_prog::node_cache_context;
-using node_prog::cache_response;
 
-// params
-bool
-two_neighborhood_params :: search_cache()
+// cache
+two_neighborhood_cache_value :: two_neighborhood_cache_value(const std::string &key,
+    const std::vector<std::pair<node_handle_t, std::string>> &resp)
+    : prop_key(key)
+    , responses(resp)
+{ }
+
+uint64_t
+two_neighborhood_cache_value :: size(void *aux_args) const
 {
-    return _search_cache;
+    return message::size(aux_args, prop_key)
+         + message::size(aux_args, responses);
 }
 
-cache_key_t
-two_neighborhood_params :: cache_key()
+void
+two_neighborhood_cache_value :: pack(e::packer& packer, void *aux_args) const
 {
-    return prop_key;
+    message::pack_buffer(packer, aux_args, prop_key);
+    message::pack_buffer(packer, aux_args, responses);
 }
 
+void
+two_neighborhood_cache_value :: unpack(e::unpacker& unpacker, void *aux_args)
+{
+    message::unpack_buffer(unpacker, aux_args, prop_key);
+    message::unpack_buffer(unpacker, aux_args, responses);
+}
+
+// params
+two_neighborhood_params :: two_neighborhood_params()
+    : _search_cache(false)
+    , on_hop(0)
+    , outgoing(true)
+{ }
+
 uint64_t
-two_neighborhood_params :: size() const 
+two_neighborhood_params :: size(void *aux_args) const
 {
-    uint64_t toRet = message::size(_search_cache)
-        + message::size(cache_update)
-        + message::size(prop_key)
-        + message::size(on_hop)
-        + message::size(outgoing)
-        + message::size(prev_node)
-        + message::size(responses);
-    return toRet;
+    return message::size(aux_args, _search_cache)
+         + message::size(aux_args, prop_key)
+         + message::size(aux_args, on_hop)
+         + message::size(aux_args, outgoing)
+         + message::size(aux_args, prev_node)
+         + message::size(aux_args, responses)
+         + message::size(aux_args, watch);
 }
 
 void
-two_neighborhood_params :: pack(e::packer& packer) const 
+two_neighborhood_params :: pack(e::packer& packer, void *aux_args) const
 {
-    message::pack_buffer(packer, _search_cache);
-    message::pack_buffer(packer, cache_update);
-    message::pack_buffer(packer, prop_key);
-    message::pack_buffer(packer, on_hop);
-    message::pack_buffer(packer, outgoing);
-    message::pack_buffer(packer, prev_node);
-    message::pack_buffer(packer, responses);
+    message::pack_buffer(packer, aux_args, _search_cache);
+    message::pack_buffer(packer, aux_args, prop_key);
+    message::pack_buffer(packer, aux_args, on_hop);
+    message::pack_buffer(packer, aux_args, outgoing);
+    message::pack_buffer(packer, aux_args, prev_node);
+    message::pack_buffer(packer, aux_args, responses);
+    message::pack_buffer(packer, aux_args, watch);
 }
 
 void
-two_neighborhood_params :: unpack(e::unpacker& unpacker)
+two_neighborhood_params :: unpack(e::unpacker& unpacker, void *aux_args)
 {
-    message::unpack_buffer(unpacker, _search_cache);
-    message::unpack_buffer(unpacker, cache_update);
-    message::unpack_buffer(unpacker, prop_key);
-    message::unpack_buffer(unpacker, on_hop);
-    message::unpack_buffer(unpacker, outgoing);
-    message::unpack_buffer(unpacker, prev_node);
-    message::unpack_buffer(unpacker, responses);
+    message::unpack_buffer(unpacker, aux_args, _search_cache);
+    message::unpack_buffer(unpacker, aux_args, prop_key);
+    message::unpack_buffer(unpacker, aux_args, on_hop);
+    message::unpack_buffer(unpacker, aux_args, outgoing);
+    message::unpack_buffer(unpacker, aux_args, prev_node);
+    message::unpack_buffer(unpacker, aux_args, responses);
+    message::unpack_buffer(unpacker, aux_args, watch);
 }
 
-// state
-two_neighborhood_state :: two_neighborhood_state()
-    : one_hop_visited(false)
-    , two_hop_visited(false)
-    , responses_left(0)
-    , prev_node()
-{ }
+bool
+two_neighborhood_params :: search_cache()
+{
+    return _search_cache && outgoing && on_hop == 0;
+}
 
-uint64_t
-two_neighborhood_state :: size() const
+cache_key_t
+two_neighborhood_params :: cache_key()
 {
-    uint64_t toRet = message::size(one_hop_visited)
-        + message::size(two_hop_visited)
-        + message::size(responses_left)
-        + message::size(prev_node)
-        + message::size(responses);
-        return toRet;
+    return prop_key;
 }
 
 void
-two_neighborhood_state :: pack(e::packer& packer) const 
+two_neighborhood_params :: set_cache_value(std::shared_ptr<Cache_Value_Base> val)
 {
-    message::pack_buffer(packer, one_hop_visited);
-    message::pack_buffer(packer, two_hop_visited);
-    message::pack_buffer(packer, responses_left);
-    message::pack_buffer(packer, prev_node);
-    message::pack_buffer(packer, responses);
+    cached = std::dynamic_pointer_cast<two_neighborhood_cache_value>(val);
 }
 
-void
-two_neighborhood_state :: unpack(e::unpacker& unpacker)
+std::shared_ptr<Cache_Value_Base>
+two_neighborhood_params :: take_cache_value(std::vector<db::remote_node> &watch_set)
 {
-    message::unpack_buffer(unpacker, one_hop_visited);
-    message::unpack_buffer(unpacker, two_hop_visited);
-    message::unpack_buffer(unpacker, responses_left);
-    message::unpack_buffer(unpacker, prev_node);
-    message::unpack_buffer(unpacker, responses);
+    watch_set = std::move(to_watch);
+    to_watch.clear();
+    std::shared_ptr<Cache_Value_Base> val = std::move(to_cache);
+    to_cache.reset();
+    return val;
 }
 
-// cache
-two_neighborhood_cache_value :: two_neighborhood_cache_value(std::string &prop_key,
-    std::vector<std::pair<node_handle_t, std::string>> &responses)
-    : prop_key(prop_key)
-    , responses(responses)
+// state
+two_neighborhood_state :: two_neighborhood_state()
+    : one_hop_visited(false)
+    , two_hop_visited(false)
+    , responses_left(0)
+    , prev_node()
 { }
 
 uint64_t
-two_neighborhood_cache_value :: size() const 
+two_neighborhood_state :: size(void *aux_args) const
 {
-    uint64_t toRet = message::size(prop_key)
-        + message::size(responses);
-        return toRet;
+    return message::size(aux_args, one_hop_visited)
+         + message::size(aux_args, two_hop_visited)
+         + message::size(aux_args, responses_left)
+         + message::size(aux_args, prev_node)
+         + message::size(aux_args, responses)
+         + message::size(aux_args, watch);
 }
 
 void
-two_neighborhood_cache_value :: pack(e::packer& packer) const 
+two_neighborhood_state :: pack(e::packer& packer, void *aux_args) const
 {
-    message::pack_buffer(packer, prop_key);
-    message::pack_buffer(packer, responses);
+    message::pack_buffer(packer, aux_args, one_hop_visited);
+    message::pack_buffer(packer, aux_args, two_hop_visited);
+    message::pack_buffer(packer, aux_args, responses_left);
+    message::pack_buffer(packer, aux_args, prev_node);
+    message::pack_buffer(packer, aux_args, responses);
+    message::pack_buffer(packer, aux_args, watch);
 }
 
 void
-two_neighborhood_cache_value :: unpack(e::unpacker& unpacker)
+two_neighborhood_state :: unpack(e::unpacker& unpacker, void *aux_args)
 {
-    message::unpack_buffer(unpacker, prop_key);
-    message::unpack_buffer(unpacker, responses);
+    message::unpack_buffer(unpacker, aux_args, one_hop_visited);
+    message::unpack_buffer(unpacker, aux_args, two_hop_visited);
+    message::unpack_buffer(unpacker, aux_args, responses_left);
+    message::unpack_buffer(unpacker, aux_args, prev_node);
+    message::unpack_buffer(unpacker, aux_args, responses);
+    message::unpack_buffer(unpacker, aux_args, watch);
 }
 
-
-// node prog code
-bool
-check_cache_context(std::vector<node_cache_context>& contexts, db::remote_node &center,
-        std::vector<db::remote_node> &one_hops_to_check, std::vector<db::remote_node> &two_hops_to_check)
+// result complete at the center node, cache it with every node it was read from
+inline void
+finish_at_center(two_neighborhood_params &params)
 {
-    if (contexts.size() == 0) {
-        return true;
+    if (MaxCacheEntries && params._search_cache) {
+        params.to_cache = std::make_shared<two_neighborhood_cache_value>(params.prop_key, params.responses);
+        params.to_watch = params.watch;
     }
-
-    for (node_cache_context& node_context : contexts)
-    {
-        if (node_context.node_deleted){  // node deletion
-            WDEBUG  << "Cache entry INVALID because of node deletion" << std::endl;
-            return false;
-        } else if (!node_context.edges_deleted.empty()) {
-            WDEBUG  << "Cache entry INVALID because of edge deletion" << std::endl;
-            return false;
-        }
-        for(auto &new_edge : node_context.edges_added){
-            if (node_context.node == center) {
-                WDEBUG << "need to revalidate at 1 hop " << new_edge.nbr.handle << std::endl;
-                one_hops_to_check.emplace_back(new_edge.nbr);
-            } else  {
-                WDEBUG << "need to revalidate at 2 hops " << new_edge.nbr.handle << std::endl;
-                two_hops_to_check.emplace_back(new_edge.nbr);
-            }
-        }
-    }
-    WDEBUG  << "Cache entry with context size " << contexts.size() << " valid but need to read "
-        << one_hops_to_check.size() << " one hop neghbors and " << two_hops_to_check.size() << " two hop neighbors to revalidate" << std::endl;
-    return true;
+    params.watch.clear();
 }
 
-inline void
-fill_minus_duplicates(std::vector<std::pair<node_handle_t, std::string>> &from, std::vector<std::pair<node_handle_t, std::string>> &to)
-{
-    to.swap(from); // TODO actually filter
-}
+extern "C" {
+
+PROG_FUNC_DEFINE(two_neighborhood);
 
-std::pair<search_type, std::vector<std::pair<db::remote_node, two_neighborhood_params>>>
-node_prog :: two_neighborhood_node_program(
-    node &n,
-    db::remote_node &rn,
-    two_neighborhood_params &params,
-    std::function<two_neighborhood_state&()> state_getter,
-    std::function<void(std::shared_ptr<node_prog::two_neighborhood_cache_value>,
-        std::shared_ptr<std::vector<db::remote_node>>, cache_key_t)> &add_cache_func,
-    cache_response<two_neighborhood_cache_value> *cache_response)
+std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>>
+node_prog :: node_program(node &n,
+   db::remote_node &rn,
+   std::shared_ptr<Node_Parameters_Base> param_ptr,
+   std::function<Node_State_Base&()> state_getter)
 {
-    std::vector<std::pair<db::remote_node, two_neighborhood_params>> next;
-    two_neighborhood_state &state = state_getter();
-
-    if (MaxCacheEntries && params._search_cache  && cache_response != NULL && cache_response->get_value()->prop_key.compare(params.prop_key) == 0) {
-        WDEBUG  << "GOT CACHE" << std::endl;
-        params._search_cache = false; // only search cache once
-        assert(params.on_hop == 0 && params.outgoing);
-        std::vector<db::remote_node> one_hops_to_check;
-        std::vector<db::remote_node> two_hops_to_check;
-        if (check_cache_context(cache_response->get_context(), rn, one_hops_to_check, two_hops_to_check)) { // if context is valid
-            params.cache_update = true;
-            params.on_hop = 1;
-            params.prev_node = rn;
-            for (auto to_check : one_hops_to_check) {
-                    next.emplace_back(std::make_pair(to_check, params));
-            }
-            params.on_hop = 2;
-            for (auto to_check : two_hops_to_check) {
-                    next.emplace_back(std::make_pair(to_check, params));
-            }
-            if (next.empty()) { // can reply now
-                params.responses = cache_response->get_value()->responses;
-                next.emplace_back(std::make_pair(db::coordinator, params));
-            } else { // waiting for new nodes to be checked
-                state.prev_node = db::coordinator;
-                state.one_hop_visited = true; // in case of self loops
-                state.responses = cache_response->get_value()->responses;
-                WDEBUG  << "GOT CACHE with size " << state.responses.size()<< std::endl;
-                state.responses_left = next.size();
-            }
-        } else {
-            cache_response->invalidate();
+    Node_Parameters_Base &param_base = *param_ptr;
+    two_neighborhood_params &params = dynamic_cast<two_neighborhood_params&>(param_base);
+
+    std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>> next;
+
+    if (params.cached != nullptr) {
+        // shard validated the cached value against the watch set
+        std::shared_ptr<two_neighborhood_cache_value> cached = std::move(params.cached);
+        params.cached.reset();
+        if (cached->prop_key == params.prop_key) {
+            params.outgoing = false;
+            params.responses = cached->responses;
+            next.emplace_back(std::make_pair(db::coordinator, std::make_shared<two_neighborhood_params>(params)));
+            return std::make_pair(search_type::BREADTH_FIRST, next);
         }
-        return std::make_pair(search_type::DEPTH_FIRST, next); 
     }
 
-    params._search_cache = false;
+    two_neighborhood_state &state = dynamic_cast<two_neighborhood_state&>(state_getter());
+
     if (params.outgoing) {
         assert(params.responses.empty());
-        switch (params.on_hop){
+        switch (params.on_hop) {
             case 0:
                 state.prev_node = db::coordinator;
                 state.one_hop_visited = true; // in case of self loops
+                state.watch.emplace_back(rn);
                 params.prev_node = rn;
                 params.on_hop = 1;
                 for (edge &e: n.get_edges()) {
-                    next.emplace_back(std::make_pair(e.get_neighbor(), params));
+                    next.emplace_back(std::make_pair(e.get_neighbor(), std::make_shared<two_neighborhood_params>(params)));
                 }
                 state.responses_left = next.size();
                 if (next.empty()) { // no neighbors
                     params.on_hop = 0;
                     params.outgoing = false;
-                    next.emplace_back(std::make_pair(state.prev_node, params));
+                    params.watch = std::move(state.watch);
+                    finish_at_center(params);
+                    next.emplace_back(std::make_pair(state.prev_node, std::make_shared<two_neighborhood_params>(params)));
                 }
                 break;
+
             case 1:
                 if (state.one_hop_visited) {
                     params.on_hop = 0;
                     params.outgoing = false;
-                    next.emplace_back(std::make_pair(params.prev_node, params));
+                    next.emplace_back(std::make_pair(params.prev_node, std::make_shared<two_neighborhood_params>(params)));
                 } else {
-                    assert(state.responses.size() == 0);
+                    assert(state.responses.empty());
                     state.one_hop_visited = true;
                     state.prev_node = params.prev_node;
+                    state.watch.emplace_back(rn); // edges of this node decide the 2 hop nodes
                     params.prev_node = rn;
                     params.on_hop = 2;
 
                     for (edge &e: n.get_edges()) {
-                        next.emplace_back(std::make_pair(e.get_neighbor(), params));
+                        next.emplace_back(std::make_pair(e.get_neighbor(), std::make_shared<two_neighborhood_params>(params)));
                     }
                     state.responses_left = next.size();
                     if (next.empty()) { // no neighbors
                         params.on_hop = 0;
                         params.outgoing = false;
-                        next.emplace_back(std::make_pair(state.prev_node, params));
+                        params.watch = std::move(state.watch);
+                        next.emplace_back(std::make_pair(state.prev_node, std::make_shared<two_neighborhood_params>(params)));
                     }
                 }
                 break;
+
             case 2:
                 if (!state.two_hop_visited) {
                     state.two_hop_visited = true;
-                    for (std::vector<std::shared_ptr<property>> prop_vec : n.get_properties()) {
-                        if (prop_vec[0]->get_key().compare(params.prop_key) == 0) {
-                            for (std::shared_ptr<property> prop: prop_vec) {
-                                params.responses.emplace_back(rn.handle, prop->get_value());
-                            }
+                    params.watch.emplace_back(rn);
+                    for (prop_view prop: n.get_properties()) {
+                        if (prop.get_key() == params.prop_key) {
+                            params.responses.emplace_back(rn.handle, prop.get_value());
                         }
                     }
                 }
                 params.on_hop = 1;
                 params.outgoing = false;
-                next.emplace_back(std::make_pair(params.prev_node, params));
+                next.emplace_back(std::make_pair(params.prev_node, std::make_shared<two_neighborhood_params>(params)));
                 break;
         }
     } else { // returning
-        assert(params.on_hop == 0 or params.on_hop == 1);
-        //WDEBUG<< "GOT " << params.responses.size() << " responses with on_hop " << params.on_hop << std::endl;
         assert(params.on_hop == 0 || params.on_hop == 1);
 
-        state.responses.insert(state.responses.end(), params.responses.begin(), params.responses.end()); 
+        state.responses.insert(state.responses.end(), params.responses.begin(), params.responses.end());
+        state.watch.insert(state.watch.end(), params.watch.begin(), params.watch.end());
 
         assert(state.responses_left != 0);
-        state.responses_left--;
-        if (state.responses_left == 0) {
-            params.responses.clear();
-            if (MaxCacheEntries && params.on_hop == 0 && params.cache_update) {
-                fill_minus_duplicates(state.responses, params.responses);
+        if (--state.responses_left == 0) {
+            params.responses = std::move(state.responses);
+            params.watch = std::move(state.watch);
+            if (params.on_hop == 0) {
+                finish_at_center(params);
             } else {
-                params.responses.swap(state.responses);
-            }
-            if (MaxCacheEntries && params.on_hop == 0) {
-                WDEBUG  << "addin to CACHE" << std::endl;
-                std::shared_ptr<node_prog::two_neighborhood_cache_value> toCache(new two_neighborhood_cache_value(params.prop_key, params.responses));
-                std::shared_ptr<std::vector<db::remote_node>> watch_set(new std::vector<db::remote_node>());
-                watch_set->emplace_back(rn);
-                for (edge &e: n.get_edges()) {
-                    watch_set->emplace_back(e.get_neighbor());
-                }
-                //WDEBUG << "storing cache" << std::endl;
-                add_cache_func(toCache, watch_set, params.prop_key);
-            } else  {
                 params.on_hop--;
             }
-            next.emplace_back(std::make_pair(state.prev_node, params));
-        } else {
-            assert(next.size() == 0);
+            next.emplace_back(std::make_pair(state.prev_node, std::make_shared<two_neighborhood_params>(params)));
         }
     }
-    return std::make_pair(search_type::BREADTH_FIRST, next); 
+
+    return std::make_pair(search_type::BREADTH_FIRST, next);
+}
+
 }
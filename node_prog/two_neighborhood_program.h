@@ -1,6 +1,7 @@
 /*
  * ===============================================================
- *    Description:  Node program to read properties of a single node
+ *    Description:  Node program to read a property of all nodes
+ *                  within two hops of a center node
  *
  *        Created:  Friday 17 January 2014 11:00:03  EDT
  *
@@ -12,36 +13,53 @@
  * ================================================================
  */
 
-#ifndef weaver_node_prog_two_neighborhood_program_h 
-#define weaver_node_prog_two_neighborhood_program_h 
+#ifndef weaver_node_prog_two_neighborhood_program_h_
+#define weaver_node_prog_two_neighborhood_program_h_
 
 #include <vector>
 #include <string>
 
-#include "node_prog/base_classes.h"
-#include "db/remote_node.h"
-#include "node_prog/node.h"
-#include "node_prog/cache_response.h"
+#include "node_prog/boilerplate.h"
 
 namespace node_prog
 {
-    class two_neighborhood_params : public virtual Node_Parameters_Base 
+    struct two_neighborhood_cache_value : public virtual Cache_Value_Base
     {
-        public:
-            bool _search_cache;
-            bool cache_update;
-            std::string prop_key;
-            uint32_t on_hop;
-            bool outgoing;
-            db::remote_node prev_node;
-            std::vector<std::pair<node_handle_t, std::string>> responses;
+        std::string prop_key;
+        std::vector<std::pair<node_handle_t, std::string>> responses;
+
+        two_neighborhood_cache_value() { }
+        two_neighborhood_cache_value(const std::string &prop_key, const std::vector<std::pair<node_handle_t, std::string>> &responses);
+        ~two_neighborhood_cache_value() { }
+        uint64_t size(void*) const;
+        void pack(e::packer& packer, void*) const;
+        void unpack(e::unpacker& unpacker, void*);
+    };
+
+    struct two_neighborhood_params : public virtual Node_Parameters_Base
+    {
+        bool _search_cache; // look up and store the result at the center node
+        std::string prop_key;
+        uint32_t on_hop;
+        bool outgoing;
+        db::remote_node prev_node;
+        std::vector<std::pair<node_handle_t, std::string>> responses;
+        std::vector<db::remote_node> watch; // nodes the responses were read from
+        // not sent, see set_cache_value and take_cache_value
+        std::shared_ptr<two_neighborhood_cache_value> cached, to_cache;
+        std::vector<db::remote_node> to_watch;
+
+        two_neighborhood_params();
+        ~two_neighborhood_params() { }
+        uint64_t size(void*) const;
+        void pack(e::packer& packer, void*) const;
+        void unpack(e::unpacker& unpacker, void*);
 
-        public:
-            bool search_cache();
-            cache_key_t cache_key();
-            uint64_t size() const;
-            void pack(e::packer& packer) const;
-            void unpack(e::unpacker& unpacker);
+        // cached at the center node, keyed by prop_key
+        bool search_cache();
+        cache_key_t cache_key();
+        void set_cache_value(std::shared_ptr<Cache_Value_Base> val);
+        std::shared_ptr<Cache_Value_Base> take_cache_value(std::vector<db::remote_node> &watch_set);
     };
 
     struct two_neighborhood_state : public virtual Node_State_Base
@@ -51,35 +69,18 @@ namespace node_prog
         uint32_t responses_left;
         db::remote_node prev_node;
         std::vector<std::pair<node_handle_t, std::string>> responses;
+        std::vector<db::remote_node> watch;
 
         two_neighborhood_state();
         ~two_neighborhood_state() { }
-        uint64_t size() const;
-        void pack(e::packer& packer) const;
-        void unpack(e::unpacker& unpacker);
-    };
-
-    struct two_neighborhood_cache_value : public virtual Cache_Value_Base 
-    {
-        std::string prop_key;
-        std::vector<std::pair<node_handle_t, std::string>> responses;
-
-        two_neighborhood_cache_value(std::string &prop_key, std::vector<std::pair<node_handle_t, std::string>> &responses);
-        ~two_neighborhood_cache_value () { }
-        uint64_t size() const;
-        void pack(e::packer& packer) const;
-        void unpack(e::unpacker& unpacker);
+        uint64_t size(void*) const;
+        void pack(e::packer& packer, void*) const;
+        void unpack(e::unpacker& unpacker, void*);
     };
 
-    std::pair<search_type, std::vector<std::pair<db::remote_node, two_neighborhood_params>>>
-    two_neighborhood_node_program(
-            node &,
-            db::remote_node &,
-            two_neighborhood_params &,
-            std::function<two_neighborhood_state&()>,
-            std::function<void(std::shared_ptr<two_neighborhood_cache_value>,
-                std::shared_ptr<std::vector<db::remote_node>>, cache_key_t)> &,
-            cache_response<two_neighborhood_cache_value> *);
+    extern "C" {
+        PROG_FUNC_DECLARE;
+    }
 }
 
 #endif
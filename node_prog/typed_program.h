@@ -0,0 +1,297 @@
+/*
+ * ===============================================================
+ *    Description:  Node programs with statically typed params and
+ *                  state. A program is a struct deriving from
+ *                  typed_program<itself>, with params_type,
+ *                  state_type and a static run(), and
+ *                  PROG_TYPED_FUNC_DEFINE generates the functions
+ *                  the shard loads into its dynamic_prog_table.
+ *
+ *                  Params and state derive non virtually from the
+ *                  base classes, so the generated functions
+ *                  static_cast instead of dynamic_cast and call
+ *                  size/pack/unpack of the concrete type, which the
+ *                  compiler can inline. The shard hands the program
+ *                  a state_accessor instead of a std::function, and
+ *                  next hop params come from per thread free lists.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#ifndef weaver_node_prog_typed_program_h_
+#define weaver_node_prog_typed_program_h_
+
+#include <new>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+#include "node_prog/boilerplate.h"
+
+namespace node_prog
+{
+    // per thread free list of blocks of one size
+    // a block freed on another thread than the one it came from joins that thread's list
+    template <size_t Bytes>
+    class block_pool
+    {
+        public:
+            static const size_t MaxFree = 1024;
+
+        private:
+            std::vector<void*> m_free;
+
+        public:
+            ~block_pool()
+            {
+                for (void *b: m_free) {
+                    ::operator delete(b);
+                }
+            }
+
+            static block_pool& local()
+            {
+                static thread_local block_pool pool;
+                return pool;
+            }
+
+            void* get()
+            {
+                if (m_free.empty()) {
+                    return ::operator new(Bytes);
+                }
+                void *b = m_free.back();
+                m_free.pop_back();
+                return b;
+            }
+
+            void put(void *b)
+            {
+                if (m_free.size() < MaxFree) {
+                    m_free.emplace_back(b);
+                } else {
+                    ::operator delete(b);
+                }
+            }
+    };
+
+    // for std::allocate_shared, so that the params and their control block come from a block_pool
+    template <typename T>
+    struct pool_allocator
+    {
+        typedef T value_type;
+
+        pool_allocator() { }
+        template <typename U> pool_allocator(const pool_allocator<U>&) { }
+
+        T* allocate(size_t n)
+        {
+            if (n != 1) {
+                return static_cast<T*>(::operator new(n * sizeof(T)));
+            }
+            return static_cast<T*>(block_pool<sizeof(T)>::local().get());
+        }
+
+        void deallocate(T *p, size_t n)
+        {
+            if (n != 1) {
+                ::operator delete(p);
+            } else {
+                block_pool<sizeof(T)>::local().put(p);
+            }
+        }
+    };
+
+    template <typename T, typename U>
+    inline bool operator==(const pool_allocator<T>&, const pool_allocator<U>&) { return true; }
+    template <typename T, typename U>
+    inline bool operator!=(const pool_allocator<T>&, const pool_allocator<U>&) { return false; }
+
+    // state of the node a typed program runs at, created on first call
+    template <typename S>
+    class typed_state
+    {
+        private:
+            const state_accessor &m_acc;
+
+        public:
+            typed_state(const state_accessor &acc) : m_acc(acc) { }
+            S& operator()() const { return static_cast<S&>(m_acc()); }
+    };
+
+    typedef std::vector<std::pair<db::remote_node, np_param_ptr_t>> next_hops_t;
+
+    // Prog derives from typed_program<Prog> and defines
+    //   typedef ... params_type; // derives from Node_Parameters_Base, not virtually
+    //   typedef ... state_type;  // derives from Node_State_Base, not virtually
+    //   static search_type run(node &n, db::remote_node &rn, params_type &params,
+    //                          const typed_state<state_type> &state, next_hops_t &next);
+    template <typename Prog>
+    struct typed_program
+    {
+        // params for a next hop, allocated from this thread's pool
+        // Pr is Prog, deferred because Prog is incomplete where it derives from typed_program<Prog>
+        template <typename Pr = Prog, typename... Args>
+        static std::shared_ptr<typename Pr::params_type> make_params(Args&&... args)
+        {
+            typedef typename Pr::params_type P;
+            return std::allocate_shared<P>(pool_allocator<P>(), std::forward<Args>(args)...);
+        }
+
+        static np_param_ptr_t param_ctor()
+        {
+            return make_params();
+        }
+
+        static uint64_t param_size(const Node_Parameters_Base &p, void *aux_args)
+        {
+            typedef typename Prog::params_type P;
+            return static_cast<const P&>(p).P::size(aux_args);
+        }
+
+        static void param_pack(const Node_Parameters_Base &p, e::packer &packer, void *aux_args)
+        {
+            typedef typename Prog::params_type P;
+            static_cast<const P&>(p).P::pack(packer, aux_args);
+        }
+
+        static void param_unpack(Node_Parameters_Base &p, e::unpacker &unpacker, void *aux_args)
+        {
+            typedef typename Prog::params_type P;
+            static_cast<P&>(p).P::unpack(unpacker, aux_args);
+        }
+
+        static np_state_ptr_t state_ctor()
+        {
+            return std::make_shared<typename Prog::state_type>();
+        }
+
+        static uint64_t state_bytes()
+        {
+            return sizeof(typename Prog::state_type);
+        }
+
+        static Node_State_Base* state_ctor_at(void *mem)
+        {
+            return new (mem) typename Prog::state_type();
+        }
+
+        static uint64_t state_size(const Node_State_Base &s, void *aux_args)
+        {
+            typedef typename Prog::state_type S;
+            return static_cast<const S&>(s).S::size(aux_args);
+        }
+
+        static void state_pack(const Node_State_Base &s, e::packer &packer, void *aux_args)
+        {
+            typedef typename Prog::state_type S;
+            static_cast<const S&>(s).S::pack(packer, aux_args);
+        }
+
+        static void state_unpack(Node_State_Base &s, e::unpacker &unpacker, void *aux_args)
+        {
+            typedef typename Prog::state_type S;
+            static_cast<S&>(s).S::unpack(unpacker, aux_args);
+        }
+
+        static std::pair<search_type, next_hops_t>
+        node_program(node &n, db::remote_node &rn, np_param_ptr_t param_ptr, const state_accessor &state)
+        {
+            typedef typename Prog::params_type P;
+            typedef typename Prog::state_type S;
+            static_assert(std::is_base_of<Node_Parameters_Base, P>::value, "params_type must derive from Node_Parameters_Base");
+            static_assert(std::is_base_of<Node_State_Base, S>::value, "state_type must derive from Node_State_Base");
+
+            std::pair<search_type, next_hops_t> ret;
+            ret.first = Prog::run(n, rn, static_cast<P&>(*param_ptr), typed_state<S>(state), ret.second);
+            return ret;
+        }
+    };
+}
+
+// for typed programs, instead of PROG_FUNC_DECLARE
+#define PROG_TYPED_FUNC_DECLARE \
+    PROG_PARAM_FUNC_DECLARE \
+    PROG_STATE_FUNC_DECLARE \
+    \
+    std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>> \
+    typed_node_program(node &n, \
+        db::remote_node &rn, \
+        std::shared_ptr<Node_Parameters_Base> param_ptr, \
+        const state_accessor &state);
+
+#define PROG_TYPED_FUNC_DEFINE(PROG) \
+    std::shared_ptr<Node_Parameters_Base> \
+    param_ctor() \
+    { \
+        return node_prog::typed_program<PROG>::param_ctor(); \
+    } \
+    \
+    uint64_t \
+    param_size(const Node_Parameters_Base &p, void *aux_args) \
+    { \
+        return node_prog::typed_program<PROG>::param_size(p, aux_args); \
+    } \
+    \
+    void \
+    param_pack(const Node_Parameters_Base &p, e::packer &packer, void *aux_args) \
+    { \
+        node_prog::typed_program<PROG>::param_pack(p, packer, aux_args); \
+    } \
+    \
+    void \
+    param_unpack(Node_Parameters_Base &p, e::unpacker &unpacker, void *aux_args) \
+    { \
+        node_prog::typed_program<PROG>::param_unpack(p, unpacker, aux_args); \
+    } \
+    \
+    std::shared_ptr<Node_State_Base> \
+    state_ctor() \
+    { \
+        return node_prog::typed_program<PROG>::state_ctor(); \
+    } \
+    \
+    uint64_t \
+    state_bytes() \
+    { \
+        return node_prog::typed_program<PROG>::state_bytes(); \
+    } \
+    \
+    Node_State_Base* \
+    state_ctor_at(void *mem) \
+    { \
+        return node_prog::typed_program<PROG>::state_ctor_at(mem); \
+    } \
+    \
+    uint64_t \
+    state_size(const Node_State_Base &s, void *aux_args) \
+    { \
+        return node_prog::typed_program<PROG>::state_size(s, aux_args); \
+    } \
+    \
+    void \
+    state_pack(const Node_State_Base &s, e::packer &packer, void *aux_args) \
+    { \
+        node_prog::typed_program<PROG>::state_pack(s, packer, aux_args); \
+    } \
+    \
+    void \
+    state_unpack(Node_State_Base &s, e::unpacker &unpacker, void *aux_args) \
+    { \
+        node_prog::typed_program<PROG>::state_unpack(s, unpacker, aux_args); \
+    } \
+    \
+    std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>> \
+    typed_node_program(node_prog::node &n, \
+        db::remote_node &rn, \
+        std::shared_ptr<Node_Parameters_Base> param_ptr, \
+        const node_prog::state_accessor &state) \
+    { \
+        return node_prog::typed_program<PROG>::node_program(n, rn, param_ptr, state); \
+    }
+
+#endif
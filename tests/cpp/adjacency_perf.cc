@@ -0,0 +1,111 @@
+/*
+ * ===============================================================
+ *    Description:  Compare out-edge iteration over the handle map
+ *                  with iteration over the adjacency block.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <iostream>
+#include <string>
+
+#include "common/clock.h"
+#include "common/config_constants.h"
+#include "common/event_order.h"
+#include "db/node.h"
+
+DECLARE_CONFIG_CONSTANTS;
+
+// edge iteration as done before the adjacency block
+uint64_t
+iterate_handle_map(db::node &n, order::oracle &time_oracle)
+{
+    uint64_t sum = 0;
+    for (auto &x: n.out_edges) {
+        for (db::edge *e: x.second) {
+            if (time_oracle.clock_creat_before_del_after(*n.base.view_time, e->base.get_creat_time(), e->base.get_del_time())) {
+                sum += e->nbr.loc;
+                break;
+            }
+        }
+    }
+    return sum;
+}
+
+uint64_t
+iterate_adjacency(db::node &n)
+{
+    uint64_t sum = 0;
+    for (node_prog::edge &e: n.get_edges()) {
+        sum += e.get_neighbor().loc;
+    }
+    return sum;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        std::cerr << "usage: " << argv[0] << " <num_edges> <num_iterations>" << std::endl;
+        return -1;
+    }
+
+    uint64_t num_edges = std::stoull(argv[1]);
+    uint64_t num_iter = std::stoull(argv[2]);
+    NumVts = 1;
+    ClkSz = 2;
+
+    // single vector timestamper, all clocks comparable without Kronos
+    vc::vclock_t clk(2, 0);
+    clk[1] = 1;
+    vclock_ptr_t creat_clk(new vc::vclock(0, clk));
+    clk[1] = 2;
+    vclock_ptr_t del_clk(new vc::vclock(0, clk));
+    clk[1] = 3;
+    vclock_ptr_t req_clk(new vc::vclock(0, clk));
+
+    order::oracle time_oracle;
+    db::node n("adj_perf", 0, creat_clk, nullptr);
+    n.base.view_time = req_clk;
+    n.base.time_oracle = &time_oracle;
+    n.out_adjacency.reserve(num_edges);
+
+    for (uint64_t i = 0; i < num_edges; i++) {
+        db::edge *e = new db::edge(std::to_string(i), creat_clk, i % 8, std::to_string(i+1));
+        n.add_edge_unique(e);
+        // every fourth edge deleted before the read
+        if (i % 4 == 0) {
+            n.delete_edge(e, del_clk);
+        }
+    }
+
+    wclock::weaver_timer timer;
+    uint64_t sum_map = 0, sum_adj = 0;
+
+    uint64_t start = timer.get_real_time();
+    for (uint64_t i = 0; i < num_iter; i++) {
+        sum_map += iterate_handle_map(n, time_oracle);
+    }
+    uint64_t map_ns = timer.get_real_time() - start;
+
+    start = timer.get_real_time();
+    for (uint64_t i = 0; i < num_iter; i++) {
+        sum_adj += iterate_adjacency(n);
+    }
+    uint64_t adj_ns = timer.get_real_time() - start;
+
+    if (sum_map != sum_adj) {
+        std::cerr << "mismatch: handle map sum=" << sum_map << ", adjacency sum=" << sum_adj << std::endl;
+        return 1;
+    }
+
+    double edges_visited = (double)num_edges * num_iter;
+    std::cout << "handle map: " << map_ns / 1e6 << " ms, " << edges_visited * 1e3 / map_ns << " Medges/s" << std::endl;
+    std::cout << "adjacency:  " << adj_ns / 1e6 << " ms, " << edges_visited * 1e3 / adj_ns << " Medges/s" << std::endl;
+
+    n.free_edges();
+    return 0;
+}
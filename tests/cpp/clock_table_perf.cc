@@ -0,0 +1,188 @@
+/*
+ * ===============================================================
+ *    Description:  Heap used by version stamps of a bulk loaded
+ *                  graph, and concurrent intern/acquire/release
+ *                  on the clock table.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <atomic>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include <malloc.h>
+#include <pthread.h>
+
+#include "common/clock.h"
+#include "common/config_constants.h"
+#include "common/clock_table.h"
+#include "db/node.h"
+
+DECLARE_CONFIG_CONSTANTS;
+
+// heap in use, counted at operator new/delete, plus element slab chunks
+static std::atomic<uint64_t> heap_in_use(0);
+
+void*
+operator new(size_t sz)
+{
+    void *p = malloc(sz);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    heap_in_use += malloc_usable_size(p);
+    return p;
+}
+
+void
+operator delete(void *p) noexcept
+{
+    if (p != nullptr) {
+        heap_in_use -= malloc_usable_size(p);
+        free(p);
+    }
+}
+
+void* operator new[](size_t sz) { return operator new(sz); }
+void operator delete[](void *p) noexcept { operator delete(p); }
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+void operator delete[](void *p, size_t) noexcept { operator delete(p); }
+
+uint64_t
+heap_bytes()
+{
+    return heap_in_use.load()
+         + db::node::default_slab().stats().chunk_bytes
+         + db::edge::default_slab().stats().chunk_bytes;
+}
+
+vclock_ptr_t
+make_clock(uint64_t vt_id, uint64_t c)
+{
+    vc::vclock_t clk(ClkSz, 0);
+    clk[vt_id+1] = c;
+    return vclock_ptr_t(new vc::vclock(vt_id, clk));
+}
+
+struct churn_args
+{
+    const std::vector<vclock_ptr_t> *clocks;
+    uint64_t tid;
+    uint64_t num_iter;
+};
+
+// elements created, copied and destroyed by shard threads, stamped with overlapping clocks
+void*
+churn_loop(void *a)
+{
+    churn_args *args = (churn_args*)a;
+    const std::vector<vclock_ptr_t> &clocks = *args->clocks;
+    std::vector<uint32_t> held;
+    held.reserve(64);
+
+    for (uint64_t i = 0; i < args->num_iter; i++) {
+        uint32_t id = vc::interned_clocks.intern(clocks[(i * 7 + args->tid) % clocks.size()]);
+        vc::interned_clocks.acquire(id);
+        held.emplace_back(id);
+        held.emplace_back(id);
+        if (held.size() == 64) {
+            for (uint32_t h: held) {
+                vc::interned_clocks.release(h);
+            }
+            held.clear();
+        }
+    }
+    for (uint32_t h: held) {
+        vc::interned_clocks.release(h);
+    }
+
+    return nullptr;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 6) {
+        std::cerr << "usage: " << argv[0] << " <num_nodes> <degree> <nodes_per_tx> <num_threads> <num_iterations>" << std::endl;
+        return -1;
+    }
+
+    uint64_t num_nodes = std::stoull(argv[1]);
+    uint64_t degree = std::stoull(argv[2]);
+    uint64_t nodes_per_tx = std::stoull(argv[3]);
+    uint64_t num_threads = std::stoull(argv[4]);
+    uint64_t num_iter = std::stoull(argv[5]);
+    NumVts = 4;
+    ClkSz = NumVts + 1;
+
+    // nodes with degree out-edges and two properties each, every nodes_per_tx nodes written by one transaction
+    uint64_t heap_start = heap_bytes();
+    std::vector<db::node*> nodes;
+    nodes.reserve(num_nodes);
+    vclock_ptr_t tx_clk;
+    for (uint64_t i = 0; i < num_nodes; i++) {
+        if (i % nodes_per_tx == 0) {
+            tx_clk = make_clock(i % NumVts, i / nodes_per_tx + 1);
+        }
+        node_handle_t handle = std::to_string(i);
+        db::node *n = new db::node(handle, 0, tx_clk, nullptr);
+        n->base.add_property("type", "user", tx_clk);
+        n->base.add_property("name", handle, tx_clk);
+        for (uint64_t j = 0; j < degree; j++) {
+            db::edge *e = new db::edge(handle + "_" + std::to_string(j), tx_clk, 0, std::to_string((i + j + 1) % num_nodes));
+            n->add_edge_unique(e);
+        }
+        nodes.emplace_back(n);
+    }
+    tx_clk.reset();
+    uint64_t load_bytes = heap_bytes() - heap_start;
+
+    uint64_t num_elems = num_nodes * (degree + 1);
+    std::cout << "loaded " << num_nodes << " nodes, " << num_nodes * degree << " edges" << std::endl;
+    std::cout << "heap:   " << load_bytes << " bytes, " << (double)load_bytes / num_elems << " bytes/element" << std::endl;
+    std::cout << "clocks: " << vc::interned_clocks.num_clocks() << " distinct, "
+              << vc::interned_clocks.num_references() << " references, "
+              << vc::interned_clocks.bytes() << " table bytes" << std::endl;
+
+    for (db::node *n: nodes) {
+        n->free_edges();
+        delete n;
+    }
+
+    // concurrent churn over clocks shared between threads
+    std::vector<vclock_ptr_t> clocks;
+    for (uint64_t i = 0; i < 1024; i++) {
+        clocks.emplace_back(make_clock(i % NumVts, i+1));
+    }
+    std::vector<pthread_t> threads(num_threads);
+    std::vector<churn_args> args(num_threads);
+    wclock::weaver_timer timer;
+    uint64_t start = timer.get_real_time();
+    for (uint64_t t = 0; t < num_threads; t++) {
+        args[t].clocks = &clocks;
+        args[t].tid = t;
+        args[t].num_iter = num_iter;
+        pthread_create(&threads[t], nullptr, churn_loop, &args[t]);
+    }
+    for (uint64_t t = 0; t < num_threads; t++) {
+        pthread_join(threads[t], nullptr);
+    }
+    uint64_t churn_ns = timer.get_real_time() - start;
+
+    if (vc::interned_clocks.num_clocks() != 0 || vc::interned_clocks.num_references() != 0) {
+        std::cerr << "mismatch: " << vc::interned_clocks.num_clocks() << " clocks, "
+                  << vc::interned_clocks.num_references() << " references left after teardown" << std::endl;
+        return 1;
+    }
+
+    // each iteration is one intern, one acquire and two releases
+    std::cout << "churn:  " << num_threads << " threads, "
+              << (double)churn_ns / (num_threads * num_iter) << " ns/iteration" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * ===============================================================
+ *    Description:  6 hop BFS from random sources on one shard,
+ *                  keeping visited/parent/hop count per node as a
+ *                  Node_State_Base in the request arena vs a dense
+ *                  state indexed by the node's slot.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <dlfcn.h>
+#include <deque>
+#include <random>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "common/clock.h"
+#include "common/config_constants.h"
+#include "node_prog/boilerplate.h"
+#include "db/prog_state_arena.h"
+
+DECLARE_CONFIG_CONSTANTS;
+
+namespace node_prog
+{
+    // the per node state traversal programs kept before dense states
+    struct bfs_state : public virtual Node_State_Base
+    {
+        bool visited;
+        uint32_t hops;
+        uint32_t out_count;
+        db::remote_node parent;
+
+        bfs_state() : visited(false), hops(0), out_count(0) { }
+        ~bfs_state() { }
+        uint64_t size(void*) const { return 0; }
+        void pack(e::packer&, void*) const { }
+        void unpack(e::unpacker&, void*) { }
+    };
+
+    struct bfs_params : public virtual Node_Parameters_Base
+    {
+        ~bfs_params() { }
+        uint64_t size(void*) const { return 0; }
+        void pack(e::packer&, void*) const { }
+        void unpack(e::unpacker&, void*) { }
+        bool search_cache() { return false; }
+        cache_key_t cache_key() { return cache_key_t(); }
+    };
+
+    extern "C" {
+        PROG_FUNC_DECLARE;
+    }
+}
+
+using node_prog::Node_Parameters_Base;
+using node_prog::Node_State_Base;
+using node_prog::search_type;
+using node_prog::bfs_params;
+using node_prog::bfs_state;
+
+extern "C" {
+
+PROG_FUNC_DEFINE(bfs);
+
+// shard calls dense_node_program instead for dense programs
+std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>>
+node_prog :: node_program(node&, db::remote_node&, std::shared_ptr<Node_Parameters_Base>, std::function<Node_State_Base&()>)
+{
+    return std::make_pair(search_type::BREADTH_FIRST, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>());
+}
+
+}
+
+struct bfs_graph
+{
+    std::vector<node_handle_t> handles;
+    std::vector<std::vector<uint64_t>> nbrs; // node index is also its node id on the shard
+};
+
+// the state update of a traversal program at every hop, returns number of nodes visited
+template <typename GetState>
+uint64_t
+run_bfs(const bfs_graph &g, uint64_t source, uint32_t max_hops, GetState get_state)
+{
+    uint64_t visited = 0;
+    std::deque<std::pair<uint64_t, uint64_t>> frontier; // node, parent
+    frontier.emplace_back(source, UINT64_MAX);
+    for (uint32_t hop = 0; hop <= max_hops && !frontier.empty(); hop++) {
+        for (uint64_t sz = frontier.size(); sz > 0; sz--) {
+            uint64_t cur = frontier.front().first;
+            uint64_t parent = frontier.front().second;
+            frontier.pop_front();
+
+            auto &state = get_state(cur);
+            if (state.visited) {
+                continue;
+            }
+            state.visited = true;
+            state.hops = hop;
+            if (parent != UINT64_MAX) {
+                state.parent = db::remote_node(0, g.handles[parent]);
+            }
+            visited++;
+            if (hop < max_hops) {
+                for (uint64_t nbr: g.nbrs[cur]) {
+                    frontier.emplace_back(nbr, cur);
+                    state.out_count++;
+                }
+            }
+        }
+    }
+    return visited;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 4) {
+        std::cerr << "usage: " << argv[0] << " <num_nodes> <degree> <num_queries>" << std::endl;
+        return -1;
+    }
+
+    uint64_t num_nodes = std::stoull(argv[1]);
+    uint64_t degree = std::stoull(argv[2]);
+    uint64_t num_queries = std::stoull(argv[3]);
+    const uint32_t max_hops = 6;
+
+    bfs_graph g;
+    std::mt19937_64 rng(42);
+    g.nbrs.resize(num_nodes);
+    for (uint64_t i = 0; i < num_nodes; i++) {
+        g.handles.emplace_back("n" + std::to_string(i));
+        for (uint64_t j = 0; j < degree; j++) {
+            g.nbrs[i].emplace_back(rng() % num_nodes);
+        }
+    }
+
+    // state functions of this binary, as the shard finds them in a program library
+    void *self = dlopen(nullptr, RTLD_NOW);
+    dynamic_prog_table prog_table(self);
+    assert(prog_table.state_ctor_at != nullptr);
+
+    wclock::weaver_timer timer;
+    std::cout << "mode\tmean_ms\tteardown_ms\tstate_KB\tvisited" << std::endl;
+
+    uint64_t mode_visited[2];
+    for (bool dense: {false, true}) {
+        std::mt19937_64 query_rng(7);
+        uint64_t run_ns = 0, teardown_ns = 0, state_bytes = 0, visited = 0;
+
+        for (uint64_t q = 0; q < num_queries; q++) {
+            uint64_t source = query_rng() % num_nodes;
+            auto states = std::make_shared<db::request_states>();
+
+            uint64_t start = timer.get_real_time();
+            if (dense) {
+                visited += run_bfs(g, source, max_hops, [&](uint64_t n) -> node_prog::dense_node_state& {
+                    return states->get_dense(n, g.handles[n]);
+                });
+            } else {
+                visited += run_bfs(g, source, max_hops, [&](uint64_t n) -> bfs_state& {
+                    return dynamic_cast<bfs_state&>(states->get(g.handles[n], prog_table));
+                });
+            }
+            uint64_t end = timer.get_real_time();
+            state_bytes += db::shard_memory().get(db::MEM_PROG_STATE);
+
+            states.reset();
+            teardown_ns += timer.get_real_time() - end;
+            run_ns += end - start;
+        }
+
+        std::cout << (dense? "dense\t" : "keyed\t")
+                  << run_ns / 1e6 / num_queries << "\t"
+                  << teardown_ns / 1e6 / num_queries << "\t"
+                  << state_bytes / 1024 / num_queries << "\t"
+                  << visited / num_queries << std::endl;
+        mode_visited[dense] = visited;
+    }
+
+    if (mode_visited[0] != mode_visited[1]) {
+        std::cerr << "mismatch: keyed state visited " << mode_visited[0] << " nodes, dense state visited " << mode_visited[1] << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,247 @@
+/*
+ * ===============================================================
+ *    Description:  Wide BFS over a power-law graph on one shard:
+ *                  a single thread works through the whole local
+ *                  frontier vs worker threads splitting and
+ *                  stealing frontier pieces.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <cmath>
+#include <atomic>
+#include <deque>
+#include <random>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <po6/threads/mutex.h>
+
+#include "common/clock.h"
+#include "common/config_constants.h"
+#include "common/event_order.h"
+#include "db/shard_constants.h"
+#include "db/frontier_pool.h"
+#include "db/node.h"
+
+DECLARE_CONFIG_CONSTANTS;
+
+typedef std::deque<uint64_t> piece_t;
+
+struct bfs_graph
+{
+    std::vector<db::node*> nodes;
+    po6::threads::mutex map_mutexes[NUM_NODE_MAPS];
+    std::vector<uint8_t> visited; // per node state, guarded by the node latch as in a shard
+};
+
+// out-degrees follow a power law with exponent gamma, edges favour low numbered nodes
+void
+load_graph(bfs_graph &g, uint64_t num_nodes, double gamma, vclock_ptr_t &clk)
+{
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<double> unif(0.0, 1.0);
+    uint64_t max_degree = num_nodes / 10;
+
+    g.nodes.reserve(num_nodes);
+    for (uint64_t i = 0; i < num_nodes; i++) {
+        g.nodes.emplace_back(new db::node(std::to_string(i), 0, clk, g.map_mutexes + (i % NUM_NODE_MAPS)));
+        g.nodes.back()->in_use = false;
+    }
+
+    for (uint64_t i = 0; i < num_nodes; i++) {
+        double u = 1.0 - unif(gen);
+        uint64_t degree = (uint64_t)std::pow(u, -1.0 / (gamma - 1.0));
+        if (degree > max_degree) {
+            degree = max_degree;
+        }
+        for (uint64_t j = 0; j < degree; j++) {
+            uint64_t nbr = (uint64_t)(num_nodes * std::pow(unif(gen), 3));
+            db::edge *e = new db::edge(std::to_string(i) + "_" + std::to_string(j), clk, 0, std::to_string(nbr));
+            e->nbr.id = nbr;
+            g.nodes[i]->add_edge_unique(e);
+        }
+    }
+    g.visited.assign(num_nodes, 0);
+}
+
+// body of a BFS node program: check and set visited, emit all neighbors
+void
+visit(bfs_graph &g, uint64_t idx, uint64_t req_id, piece_t &frontier, uint64_t &edges_read)
+{
+    db::node &n = *g.nodes[idx];
+    po6::threads::mutex &mtx = g.map_mutexes[idx % NUM_NODE_MAPS];
+
+    mtx.lock();
+    n.latch_shared(req_id);
+    mtx.unlock();
+
+    if (!g.visited[idx]) {
+        g.visited[idx] = 1;
+        for (uint64_t i = 0; i < n.out_adjacency.size(); i++) {
+            db::remote_node nbr = n.out_adjacency.at(i)->nbr;
+            frontier.emplace_back(nbr.id);
+            edges_read++;
+        }
+    }
+
+    mtx.lock();
+    n.unlatch_shared(req_id);
+    mtx.unlock();
+}
+
+struct steal_args
+{
+    bfs_graph *g;
+    db::frontier_pool<piece_t> *pool;
+    std::atomic<uint64_t> *outstanding; // pieces pushed and not yet finished
+    uint64_t tid;
+    uint64_t num_threads;
+    uint64_t piece_size;
+    uint64_t edges_read;
+    uint64_t pieces_run;
+};
+
+void*
+steal_loop(void *a)
+{
+    steal_args *args = (steal_args*)a;
+    piece_t frontier;
+
+    while (true) {
+        if (!args->pool->take(args->tid, frontier)) {
+            if (args->outstanding->load() == 0) {
+                break;
+            }
+            continue;
+        }
+        args->pieces_run++;
+
+        while (!frontier.empty()) {
+            uint64_t idx = frontier.front();
+            frontier.pop_front();
+            visit(*args->g, idx, 1, frontier, args->edges_read);
+
+            // same split rule as node_prog_loop
+            while (frontier.size() >= 2*args->piece_size
+                && args->pool->pending() < args->num_threads) {
+                piece_t piece(frontier.end() - args->piece_size, frontier.end());
+                frontier.erase(frontier.end() - args->piece_size, frontier.end());
+                (*args->outstanding)++;
+                args->pool->push(args->tid, std::move(piece));
+            }
+        }
+        (*args->outstanding)--;
+    }
+
+    return nullptr;
+}
+
+uint64_t
+run_single(bfs_graph &g, uint64_t &edges_read)
+{
+    wclock::weaver_timer timer;
+    piece_t frontier(1, 0);
+    edges_read = 0;
+
+    uint64_t start = timer.get_real_time();
+    while (!frontier.empty()) {
+        uint64_t idx = frontier.front();
+        frontier.pop_front();
+        visit(g, idx, 1, frontier, edges_read);
+    }
+    return timer.get_real_time() - start;
+}
+
+uint64_t
+run_stealing(bfs_graph &g, uint64_t num_threads, uint64_t piece_size, uint64_t &edges_read, uint64_t &pieces_stolen)
+{
+    wclock::weaver_timer timer;
+    db::frontier_pool<piece_t> pool(num_threads);
+    std::atomic<uint64_t> outstanding(1);
+    std::vector<pthread_t> threads(num_threads);
+    std::vector<steal_args> args(num_threads);
+
+    uint64_t start = timer.get_real_time();
+    pool.push(0, piece_t(1, 0));
+    for (uint64_t i = 0; i < num_threads; i++) {
+        args[i].g = &g;
+        args[i].pool = &pool;
+        args[i].outstanding = &outstanding;
+        args[i].tid = i;
+        args[i].num_threads = num_threads;
+        args[i].piece_size = piece_size;
+        args[i].edges_read = 0;
+        args[i].pieces_run = 0;
+        int rc = pthread_create(&threads[i], nullptr, &steal_loop, (void*)&args[i]);
+        assert(rc == 0);
+    }
+
+    edges_read = 0;
+    for (uint64_t i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], nullptr);
+        edges_read += args[i].edges_read;
+    }
+    pieces_stolen = pool.stolen();
+    return timer.get_real_time() - start;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 4) {
+        std::cerr << "usage: " << argv[0] << " <num_nodes> <num_threads> <piece_size>" << std::endl;
+        return -1;
+    }
+
+    uint64_t num_nodes = std::stoull(argv[1]);
+    uint64_t num_threads = std::stoull(argv[2]);
+    uint64_t piece_size = std::stoull(argv[3]);
+    NumVts = 1;
+    ClkSz = 2;
+
+    vc::vclock_t clk(2, 0);
+    clk[1] = 1;
+    vclock_ptr_t creat_clk(new vc::vclock(0, clk));
+
+    bfs_graph g;
+    load_graph(g, num_nodes, 2.1, creat_clk);
+
+    uint64_t single_edges, steal_edges, pieces_stolen;
+    uint64_t single_ns = run_single(g, single_edges);
+    uint64_t single_visited = 0;
+    for (uint8_t v: g.visited) {
+        single_visited += v;
+    }
+    std::vector<uint8_t> single_set = g.visited;
+
+    g.visited.assign(num_nodes, 0);
+    uint64_t steal_ns = run_stealing(g, num_threads, piece_size, steal_edges, pieces_stolen);
+    uint64_t steal_visited = 0;
+    for (uint8_t v: g.visited) {
+        steal_visited += v;
+    }
+
+    // pieces together visit exactly the nodes of the unsplit run, each once
+    if (single_set != g.visited || single_edges != steal_edges) {
+        std::cerr << "mismatch: single thread visited " << single_visited << " nodes, "
+                  << num_threads << " threads visited " << steal_visited << std::endl;
+        return 1;
+    }
+
+    std::cout << "visited " << single_visited << " nodes, " << single_edges << " edges" << std::endl;
+    std::cout << "single thread: " << single_ns / 1e6 << " ms" << std::endl;
+    std::cout << num_threads << " threads:     " << steal_ns / 1e6 << " ms, "
+              << pieces_stolen << " pieces stolen, speedup " << (double)single_ns / steal_ns << std::endl;
+
+    for (db::node *n: g.nodes) {
+        n->free_edges();
+        delete n;
+    }
+
+    return 0;
+}
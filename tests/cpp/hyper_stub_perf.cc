@@ -40,6 +40,6 @@ int main(int argc, char *argv[])
     float secs     = (end-start) / 1000.0;
     std::cout << "time taken=" << secs << " s" << std::endl;
 
-    n.out_edges.clear();
+    n.free_edges();
     return 0;
 }
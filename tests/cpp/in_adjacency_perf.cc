@@ -0,0 +1,162 @@
+/*
+ * ===============================================================
+ *    Description:  Cost of the in-neighbors of a node: applying
+ *                  in edge updates, iterating in edges vs out
+ *                  edges, memory per in edge vs per out edge, and
+ *                  bytes sent per in edge update.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <iostream>
+#include <string>
+
+#include "common/clock.h"
+#include "common/config_constants.h"
+#include "common/event_order.h"
+#include "common/message.h"
+#include "db/node.h"
+
+DECLARE_CONFIG_CONSTANTS;
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        std::cerr << "usage: " << argv[0] << " <num_edges> <num_iterations>" << std::endl;
+        return -1;
+    }
+
+    uint64_t num_edges = std::stoull(argv[1]);
+    uint64_t num_iter = std::stoull(argv[2]);
+    NumVts = 1;
+    ClkSz = 2;
+
+    // single vector timestamper, all clocks comparable without Kronos
+    vc::vclock_t clk(2, 0);
+    clk[1] = 1;
+    vclock_ptr_t creat_clk(new vc::vclock(0, clk));
+    clk[1] = 2;
+    vclock_ptr_t del_clk(new vc::vclock(0, clk));
+    clk[1] = 3;
+    vclock_ptr_t req_clk(new vc::vclock(0, clk));
+
+    order::oracle time_oracle;
+    db::node n("in_adj_perf", 0, creat_clk, nullptr);
+    n.base.view_time = req_clk;
+    n.base.time_oracle = &time_oracle;
+    n.out_adjacency.reserve(num_edges);
+
+    db::mem_accounting &mem = db::shard_memory();
+    uint64_t edge_bytes = mem.get(db::MEM_EDGES);
+
+    // the same edges out of n and into n, every fourth deleted before the read
+    std::vector<db::in_edge_update> creates, deletes;
+    for (uint64_t i = 0; i < num_edges; i++) {
+        db::edge *e = new db::edge(std::to_string(i), creat_clk, i % 8, std::to_string(i+1));
+        n.add_edge_unique(e);
+
+        db::in_edge_update upd;
+        upd.node = n.get_handle();
+        upd.edge = e->get_handle();
+        upd.src = e->nbr;
+        upd.creat_time = creat_clk;
+        creates.emplace_back(upd);
+        if (i % 4 == 0) {
+            n.delete_edge(e, del_clk);
+            upd.del_time = del_clk;
+            deletes.emplace_back(upd);
+        }
+    }
+    edge_bytes = mem.get(db::MEM_EDGES) - edge_bytes;
+
+    wclock::weaver_timer timer;
+    uint64_t start = timer.get_real_time();
+    for (const db::in_edge_update &upd: creates) {
+        n.in_edges.apply(upd, 0);
+    }
+    uint64_t create_ns = timer.get_real_time() - start;
+
+    start = timer.get_real_time();
+    for (const db::in_edge_update &upd: deletes) {
+        n.in_edges.apply(upd, 0);
+    }
+    uint64_t delete_ns = timer.get_real_time() - start;
+    uint64_t in_edge_bytes = mem.get(db::MEM_IN_EDGES);
+
+    uint64_t out_cnt = 0, in_cnt = 0;
+    start = timer.get_real_time();
+    for (uint64_t i = 0; i < num_iter; i++) {
+        for (node_prog::edge &e: n.get_edges()) {
+            out_cnt += e.get_neighbor().loc;
+        }
+    }
+    uint64_t out_ns = timer.get_real_time() - start;
+
+    start = timer.get_real_time();
+    for (uint64_t i = 0; i < num_iter; i++) {
+        for (const db::in_edge &e: n.get_in_edges()) {
+            in_cnt += e.get_neighbor().loc;
+        }
+    }
+    uint64_t in_ns = timer.get_real_time() - start;
+
+    if (out_cnt != in_cnt) {
+        std::cerr << "mismatch: out edges sum=" << out_cnt << ", in edges sum=" << in_cnt << std::endl;
+        return 1;
+    }
+
+    // every edge write is sent again as an update to the shard of the edge target
+    uint64_t update_bytes = 0;
+    for (const db::in_edge_update &upd: creates) {
+        update_bytes += message::size(nullptr, upd);
+    }
+
+    start = timer.get_real_time();
+    uint64_t reclaimed = n.in_edges.compact([](uint32_t del_id) { return del_id != vc::clock_table::null_id; });
+    uint64_t compact_ns = timer.get_real_time() - start;
+
+    double edges_visited = (double)num_edges * num_iter;
+    std::cout << "apply create:  " << (double)create_ns / creates.size() << " ns/update" << std::endl;
+    std::cout << "apply delete:  " << (double)delete_ns / deletes.size() << " ns/update" << std::endl;
+    std::cout << "out edges:     " << out_ns / 1e6 << " ms, " << edges_visited * 1e3 / out_ns << " Medges/s" << std::endl;
+    std::cout << "in edges:      " << in_ns / 1e6 << " ms, " << edges_visited * 1e3 / in_ns << " Medges/s" << std::endl;
+    std::cout << "memory:        " << (double)edge_bytes / num_edges << " bytes/out edge, "
+              << (double)in_edge_bytes / num_edges << " bytes/in edge" << std::endl;
+    std::cout << "sent:          " << (double)update_bytes / num_edges << " bytes/update" << std::endl;
+    std::cout << "compact:       " << reclaimed << " versions in " << compact_ns / 1e6 << " ms" << std::endl;
+    n.free_edges();
+
+    // a delete ahead of its create skips the create, unless the create comes after IN_EDGE_HOLD_NOPS
+    db::node m("in_adj_order", 0, creat_clk, nullptr);
+    db::in_edge_update upd = creates[0];
+    upd.node = m.get_handle();
+    upd.del_time = del_clk;
+    upd.edge = "early";
+    m.in_edges.apply(upd, 0);
+    upd.edge = "expired";
+    m.in_edges.apply(upd, 0);
+    upd.del_time.reset();
+    upd.edge = "early";
+    m.in_edges.apply(upd, 1);
+    upd.del_time = del_clk;
+    upd.edge = "late";
+    m.in_edges.apply(upd, IN_EDGE_HOLD_NOPS+1);
+    upd.del_time.reset();
+    upd.edge = "expired";
+    m.in_edges.apply(upd, IN_EDGE_HOLD_NOPS+1);
+
+    // versions survive eviction and recovery
+    db::in_adjacency evicted;
+    evicted.swap(m.in_edges);
+    if (evicted.size() != 4 || !m.in_edges.empty()) {
+        std::cerr << "mismatch: " << evicted.size() << " in edge versions after early deletes, expected 4" << std::endl;
+        return 1;
+    }
+    evicted.clear();
+
+    return 0;
+}
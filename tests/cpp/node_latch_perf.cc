@@ -0,0 +1,156 @@
+/*
+ * ===============================================================
+ *    Description:  Contention on a single hot node: threads run
+ *                  the read_node_props node program body under an
+ *                  exclusive vs shared node latch.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <po6/threads/mutex.h>
+
+#include "common/clock.h"
+#include "common/config_constants.h"
+#include "common/event_order.h"
+#include "db/node.h"
+
+DECLARE_CONFIG_CONSTANTS;
+
+struct latch_args
+{
+    db::node *n;
+    po6::threads::mutex *mtx;
+    vclock_ptr_t req_clk;
+    uint64_t tid;
+    uint64_t num_threads;
+    uint64_t num_iter;
+    bool shared;
+    uint64_t props_read;
+};
+
+// same work as read_node_props with no keys specified, i.e. fetch all
+uint64_t
+read_node_props(db::node &n)
+{
+    std::vector<std::pair<std::string, std::string>> node_props;
+    for (node_prog::prop_view prop: n.get_properties()) {
+        node_props.emplace_back(prop.get_key(), prop.get_value());
+    }
+    return node_props.size();
+}
+
+void*
+reader_loop(void *a)
+{
+    latch_args *args = (latch_args*)a;
+    db::node &n = *args->n;
+    order::oracle time_oracle;
+
+    for (uint64_t i = 0; i < args->num_iter; i++) {
+        // distinct request per visit, like node programs from many clients
+        uint64_t req_id = i * args->num_threads + args->tid;
+
+        args->mtx->lock();
+        if (args->shared) {
+            n.latch_shared(req_id);
+        } else {
+            n.latch_exclusive();
+        }
+        args->mtx->unlock();
+
+        n.base.view_time = args->req_clk;
+        n.base.time_oracle = &time_oracle;
+        args->props_read += read_node_props(n);
+        n.base.view_time = nullptr;
+        n.base.time_oracle = nullptr;
+
+        args->mtx->lock();
+        if (args->shared) {
+            n.unlatch_shared(req_id);
+        } else {
+            n.unlatch();
+        }
+        args->mtx->unlock();
+    }
+
+    return nullptr;
+}
+
+uint64_t
+run(db::node &n, po6::threads::mutex &mtx, vclock_ptr_t &req_clk, uint64_t num_threads, uint64_t num_iter, bool shared, uint64_t &props_read)
+{
+    std::vector<pthread_t> threads(num_threads);
+    std::vector<latch_args> args(num_threads);
+    wclock::weaver_timer timer;
+
+    uint64_t start = timer.get_real_time();
+    for (uint64_t i = 0; i < num_threads; i++) {
+        args[i].n = &n;
+        args[i].mtx = &mtx;
+        args[i].req_clk = req_clk;
+        args[i].tid = i;
+        args[i].num_threads = num_threads;
+        args[i].num_iter = num_iter;
+        args[i].shared = shared;
+        args[i].props_read = 0;
+        int rc = pthread_create(&threads[i], nullptr, &reader_loop, (void*)&args[i]);
+        assert(rc == 0);
+    }
+
+    props_read = 0;
+    for (uint64_t i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], nullptr);
+        props_read += args[i].props_read;
+    }
+    return timer.get_real_time() - start;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 4) {
+        std::cerr << "usage: " << argv[0] << " <num_threads> <num_props> <num_iterations>" << std::endl;
+        return -1;
+    }
+
+    uint64_t num_threads = std::stoull(argv[1]);
+    uint64_t num_props = std::stoull(argv[2]);
+    uint64_t num_iter = std::stoull(argv[3]);
+    NumVts = 1;
+    ClkSz = 2;
+
+    vc::vclock_t clk(2, 0);
+    clk[1] = 1;
+    vclock_ptr_t creat_clk(new vc::vclock(0, clk));
+    clk[1] = 2;
+    vclock_ptr_t req_clk(new vc::vclock(0, clk));
+
+    po6::threads::mutex mtx;
+    db::node n("hot_node", 0, creat_clk, &mtx);
+    n.in_use = false;
+    for (uint64_t i = 0; i < num_props; i++) {
+        n.base.add_property(std::to_string(i), std::to_string(i), creat_clk);
+    }
+
+    uint64_t excl_props, shared_props;
+    uint64_t excl_ns = run(n, mtx, req_clk, num_threads, num_iter, false, excl_props);
+    uint64_t shared_ns = run(n, mtx, req_clk, num_threads, num_iter, true, shared_props);
+
+    if (excl_props != shared_props || excl_props != num_threads * num_iter * num_props) {
+        std::cerr << "mismatch: exclusive read " << excl_props << " props, shared read " << shared_props << std::endl;
+        return 1;
+    }
+
+    double visits = (double)num_threads * num_iter;
+    std::cout << "exclusive latch: " << excl_ns / 1e6 << " ms, " << visits * 1e3 / excl_ns << " Mvisits/s" << std::endl;
+    std::cout << "shared latch:    " << shared_ns / 1e6 << " ms, " << visits * 1e3 / shared_ns << " Mvisits/s" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,272 @@
+/*
+ * ===============================================================
+ *    Description:  Node program messages from concurrent requests
+ *                  sent one busybee message each vs coalesced in
+ *                  the per shard outbox. Reports messages/sec and
+ *                  frame latency at several concurrency levels,
+ *                  sending is modelled as a fixed cost per message.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <time.h>
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "common/clock.h"
+#include "db/shard_constants.h"
+#include "db/outbox.h"
+
+#define NUM_DESTS 8
+#define FRAME_SZ 128
+#define HEADER_SZ 8
+
+struct run_config
+{
+    bool coalesce;
+    uint64_t send_cost_ns;
+    uint64_t think_ns;
+};
+
+struct run_state
+{
+    db::outbox *box;
+    const run_config *conf;
+    std::atomic<bool> stop;
+    std::atomic<uint64_t> messages, frames;
+};
+
+struct thread_args
+{
+    run_state *st;
+    uint64_t tid;
+    std::vector<uint64_t> latencies;
+};
+
+uint64_t
+now_ns()
+{
+    return wclock::weaver_timer().get_time_elapsed();
+}
+
+void
+spin(uint64_t ns)
+{
+    uint64_t until = now_ns() + ns;
+    while (now_ns() < until);
+}
+
+// frame stamped with its enqueue time, or any other word
+void
+pack_frame(e::packer &packer, uint64_t now)
+{
+    char frame[FRAME_SZ];
+    memset(frame, 'x', FRAME_SZ);
+    memcpy(frame, &now, sizeof(now));
+    packer = packer.copy(e::slice(frame, FRAME_SZ));
+}
+
+// one busybee message carrying a single frame
+void
+send_frame(run_state &st, uint64_t enqueued, std::vector<uint64_t> &latencies)
+{
+    spin(st.conf->send_cost_ns);
+    latencies.emplace_back(now_ns() - enqueued);
+    st.messages++;
+    st.frames++;
+}
+
+// one busybee message carrying a batch, latency of each frame is measured up to the send
+void
+send_batch(run_state &st, const db::outbox::batch_t &batch, std::vector<uint64_t> &latencies)
+{
+    spin(st.conf->send_cost_ns);
+    uint64_t sent = now_ns();
+    uint64_t frames = 0;
+    db::outbox::for_each_frame(*batch, HEADER_SZ, [&](const uint8_t *frame, uint64_t frame_sz) {
+        assert(frame_sz == FRAME_SZ);
+        uint64_t enqueued;
+        memcpy(&enqueued, frame, sizeof(enqueued));
+        latencies.emplace_back(sent - enqueued);
+        frames++;
+    });
+    st.messages++;
+    st.frames += frames;
+}
+
+void*
+producer_loop(void *a)
+{
+    thread_args *args = (thread_args*)a;
+    run_state &st = *args->st;
+    uint64_t dest = args->tid;
+
+    while (!st.stop.load()) {
+        uint64_t now = now_ns();
+        dest = (dest + 1) % NUM_DESTS;
+
+        db::outbox::batch_t batch;
+        bool queued = st.conf->coalesce
+                   && st.box->add(dest, args->tid, FRAME_SZ, [now](e::packer &packer) { pack_frame(packer, now); }, now, batch);
+        if (batch) {
+            send_batch(st, batch, args->latencies);
+        }
+        if (!queued) {
+            send_frame(st, now, args->latencies);
+        }
+
+        // node program execution between hops
+        spin(st.conf->think_ns);
+    }
+
+    return nullptr;
+}
+
+void*
+flush_loop(void *a)
+{
+    thread_args *args = (thread_args*)a;
+    run_state &st = *args->st;
+    std::vector<std::pair<uint64_t, db::outbox::batch_t>> batches;
+
+    while (st.box->wait_expired(batches)) {
+        for (auto &p: batches) {
+            send_batch(st, p.second, args->latencies);
+        }
+        batches.clear();
+    }
+
+    return nullptr;
+}
+
+// frames of a cancelled request are not sent once dropped, frames kept after them stay intact
+bool
+check_drop()
+{
+    db::outbox box(HEADER_SZ, OUTBOX_FLUSH_US, OUTBOX_MAX_FRAMES, OUTBOX_MAX_BYTES);
+    uint64_t num_frames = 13, before = 0, after = 0;
+    for (uint64_t i = 0; i < num_frames; i++) {
+        // frame carries its request id, odd ones are cancelled
+        uint64_t req_id = i % 2;
+        db::outbox::batch_t batch;
+        if (!box.add(0, req_id, FRAME_SZ, [req_id](e::packer &packer) { pack_frame(packer, req_id); }, now_ns(), batch)) {
+            before++;
+        }
+        if (batch) {
+            db::outbox::for_each_frame(*batch, HEADER_SZ, [&](const uint8_t*, uint64_t) { before++; });
+        }
+    }
+
+    uint64_t dropped = box.drop(1);
+    bool ok = dropped > 0 && dropped == box.dropped();
+    std::vector<std::pair<uint64_t, db::outbox::batch_t>> batches;
+    if (before + dropped < num_frames) {
+        box.wait_expired(batches);
+    }
+    for (auto &p: batches) {
+        db::outbox::for_each_frame(*p.second, HEADER_SZ, [&](const uint8_t *frame, uint64_t frame_sz) {
+            uint64_t req_id;
+            memcpy(&req_id, frame, sizeof(req_id));
+            ok = ok && frame_sz == FRAME_SZ && req_id == 0 && frame[FRAME_SZ-1] == 'x';
+            after++;
+        });
+    }
+    box.stop();
+
+    ok = ok && before + dropped + after == num_frames;
+    if (!ok) {
+        std::cerr << "mismatch: " << before << " frames sent, " << dropped << " dropped, "
+                  << after << " sent after drop, of " << num_frames << std::endl;
+    }
+    return ok;
+}
+
+void
+run(const run_config &conf, uint64_t concurrency, uint64_t duration_ms)
+{
+    db::outbox box(HEADER_SZ, OUTBOX_FLUSH_US, OUTBOX_MAX_FRAMES, OUTBOX_MAX_BYTES);
+    run_state st;
+    st.box = &box;
+    st.conf = &conf;
+    st.stop = false;
+    st.messages = 0;
+    st.frames = 0;
+
+    std::vector<pthread_t> threads(concurrency + 1);
+    std::vector<thread_args> args(concurrency + 1);
+    for (uint64_t i = 0; i <= concurrency; i++) {
+        args[i].st = &st;
+        args[i].tid = i;
+        int rc = pthread_create(&threads[i], nullptr, i < concurrency? &producer_loop : &flush_loop, (void*)&args[i]);
+        assert(rc == 0);
+    }
+
+    timespec duration;
+    duration.tv_sec = duration_ms / 1000;
+    duration.tv_nsec = (duration_ms % 1000) * 1000000;
+    nanosleep(&duration, nullptr);
+    st.stop = true;
+    box.stop();
+
+    std::vector<uint64_t> latencies;
+    for (uint64_t i = 0; i <= concurrency; i++) {
+        pthread_join(threads[i], nullptr);
+        latencies.insert(latencies.end(), args[i].latencies.begin(), args[i].latencies.end());
+    }
+
+    double mean_us = 0, p99_us = 0;
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        uint64_t sum = 0;
+        for (uint64_t l: latencies) {
+            sum += l;
+        }
+        mean_us = sum / 1e3 / latencies.size();
+        p99_us = latencies[latencies.size() * 99 / 100] / 1e3;
+    }
+
+    double secs = duration_ms / 1e3;
+    std::cout << (conf.coalesce? "outbox " : "direct ")
+              << concurrency << "\t"
+              << (uint64_t)(st.messages / secs) << "\t"
+              << (uint64_t)(st.frames / secs) << "\t"
+              << mean_us << "\t"
+              << p99_us << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 4) {
+        std::cerr << "usage: " << argv[0] << " <duration_ms> <send_cost_ns> <think_ns>" << std::endl;
+        return -1;
+    }
+
+    uint64_t duration_ms = std::stoull(argv[1]);
+    run_config conf;
+    conf.send_cost_ns = std::stoull(argv[2]);
+    conf.think_ns = std::stoull(argv[3]);
+
+    if (!check_drop()) {
+        return 1;
+    }
+
+    std::cout << "mode   conc\tmsgs/s\tframes/s\tmean_us\tp99_us" << std::endl;
+    for (uint64_t concurrency: {1, 4, 16, 64}) {
+        conf.coalesce = false;
+        run(conf, concurrency, duration_ms);
+        conf.coalesce = true;
+        run(conf, concurrency, duration_ms);
+    }
+
+    return 0;
+}
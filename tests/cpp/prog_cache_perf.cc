@@ -0,0 +1,229 @@
+/*
+ * ===============================================================
+ *    Description:  Repeated two neighborhood queries on a graph
+ *                  with concurrent property writes, with and
+ *                  without node program result caching. Runs the
+ *                  program and cache validation in process, the
+ *                  way the shard does for nodes on one shard.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "common/clock.h"
+#include "common/config_constants.h"
+#include "common/event_order.h"
+#include "db/node.h"
+#include "db/prog_cache.h"
+#include "node_prog/two_neighborhood_program.h"
+
+DECLARE_CONFIG_CONSTANTS;
+
+using node_prog::Node_State_Base;
+using node_prog::Node_Parameters_Base;
+using node_prog::two_neighborhood_params;
+using node_prog::two_neighborhood_state;
+
+struct graph
+{
+    std::vector<db::node*> nodes;
+    std::unordered_map<node_handle_t, uint64_t> idx;
+    uint64_t now;
+
+    vclock_ptr_t
+    next_clk()
+    {
+        vc::vclock_t clk(2, 0);
+        clk[1] = ++now;
+        return vclock_ptr_t(new vc::vclock(0, clk));
+    }
+};
+
+// cache lookup of shard.cc for a watch set on this shard
+void
+cache_lookup(graph &g, db::node &center, two_neighborhood_params &params, const vc::vclock &req_clk, db::prog_cache &counters)
+{
+    auto cache_iter = center.cache.find(params.cache_key());
+    if (cache_iter == center.cache.end()
+     || !order::oracle::happens_before_no_kronos(cache_iter->second.clk->clock, req_clk.clock)) {
+        counters.miss();
+        return;
+    }
+
+    const db::cache_entry &entry = cache_iter->second;
+    for (const db::remote_node &rn: *entry.watch_set) {
+        if (g.nodes[g.idx[rn.handle]]->written_since(*entry.clk)) {
+            counters.invalidation();
+            center.cache.erase(cache_iter);
+            return;
+        }
+    }
+
+    counters.hit();
+    params.set_cache_value(entry.val);
+}
+
+typedef std::vector<std::pair<node_handle_t, std::string>> response_t;
+
+// run one query to completion, returns the responses sorted by node
+response_t
+run_query(graph &g, uint64_t center, bool caching, order::oracle &time_oracle, db::prog_cache &counters)
+{
+    vclock_ptr_t req_clk = g.next_clk();
+    std::unordered_map<uint64_t, std::shared_ptr<Node_State_Base>> states;
+
+    auto start = std::make_shared<two_neighborhood_params>();
+    start->_search_cache = caching;
+    start->prop_key = "name";
+    std::deque<std::pair<uint64_t, std::shared_ptr<Node_Parameters_Base>>> frontier;
+    frontier.emplace_back(center, start);
+
+    while (!frontier.empty()) {
+        uint64_t cur = frontier.front().first;
+        std::shared_ptr<Node_Parameters_Base> params = std::move(frontier.front().second);
+        frontier.pop_front();
+
+        db::node &n = *g.nodes[cur];
+        if (MaxCacheEntries && params->search_cache()) {
+            cache_lookup(g, n, dynamic_cast<two_neighborhood_params&>(*params), *req_clk, counters);
+        }
+
+        auto state_getter = [&states, cur]() -> Node_State_Base& {
+            std::shared_ptr<Node_State_Base> &s = states[cur];
+            if (!s) {
+                s = std::make_shared<two_neighborhood_state>();
+            }
+            return *s;
+        };
+
+        db::remote_node rn(0, n.get_handle());
+        n.base.view_time = req_clk;
+        n.base.time_oracle = &time_oracle;
+        auto next = node_prog::node_program(n, rn, params, state_getter);
+        n.base.view_time = nullptr;
+        n.base.time_oracle = nullptr;
+
+        if (MaxCacheEntries) {
+            std::vector<db::remote_node> watch_set;
+            std::shared_ptr<node_prog::Cache_Value_Base> to_cache = params->take_cache_value(watch_set);
+            if (to_cache != nullptr) {
+                n.add_cache_value(req_clk, to_cache, std::make_shared<std::vector<db::remote_node>>(std::move(watch_set)), params->cache_key());
+                counters.store();
+            }
+        }
+
+        for (auto &p: next.second) {
+            if (p.first == db::coordinator) {
+                response_t responses = dynamic_cast<two_neighborhood_params&>(*p.second).responses;
+                std::sort(responses.begin(), responses.end());
+                return responses;
+            }
+            frontier.emplace_back(g.idx[p.first.handle], std::move(p.second));
+        }
+    }
+
+    return response_t();
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 6) {
+        std::cerr << "usage: " << argv[0] << " <num_nodes> <degree> <num_centers> <num_queries> <writes_per_1000_queries>" << std::endl;
+        return -1;
+    }
+
+    uint64_t num_nodes = std::stoull(argv[1]);
+    uint64_t degree = std::stoull(argv[2]);
+    uint64_t num_centers = std::stoull(argv[3]);
+    uint64_t num_queries = std::stoull(argv[4]);
+    uint64_t write_rate = std::stoull(argv[5]);
+    NumVts = 1;
+    ClkSz = 2;
+    MaxCacheEntries = 4;
+
+    // single vector timestamper, all clocks comparable without Kronos
+    graph g;
+    g.now = 0;
+    std::mt19937_64 rng(42);
+    vclock_ptr_t creat_clk = g.next_clk();
+    for (uint64_t i = 0; i < num_nodes; i++) {
+        db::node *n = new db::node("n" + std::to_string(i), 0, creat_clk, nullptr);
+        n->base.set_property("name", "v0", creat_clk);
+        g.idx[n->get_handle()] = i;
+        g.nodes.emplace_back(n);
+    }
+    for (uint64_t i = 0; i < num_nodes; i++) {
+        for (uint64_t j = 0; j < degree; j++) {
+            uint64_t nbr = rng() % num_nodes;
+            g.nodes[i]->add_edge_unique(new db::edge("e" + std::to_string(i) + "_" + std::to_string(j), creat_clk, 0, "n" + std::to_string(nbr)));
+        }
+    }
+
+    order::oracle time_oracle;
+    wclock::weaver_timer timer;
+    std::cout << "mode\tqueries/s\tmean_us\thits\tmisses\tinvalidations\tstores" << std::endl;
+
+    for (bool caching: {false, true}) {
+        db::prog_cache counters;
+        std::mt19937_64 query_rng(7);
+        uint64_t responses = 0, write_ns = 0, check_ns = 0, mismatches = 0;
+
+        uint64_t start = timer.get_real_time();
+        for (uint64_t q = 0; q < num_queries; q++) {
+            if (query_rng() % 1000 < write_rate) {
+                // property write, as applied and released by the shard
+                uint64_t w_start = timer.get_real_time();
+                db::node *n = g.nodes[query_rng() % num_nodes];
+                vclock_ptr_t wr_clk = g.next_clk();
+                n->base.set_property("name", "v" + std::to_string(g.now), wr_clk);
+                n->last_upd_clk = wr_clk;
+                write_ns += timer.get_real_time() - w_start;
+            }
+            uint64_t center = query_rng() % num_centers;
+            response_t resp = run_query(g, center, caching, time_oracle, counters);
+            responses += resp.size();
+
+            if (caching) {
+                // a stale cache entry would answer differently from running the program again
+                uint64_t c_start = timer.get_real_time();
+                db::prog_cache uncached;
+                if (run_query(g, center, false, time_oracle, uncached) != resp) {
+                    mismatches++;
+                }
+                check_ns += timer.get_real_time() - c_start;
+            }
+        }
+        uint64_t elapsed = timer.get_real_time() - start - write_ns - check_ns;
+
+        std::cout << (caching? "cached\t" : "uncached\t")
+                  << (uint64_t)(num_queries * 1e9 / elapsed) << "\t"
+                  << elapsed / 1e3 / num_queries << "\t"
+                  << counters.hits() << "\t"
+                  << counters.misses() << "\t"
+                  << counters.invalidations() << "\t"
+                  << counters.stores() << std::endl;
+        std::cerr << "responses " << responses << std::endl;
+
+        if (mismatches > 0) {
+            std::cerr << "mismatch: " << mismatches << " cached queries differ from uncached" << std::endl;
+            return 1;
+        }
+    }
+
+    for (db::node *n: g.nodes) {
+        n->free_edges();
+        delete n;
+    }
+    return 0;
+}
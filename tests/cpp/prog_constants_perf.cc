@@ -0,0 +1,176 @@
+/*
+ * ===============================================================
+ *    Description:  Bytes and packing time of node program hop
+ *                  messages when per request constants travel with
+ *                  every hop vs once per pair of shards.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <e/buffer.h>
+
+#include "common/clock.h"
+#include "common/config_constants.h"
+#include "common/stl_serialization.h"
+#include "node_prog/traverse_with_props.h"
+#include "db/prog_constants.h"
+
+using node_prog::Node_Parameters_Base;
+using node_prog::Node_Constants_Base;
+
+struct hop_totals
+{
+    uint64_t bytes;
+    uint64_t pack_ns;
+    uint64_t const_msgs;
+};
+
+// each hop message goes from one shard to another, constants are packed into it if
+// per_hop is set or if it is the first message between that pair of shards
+hop_totals
+pack_hops(const Node_Parameters_Base &params,
+          const Node_Constants_Base &constants,
+          uint64_t num_hops,
+          uint64_t num_shards,
+          bool per_hop)
+{
+    wclock::weaver_timer timer;
+    std::unordered_set<uint64_t> pairs_sent;
+    hop_totals t;
+    t.bytes = 0;
+    t.const_msgs = 0;
+
+    uint64_t start = timer.get_real_time();
+    for (uint64_t i = 0; i < num_hops; i++) {
+        uint64_t src = i % num_shards;
+        uint64_t dst = (i / num_shards) % num_shards;
+        bool with_constants = per_hop || pairs_sent.emplace(src*num_shards + dst).second;
+
+        uint64_t sz = params.size(nullptr);
+        if (with_constants) {
+            sz += constants.size(nullptr);
+            t.const_msgs++;
+        }
+
+        std::unique_ptr<e::buffer> buf(e::buffer::create(sz));
+        e::packer packer = buf->pack_at(0);
+        params.pack(packer, nullptr);
+        if (with_constants) {
+            constants.pack(packer, nullptr);
+        }
+        t.bytes += sz;
+    }
+    t.pack_ns = timer.get_real_time() - start;
+
+    return t;
+}
+
+void
+report(const std::string &prog, const Node_Parameters_Base &params, const Node_Constants_Base &constants,
+       uint64_t num_hops, uint64_t num_shards)
+{
+    hop_totals before = pack_hops(params, constants, num_hops, num_shards, true);
+    hop_totals after = pack_hops(params, constants, num_hops, num_shards, false);
+
+    std::cout << prog << ": params " << params.size(nullptr) << " B, constants " << constants.size(nullptr) << " B" << std::endl;
+    std::cout << "  per hop:   " << before.bytes / num_hops << " B/msg, "
+              << before.pack_ns / num_hops << " ns/msg packing" << std::endl;
+    std::cout << "  per shard: " << after.bytes / num_hops << " B/msg, "
+              << after.pack_ns / num_hops << " ns/msg packing, constants in "
+              << after.const_msgs << " of " << num_hops << " msgs" << std::endl;
+}
+
+std::shared_ptr<db::node_prog_running_state>
+make_prog(uint64_t req_id)
+{
+    std::shared_ptr<db::node_prog_running_state> np(new db::node_prog_running_state());
+    np->req_id = req_id;
+    np->vt_id = 0;
+    vc::vclock_t clk(2, 0);
+    clk[1] = req_id;
+    np->req_vclock.reset(new vc::vclock(0, clk));
+    return np;
+}
+
+// hops which overtake the one carrying the constants wait for it, later hops find them
+bool
+check_late_constants(node_prog::np_const_ptr_t constants)
+{
+    db::prog_constants consts;
+    std::vector<std::shared_ptr<db::node_prog_running_state>> ready;
+    bool ok = true;
+
+    auto early1 = make_prog(1), early2 = make_prog(1), carrier = make_prog(1), later = make_prog(1);
+    ok = ok && !consts.attach(early1, nullptr, ready) && ready.empty();
+    ok = ok && !consts.attach(early2, nullptr, ready) && ready.empty();
+    ok = ok && consts.attach(carrier, constants, ready) && carrier->constants == constants;
+    ok = ok && ready.size() == 2 && ready[0] == early1 && ready[1] == early2
+            && early1->constants == constants && early2->constants == constants;
+    ready.clear();
+    ok = ok && consts.attach(later, nullptr, ready) && ready.empty() && later->constants == constants;
+
+    // another request does not see them
+    auto other = make_prog(2);
+    ok = ok && !consts.attach(other, nullptr, ready) && other->constants == nullptr;
+
+    // sent once per shard, forgotten once the request is done
+    ok = ok && consts.must_send(1, 5);
+    consts.mark_sent(1, 5);
+    ok = ok && !consts.must_send(1, 5) && consts.must_send(1, 6);
+    vc::vclock_t done(2, 0);
+    done[1] = 2;
+    consts.cleanup(std::vector<vc::vclock_t>(1, done));
+    ok = ok && consts.must_send(1, 5);
+
+    if (!ok) {
+        std::cerr << "mismatch: programs waiting for late constants" << std::endl;
+    }
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 4) {
+        std::cerr << "usage: " << argv[0] << " <num_hops> <num_shards> <props_per_hop>" << std::endl;
+        return -1;
+    }
+
+    uint64_t num_hops = std::stoull(argv[1]);
+    uint64_t num_shards = std::stoull(argv[2]);
+    uint64_t props_per_hop = std::stoull(argv[3]);
+    // config constants are those of libweaverclient, a single vector timestamper
+    NumVts = 1;
+    ClkSz = 2;
+
+    // 4 hop traversal, the client fills params as for client::traverse_props_program
+    node_prog::traverse_props_params tp;
+    for (uint64_t h = 0; h < 5; h++) {
+        std::vector<std::pair<std::string, std::string>> props;
+        for (uint64_t i = 0; i < props_per_hop; i++) {
+            props.emplace_back("property_key_" + std::to_string(i), "property_value_" + std::to_string(h));
+        }
+        tp.node_aliases.emplace_back();
+        tp.node_props.emplace_back(props);
+        if (h < 4) {
+            tp.edge_props.emplace_back(props);
+        }
+    }
+    tp.prev_node.handle = "traversal_start_node";
+
+    node_prog::np_const_ptr_t tp_constants = tp.extract_constants();
+    if (!check_late_constants(tp_constants)) {
+        return 1;
+    }
+    report("traverse_props", tp, *tp_constants, num_hops, num_shards);
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * ===============================================================
+ *    Description:  Round trips of node program credit: whole
+ *                  credit split into random pieces and added back
+ *                  in random orders must be whole again exactly
+ *                  when the last piece is back, including the
+ *                  e = 0 boundary.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <random>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "common/prog_credit.h"
+
+using weaver_util::prog_credit_t;
+using weaver_util::whole_credit;
+using weaver_util::is_whole_credit;
+using weaver_util::add_credit;
+using weaver_util::split_credit;
+
+uint64_t failures = 0;
+
+void
+check(bool cond, const std::string &what)
+{
+    if (!cond) {
+        std::cerr << "mismatch: " << what << std::endl;
+        failures++;
+    }
+}
+
+// exponents ascending and without repeats
+bool
+well_formed(const prog_credit_t &c)
+{
+    for (uint64_t i = 1; i < c.size(); i++) {
+        if (c[i-1] >= c[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// adds pieces to an empty total in the given order, whole only after the last one
+void
+return_all(const std::vector<prog_credit_t> &pieces, const std::string &what)
+{
+    prog_credit_t total;
+    for (uint64_t i = 0; i < pieces.size(); i++) {
+        add_credit(total, pieces[i]);
+        check(well_formed(total), what + ": sum not well formed");
+        check(is_whole_credit(total) == (i+1 == pieces.size()), what + ": whole after " + std::to_string(i+1) + " of " + std::to_string(pieces.size()) + " pieces");
+    }
+}
+
+void
+check_boundary()
+{
+    // whole credit is the single exponent 0
+    prog_credit_t c = whole_credit();
+    check(is_whole_credit(c), "whole_credit() is whole");
+    check(!is_whole_credit(prog_credit_t()), "no credit is not whole");
+
+    // splitting 2^0 gives two 2^-1
+    prog_credit_t half = split_credit(c);
+    check(c == prog_credit_t(1, 1) && half == prog_credit_t(1, 1), "split of whole credit is two halves");
+    check(!is_whole_credit(c) && !is_whole_credit(half), "a half is not whole");
+
+    // two 2^-1 carry into 2^0 from either side
+    prog_credit_t a = c, b = half;
+    add_credit(a, half);
+    add_credit(b, c);
+    check(is_whole_credit(a) && is_whole_credit(b), "halves add back to whole in either order");
+
+    // nothing carries past 2^0, extra credit never looks whole
+    prog_credit_t over = whole_credit();
+    add_credit(over, whole_credit());
+    check(!is_whole_credit(over), "twice the whole credit is not whole");
+
+    // adding to or from nothing
+    prog_credit_t empty;
+    add_credit(empty, whole_credit());
+    check(is_whole_credit(empty), "whole credit added to nothing is whole");
+    prog_credit_t w = whole_credit();
+    add_credit(w, prog_credit_t());
+    check(is_whole_credit(w), "nothing added to whole credit is whole");
+}
+
+// the same piece halved depth times, as a long chain of hops would
+void
+check_deep(uint64_t depth)
+{
+    prog_credit_t c = whole_credit();
+    std::vector<prog_credit_t> pieces;
+    for (uint64_t i = 0; i < depth; i++) {
+        pieces.emplace_back(split_credit(c));
+        check(c.size() == 1 && c[0] == i+1, "deep split keeps one piece");
+    }
+    pieces.emplace_back(c);
+
+    return_all(pieces, "deep, in split order");
+    std::reverse(pieces.begin(), pieces.end());
+    return_all(pieces, "deep, in reverse order");
+}
+
+// random splits of random pieces, returned in random orders
+void
+check_random(std::mt19937_64 &gen, uint64_t num_pieces, uint64_t num_orders)
+{
+    std::vector<prog_credit_t> pieces(1, whole_credit());
+    while (pieces.size() < num_pieces) {
+        prog_credit_t &p = pieces[gen() % pieces.size()];
+        prog_credit_t half = split_credit(p);
+        check(!p.empty() && well_formed(p) && well_formed(half), "split pieces well formed");
+        pieces.emplace_back(std::move(half));
+    }
+
+    for (uint64_t i = 0; i < num_orders; i++) {
+        std::shuffle(pieces.begin(), pieces.end(), gen);
+        return_all(pieces, "random, order " + std::to_string(i));
+    }
+
+    // partial sums merged in a tree, as shards and the VT do
+    std::shuffle(pieces.begin(), pieces.end(), gen);
+    while (pieces.size() > 1) {
+        std::vector<prog_credit_t> merged;
+        for (uint64_t i = 0; i+1 < pieces.size(); i += 2) {
+            merged.emplace_back(pieces[i]);
+            add_credit(merged.back(), pieces[i+1]);
+            check(!is_whole_credit(merged.back()) || pieces.size() == 2, "partial sum is not whole");
+        }
+        if (pieces.size() % 2 == 1) {
+            merged.emplace_back(pieces.back());
+        }
+        pieces = std::move(merged);
+    }
+    check(is_whole_credit(pieces[0]), "tree of partial sums is whole");
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        std::cerr << "usage: " << argv[0] << " <num_pieces> <num_orders>" << std::endl;
+        return -1;
+    }
+
+    uint64_t num_pieces = std::stoull(argv[1]);
+    uint64_t num_orders = std::stoull(argv[2]);
+    std::mt19937_64 gen(42);
+
+    check_boundary();
+    check_deep(num_pieces);
+    for (uint64_t n = 1; n <= num_pieces; n *= 2) {
+        check_random(gen, n, num_orders);
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " credit checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "credit round trips ok" << std::endl;
+    return 0;
+}
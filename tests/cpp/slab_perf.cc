@@ -0,0 +1,141 @@
+/*
+ * ===============================================================
+ *    Description:  Bulk load and teardown of nodes and edges with
+ *                  individual heap allocations vs per node map
+ *                  slabs.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <po6/threads/mutex.h>
+
+#include "common/clock.h"
+#include "common/config_constants.h"
+#include "common/event_order.h"
+#include "db/shard_constants.h"
+#include "db/node.h"
+
+DECLARE_CONFIG_CONSTANTS;
+
+struct load_timing
+{
+    uint64_t load_ns, free_ns;
+};
+
+// bulk load as in load_graph: node and out-edges created together, then evicted
+load_timing
+run(bool use_slab, uint64_t num_nodes, uint64_t degree, vclock_ptr_t &clk,
+    po6::threads::mutex *map_mutexes,
+    db::slab<db::node> *node_slabs,
+    db::slab<db::edge> *edge_slabs)
+{
+    std::vector<db::node*> nodes;
+    nodes.reserve(num_nodes);
+    wclock::weaver_timer timer;
+    load_timing t;
+
+    uint64_t start = timer.get_real_time();
+    for (uint64_t i = 0; i < num_nodes; i++) {
+        node_handle_t handle = std::to_string(i);
+        uint64_t map_idx = i % NUM_NODE_MAPS;
+        db::node *n;
+        if (use_slab) {
+            n = new (node_slabs[map_idx]) db::node(handle, 0, clk, map_mutexes+map_idx);
+        } else {
+            n = ::new db::node(handle, 0, clk, map_mutexes+map_idx);
+        }
+
+        for (uint64_t j = 0; j < degree; j++) {
+            edge_handle_t edge_handle = handle + "_" + std::to_string(j);
+            node_handle_t nbr = std::to_string((i + j + 1) % num_nodes);
+            db::edge *e;
+            if (use_slab) {
+                e = new (edge_slabs[map_idx]) db::edge(edge_handle, clk, 0, nbr);
+            } else {
+                e = ::new db::edge(edge_handle, clk, 0, nbr);
+            }
+            n->add_edge_unique(e);
+        }
+        nodes.emplace_back(n);
+    }
+    t.load_ns = timer.get_real_time() - start;
+
+    start = timer.get_real_time();
+    for (db::node *n: nodes) {
+        if (use_slab) {
+            n->free_edges();
+            delete n;
+        } else {
+            for (uint64_t j = 0; j < n->out_adjacency.size(); j++) {
+                ::delete n->out_adjacency.at(j);
+            }
+            n->out_adjacency.clear();
+            n->out_edges.clear();
+            ::delete n;
+        }
+    }
+    t.free_ns = timer.get_real_time() - start;
+
+    return t;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 4) {
+        std::cerr << "usage: " << argv[0] << " <num_nodes> <degree> <num_rounds>" << std::endl;
+        return -1;
+    }
+
+    uint64_t num_nodes = std::stoull(argv[1]);
+    uint64_t degree = std::stoull(argv[2]);
+    uint64_t num_rounds = std::stoull(argv[3]);
+    NumVts = 1;
+    ClkSz = 2;
+
+    vc::vclock_t clk(2, 0);
+    clk[1] = 1;
+    vclock_ptr_t creat_clk(new vc::vclock(0, clk));
+
+    po6::threads::mutex map_mutexes[NUM_NODE_MAPS];
+    std::vector<db::slab<db::node>> node_slabs(NUM_NODE_MAPS);
+    std::vector<db::slab<db::edge>> edge_slabs(NUM_NODE_MAPS);
+
+    // later rounds reuse freed slots, as after eviction
+    load_timing heap = {0, 0}, slab = {0, 0};
+    for (uint64_t r = 0; r < num_rounds; r++) {
+        load_timing t = run(false, num_nodes, degree, creat_clk, map_mutexes, nullptr, nullptr);
+        heap.load_ns += t.load_ns;
+        heap.free_ns += t.free_ns;
+        t = run(true, num_nodes, degree, creat_clk, map_mutexes, node_slabs.data(), edge_slabs.data());
+        slab.load_ns += t.load_ns;
+        slab.free_ns += t.free_ns;
+    }
+
+    db::slab_stats node_stats, edge_stats;
+    for (uint64_t i = 0; i < NUM_NODE_MAPS; i++) {
+        node_stats += node_slabs[i].stats();
+        edge_stats += edge_slabs[i].stats();
+    }
+    if (node_stats.live() != 0 || edge_stats.live() != 0
+     || node_stats.allocs != num_nodes * num_rounds || edge_stats.allocs != num_nodes * degree * num_rounds) {
+        std::cerr << "mismatch: " << node_stats.live() << " nodes, " << edge_stats.live() << " edges live after teardown" << std::endl;
+        return 1;
+    }
+
+    double elems = (double)num_nodes * (degree + 1) * num_rounds;
+    std::cout << "heap: load " << heap.load_ns / 1e6 << " ms, free " << heap.free_ns / 1e6 << " ms, "
+              << elems * 1e3 / heap.load_ns << " Melems/s loaded" << std::endl;
+    std::cout << "slab: load " << slab.load_ns / 1e6 << " ms, free " << slab.free_ns / 1e6 << " ms, "
+              << elems * 1e3 / slab.load_ns << " Melems/s loaded" << std::endl;
+    std::cout << "slab chunks: " << node_stats.chunks << " node, " << edge_stats.chunks << " edge, "
+              << (node_stats.chunk_bytes + edge_stats.chunk_bytes) << " bytes" << std::endl;
+
+    return 0;
+}
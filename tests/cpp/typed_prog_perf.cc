@@ -0,0 +1,368 @@
+/*
+ * ===============================================================
+ *    Description:  Per hop cost of a traversal program on one
+ *                  shard, with the program defined by
+ *                  PROG_FUNC_DEFINE vs by typed_program. Every hop
+ *                  unpacks its params, gets the node's state, runs
+ *                  the program and packs the params of each next hop.
+ *
+ *         Author:  agent, agent@local
+ *
+ * Copyright (C) 2026, agent, see the LICENSE file
+ *                     for licensing agreement
+ * ===============================================================
+ */
+
+#include <dlfcn.h>
+#include <deque>
+#include <random>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "common/clock.h"
+#include "common/config_constants.h"
+#include "common/stl_serialization.h"
+#include "node_prog/boilerplate.h"
+#include "node_prog/typed_program.h"
+#include "db/prog_state_arena.h"
+
+DECLARE_CONFIG_CONSTANTS;
+
+namespace node_prog
+{
+    // what the programs need of a node
+    class bench_node : public node
+    {
+        public:
+            node_handle_t handle;
+            std::vector<db::remote_node> nbrs;
+
+            const node_handle_t& get_handle() const { return handle; }
+            bool edge_exists(const edge_handle_t&) { return false; }
+            edge& get_edge(const edge_handle_t&) { abort(); }
+            edge_list get_edges() { abort(); }
+            in_edge_list get_in_edges() { abort(); }
+            prop_list get_properties() { abort(); }
+            std::string get_property(const std::string&) { return std::string(); }
+            bool has_property(std::pair<std::string, std::string>&) { return false; }
+            bool has_all_properties(std::vector<std::pair<std::string, std::string>>&) { return true; }
+            bool has_all_predicates(std::vector<predicate::prop_predicate>&) { return true; }
+            bool is_alias(const node_handle_t&) const { return false; }
+            void get_client_node(cl::node&, bool, bool, bool) { }
+    };
+
+    // params of both programs
+    struct hop_fields
+    {
+        uint32_t hops, max_hops;
+        db::remote_node prev_node;
+        std::vector<std::pair<std::string, std::string>> edge_props;
+
+        hop_fields() : hops(0), max_hops(0) { }
+
+        uint64_t fields_size(void *aux_args) const
+        {
+            return message::size(aux_args, hops)
+                 + message::size(aux_args, max_hops)
+                 + message::size(aux_args, prev_node)
+                 + message::size(aux_args, edge_props);
+        }
+
+        void fields_pack(e::packer &packer, void *aux_args) const
+        {
+            message::pack_buffer(packer, aux_args, hops);
+            message::pack_buffer(packer, aux_args, max_hops);
+            message::pack_buffer(packer, aux_args, prev_node);
+            message::pack_buffer(packer, aux_args, edge_props);
+        }
+
+        void fields_unpack(e::unpacker &unpacker, void *aux_args)
+        {
+            message::unpack_buffer(unpacker, aux_args, hops);
+            message::unpack_buffer(unpacker, aux_args, max_hops);
+            message::unpack_buffer(unpacker, aux_args, prev_node);
+            message::unpack_buffer(unpacker, aux_args, edge_props);
+        }
+    };
+
+    struct hop_params : public virtual Node_Parameters_Base, public hop_fields
+    {
+        ~hop_params() { }
+        uint64_t size(void *aux_args) const { return fields_size(aux_args); }
+        void pack(e::packer &packer, void *aux_args) const { fields_pack(packer, aux_args); }
+        void unpack(e::unpacker &unpacker, void *aux_args) { fields_unpack(unpacker, aux_args); }
+        bool search_cache() { return false; }
+        cache_key_t cache_key() { return cache_key_t(); }
+    };
+
+    struct hop_state : public virtual Node_State_Base
+    {
+        bool visited;
+        uint32_t hops;
+        db::remote_node parent;
+
+        hop_state() : visited(false), hops(0) { }
+        ~hop_state() { }
+        uint64_t size(void*) const { return 0; }
+        void pack(e::packer&, void*) const { }
+        void unpack(e::unpacker&, void*) { }
+    };
+
+    struct typed_hop_params : public Node_Parameters_Base, public hop_fields
+    {
+        ~typed_hop_params() { }
+        uint64_t size(void *aux_args) const { return fields_size(aux_args); }
+        void pack(e::packer &packer, void *aux_args) const { fields_pack(packer, aux_args); }
+        void unpack(e::unpacker &unpacker, void *aux_args) { fields_unpack(unpacker, aux_args); }
+        bool search_cache() { return false; }
+        cache_key_t cache_key() { return cache_key_t(); }
+    };
+
+    struct typed_hop_state : public Node_State_Base
+    {
+        bool visited;
+        uint32_t hops;
+        db::remote_node parent;
+
+        typed_hop_state() : visited(false), hops(0) { }
+        ~typed_hop_state() { }
+        uint64_t size(void*) const { return 0; }
+        void pack(e::packer&, void*) const { }
+        void unpack(e::unpacker&, void*) { }
+    };
+
+    struct typed_hop : public typed_program<typed_hop>
+    {
+        typedef typed_hop_params params_type;
+        typedef typed_hop_state state_type;
+
+        static search_type
+        run(node &n, db::remote_node &rn, typed_hop_params &params,
+            const typed_state<typed_hop_state> &get_state, next_hops_t &next)
+        {
+            typed_hop_state &state = get_state();
+            if (state.visited) {
+                return search_type::BREADTH_FIRST;
+            }
+            state.visited = true;
+            state.hops = params.hops;
+            state.parent = params.prev_node;
+
+            if (params.hops < params.max_hops) {
+                for (const db::remote_node &nbr: static_cast<bench_node&>(n).nbrs) {
+                    auto p = make_params(params);
+                    p->hops++;
+                    p->prev_node = rn;
+                    next.emplace_back(nbr, p);
+                }
+            }
+            return search_type::BREADTH_FIRST;
+        }
+    };
+
+    extern "C" {
+        PROG_FUNC_DECLARE;
+    }
+}
+
+using node_prog::Node_Parameters_Base;
+using node_prog::Node_State_Base;
+using node_prog::search_type;
+using node_prog::hop_params;
+using node_prog::hop_state;
+
+extern "C" {
+
+PROG_FUNC_DEFINE(hop);
+
+std::pair<search_type, std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>>>
+node_prog :: node_program(node &n,
+    db::remote_node &rn,
+    std::shared_ptr<Node_Parameters_Base> param_ptr,
+    std::function<Node_State_Base&()> state_getter)
+{
+    hop_params &params = dynamic_cast<hop_params&>(*param_ptr);
+    hop_state &state = dynamic_cast<hop_state&>(state_getter());
+
+    std::vector<std::pair<db::remote_node, std::shared_ptr<Node_Parameters_Base>>> next;
+    if (state.visited) {
+        return std::make_pair(search_type::BREADTH_FIRST, next);
+    }
+    state.visited = true;
+    state.hops = params.hops;
+    state.parent = params.prev_node;
+
+    if (params.hops < params.max_hops) {
+        for (const db::remote_node &nbr: static_cast<bench_node&>(n).nbrs) {
+            auto p = std::make_shared<hop_params>(params);
+            p->hops++;
+            p->prev_node = rn;
+            next.emplace_back(nbr, p);
+        }
+    }
+    return std::make_pair(search_type::BREADTH_FIRST, next);
+}
+
+}
+
+// as the shard gets the state of a node
+node_prog::Node_State_Base&
+get_state(db::request_states &states, const dynamic_prog_table &prog, const node_handle_t &handle)
+{
+    return states.get(handle, prog);
+}
+
+struct hop_state_ctx
+{
+    db::request_states *states;
+    const dynamic_prog_table *prog;
+    const node_handle_t *handle;
+};
+
+node_prog::Node_State_Base&
+get_hop_state(void *ctx)
+{
+    hop_state_ctx *hop = (hop_state_ctx*)ctx;
+    return get_state(*hop->states, *hop->prog, *hop->handle);
+}
+
+// the table the shard loads for a typed program
+void
+set_typed(dynamic_prog_table &t)
+{
+    typedef node_prog::typed_program<node_prog::typed_hop> tp;
+    t.param_ctor = tp::param_ctor;
+    t.param_size = tp::param_size;
+    t.param_pack = tp::param_pack;
+    t.param_unpack = tp::param_unpack;
+    t.state_ctor = tp::state_ctor;
+    t.state_size = tp::state_size;
+    t.state_pack = tp::state_pack;
+    t.state_unpack = tp::state_unpack;
+    t.state_bytes = tp::state_bytes;
+    t.state_ctor_at = tp::state_ctor_at;
+    t.node_program = nullptr;
+    t.typed_node_program = tp::node_program;
+}
+
+// one query, returns number of hops run
+uint64_t
+run_query(std::vector<node_prog::bench_node> &nodes,
+    const std::unordered_map<node_handle_t, uint64_t> &index,
+    const dynamic_prog_table &prog,
+    uint64_t source,
+    uint32_t max_hops,
+    uint64_t &bytes)
+{
+    auto states = std::make_shared<db::request_states>();
+    std::deque<std::pair<uint64_t, np_param_ptr_t>> frontier;
+
+    np_param_ptr_t start = prog.param_ctor();
+    node_prog::hop_fields *start_fields = prog.typed_node_program == nullptr?
+        static_cast<node_prog::hop_fields*>(&dynamic_cast<node_prog::hop_params&>(*start))
+      : static_cast<node_prog::hop_fields*>(&static_cast<node_prog::typed_hop_params&>(*start));
+    start_fields->max_hops = max_hops;
+    start_fields->edge_props.emplace_back("color", "blue");
+    frontier.emplace_back(source, start);
+
+    uint64_t hops = 0;
+    while (!frontier.empty()) {
+        node_prog::bench_node &n = nodes[frontier.front().first];
+        np_param_ptr_t params = std::move(frontier.front().second);
+        frontier.pop_front();
+        db::remote_node this_node(0, n.handle);
+        hops++;
+
+        std::pair<search_type, std::vector<std::pair<db::remote_node, np_param_ptr_t>>> next;
+        if (prog.typed_node_program != nullptr) {
+            hop_state_ctx state_ctx = { states.get(), &prog, &n.handle };
+            node_prog::state_accessor state_acc = { get_hop_state, &state_ctx };
+            next = prog.typed_node_program(n, this_node, params, state_acc);
+        } else {
+            std::function<Node_State_Base&()> state_getter = std::bind(get_state,
+                std::ref(*states),
+                std::cref(prog),
+                std::cref(n.handle));
+            next = prog.node_program(n, this_node, params, state_getter);
+        }
+
+        // as if every next hop is at another shard
+        for (auto &p: next.second) {
+            uint64_t sz = prog.param_size(*p.second, nullptr);
+            std::unique_ptr<e::buffer> buf(e::buffer::create(sz));
+            e::packer packer = buf->pack_at(0);
+            prog.param_pack(*p.second, packer, nullptr);
+            bytes += sz;
+
+            np_param_ptr_t recv = prog.param_ctor();
+            e::unpacker unpacker = buf->unpack_from(0);
+            prog.param_unpack(*recv, unpacker, nullptr);
+            frontier.emplace_back(index.at(p.first.handle), std::move(recv));
+        }
+    }
+
+    return hops;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 4) {
+        std::cerr << "usage: " << argv[0] << " <num_nodes> <degree> <num_queries>" << std::endl;
+        return -1;
+    }
+
+    uint64_t num_nodes = std::stoull(argv[1]);
+    uint64_t degree = std::stoull(argv[2]);
+    uint64_t num_queries = std::stoull(argv[3]);
+    const uint32_t max_hops = 4;
+
+    std::vector<node_prog::bench_node> nodes(num_nodes);
+    std::unordered_map<node_handle_t, uint64_t> index;
+    std::mt19937_64 rng(42);
+    for (uint64_t i = 0; i < num_nodes; i++) {
+        nodes[i].handle = "n" + std::to_string(i);
+        index.emplace(nodes[i].handle, i);
+    }
+    for (uint64_t i = 0; i < num_nodes; i++) {
+        for (uint64_t j = 0; j < degree; j++) {
+            nodes[i].nbrs.emplace_back(0, nodes[rng() % num_nodes].handle);
+        }
+    }
+
+    // functions of this binary, as the shard finds them in a program library
+    dynamic_prog_table old_table(dlopen(nullptr, RTLD_NOW));
+    dynamic_prog_table typed_table(dlopen(nullptr, RTLD_NOW));
+    assert(old_table.node_program != nullptr && old_table.typed_node_program == nullptr);
+    set_typed(typed_table);
+
+    wclock::weaver_timer timer;
+    std::cout << "api\tns_per_hop\thops\tbytes_per_hop" << std::endl;
+
+    uint64_t api_hops[2];
+    for (bool typed: {false, true}) {
+        const dynamic_prog_table &prog = typed? typed_table : old_table;
+        std::mt19937_64 query_rng(7);
+        uint64_t hops = 0, bytes = 0;
+
+        uint64_t start = timer.get_real_time();
+        for (uint64_t q = 0; q < num_queries; q++) {
+            hops += run_query(nodes, index, prog, query_rng() % num_nodes, max_hops, bytes);
+        }
+        uint64_t elapsed = timer.get_real_time() - start;
+
+        std::cout << (typed? "typed\t" : "virtual\t")
+                  << elapsed / hops << "\t"
+                  << hops << "\t"
+                  << bytes / hops << std::endl;
+        api_hops[typed] = hops;
+    }
+
+    if (api_hops[0] != api_hops[1]) {
+        std::cerr << "mismatch: virtual api ran " << api_hops[0] << " hops, typed api ran " << api_hops[1] << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
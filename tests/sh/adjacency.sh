@@ -0,0 +1,9 @@
+#! /bin/bash
+#
+# adjacency.sh
+# Copyright (C) 2026 agent <agent@local>
+#
+# See the LICENSE file for licensing agreement
+#
+
+weaver-test-adj 1000 10
@@ -0,0 +1,9 @@
+#! /bin/bash
+#
+# clock_table.sh
+# Copyright (C) 2026 agent <agent@local>
+#
+# See the LICENSE file for licensing agreement
+#
+
+weaver-test-clocks 10000 4 10 4 100000
@@ -0,0 +1,9 @@
+#! /bin/bash
+#
+# dense_state.sh
+# Copyright (C) 2026 agent <agent@local>
+#
+# See the LICENSE file for licensing agreement
+#
+
+weaver-test-dense-state 1000 4 10
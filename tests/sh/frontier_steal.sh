@@ -0,0 +1,9 @@
+#! /bin/bash
+#
+# frontier_steal.sh
+# Copyright (C) 2026 agent <agent@local>
+#
+# See the LICENSE file for licensing agreement
+#
+
+weaver-test-frontier 10000 4 64
@@ -0,0 +1,9 @@
+#! /bin/bash
+#
+# in_adjacency.sh
+# Copyright (C) 2026 agent <agent@local>
+#
+# See the LICENSE file for licensing agreement
+#
+
+weaver-test-in-adj 1000 10
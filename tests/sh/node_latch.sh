@@ -0,0 +1,9 @@
+#! /bin/bash
+#
+# node_latch.sh
+# Copyright (C) 2026 agent <agent@local>
+#
+# See the LICENSE file for licensing agreement
+#
+
+weaver-test-latch 4 16 1000
@@ -0,0 +1,9 @@
+#! /bin/bash
+#
+# outbox.sh
+# Copyright (C) 2026 agent <agent@local>
+#
+# See the LICENSE file for licensing agreement
+#
+
+weaver-test-outbox 20 2000 1000
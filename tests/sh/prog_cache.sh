@@ -0,0 +1,9 @@
+#! /bin/bash
+#
+# prog_cache.sh
+# Copyright (C) 2026 agent <agent@local>
+#
+# See the LICENSE file for licensing agreement
+#
+
+weaver-test-prog-cache 1000 4 20 2000 50
@@ -0,0 +1,9 @@
+#! /bin/bash
+#
+# prog_constants.sh
+# Copyright (C) 2026 agent <agent@local>
+#
+# See the LICENSE file for licensing agreement
+#
+
+weaver-test-prog-constants 1000 4 4
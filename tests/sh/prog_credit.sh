@@ -0,0 +1,9 @@
+#! /bin/bash
+#
+# prog_credit.sh
+# Copyright (C) 2026 agent <agent@local>
+#
+# See the LICENSE file for licensing agreement
+#
+
+weaver-test-credit 1000 10
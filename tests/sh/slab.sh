@@ -0,0 +1,9 @@
+#! /bin/bash
+#
+# slab.sh
+# Copyright (C) 2026 agent <agent@local>
+#
+# See the LICENSE file for licensing agreement
+#
+
+weaver-test-slab 1000 4 2
@@ -0,0 +1,9 @@
+#! /bin/bash
+#
+# typed_prog.sh
+# Copyright (C) 2026 agent <agent@local>
+#
+# See the LICENSE file for licensing agreement
+#
+
+weaver-test-typed-prog 1000 4 10